@@ -0,0 +1,38 @@
+// Library of per-vertex displacements used by the animated elements of the scene
+//  Each function returns the offset added to the vertex position in world space.
+//  The function actually used is selected in mesh_custom.vert.glsl by the DEFORMATION_xxx define.
+
+// Foliage of the birch trees swaying in the wind
+vec3 deformation_birch(vec3 p, float t)
+{
+	return vec3(0.5 * sin(t + 45.0 * p.z), 0.5 * cos(t + 40.0 * p.z), 0.5 * sin(t + 30.0 * p.z));
+}
+
+// Static noisy displacement of the ground
+vec3 deformation_earth(vec3 p, float t)
+{
+	float frequency = 0.5;
+	return vec3( 10.0 * sin(frequency * (3.0 * p.x + 100.0 * p.z)),
+	             15.0 * cos(frequency * (20.0 * p.y + 100.0 * p.z - p.x)),
+	              7.0 * sin(frequency * (3.0 + 100.0 * p.z + p.x * p.y)) );
+}
+
+// Grass blades moving in the wind
+vec3 deformation_grass(vec3 p, float t)
+{
+	return vec3( 0.07 * sin(3.0 * t + 100.0 * p.x + p.y * p.z),
+	             0.09 * cos(3.0 * t + 100.0 * p.y + p.z * p.x),
+	             0.07 * cos(3.0 * t + 100.0 * p.z + p.y * p.x) );
+}
+
+// Wriggling of a snake body oriented along the x-axis
+vec3 deformation_snake_x(vec3 p, float t)
+{
+	return vec3(0.0, 0.15 * sin(3.0 * t + 100.0 * p.x + p.x * p.x), 0.0);
+}
+
+// Wriggling of a snake body oriented along the y-axis
+vec3 deformation_snake_y(vec3 p, float t)
+{
+	return vec3(0.15 * sin(3.0 * t + 100.0 * p.y + p.y * p.y), 0.0, 0.0);
+}
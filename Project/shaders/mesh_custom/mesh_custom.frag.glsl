@@ -9,6 +9,8 @@
 //    - image_texture: color coming from the texture image
 //  The color considered is the product of: fragment_data.color x material.color x image_texture
 //  The alpha (/transparent) channel is obtained as the product of: material.alpha x image_texture.a
+//
+// If TEXTURE_ARRAY is defined, image_texture is a GL_TEXTURE_2D_ARRAY sampled at the layer received from the vertex shader.
 // 
 
 uniform float time;
@@ -30,7 +32,15 @@ layout(location=0) out vec4 FragColor;
 // Uniform values that must be send from the C++ code
 // ***************************************************** //
 
+#ifdef TEXTURE_ARRAY
+#ifdef GL_ES
+precision mediump sampler2DArray; // no default precision for this sampler in OpenGL ES
+#endif
+uniform sampler2DArray image_texture; // Texture array - the layer is given per vertex or per instance
+flat in float texture_layer;          // Layer of the texture array used by this fragment
+#else
 uniform sampler2D image_texture;   // Texture image identifiant
+#endif
 
 uniform mat4 view;       // View matrix (rigid transform) of the camera - to compute the camera position
 
@@ -110,7 +120,11 @@ void main()
 	}
 
 	// Get the current texture color
+#ifdef TEXTURE_ARRAY
+	vec4 color_image_texture = texture(image_texture, vec3(uv_image, texture_layer));
+#else
 	vec4 color_image_texture = texture(image_texture, uv_image);
+#endif
 	if(material.texture_settings.use_texture == false) {
 		color_image_texture=vec4(1.0,1.0,1.0,1.0);
 	}
@@ -1,6 +1,13 @@
 #version 330 core
 
 // Vertex shader - this code is executed for every vertex of the shape
+//
+// Shared by all the animated elements of the scene. The displacement applied to the vertex is selected
+//  at compile time by one of the defines: DEFORMATION_BIRCH, DEFORMATION_EARTH, DEFORMATION_GRASS,
+//  DEFORMATION_SNAKE_X, DEFORMATION_SNAKE_Y (no displacement if none is defined).
+// With TEXTURE_ARRAY, the layer of the texture array is read from the attribute at location 4.
+// With INSTANCED, the global transform of the instance (hierarchy_mesh_drawable_instances) is read at locations 5 to 8
+//  and applied before the model matrix of the drawable.
 
 uniform float time;
 
@@ -9,6 +16,13 @@ layout (location = 0) in vec3 vertex_position; // vertex position in local space
 layout (location = 1) in vec3 vertex_normal;   // vertex normal in local space   (nx,ny,nz)
 layout (location = 2) in vec3 vertex_color;    // vertex color      (r,g,b)
 layout (location = 3) in vec2 vertex_uv;       // vertex uv-texture (u,v)
+#ifdef TEXTURE_ARRAY
+layout (location = 4) in float vertex_layer;   // layer of the texture array (per vertex, or per instance with a divisor)
+flat out float texture_layer;
+#endif
+#ifdef INSTANCED
+layout (location = 5) in mat4 instance_model;  // rows of the cgp matrix of the instance (per instance)
+#endif
 
 // Output variables sent to the fragment shader
 out struct fragment_data
@@ -24,22 +38,37 @@ uniform mat4 model; // Model affine transform matrix associated to the current s
 uniform mat4 view;  // View matrix (rigid transform) of the camera
 uniform mat4 projection; // Projection (perspective or orthogonal) matrix of the camera
 
+#include "deformation.glsl"
 
 void main()
 {
-	float freaquance = 0.5;
+	// Displacement of the vertex in world space
+#if defined(DEFORMATION_BIRCH)
+	vec3 offset = deformation_birch(vertex_position, time);
+#elif defined(DEFORMATION_EARTH)
+	vec3 offset = deformation_earth(vertex_position, time);
+#elif defined(DEFORMATION_GRASS)
+	vec3 offset = deformation_grass(vertex_position, time);
+#elif defined(DEFORMATION_SNAKE_X)
+	vec3 offset = deformation_snake_x(vertex_position, time);
+#elif defined(DEFORMATION_SNAKE_Y)
+	vec3 offset = deformation_snake_y(vertex_position, time);
+#else
+	vec3 offset = vec3(0.0);
+#endif
 
-	// The position of the vertex in the world space
-     mat4 M = transpose(
-         mat4(1.0, 0.0, 0.0, 0.5 * sin(time + 45 * vertex_position.z ) ,
-             0.0, 1.0, 0.0, 0.5 * cos(time + 40 * vertex_position.z),
-             0.0, 0.0, 1.0,  0.5 * sin(time + 30 * vertex_position.z),
-             0.0, 0.0, 0.0, 1.0));
+#ifdef INSTANCED
+	mat4 M = transpose(instance_model) * model;
+#else
+	mat4 M = model;
+#endif
 
-	vec4 position = M * model * vec4(vertex_position, 1.0);
+	// The position of the vertex in the world space
+	vec4 position = M * vec4(vertex_position, 1.0);
+	position.xyz += offset;
 
 	// The normal of the vertex in the world space
-	mat4 modelNormal = transpose(inverse(model));
+	mat4 modelNormal = transpose(inverse(M));
 	vec4 normal = modelNormal * vec4(vertex_normal, 0.0);
 
 
@@ -51,6 +80,9 @@ void main()
 	fragment.normal   = normal.xyz;
 	fragment.color = vertex_color;
 	fragment.uv = vertex_uv;
+#ifdef TEXTURE_ARRAY
+	texture_layer = vertex_layer;
+#endif
 
 	// gl_Position is a built-in variable which is the expected output of the vertex shader
 	gl_Position = position_projected; // gl_Position is the projected vertex position (in normalized device coordinates)
@@ -14,33 +14,25 @@ void amanite_mushroom::initialize(scene_structure &scene) {
     constexpr float CAP_HEIGHT = 0.4f;
     constexpr float CAP_RADIUS = 0.6f;
 
-    // Paths to texture files
-    const std::string STEM_TEXTURE_PATH = project::path + "assets/stem.jpg";
-    const std::string CAP_TEXTURE_PATH = project::path + "assets/cap_amanite.jpg";
-
-    // Create the stem mesh and apply texture
+    // Create the stem and cap meshes
     mesh stem_amanite_mesh = create_stem_amanite(STEM_HEIGHT);
-    scene.initialize_mesh_with_texture(stem, stem_amanite_mesh, STEM_TEXTURE_PATH);
-
-    // Create the cap mesh and apply texture
     mesh cap_amanite_mesh = create_cone_mesh(CAP_RADIUS, CAP_HEIGHT, STEM_HEIGHT);
-    scene.initialize_mesh_with_texture(cap, cap_amanite_mesh, CAP_TEXTURE_PATH);
 
-    // Add the stem and cap to the hierarchy
-    hierarchy.add(stem, "stem");
-    hierarchy.add(cap, "cap", "stem");
+    // Merge them in a single drawable using the stem and cap layers of the texture array
+    scene.initialize_mesh_with_texture_layers(mushroom, {stem_amanite_mesh, cap_amanite_mesh},
+                                              {mushroom_manager::LAYER_STEM, mushroom_manager::LAYER_CAP_AMANITE},
+                                              scene.mushroom_manager.texture_array);
 }
 
 
 void amanite_mushroom::display(scene_structure &scene, const vec3 &position) {
-    // Set the translation for the stem position
-    hierarchy["stem"].transform_local.translation = position;
+    // Set the translation of the mushroom
+    mushroom.model.translation = position;
 
     // Adjust the size of the mushroom for a dynamic visual effect
-    const float SCALE_FACTOR = 1.0f + fabs(sin(scene.timer.t + position[2])) / 2.0f;
-    hierarchy["stem"].transform_local.scaling = SCALE_FACTOR;
+    const float SCALE_FACTOR = 1.0f + fabs(sin(scene.animation.t + position[2])) / 2.0f;
+    mushroom.model.scaling = SCALE_FACTOR;
 
-    // Update hierarchy to global coordinates and draw the mushroom
-    hierarchy.update_local_to_global_coordinates();
-    draw(hierarchy, scene.environment);
-}
+    // Draw the mushroom (stem and cap in a single draw call)
+    draw(mushroom, scene.environment);
+}
\ No newline at end of file
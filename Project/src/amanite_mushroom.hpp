@@ -10,12 +10,8 @@ using namespace cgp;
 
 // Structure representing an amanite mushroom
 struct amanite_mushroom {
-    // Hierarchical drawable for the mushroom
-    cgp::hierarchy_mesh_drawable hierarchy;
-
-    // Drawable components
-    mesh_drawable stem;
-    mesh_drawable cap;
+    // Stem and cap merged in a single drawable, textured by the layers of the mushroom texture array
+    mesh_drawable mushroom;
 
     // Function to initialize the mushroom in the scene
     void initialize(scene_structure &scene);
@@ -0,0 +1,538 @@
+#include "benchmark.hpp"
+#include "scene.hpp"
+#include "scene_config.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+using namespace cgp;
+
+namespace {
+    // Summary of a series of durations (in milliseconds)
+    struct benchmark_statistics {
+        double mean = 0;
+        double min = 0;
+        double max = 0;
+        double p50 = 0;
+        double p95 = 0;
+        double p99 = 0;
+    };
+
+    // Nearest-rank percentile of sorted values
+    double percentile(const std::vector<double> &sorted, double p) {
+        if (sorted.empty())
+            return 0;
+        size_t rank = size_t(p / 100.0 * double(sorted.size()) + 0.999999);
+        rank = std::max(size_t(1), std::min(rank, sorted.size()));
+        return sorted[rank - 1];
+    }
+
+    benchmark_statistics compute_statistics(std::vector<double> values) {
+        benchmark_statistics s;
+        if (values.empty())
+            return s;
+        std::sort(values.begin(), values.end());
+        double sum = 0;
+        for (double v : values)
+            sum += v;
+        s.mean = sum / double(values.size());
+        s.min = values.front();
+        s.max = values.back();
+        s.p50 = percentile(values, 50);
+        s.p95 = percentile(values, 95);
+        s.p99 = percentile(values, 99);
+        return s;
+    }
+
+    std::string json_string(const std::string &s) {
+        std::string result = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            result += c;
+        }
+        return result + "\"";
+    }
+
+    std::string json_statistics(const benchmark_statistics &s) {
+        std::ostringstream out;
+        out << "{\"mean\": " << s.mean << ", \"min\": " << s.min << ", \"max\": " << s.max
+            << ", \"p50\": " << s.p50 << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99 << "}";
+        return out.str();
+    }
+
+    // Value of "key" in the object "section" of a JSON file written by benchmark_run (0 if not found)
+    double json_find_value(const std::string &json, const std::string &section, const std::string &key) {
+        size_t const section_position = json.find("\"" + section + "\"");
+        if (section_position == std::string::npos)
+            return 0;
+        size_t const key_position = json.find("\"" + key + "\":", section_position);
+        if (key_position == std::string::npos)
+            return 0;
+        return std::strtod(json.c_str() + key_position + key.size() + 3, nullptr);
+    }
+
+    // Time of each stage in each measured frame (0 if the stage is absent from the frame)
+    using stage_times = std::map<std::string, std::vector<double>>;
+
+    void accumulate_stages(stage_times &cpu, stage_times &gpu, const std::deque<profiler_frame> &frames,
+                           int first_frame, int number_of_frames) {
+        for (const profiler_frame &frame : frames) {
+            int const k = frame.index - first_frame;
+            if (k < 0 || k >= number_of_frames)
+                continue;
+            for (const profiler_event &event : frame.events) {
+                stage_times &stages = event.thread < 0 ? gpu : cpu;
+                std::vector<double> &times = stages[event.name];
+                times.resize(number_of_frames, 0.0);
+                times[k] += event.duration / 1000.0;
+            }
+        }
+    }
+
+    // Mean per frame of the render statistics (total of the frame, then each scope)
+    std::string json_render_stats(const render_stats_structure &stats) {
+        std::vector<std::string> names = {"total"};
+        std::map<std::string, render_stats_counters> sums;
+        for (const render_stats_frame &frame : stats.frames()) {
+            sums["total"] += frame.total;
+            for (const render_stats_scope_counters &scope : frame.scopes) {
+                if (sums.find(scope.name) == sums.end())
+                    names.push_back(scope.name);
+                sums[scope.name] += scope.counters;
+            }
+        }
+
+        double const N = std::max(size_t(1), stats.frames().size());
+        std::ostringstream out;
+        out << "{";
+        for (size_t k = 0; k < names.size(); ++k) {
+            const render_stats_counters &c = sums[names[k]];
+            out << (k == 0 ? "\n    " : ",\n    ") << json_string(names[k]) << ": {\"draw_calls\": " << c.draw_calls / N
+                << ", \"program_switches\": " << c.program_switches / N << ", \"texture_binds\": " << c.texture_binds / N
+                << ", \"uniform_uploads\": " << c.uniform_uploads / N << ", \"triangles\": " << double(c.triangles) / N << "}";
+        }
+        out << "\n  }";
+        return out.str();
+    }
+
+    std::string json_stages(const stage_times &stages) {
+        std::string result = "{";
+        bool first = true;
+        for (const auto &stage : stages) {
+            result += (first ? "\n    " : ",\n    ") + json_string(stage.first) + ": " +
+                      json_statistics(compute_statistics(stage.second));
+            first = false;
+        }
+        return result + "\n  }";
+    }
+
+    // Renderer, resolution and number of frames
+    std::string json_context(const benchmark_parameters &parameters) {
+        GLubyte const *renderer = glGetString(GL_RENDERER);
+        GLubyte const *version = glGetString(GL_VERSION);
+        std::ostringstream out;
+        out << "  \"renderer\": " << json_string(renderer != nullptr ? reinterpret_cast<char const *>(renderer) : "") << ",\n"
+            << "  \"opengl_version\": " << json_string(version != nullptr ? reinterpret_cast<char const *>(version) : "") << ",\n"
+            << "  \"width\": " << parameters.width << ",\n"
+            << "  \"height\": " << parameters.height << ",\n"
+            << "  \"frames\": " << parameters.frames << ",\n"
+            << "  \"warmup_frames\": " << parameters.warmup_frames << ",\n";
+        return out.str();
+    }
+
+    // Write the results in the file (nothing to do if filename is empty)
+    bool write_output(const std::string &filename, const std::string &json) {
+        if (filename.empty())
+            return true;
+        std::ofstream stream(filename);
+        if (!stream) {
+            std::cerr << "Benchmark: cannot write " << filename << std::endl;
+            return false;
+        }
+        stream << json;
+        std::cout << "Benchmark: results written in " << filename << std::endl;
+        return true;
+    }
+
+    // Values of a comma-separated list
+    std::vector<std::string> split_list(const std::string &list) {
+        std::vector<std::string> values;
+        std::istringstream stream(list);
+        std::string value;
+        while (std::getline(stream, value, ','))
+            if (!value.empty())
+                values.push_back(value);
+        return values;
+    }
+
+    bool load_camera_path(const benchmark_parameters &parameters, std::vector<benchmark_camera_key> &path) {
+        path = benchmark_camera_path_default();
+        if (!parameters.camera_path.empty()) {
+            path = benchmark_camera_path_load(parameters.camera_path);
+            if (path.empty()) {
+                std::cerr << "Benchmark: cannot read the camera path " << parameters.camera_path << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Render warmup_frames + frames frames along the camera path in a framebuffer object, and return the time of each measured frame
+    //  first_measured_frame is set to the index of the first measured frame in the history of the profiler.
+    std::vector<double> render_frames(scene_structure &scene, const benchmark_parameters &parameters,
+                                      const std::vector<benchmark_camera_key> &path, int &first_measured_frame) {
+        using clock = std::chrono::steady_clock;
+
+        // There is no default framebuffer in a headless context: the scene is rendered in a framebuffer object
+        scene.window.width = parameters.width;
+        scene.window.height = parameters.height;
+        opengl_fbo_structure fbo = {};
+        fbo.initialize();
+        fbo.update_screen_size(parameters.width, parameters.height);
+        scene.camera_projection.aspect_ratio = scene.window.aspect_ratio();
+        scene.environment.camera_projection = scene.camera_projection.matrix();
+
+        // The stages are measured by the markers of the profiler
+        profiler_structure &profiler = default_profiler();
+        profiler_structure::enabled = true;
+        profiler.max_frames = parameters.warmup_frames + parameters.frames + 1;
+        profiler.clear_history();
+        render_stats_structure &render_stats = default_render_stats();
+        render_stats.max_frames = parameters.frames;
+
+        int const total_frames = parameters.warmup_frames + parameters.frames;
+        first_measured_frame = -1;
+        std::vector<double> frame_times;
+        frame_times.reserve(parameters.frames);
+
+        std::cout << "Benchmark: " << parameters.warmup_frames << " warmup frames + " << parameters.frames
+                  << " measured frames (" << parameters.width << "x" << parameters.height << ")" << std::endl;
+        for (int k = 0; k < total_frames; ++k) {
+            clock::time_point const frame_start = clock::now();
+            profiler.frame_begin();
+            if (k == parameters.warmup_frames) {
+                first_measured_frame = profiler.frames().empty() ? 0 : profiler.frames().back().index + 1;
+                render_stats.clear_history();
+            }
+            render_stats.frame_begin();
+
+            // The measured frames describe exactly one loop of the camera path
+            float const s = float(k - parameters.warmup_frames) / float(parameters.frames);
+            benchmark_camera_key const key = benchmark_camera_path_evaluate(path, s);
+            scene.camera_control.look_at(key.eye, key.center);
+            scene.environment.camera_view = scene.camera_control.camera_model.matrix_view();
+            scene.simulation.set_time(k * double(parameters.time_step));
+
+            fbo.bind();
+            glViewport(0, 0, parameters.width, parameters.height);
+            vec3 const &background_color = scene.environment.background_color;
+            glClearColor(background_color.x, background_color.y, background_color.z, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glEnable(GL_DEPTH_TEST);
+
+            default_job_system().execute_main_thread_jobs();
+            scene.display_frame();
+            fbo.unbind();
+
+            // Wait for the GPU, as a swap of buffers would: the frame time includes the rendering
+            {
+                CGP_PROFILE_SCOPE("wait GPU");
+                glFinish();
+            }
+            render_stats.frame_end();
+            profiler.frame_end();
+
+            double const frame_time = std::chrono::duration<double, std::milli>(clock::now() - frame_start).count();
+            if (k >= parameters.warmup_frames)
+                frame_times.push_back(frame_time);
+        }
+        // Read the GPU timings of the last frames
+        profiler.frame_begin();
+        profiler.frame_end();
+        opengl_check;
+
+        // Release the framebuffer (its depth buffer has the maximal size)
+        fbo.texture.clear();
+        glDeleteRenderbuffers(1, &fbo.depth_buffer_id);
+        glDeleteFramebuffers(1, &fbo.id);
+
+        return frame_times;
+    }
+}
+
+bool benchmark_parse_arguments(int argc, char *argv[], benchmark_parameters &parameters) {
+    bool is_benchmark = false;
+    for (int k = 1; k < argc; ++k) {
+        std::string const argument = argv[k];
+        bool const has_value = k + 1 < argc;
+
+        if (argument == "--benchmark")
+            is_benchmark = true;
+        else if (argument == "--stress") {
+            is_benchmark = true;
+            parameters.stress = true;
+        } else if (argument == "--stress-factors" && has_value) {
+            parameters.stress_factors.clear();
+            for (const std::string &value : split_list(argv[++k])) {
+                float const factor = float(std::atof(value.c_str()));
+                if (factor > 0)
+                    parameters.stress_factors.push_back(factor);
+            }
+        } else if (argument == "--stress-subsystems" && has_value)
+            parameters.stress_subsystems = split_list(argv[++k]);
+        else if ((argument == "--config" || argument == "--set") && has_value)
+            ++k; // scene configuration (see scene_config_parse_arguments)
+        else if (argument == "--frames" && has_value)
+            parameters.frames = std::max(1, std::atoi(argv[++k]));
+        else if (argument == "--warmup" && has_value)
+            parameters.warmup_frames = std::max(0, std::atoi(argv[++k]));
+        else if (argument == "--size" && has_value) {
+            std::string const size = argv[++k];
+            size_t const x = size.find('x');
+            if (x != std::string::npos) {
+                // Limited by the size of the depth buffer of the framebuffer objects
+                parameters.width = std::max(1, std::min(std::atoi(size.substr(0, x).c_str()), int(opengl_fbo_structure::max_width)));
+                parameters.height = std::max(1, std::min(std::atoi(size.substr(x + 1).c_str()), int(opengl_fbo_structure::max_height)));
+            }
+        } else if (argument == "--camera-path" && has_value)
+            parameters.camera_path = argv[++k];
+        else if (argument == "--output" && has_value)
+            parameters.output = argv[++k];
+        else if (argument == "--render-stats" && has_value)
+            parameters.render_stats = argv[++k];
+        else if (argument == "--baseline" && has_value)
+            parameters.baseline = argv[++k];
+        else if (argument == "--tolerance" && has_value)
+            parameters.tolerance = float(std::atof(argv[++k]));
+        else if (is_benchmark)
+            std::cerr << "Benchmark: ignored argument " << argument << std::endl;
+    }
+    return is_benchmark;
+}
+
+std::vector<benchmark_camera_key> benchmark_camera_path_default() {
+    int const N = 16;
+    std::vector<benchmark_camera_key> path(N);
+    for (int k = 0; k < N; ++k) {
+        float const angle = 2 * Pi * k / float(N);
+        float const height = 6.0f + 4.0f * std::sin(angle);
+        float const radius = 16.0f + 6.0f * std::cos(2 * angle);
+        path[k].eye = {radius * std::cos(angle), radius * std::sin(angle), height};
+        path[k].center = {0, 0, 0};
+    }
+    return path;
+}
+
+std::vector<benchmark_camera_key> benchmark_camera_path_load(const std::string &filename) {
+    std::vector<benchmark_camera_key> path;
+    std::ifstream stream(filename);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream line_stream(line);
+        benchmark_camera_key key;
+        if (line_stream >> key.eye.x >> key.eye.y >> key.eye.z >> key.center.x >> key.center.y >> key.center.z)
+            path.push_back(key);
+    }
+    return path;
+}
+
+benchmark_camera_key benchmark_camera_path_evaluate(const std::vector<benchmark_camera_key> &path, float s) {
+    assert_cgp_no_msg(!path.empty());
+    int const N = int(path.size());
+    float const x = (s - std::floor(s)) * N;
+    int const k0 = std::min(int(x), N - 1);
+    int const k1 = (k0 + 1) % N;
+    float const alpha = x - k0;
+
+    benchmark_camera_key key;
+    key.eye = (1 - alpha) * path[k0].eye + alpha * path[k1].eye;
+    key.center = (1 - alpha) * path[k0].center + alpha * path[k1].center;
+    return key;
+}
+
+int benchmark_run(scene_structure &scene, const benchmark_parameters &parameters) {
+    std::vector<benchmark_camera_key> path;
+    if (!load_camera_path(parameters, path))
+        return EXIT_FAILURE;
+
+    int first_measured_frame = -1;
+    std::vector<double> const frame_times = render_frames(scene, parameters, path, first_measured_frame);
+    profiler_structure &profiler = default_profiler();
+    render_stats_structure &render_stats = default_render_stats();
+
+    // Statistics
+    benchmark_statistics const frame_statistics = compute_statistics(frame_times);
+    stage_times cpu_stages, gpu_stages;
+    accumulate_stages(cpu_stages, gpu_stages, profiler.frames(), first_measured_frame, parameters.frames);
+
+    std::ostringstream json;
+    json << "{\n"
+         << json_context(parameters)
+         << "  \"camera_path\": " << json_string(parameters.camera_path.empty() ? "default" : parameters.camera_path) << ",\n"
+         << "  \"frame_time_ms\": " << json_statistics(frame_statistics) << ",\n"
+         << "  \"cpu_stages_ms\": " << json_stages(cpu_stages) << ",\n"
+         << "  \"gpu_stages_ms\": " << json_stages(gpu_stages) << ",\n"
+         << "  \"render_stats_per_frame\": " << json_render_stats(render_stats) << "\n"
+         << "}\n";
+
+    std::cout << json.str();
+    if (!write_output(parameters.output, json.str()))
+        return EXIT_FAILURE;
+
+    // Counters of each measured frame
+    if (!parameters.render_stats.empty()) {
+        if (!render_stats.save_csv(parameters.render_stats + ".csv") || !render_stats.save_json(parameters.render_stats + ".json")) {
+            std::cerr << "Benchmark: cannot write " << parameters.render_stats << ".csv/json" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "Benchmark: render statistics written in " << parameters.render_stats << ".csv/json" << std::endl;
+    }
+
+    // Comparison with a previous run
+    if (!parameters.baseline.empty()) {
+        std::ifstream stream(parameters.baseline);
+        if (!stream) {
+            std::cerr << "Benchmark: cannot read the baseline " << parameters.baseline << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::string const baseline((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        bool regression = false;
+        for (const char *key : {"p50", "p95"}) {
+            double const reference = json_find_value(baseline, "frame_time_ms", key);
+            double const current = key == std::string("p50") ? frame_statistics.p50 : frame_statistics.p95;
+            if (reference <= 0)
+                continue;
+            double const change = current / reference - 1.0;
+            std::cout << "Benchmark: frame time " << key << " " << current << " ms (baseline " << reference << " ms, "
+                      << (change >= 0 ? "+" : "") << 100 * change << "%)" << std::endl;
+            if (change > parameters.tolerance)
+                regression = true;
+        }
+        if (regression) {
+            std::cout << "Benchmark: slower than the baseline (tolerance " << 100 * parameters.tolerance << "%)" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+int benchmark_stress_run(const scene_config_structure &config, const benchmark_parameters &parameters) {
+    std::vector<benchmark_camera_key> path;
+    if (!load_camera_path(parameters, path))
+        return EXIT_FAILURE;
+
+    std::vector<std::string> subsystems = parameters.stress_subsystems;
+    if (subsystems.empty())
+        subsystems = scene_config_structure::subsystems();
+    for (const std::string &subsystem : subsystems) {
+        if (scene_config_structure().count(subsystem) < 0) {
+            std::cerr << "Stress: unknown subsystem " << subsystem << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::vector<float> factors = parameters.stress_factors;
+    std::sort(factors.begin(), factors.end());
+    factors.erase(std::unique(factors.begin(), factors.end()), factors.end());
+    if (factors.empty()) {
+        std::cerr << "Stress: no scaling factor" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Frame time of each configuration (the configuration at the factor 1 is shared by all the subsystems, and measured once)
+    std::map<std::string, benchmark_statistics> measured;
+    std::ostringstream json_steps, json_knees;
+    std::cout << "Stress: " << subsystems.size() << " subsystem(s), factors";
+    for (float factor : factors)
+        std::cout << " " << factor;
+    std::cout << std::endl;
+
+    for (size_t s = 0; s < subsystems.size(); ++s) {
+        const std::string &subsystem = subsystems[s];
+        std::vector<double> p50;
+        for (float factor : factors) {
+            scene_config_structure step_config = config;
+            step_config.scale(subsystem, factor);
+            std::string const key = step_config.to_string();
+
+            if (measured.find(key) == measured.end()) {
+                std::cout << "Stress: " << subsystem << " x" << factor << " (" << step_config.count(subsystem) << " elements)" << std::endl;
+
+                // A new scene is initialized with the scaled number of elements
+                std::unique_ptr<scene_structure> scene(new scene_structure);
+                scene->config = step_config;
+                scene->simulation.manual_clock = true;
+                scene->window.width = parameters.width;
+                scene->window.height = parameters.height;
+                scene->initialize();
+
+                int first_measured_frame = -1;
+                measured[key] = compute_statistics(render_frames(*scene, parameters, path, first_measured_frame));
+
+                scene->simulation.stop();
+                scene->texture_manager.clear();
+                scene->shader_builder.clear();
+            }
+            benchmark_statistics const &frame_statistics = measured[key];
+            p50.push_back(frame_statistics.p50);
+
+            json_steps << (json_steps.tellp() == 0 ? "\n    " : ",\n    ") << "{\"subsystem\": " << json_string(subsystem)
+                       << ", \"factor\": " << factor << ", \"count\": " << step_config.count(subsystem)
+                       << ", \"frame_time_ms\": " << json_statistics(frame_statistics) << "}";
+        }
+
+        // Exponent of the frame time between two consecutive factors: t(f) ~ f^exponent
+        //  (0: the cost of the subsystem is negligible, 1: the frame time is proportional to the number of elements)
+        std::ostringstream exponents;
+        float knee_factor = -1;
+        for (size_t k = 0; k + 1 < factors.size(); ++k) {
+            double exponent = 0;
+            if (p50[k] > 0 && p50[k + 1] > 0)
+                exponent = std::log(p50[k + 1] / p50[k]) / std::log(double(factors[k + 1]) / factors[k]);
+            exponents << (k == 0 ? "" : ", ") << exponent;
+            if (knee_factor < 0 && exponent >= 0.5)
+                knee_factor = factors[k];
+        }
+        json_knees << (s == 0 ? "\n    " : ",\n    ") << json_string(subsystem) << ": {\"exponents\": [" << exponents.str()
+                   << "], \"knee_factor\": ";
+        if (knee_factor > 0)
+            json_knees << knee_factor << "}";
+        else
+            json_knees << "null}";
+
+        std::cout << "Stress: " << subsystem << " p50 frame time";
+        for (size_t k = 0; k < factors.size(); ++k)
+            std::cout << " x" << factors[k] << " " << p50[k] << " ms";
+        if (knee_factor > 0)
+            std::cout << ", knee at x" << knee_factor;
+        else
+            std::cout << ", no knee";
+        std::cout << std::endl;
+    }
+
+    std::ostringstream factors_list;
+    for (size_t k = 0; k < factors.size(); ++k)
+        factors_list << (k == 0 ? "" : ", ") << factors[k];
+
+    std::ostringstream json;
+    json << "{\n"
+         << json_context(parameters)
+         << "  \"factors\": [" << factors_list.str() << "],\n"
+         << "  \"steps\": [" << json_steps.str() << "\n  ],\n"
+         << "  \"knees\": {" << json_knees.str() << "\n  }\n"
+         << "}\n";
+
+    std::cout << json.str();
+    return write_output(parameters.output, json.str()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
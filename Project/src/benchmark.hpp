@@ -0,0 +1,65 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+
+#include <string>
+#include <vector>
+
+// Forward declaration of scene_structure to avoid circular dependencies
+struct scene_structure;
+struct scene_config_structure;
+
+using cgp::vec3;
+
+// Key of the scripted camera path (the camera is placed at eye and looks at center)
+struct benchmark_camera_key {
+    vec3 eye;
+    vec3 center;
+};
+
+// Parameters of the headless benchmark, set from the command line:
+//  ./floating_forest --benchmark [--frames N] [--warmup N] [--size WxH] [--camera-path file] [--output file.json]
+//                                [--render-stats prefix] [--baseline file.json] [--tolerance 0.05]
+//  Stress mode (implies --benchmark): ./floating_forest --stress [--stress-factors 1,10,100] [--stress-subsystems tree,grass,...]
+struct benchmark_parameters {
+    int frames = 600;          // number of measured frames (one loop of the camera path)
+    int warmup_frames = 60;    // frames rendered before the measure (driver caches, first uploads)
+    int width = 1280;          // resolution of the framebuffer
+    int height = 720;
+    float time_step = 1.0f / 60.0f; // simulated time between two frames: the rendered images do not depend on the speed of the machine
+
+    std::string camera_path;   // file with one key per line "eye_x eye_y eye_z center_x center_y center_z" (empty: default orbit)
+    std::string output;        // JSON file of the results (empty: standard output only)
+    std::string render_stats;  // render statistics of each frame saved in render_stats + ".csv" and ".json" (empty: not saved)
+    std::string baseline;      // JSON file of a previous run to compare with (empty: no comparison)
+    float tolerance = 0.05f;   // relative slow-down of the median/p95 frame time accepted with respect to the baseline
+
+    // Stress mode: the number of elements of each subsystem is multiplied by each factor in turn (the other subsystems keep their number)
+    bool stress = false;
+    std::vector<float> stress_factors = {1, 10, 100};
+    std::vector<std::string> stress_subsystems; // names of scene_config_structure::subsystems(), or "all" to scale them together (empty: each subsystem)
+};
+
+// Read the benchmark parameters from the command line. Return false if --benchmark is not one of the arguments.
+bool benchmark_parse_arguments(int argc, char *argv[], benchmark_parameters &parameters);
+
+// Orbit around the center of the terrain, going up and down once per loop
+std::vector<benchmark_camera_key> benchmark_camera_path_default();
+// Keys read from a file (empty if the file cannot be read)
+std::vector<benchmark_camera_key> benchmark_camera_path_load(const std::string &filename);
+// Key linearly interpolated along the closed path at s in [0,1[
+benchmark_camera_key benchmark_camera_path_evaluate(const std::vector<benchmark_camera_key> &path, float s);
+
+// Render the scene in a framebuffer object for warmup_frames + frames frames along the camera path, and write the statistics:
+//  frame time (mean, p50, p95, p99, including the end of the GPU work), time of each profiled CPU/GPU stage per frame,
+//  and mean render statistics per frame (draw calls, program switches, texture binds, uniform uploads, triangles).
+//  The scene must be initialized, with simulation.manual_clock set to true before scene.initialize().
+//  Return EXIT_FAILURE if the frame time is slower than the baseline (beyond the tolerance), EXIT_SUCCESS otherwise.
+int benchmark_run(scene_structure &scene, const benchmark_parameters &parameters);
+
+// Stress mode: for each subsystem and each factor, initialize a new scene from config with the number of elements of the subsystem
+//  multiplied by the factor, and measure its frame time as benchmark_run does. The results (frame time of each step, and knee of the
+//  scaling curve of each subsystem) are written in the JSON file parameters.output.
+//  The knee is the first factor from which the frame time grows at least as the square root of the number of elements
+//  (the subsystem becomes the main cost of the frame).
+int benchmark_stress_run(const scene_config_structure &config, const benchmark_parameters &parameters);
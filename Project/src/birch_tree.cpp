@@ -8,9 +8,8 @@ void birch_tree::initialize(scene_structure &scene) {
     // Birch foliage has one structure and one color. It is built using a separate function
     // that combines several spheres of different radii. The trunk is built separately due to its distinct structure.
 
-    // Define texture paths for the trunk and foliage
+    // Texture of the trunk (the foliage uses the vegetation texture array)
     const std::string TRUNK_TEXTURE_PATH = project::path + "assets/trunk_birch.jpg";
-    const std::string FOLIAGE_TEXTURE_PATH = project::path + "assets/foliage_birch.jpg";
 
     // Define trunk dimensions
     constexpr float TRUNK_RADIUS = 0.2f;
@@ -18,10 +17,12 @@ void birch_tree::initialize(scene_structure &scene) {
 
     // Initialize the trunk and foliage
     initialize_trunk(scene, trunk, TRUNK_RADIUS, TRUNK_HEIGHT, TRUNK_TEXTURE_PATH);
-    initialize_foliage(scene, foliage, TRUNK_HEIGHT, FOLIAGE_TEXTURE_PATH);
+    initialize_foliage(scene, foliage, TRUNK_HEIGHT);
+
+    trunk.shader = scene.shader_instanced;
 
     // Add the trunk and foliage to the hierarchy
-    hierarchy.add(trunk, "trunk");
+    trunk_node = hierarchy.add(trunk, "trunk");
     hierarchy.add(foliage, "foliage", "trunk");
 }
 
@@ -34,25 +35,26 @@ void birch_tree::initialize_trunk(scene_structure &scene, mesh_drawable &trunk,
 }
 
 
-void birch_tree::initialize_foliage(scene_structure &scene, mesh_drawable &foliage, float trunk_height,
-                                    const std::string &texture_path) {
-    // Create, translate and initialize the foliage mesh
+void birch_tree::initialize_foliage(scene_structure &scene, mesh_drawable &foliage, float trunk_height) {
+    // Create, translate and initialize the foliage mesh, textured by the birch layer of the vegetation texture array
     mesh foliage_mesh = create_foliage_birch();
     foliage_mesh.translate({0, 0, trunk_height / 1.2f});
-    scene.initialize_mesh_with_texture(foliage, foliage_mesh, texture_path);
+    scene.initialize_mesh_with_texture_layers(foliage, {foliage_mesh}, {scene_structure::VEGETATION_LAYER_BIRCH_FOLIAGE},
+                                              scene.vegetation_texture_array);
 
     // Assign the birch shader to the foliage
-    foliage.shader = scene.shader_birch;
+    foliage.shader = scene.shader_birch_instanced;
 }
 
 
-void birch_tree::display(scene_structure &scene, int tree_index, vec3 position) {
+affine_rts birch_tree::tree_transform(int tree_index, vec3 position) {
     // Set the position of the birch tree's trunk
-    hierarchy["trunk"].transform_local.translation = position;
+    affine_rts trunk_transform;
+    trunk_transform.translation = position;
 
     // Define different scaling factors for varying tree sizes
     constexpr std::array<float, 3> TREE_SCALING = {0.9f, 1.5f, 1.7f};
-    hierarchy["trunk"].transform_local.scaling = TREE_SCALING[tree_index % 3];
+    trunk_transform.scaling = TREE_SCALING[tree_index % 3];
 
     // Define rotation angles based on the tree index
     vec3 rotation_axis = {0, 0, 1};
@@ -74,9 +76,20 @@ void birch_tree::display(scene_structure &scene, int tree_index, vec3 position)
     }
 
     // Apply rotation to the tree's trunk
-    hierarchy["trunk"].transform_local.rotation = rotation_transform::from_axis_angle(rotation_axis, rotation_angle);
+    trunk_transform.rotation = rotation_transform::from_axis_angle(rotation_axis, rotation_angle);
+    return trunk_transform;
+}
+
+void birch_tree::place(const std::vector<affine_rts> &transforms) {
+    // The transform of each tree is the root of its instance
+    instances.resize(int(transforms.size()));
+    for (size_t k = 0; k < transforms.size(); ++k)
+        instances.root.set(int(k), transforms[k]);
+
+    instances.update(hierarchy);
+    instances.update_gpu(hierarchy);
+}
 
-    // Update the hierarchy's global coordinates and draw the tree
-    hierarchy.update_local_to_global_coordinates();
-    draw(hierarchy, scene.environment);
+void birch_tree::display(scene_structure &scene) {
+    draw(hierarchy, instances, scene.environment);
 }
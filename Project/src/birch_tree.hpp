@@ -12,6 +12,10 @@ using namespace cgp;
 struct birch_tree {
     // Hierarchical drawable for the tree components
     cgp::hierarchy_mesh_drawable hierarchy;
+    // Handle of the trunk (root of the hierarchy)
+    int trunk_node = -1;
+    // All the birch trees are drawn as instances of the hierarchy (static transforms, computed once)
+    cgp::hierarchy_mesh_drawable_instances instances;
 
     // Drawable elements
     mesh_drawable trunk;
@@ -24,10 +28,15 @@ struct birch_tree {
     void initialize_trunk(scene_structure &scene, mesh_drawable &trunk, float radius, float height,
                           const std::string &texture_path);
 
-    // Initializes the foliage of the birch tree with the specified trunk height and texture
-    void initialize_foliage(scene_structure &scene, mesh_drawable &foliage, float trunk_height,
-                            const std::string &texture_path);
+    // Initializes the foliage of the birch tree with the specified trunk height
+    void initialize_foliage(scene_structure &scene, mesh_drawable &foliage, float trunk_height);
 
-    // Displays the birch tree at a specified position, using the given tree index for variations
-    void display(scene_structure &scene, int tree_index, vec3 position);
+    // Transform of the birch tree at a specified position, using the given tree index for variations
+    static affine_rts tree_transform(int tree_index, vec3 position);
+
+    // Places the instances of the birch tree at the given transforms
+    void place(const std::vector<affine_rts> &transforms);
+
+    // Displays all the birch trees
+    void display(scene_structure &scene);
 };
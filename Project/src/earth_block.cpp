@@ -5,6 +5,7 @@
 
 
 void earth_block::initialize(scene_structure &scene, const int terrain_length) {
+    CGP_PROFILE_SCOPE("earth_block::initialize");
     // Define the number of samples for the terrain mesh
     constexpr int TERRAIN_SAMPLES_QUANTITY = 100;
 
@@ -29,7 +30,7 @@ void
 earth_block::initialize_terrain(scene_structure &scene, const int terrain_length, const int samples_quantity,
                                 const std::string &texture_path, const vec3 &color) {
     // Create and initialize the terrain mesh
-    mesh terrain_mesh = create_terrain_mesh(samples_quantity, terrain_length);
+    mesh terrain_mesh = create_terrain_mesh(samples_quantity, terrain_length, scene.config.n_vertices_terrain);
     scene.initialize_mesh_with_texture_and_color(terrain, terrain_mesh, texture_path, color);
 }
 
@@ -43,6 +44,8 @@ void earth_block::initialize_base(scene_structure &scene, const int terrain_leng
 
 
 void earth_block::display(scene_structure &scene) {
+    CGP_PROFILE_SCOPE("earth_block::display");
+    CGP_RENDER_STATS_SCOPE("earth_block");
     // Draw the hierarchy in the given scene environment
     draw(hierarchy, scene.environment);
 }
@@ -4,8 +4,9 @@
 
 
 void grass::initialize(scene_structure& scene, int terrain_length) {
+    CGP_PROFILE_SCOPE("grass::initialize");
     // Generate positions for grass elements
-    grass_position = generate_positions_on_terrain(GRASS_QUANTITY, terrain_length * 0.95f, false, false);
+    grass_position = generate_positions_on_terrain(scene.config.grass_quantity, terrain_length * 0.95f, false, false);
 
     // Define vertices for the grass mesh
     const vec3 BOTTOM_LEFT = {-0.5f, 0.0f, 0.0f};
@@ -13,12 +14,10 @@ void grass::initialize(scene_structure& scene, int terrain_length) {
     const vec3 TOP_RIGHT = {0.5f, 0.0f, 1.0f};
     const vec3 TOP_LEFT = {-0.5f, 0.0f, 1.0f};
 
-    // Path to grass texture file
-    const std::string TEXTURE_PATH = project::path + "assets/grass.png";
-
-    // Create the grass mesh
+    // Create the grass mesh, textured by the grass layer of the vegetation texture array
     mesh grass_mesh = mesh_primitive_quadrangle(BOTTOM_LEFT, BOTTOM_RIGHT, TOP_RIGHT, TOP_LEFT);
-    scene.initialize_mesh_with_texture(grass, grass_mesh, TEXTURE_PATH);
+    scene.initialize_mesh_with_texture_layers(grass, {grass_mesh}, {scene_structure::VEGETATION_LAYER_GRASS},
+                                              scene.vegetation_texture_array);
 
     // Set the initial position of the grass on the terrain
     const float X = 0.0f, Y = 0.0f;
@@ -39,6 +38,8 @@ float grass::get_grass_scaling(int index) const {
 
 
 void grass::display(scene_structure &scene) {
+    CGP_PROFILE_SCOPE("grass::display");
+    CGP_RENDER_STATS_SCOPE("grass");
     // Retrieve the camera model to compute the right vector
     auto const& camera = scene.camera_control.camera_model;
 
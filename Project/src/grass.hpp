@@ -12,9 +12,6 @@ using std::vector;
 
 // Structure representing a collection of grass elements
 struct grass {
-    // Define constant for the quantity of grass elements
-    static constexpr int GRASS_QUANTITY = 1000;
-
     // Drawable for the grass element
     mesh_drawable grass;
 
@@ -3,6 +3,7 @@
 #include "cgp/cgp.hpp" // Give access to the complete CGP library
 #include "environment.hpp" // The general scene environment + project variable
 #include <iostream> 
+#include <cstdlib>
 
 #include <chrono>
 #include <thread>
@@ -10,6 +11,7 @@
 // Custom scene of this code
 #include "scene.hpp"
 #include "pine_tree.hpp"
+#include "benchmark.hpp"
 
 
 
@@ -28,16 +30,35 @@ scene_structure scene;
 
 window_structure standard_window_initialization();
 void initialize_default_shaders();
+int run_benchmark(char const* executable_path, benchmark_parameters const& parameters);
 void animation_loop();
 void display_gui_default();
 
 timer_fps fps_record;
+frame_pacer pacer; // FPS limitation and duration of the frames
 
-int main(int, char* argv[])
+// Capture of the rendered frames (screenshots and recording, see display_gui_default)
+//  While capturing, the scene is rendered in capture_fbo, read asynchronously, then copied on the screen.
+opengl_frame_capture_structure frame_capture;
+opengl_fbo_structure capture_fbo;
+
+// Context used instead of the window by the benchmark (see run_benchmark)
+headless_context_structure headless_context;
+
+int main(int argc, char* argv[])
 {
 	std::cout << "Run " << argv[0] << std::endl;
 
-	
+	// Number of elements of the scene: ./floating_forest [--config file] [--set KEY=value] (see scene_config.hpp)
+	if (!scene_config_parse_arguments(argc, argv, scene.config))
+		return EXIT_FAILURE;
+
+#ifndef __EMSCRIPTEN__
+	// Benchmark without window: ./floating_forest --benchmark [options] (see benchmark.hpp)
+	benchmark_parameters benchmark;
+	if (benchmark_parse_arguments(argc, argv, benchmark))
+		return run_benchmark(argv[0], benchmark);
+#endif
 
 	// ************************ //
 	//     INITIALISATION
@@ -49,6 +70,13 @@ int main(int, char* argv[])
 	// Initialize default path for assets
 	project::path = cgp::project_path_find(argv[0], "shaders/");
 
+	// Start the worker threads of the job system (the calling thread is registered as the main thread)
+	default_job_system();
+
+	// The profiler can be activated from the start (to measure the initialization) with the environment variable CGP_PROFILER
+	if (std::getenv("CGP_PROFILER") != nullptr)
+		profiler_structure::enabled = true;
+
 	// Initialize default shaders
 	initialize_default_shaders();
 
@@ -70,17 +98,14 @@ int main(int, char* argv[])
 	//  The following part is simply a loop that call the function "animation_loop"
 	//  (This call is different when we compile in standard mode with GLFW, than when we compile with emscripten to output the result in a webpage.)
 #ifndef __EMSCRIPTEN__
-    double lasttime = glfwGetTime();
+	pacer.reset();
 	// Default mode to run the animation/display loop with GLFW in C++
 	while (!glfwWindowShouldClose(scene.window.glfw_window)) {
 		// The real animation loop
 		animation_loop();
 
-		// FPS limitation
-		if(project::fps_limiting){
-			while (glfwGetTime() < lasttime + 1.0 / project::fps_max) {	}
-        	lasttime = glfwGetTime();
-		}
+		// FPS limitation (sleeps instead of keeping the CPU busy)
+		pacer.wait(project::fps_limiting ? project::fps_max : 0.0f);
 	}
 #else
 	// Specific loop if compiled for EMScripten
@@ -90,6 +115,9 @@ int main(int, char* argv[])
 	std::cout << "\nAnimation loop stopped" << std::endl;
 
 	// Cleanup
+	scene.simulation.stop();
+	frame_capture.clear();
+	default_profiler().clear();
 	cgp::imgui_cleanup();
 	glfwDestroyWindow(scene.window.glfw_window);
 	glfwTerminate();
@@ -99,6 +127,8 @@ int main(int, char* argv[])
 
 void animation_loop()
 {
+	default_profiler().frame_begin();
+	default_render_stats().frame_begin();
 
 	emscripten_update_window_size(scene.window.width, scene.window.height); // update window size in case of use of emscripten (not used by default)
 
@@ -106,12 +136,23 @@ void animation_loop()
 	scene.environment.camera_projection = scene.camera_projection.matrix();
 	glViewport(0, 0, scene.window.width, scene.window.height);
 
+	bool const is_capturing = frame_capture.is_active();
+	if (is_capturing) {
+		if (capture_fbo.id == 0)
+			capture_fbo.initialize();
+		capture_fbo.update_screen_size(scene.window.width, scene.window.height);
+		capture_fbo.bind();
+	}
+
 	vec3 const& background_color = scene.environment.background_color;
 	glClearColor(background_color.x, background_color.y, background_color.z, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 	glClear(GL_DEPTH_BUFFER_BIT);
 	glEnable(GL_DEPTH_TEST);
 
+	// Jobs sent to the main thread by the workers (ex. data to upload on the GPU)
+	default_job_system().execute_main_thread_jobs();
+
 	float const time_interval = fps_record.update();
 	if (fps_record.event) {
 		std::string const title = "CGP Display - " + str(fps_record.fps) + " fps";
@@ -135,12 +176,27 @@ void animation_loop()
 	// Call the display of the scene
 	scene.display_frame();
 
+	// The GUI is drawn after the capture: it only appears on the screen
+	if (is_capturing) {
+		capture_fbo.unbind();
+		frame_capture.capture(capture_fbo);
+		capture_fbo.blit();
+	}
 
 	// End of ImGui display and handle GLFW events
 	ImGui::End();
-	imgui_render_frame(scene.window.glfw_window);
-	glfwSwapBuffers(scene.window.glfw_window);
+	{
+		CGP_PROFILE_SCOPE("gui");
+		CGP_PROFILE_GPU_SCOPE("gui");
+		imgui_render_frame(scene.window.glfw_window);
+	}
+	{
+		CGP_PROFILE_SCOPE("swap buffers");
+		glfwSwapBuffers(scene.window.glfw_window);
+	}
 	glfwPollEvents();
+	default_render_stats().frame_end();
+	default_profiler().frame_end();
 }
 
 
@@ -150,9 +206,16 @@ void initialize_default_shaders()
 	//  By default, it should be "shaders/"
 	std::string default_path_shaders = project::path +"shaders/";
 
+#ifndef __EMSCRIPTEN__
+	// Reuse the shader programs compiled during the previous executions (if supported by the driver)
+	GLADloadproc const opengl_loader = headless_context.is_created() ? (GLADloadproc)headless_context_structure::get_proc_address : (GLADloadproc)glfwGetProcAddress;
+	scene.shader_builder.binary_cache.initialize(project::path + "cache/shaders/", opengl_loader);
+#endif
+
 	// Set standard mesh shader for mesh_drawable
-	mesh_drawable::default_shader.load(default_path_shaders +"mesh/mesh.vert.glsl", default_path_shaders +"mesh/mesh.frag.glsl");
-	triangles_drawable::default_shader.load(default_path_shaders +"mesh/mesh.vert.glsl", default_path_shaders +"mesh/mesh.frag.glsl");
+	//  (mesh_drawable and triangles_drawable share the same program)
+	mesh_drawable::default_shader = scene.shader_builder.load(default_path_shaders +"mesh/mesh.vert.glsl", default_path_shaders +"mesh/mesh.frag.glsl");
+	triangles_drawable::default_shader = scene.shader_builder.load(default_path_shaders +"mesh/mesh.vert.glsl", default_path_shaders +"mesh/mesh.frag.glsl");
 
 	// Set default white texture
 	image_structure const white_image = image_structure{ 1,1,image_color_type::rgba,{255,255,255,255} };
@@ -160,13 +223,50 @@ void initialize_default_shaders()
 	triangles_drawable::default_texture.initialize_texture_2d_on_gpu(white_image);
 
 	// Set standard uniform color for curve/segment_drawable
-	curve_drawable::default_shader.load(default_path_shaders +"single_color/single_color.vert.glsl", default_path_shaders+"single_color/single_color.frag.glsl");
+	curve_drawable::default_shader = scene.shader_builder.load(default_path_shaders +"single_color/single_color.vert.glsl", default_path_shaders+"single_color/single_color.frag.glsl");
 }
 
 
 
 
 
+// Render the scene in an offscreen context along a scripted camera path, and write the frame time statistics
+//  No window nor display server is needed: the benchmark can run on a CI machine with Mesa llvmpipe.
+int run_benchmark(char const* executable_path, benchmark_parameters const& parameters)
+{
+	project::path = cgp::project_path_find(executable_path, "shaders/");
+
+	if (!headless_context.create(CGP_OPENGL_VERSION_MAJOR, CGP_OPENGL_VERSION_MINOR))
+		return EXIT_FAILURE;
+	std::cout << "OpenGL Information:" << std::endl;
+	std::cout << cgp::opengl_info_display() << std::endl;
+
+	default_job_system();
+	initialize_default_shaders();
+
+	int result = EXIT_SUCCESS;
+	if (parameters.stress) {
+		// A scene is initialized for each step of the stress test
+		result = benchmark_stress_run(scene.config, parameters);
+	}
+	else {
+		// The animation is driven by the frame index instead of the real time
+		scene.simulation.manual_clock = true;
+		scene.window.width = parameters.width;
+		scene.window.height = parameters.height;
+		scene.initialize();
+
+		result = benchmark_run(scene, parameters);
+	}
+
+	scene.simulation.stop();
+	default_profiler().clear();
+	headless_context.destroy();
+	return result;
+}
+
+
+
 //Callback functions
 void window_size_callback(GLFWwindow* window, int width, int height);
 void mouse_move_callback(GLFWwindow* window, double xpos, double ypos);
@@ -291,7 +391,7 @@ void keyboard_callback(GLFWwindow* window, int key, int scancode, int action, in
 
 void display_gui_default()
 {
-	std::string fps_txt = str(fps_record.fps)+" fps";
+	std::string fps_txt = str(fps_record.fps)+" fps - "+render_stats_summary(default_render_stats());
 
 	if(scene.inputs.keyboard.ctrl)
 		fps_txt += " [ctrl]";
@@ -319,6 +419,13 @@ void display_gui_default()
 		if(project::fps_limiting){
 			ImGui::SliderFloat("FPS limit",&project::fps_max, 10, 250);
 		}
+
+		// Duration of the frames: rendering (work) and FPS limitation (wait)
+		ImGui::Text("Frame %.2f ms (work %.2f ms, wait %.2f ms)", 1000*pacer.frame_duration, 1000*pacer.work_duration, 1000*pacer.wait_duration);
+		ImGui::PlotLines("##frame_duration", pacer.history_frame_duration, frame_pacer::history_size, pacer.history_index, "frame duration", 0.0f, 2.0f/project::fps_max, ImVec2(0, 40));
+		if(project::fps_limiting){
+			ImGui::Text("Wake-up error %.3f ms, timer slack %.3f ms, overruns %d", 1000*pacer.wake_up_error, 1000*pacer.timer_slack, pacer.overrun_counter);
+		}
 #endif
 		// vsync is the default synchronization of frame refresh with the screen frequency
 		//   vsync may or may not be enforced by your GPU driver and OS (on top of the GLFW request).
@@ -335,6 +442,47 @@ void display_gui_default()
 
 		ImGui::Spacing();ImGui::Separator();ImGui::Spacing();
 	}
+
+	if(ImGui::CollapsingHeader("Render statistics")) {
+		ImGui::Indent();
+		render_stats_display_gui(default_render_stats(), project::path + "render_stats");
+		ImGui::Unindent();
+		ImGui::Spacing();ImGui::Separator();ImGui::Spacing();
+	}
+
+	if(ImGui::CollapsingHeader("Profiler")) {
+		ImGui::Indent();
+		profiler_display_gui(default_profiler(), project::path + "profiler_trace.json");
+		ImGui::Unindent();
+		ImGui::Spacing();ImGui::Separator();ImGui::Spacing();
+	}
+
+#ifndef __EMSCRIPTEN__
+	if(ImGui::CollapsingHeader("Capture")) {
+		ImGui::Indent();
+		// The images are written in Project/captures/ by background threads, without slowing down the rendering
+		std::string const capture_directory = project::path + "captures/";
+		if(ImGui::Button("Screenshot"))
+			frame_capture.request_screenshot(capture_directory);
+
+		static int capture_format = 0;
+		bool recording = frame_capture.is_recording();
+		if(!recording)
+			ImGui::Combo("Format", &capture_format, "png\0jpg\0raw\0");
+		if(ImGui::Checkbox("Record", &recording)) {
+			if(recording)
+				frame_capture.start_recording(capture_directory, frame_capture_format(capture_format));
+			else
+				frame_capture.stop_recording();
+		}
+
+		std::string const capture_stats = "Written "+str(frame_capture.frames_written())+" / queued "+str(frame_capture.frames_queued())+" / dropped "+str(frame_capture.frames_dropped());
+		ImGui::Text( capture_stats.c_str(), "%s" );
+
+		ImGui::Unindent();
+		ImGui::Spacing();ImGui::Separator();ImGui::Spacing();
+	}
+#endif
 }
 
 
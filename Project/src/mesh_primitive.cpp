@@ -10,6 +10,11 @@ mesh create_cylinder_mesh(float radius, float height) {
     constexpr int N = 20;
     constexpr float TWO_PI = 2 * 3.14f;
 
+    // Storage allocated once: 2 vertices per sample, 2 triangles per side (including the closing one)
+    cylinder.position.reserve(2 * N);
+    cylinder.uv.reserve(2 * N);
+    cylinder.connectivity.reserve(2 * N);
+
     // Geometry
     for (int k = 0; k < N; ++k) {
         float u = k / float(N - 1);
@@ -53,6 +58,11 @@ mesh create_cone_mesh(float radius, float height, float z_offset) {
     constexpr int N = 20;
     constexpr float TWO_PI = 2 * 3.14f;
 
+    // Storage allocated once: side and bottom rings with their center vertex, N triangles for each
+    cone.position.reserve(2 * N + 2);
+    cone.uv.reserve(2 * N + 2);
+    cone.connectivity.reserve(2 * N);
+
     // Geometry: base of the cone
     for (int k = 0; k < N; ++k) {
         float u = k / float(N - 1);
@@ -103,6 +113,7 @@ mesh create_sphere_mesh(float radius, const vec3& translation) {
     int N = 10;
     sphere.position.resize((N + 1) * (N + 1));
     sphere.uv.resize((N + 1) * (N + 1));
+    sphere.connectivity.reserve(2 * N * N);
 
     // Fill sphere geometry
     for (int stack = 0; stack <= N; ++stack) {
@@ -148,6 +159,9 @@ mesh create_ellipse_mesh(float a, float b) {
     constexpr int CENTER_INDEX = 0;
 
     mesh ellipse;
+    ellipse.position.reserve(SEGMENTS + 2);
+    ellipse.uv.reserve(SEGMENTS + 2);
+    ellipse.connectivity.reserve(SEGMENTS);
 
     // Center of the ellipse
     ellipse.position.push_back({0.0f, 0.0f, 0.0f});
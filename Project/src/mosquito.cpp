@@ -12,8 +12,10 @@ using std::vector;
 
 // Initialize the mosquito elements in the scene
 void mosquito::initialize(scene_structure &scene, float terrain_length) {
+    CGP_PROFILE_SCOPE("mosquito::initialize");
     // Generate positions for mosquitoes on the terrain
-    mosquito_position = generate_positions_on_terrain(N_MOSQUITO, terrain_length * 0.9f, true, true);
+    mosquito_position = generate_positions_on_terrain(scene.config.n_mosquito, terrain_length * 0.9f, true, true);
+    generator.seed(1);
 
     // Define colors for the mosquito body and wings
     const vec3 BODY_COLOR = {117 / 256.0f, 92 / 256.0f, 72 / 256.0f};
@@ -25,65 +27,79 @@ void mosquito::initialize(scene_structure &scene, float terrain_length) {
     // Create and initialize the mosquito wings
     scene.initialize_mesh_with_color(wing_1, create_mosquito_wing(true), WING_COLOR);
     scene.initialize_mesh_with_color(wing_2, create_mosquito_wing(false), WING_COLOR);
+    body.shader = scene.shader_instanced;
+    wing_1.shader = scene.shader_instanced;
+    wing_2.shader = scene.shader_instanced;
 
     // Add body and wings to the hierarchy
-    hierarchy.add(body, "mosquito");
-    hierarchy.add(wing_1, "wing_1", "mosquito");
-    hierarchy.add(wing_2, "wing_2", "mosquito");
+    body_node = hierarchy.add(body, "mosquito");
+    wing_1_node = hierarchy.add(wing_1, "wing_1", "mosquito");
+    wing_2_node = hierarchy.add(wing_2, "wing_2", "mosquito");
 }
 
-// Display the mosquitoes in the scene
-void mosquito::display(scene_structure &scene) {
-    // Use mosquito_index to vary moving type and size of mosquito
-    int mosquito_index = 0;
-
+// Compute the transforms of the mosquitoes at time t
+void mosquito::simulate(simulation_state &state, float t) {
+    CGP_PROFILE_SCOPE("mosquito::simulate");
     // Define scaling values for different mosquito sizes
     constexpr std::array<float, 4> MOSQUITO_SCALING = {1.6f, 0.9f, 1.1f, 1.2f};
 
-    // Iterate over each mosquito position
-    for (const vec3 &position: mosquito_position) {
-        // Set the base position of the mosquito
-        hierarchy["mosquito"].transform_local.translation = position;
+    state.mosquito_body.resize(mosquito_position.size());
+    state.mosquito_wing_angle.resize(mosquito_position.size());
 
-        // Set the mosquito scale based on the index
-        hierarchy["mosquito"].transform_local.scaling = MOSQUITO_SCALING[mosquito_index % 4];
+    // Use mosquito_index to vary moving type and size of mosquito
+    for (size_t mosquito_index = 0; mosquito_index < mosquito_position.size(); ++mosquito_index) {
+        const vec3 &position = mosquito_position[mosquito_index];
 
-        // Display mosquito wings
-        display_mosquito_wing(scene);
+        // Rotate the wings randomly around the z-axis
+        state.mosquito_wing_angle[mosquito_index] = std::uniform_real_distribution<float>(0.0f, 1.0f)(generator);
 
         // Rotate the mosquito around itself at a different speed
-        const float ROTATION_ANGLE = scene.timer.t + position[2] + position[1] + position[0];
-        hierarchy["mosquito"].transform_local.rotation =
-                rotation_transform::from_axis_angle({0, 0, 1}, ROTATION_ANGLE);
+        const float ROTATION_ANGLE = t + position[2] + position[1] + position[0];
 
         // Vary the size and movement of the mosquito
-        vary_mosquito_behavior(scene, mosquito_index, position);
-
-        // Update the hierarchy and draw the mosquito
-        hierarchy.update_local_to_global_coordinates();
-        draw(hierarchy, scene.environment);
-
-        ++mosquito_index;
+        state.mosquito_body[mosquito_index] = affine_rts(rotation_transform::from_axis_angle({0, 0, 1}, ROTATION_ANGLE),
+                                                         vary_mosquito_behavior(t, int(mosquito_index), position),
+                                                         MOSQUITO_SCALING[mosquito_index % 4]);
     }
 }
 
-// Display the mosquito wings with rotation
-void mosquito::display_mosquito_wing(scene_structure &scene) {
-    // Rotate the wings randomly around the z-axis
-    const float RANDOM_ANGLE = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
-    hierarchy["wing_1"].transform_local.rotation =
-            rotation_transform::from_axis_angle({0, 0, 1}, RANDOM_ANGLE);
-    hierarchy["wing_2"].transform_local.rotation =
-            rotation_transform::from_axis_angle({0, 0, 1}, -RANDOM_ANGLE);
+// Display the mosquitoes in the scene
+void mosquito::display(scene_structure &scene) {
+    CGP_PROFILE_SCOPE("mosquito::display");
+    CGP_RENDER_STATS_SCOPE("mosquito");
+    const simulation_state &state = scene.animation;
+
+    // The transform of each mosquito is the root of its instance, the body keeps the identity as local transform
+    const int N_MOSQUITO = int(state.mosquito_body.size());
+    instances.resize(N_MOSQUITO);
+    cgp::soa_affine_rts &wing_1_local = instances.override_local(hierarchy, wing_1_node);
+    cgp::soa_affine_rts &wing_2_local = instances.override_local(hierarchy, wing_2_node);
+    affine_rts wing_1_transform = hierarchy.elements()[wing_1_node].transform_local;
+    affine_rts wing_2_transform = hierarchy.elements()[wing_2_node].transform_local;
+
+    for (int mosquito_index = 0; mosquito_index < N_MOSQUITO; ++mosquito_index) {
+        // Set the transform of the mosquito and the rotation of its wings
+        const float WING_ANGLE = state.mosquito_wing_angle[mosquito_index];
+        instances.root.set(mosquito_index, state.mosquito_body[mosquito_index]);
+        wing_1_transform.rotation = rotation_transform::from_axis_angle({0, 0, 1}, WING_ANGLE);
+        wing_2_transform.rotation = rotation_transform::from_axis_angle({0, 0, 1}, -WING_ANGLE);
+        wing_1_local.set(mosquito_index, wing_1_transform);
+        wing_2_local.set(mosquito_index, wing_2_transform);
+    }
+
+    // Compute the matrices of all the mosquitoes at once and draw each part once
+    instances.update(hierarchy);
+    instances.update_gpu(hierarchy);
+    draw(hierarchy, instances, scene.environment);
 }
 
 // Vary the mosquito behavior based on index and position
-void mosquito::vary_mosquito_behavior(scene_structure &scene, int mosquito_index, const vec3 &position) {
+vec3 mosquito::vary_mosquito_behavior(float time, int mosquito_index, const vec3 &position) {
     // Define useful constants for behavior variation
-    const float TIME = scene.timer.t;
+    const float TIME = time;
     const float VARIATION = 0.5f * sin(2 * TIME + position[0] + position[1] + position[2]);
-    const float RAND_UNIFORM_0_1 = rand_uniform(0.0f, 1.0f);
-    const float RAND_UNIFORM_0_2 = rand_uniform(0.0f, 2.0f);
+    const float RAND_UNIFORM_0_1 = std::uniform_real_distribution<float>(0.0f, 1.0f)(generator);
+    const float RAND_UNIFORM_0_2 = std::uniform_real_distribution<float>(0.0f, 2.0f)(generator);
     const float COS_TIME = cos(TIME);
     const float SIN_TIME = sin(TIME);
 
@@ -128,6 +144,5 @@ void mosquito::vary_mosquito_behavior(scene_structure &scene, int mosquito_index
             break;
     }
 
-    // Update the mosquito translation in the hierarchy
-    hierarchy["mosquito"].transform_local.translation = new_translation;
+    return new_translation;
 }
@@ -2,25 +2,32 @@
 
 #include "cgp/cgp.hpp"
 
+#include <random>
+
 // Forward declaration of scene_structure to avoid circular dependencies
 struct scene_structure;
+struct simulation_state;
 
 // Explicitly using cgp namespace to avoid conflicts and improve clarity
 using cgp::vec3;
 using cgp::hierarchy_mesh_drawable;
+using cgp::hierarchy_mesh_drawable_instances;
 using cgp::mesh_drawable;
 using std::vector;
 
 // Structure representing a mosquito in the scene
 struct mosquito {
-    // Define the number of mosquitoes
-    static constexpr int N_MOSQUITO = 300;
-
     // Positions of individual mosquitoes
     vector<vec3> mosquito_position;
 
     // Hierarchical drawable for mosquito components
     hierarchy_mesh_drawable hierarchy;
+    // Handles of the body and of the wings in the hierarchy
+    int body_node = -1;
+    int wing_1_node = -1;
+    int wing_2_node = -1;
+    // All the mosquitoes are drawn as instances of the hierarchy (the wings have a per-instance rotation)
+    hierarchy_mesh_drawable_instances instances;
 
     // Drawable elements
     mesh_drawable body;
@@ -30,12 +37,16 @@ struct mosquito {
     // Initializes the mosquito structure in the given scene with the specified terrain length
     void initialize(scene_structure& scene, float terrain_length);
 
-    // Displays the mosquitoes in the given scene
-    void display(scene_structure& scene);
+    // Random generator of the flight variations and of the wing angles, only used by the simulation thread
+    //  (seeded at initialization: two runs give the same animation)
+    std::mt19937 generator;
 
-    // Displays the mosquito wings
-    void display_mosquito_wing(scene_structure& scene);
+    // Computes the transforms of the mosquitoes at time t (called by the simulation thread)
+    void simulate(simulation_state& state, float t);
+
+    // Displays the mosquitoes in the given scene, at their interpolated transforms
+    void display(scene_structure& scene);
 
     // Varies the behavior of mosquitoes based on the given index and position
-    void vary_mosquito_behavior(scene_structure& scene, int mosquito_index, const vec3& position);
+    vec3 vary_mosquito_behavior(float time, int mosquito_index, const vec3& position);
 };
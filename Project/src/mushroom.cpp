@@ -5,8 +5,15 @@
 #include "mushroom.hpp"
 
 void mushroom_manager::initialize(scene_structure &scene, const float TERRAIN_LENGTH) {
+    CGP_PROFILE_SCOPE("mushroom_manager::initialize");
     // Generate positions for mushrooms on the terrain
-    mushroom_position = generate_positions_on_terrain(MUSHROOM_QUANTITY, TERRAIN_LENGTH, false, true);
+    mushroom_position = generate_positions_on_terrain(scene.config.mushroom_quantity, TERRAIN_LENGTH, false, true);
+
+    // Stems and caps textures are gathered in a texture array (one layer per image)
+    texture_array = scene.texture_manager.load_array({project::path + "assets/stem.jpg",
+                                                      project::path + "assets/cap_amanite.jpg",
+                                                      project::path + "assets/cap_porcini.jpg"},
+                                                     GL_MIRRORED_REPEAT, GL_MIRRORED_REPEAT);
 
     // Initialize different types of mushrooms
     amanite_mushroom.initialize(scene);
@@ -14,13 +21,15 @@ void mushroom_manager::initialize(scene_structure &scene, const float TERRAIN_LE
 }
 
 void mushroom_manager::display(scene_structure &scene) {
+    CGP_PROFILE_SCOPE("mushroom_manager::display");
+    CGP_RENDER_STATS_SCOPE("mushroom_manager");
     // using mushroom_index to vary mushroom type
     int mushroom_index = 0;
 
     // A single variable mushroom_position is used for the positions of all mushroom types to avoid the problem of
     // rendering two different mushrooms in approximately the same place.
     for (vec3 position: mushroom_position) {
-        if (mushroom_index < MUSHROOM_QUANTITY / 2) {
+        if (mushroom_index < int(mushroom_position.size()) / 2) {
             amanite_mushroom.display(scene, position);
         } else {
             porcini_mushroom.display(scene, position);
@@ -10,8 +10,13 @@ using std::vector;
 
 // Structure managing mushroom elements in the scene
 struct mushroom_manager {
-    // Define the number of mushrooms
-    static constexpr int MUSHROOM_QUANTITY = 600;
+    // Layers of the texture array shared by all the mushrooms
+    static constexpr float LAYER_STEM = 0;
+    static constexpr float LAYER_CAP_AMANITE = 1;
+    static constexpr float LAYER_CAP_PORCINI = 2;
+
+    // Texture array gathering the stem and cap textures (a single texture for all the mushroom types)
+    cgp::opengl_texture_image_structure texture_array;
 
     // Positions of individual mushrooms
     vector<vec3> mushroom_position;
@@ -9,12 +9,12 @@ using namespace cgp;
 
 void pine_tree::initialize(scene_structure& scene) {
     // Pine tree foliage consists of three combined cones of the same texture, but with
-    // overlapping different colours. Therefore, the mesh of all three cones is built in this function.
-    // The trunk of the pine tree is also built separately, as it is overlaid with a different texture.
+    // overlapping different colours. The three cones are merged in a single drawable (the colour is stored per vertex),
+    // textured by the pine layer of the vegetation texture array.
+    // The trunk of the pine tree is built separately, as it is overlaid with a different texture.
 
-    // Define paths to textures
+    // Path to the trunk texture
     const std::string TRUNK_TEXTURE_PATH = project::path + "assets/trunk_pine.jpg";
-    const std::string FOLIAGE_TEXTURE_PATH = project::path + "assets/sapin.jpg";
 
     // Colors for the foliage
     const vec3 FOLIAGE_1_COLOR = {47 / 256.0, 79 / 256.0, 79 / 256.0};
@@ -40,28 +40,32 @@ void pine_tree::initialize(scene_structure& scene) {
     mesh trunk_mesh = create_cylinder_mesh(TRUNK_RADIUS, TRUNK_HEIGHT);
     scene.initialize_mesh_with_texture(trunk, trunk_mesh, TRUNK_TEXTURE_PATH);
 
-    // Initialize foliage layers
-    initialize_foliage(foliage_1, FOLIAGE_1_RADIUS, FOLIAGE_1_HEIGHT, 0.0f, FOLIAGE_TRANSLATION, FOLIAGE_1_COLOR,
-                       FOLIAGE_TEXTURE_PATH, scene);
-    initialize_foliage(foliage_2, FOLIAGE_2_RADIUS, FOLIAGE_2_HEIGHT, FOLIAGE_3_RADIUS, FOLIAGE_TRANSLATION,
-                       FOLIAGE_2_COLOR, FOLIAGE_TEXTURE_PATH, scene);
-    initialize_foliage(foliage_3, FOLIAGE_3_RADIUS, FOLIAGE_3_HEIGHT, FOLIAGE_1_RADIUS, FOLIAGE_TRANSLATION,
-                       FOLIAGE_3_COLOR, FOLIAGE_TEXTURE_PATH, scene);
+    // Initialize the foliage: the three layers in a single draw call
+    mesh foliage_1_mesh = create_foliage_mesh(FOLIAGE_1_RADIUS, FOLIAGE_1_HEIGHT, 0.0f, FOLIAGE_TRANSLATION, FOLIAGE_1_COLOR);
+    mesh foliage_2_mesh = create_foliage_mesh(FOLIAGE_2_RADIUS, FOLIAGE_2_HEIGHT, FOLIAGE_3_RADIUS, FOLIAGE_TRANSLATION,
+                                              FOLIAGE_2_COLOR);
+    mesh foliage_3_mesh = create_foliage_mesh(FOLIAGE_3_RADIUS, FOLIAGE_3_HEIGHT, FOLIAGE_1_RADIUS, FOLIAGE_TRANSLATION,
+                                              FOLIAGE_3_COLOR);
+    const float LAYER = scene_structure::VEGETATION_LAYER_PINE_FOLIAGE;
+    scene.initialize_mesh_with_texture_layers(foliage, {foliage_1_mesh, foliage_2_mesh, foliage_3_mesh},
+                                              {LAYER, LAYER, LAYER}, scene.vegetation_texture_array);
+    foliage.shader = scene.shader_snake_y_instanced_texture_array; // Reuse shader for foliage
+
+    trunk.shader = scene.shader_instanced;
 
     // Add to hierarchy
-    hierarchy.add(trunk, "trunk");
-    hierarchy.add(foliage_1, "foliage_1", "trunk");
-    hierarchy.add(foliage_2, "foliage_2", "trunk");
-    hierarchy.add(foliage_3, "foliage_3", "trunk");
+    trunk_node = hierarchy.add(trunk, "trunk");
+    hierarchy.add(foliage, "foliage", "trunk");
 }
 
-void pine_tree::display(scene_structure& scene, int tree_index, vec3 position) {
+affine_rts pine_tree::tree_transform(int tree_index, vec3 position) {
     // Set the position of the tree
-    hierarchy["trunk"].transform_local.translation = position;
+    affine_rts trunk_transform;
+    trunk_transform.translation = position;
 
     // Define scaling values for different tree sizes
     constexpr std::array<float, 3> TREE_SCALING = {0.6f, 1.3f, 1.7f};
-    hierarchy["trunk"].transform_local.scaling = TREE_SCALING[tree_index % 3];
+    trunk_transform.scaling = TREE_SCALING[tree_index % 3];
 
     // Define rotation angles for different tree orientations
     constexpr float PI = 3.14159265359f;
@@ -83,21 +87,32 @@ void pine_tree::display(scene_structure& scene, int tree_index, vec3 position) {
             break;
     }
 
-    hierarchy["trunk"].transform_local.rotation =
+    trunk_transform.rotation =
             rotation_transform::from_axis_angle(rotation_axis, rotation_angle);
+    return trunk_transform;
+}
+
+void pine_tree::place(const std::vector<affine_rts>& transforms) {
+    // The transform of each tree is the root of its instance
+    instances.resize(int(transforms.size()));
+    for (size_t k = 0; k < transforms.size(); ++k)
+        instances.root.set(int(k), transforms[k]);
+
+    instances.update(hierarchy);
+    instances.update_gpu(hierarchy);
+}
 
-    // Update the hierarchy and draw the tree
-    hierarchy.update_local_to_global_coordinates();
-    draw(hierarchy, scene.environment);
+void pine_tree::display(scene_structure& scene) {
+    draw(hierarchy, instances, scene.environment);
 }
 
-void pine_tree::initialize_foliage(mesh_drawable& foliage, float base_radius, float height, float translation_z,
-                                   float position_z, vec3 color, const std::string& texture_path, scene_structure& scene) {
+mesh pine_tree::create_foliage_mesh(float base_radius, float height, float translation_z, float position_z, vec3 color) {
     // Create foliage mesh
     mesh foliage_mesh = create_cone_mesh(base_radius, height, translation_z);
     foliage_mesh.translate({0, 0, position_z});
-    scene.initialize_mesh_with_texture_and_color(foliage, foliage_mesh, texture_path, color);
 
-    // Assign shader to foliage
-    foliage.shader = scene.shader_snake_y; // Reuse shader for foliage
+    // The colour of the layer is stored per vertex, as the layers share the same drawable
+    foliage_mesh.color.resize(foliage_mesh.position.size());
+    foliage_mesh.color.fill(color);
+    return foliage_mesh;
 }
\ No newline at end of file
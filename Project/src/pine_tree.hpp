@@ -8,6 +8,8 @@ struct scene_structure;
 // Explicitly using cgp namespace to avoid conflicts and improve clarity
 using cgp::vec3;
 using cgp::hierarchy_mesh_drawable;
+using cgp::hierarchy_mesh_drawable_instances;
+using cgp::affine_rts;
 using cgp::mesh_drawable;
 using std::string;
 
@@ -15,22 +17,30 @@ using std::string;
 struct pine_tree {
     // Hierarchical drawable for pine tree components
     hierarchy_mesh_drawable hierarchy;
+    // Handle of the trunk (root of the hierarchy)
+    int trunk_node = -1;
+    // All the pine trees are drawn as instances of the hierarchy (static transforms, computed once)
+    hierarchy_mesh_drawable_instances instances;
 
     // Drawable for the tree trunk
     mesh_drawable trunk;
 
-    // Drawables for different layers of foliage
-    mesh_drawable foliage_1;
-    mesh_drawable foliage_2;
-    mesh_drawable foliage_3;
+    // Drawable for the three layers of foliage (merged, textured by the vegetation texture array)
+    mesh_drawable foliage;
 
     // Initializes the pine tree in the given scene
     void initialize(scene_structure& scene);
 
-    // Displays the pine tree at the specified position and tree index
-    void display(scene_structure& scene, int tree_index, vec3 position);
+    // Transform of the tree of the specified index at the specified position
+    static affine_rts tree_transform(int tree_index, vec3 position);
 
-    // Initializes the foliage with specified parameters
-    void initialize_foliage(mesh_drawable& foliage, float base_radius, float height, float translation_z,
-                            float position_z, vec3 color, const string& texture_path, scene_structure& scene);
+    // Places the instances of the pine tree at the given transforms
+    void place(const std::vector<affine_rts>& transforms);
+
+    // Displays all the pine trees
+    void display(scene_structure& scene);
+
+    // Creates the mesh of a layer of foliage with specified parameters (the color is stored per vertex)
+    static cgp::mesh create_foliage_mesh(float base_radius, float height, float translation_z, float position_z,
+                                         vec3 color);
 };
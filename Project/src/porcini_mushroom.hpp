@@ -13,12 +13,8 @@ using std::string;
 
 // Structure representing a porcini mushroom
 struct porcini_mushroom {
-    // Hierarchical drawable for mushroom components
-    hierarchy_mesh_drawable hierarchy;
-
-    // Drawable elements for the mushroom
-    mesh_drawable stem;
-    mesh_drawable cap;
+    // Stem and cap merged in a single drawable, textured by the layers of the mushroom texture array
+    mesh_drawable mushroom;
 
     // Initializes the porcini mushroom in the given scene
     void initialize(scene_structure& scene);
@@ -6,6 +6,7 @@
 using namespace cgp;
 
 void scene_structure::initialize() {
+    CGP_PROFILE_SCOPE("scene_structure::initialize");
     // Initialize camera controls
     camera_control.initialize(inputs, window);
     camera_control.set_rotation_axis_z();
@@ -14,20 +15,37 @@ void scene_structure::initialize() {
     // Initialize general information
     display_info();
     initialize_shader();
+#ifndef __EMSCRIPTEN__
+    // Reuse the mipmap chains computed during the previous executions (block-compressed if requested and supported)
+    texture_manager.initialize_mipmap_cache(project::path + "cache/textures/", config.texture_compression);
+#endif
     global_frame.initialize_data_on_gpu(mesh_primitive_frame());
 
+    // Grass and foliage textures are gathered in a texture array (one layer per image)
+    vegetation_texture_array = texture_manager.load_array({project::path + "assets/grass.png",
+                                                           project::path + "assets/sapin.jpg",
+                                                           project::path + "assets/foliage_birch.jpg"},
+                                                          GL_MIRRORED_REPEAT, GL_MIRRORED_REPEAT);
+
     // Initialize scene objects
-    earth_block.initialize(*this, TERRAIN_LENGTH);
+    earth_block.initialize(*this, config.terrain_length);
     sky.initialize(*this);
-    grass.initialize(*this, TERRAIN_LENGTH);
-    tree_manager.initialize(*this, TERRAIN_LENGTH);
-    mushroom_manager.initialize(*this, TERRAIN_LENGTH);
-    mosquito.initialize(*this, TERRAIN_LENGTH);
-    snake.initialize(*this, TERRAIN_LENGTH);
-    skull.initialize(*this, TERRAIN_LENGTH);
+    grass.initialize(*this, config.terrain_length);
+    tree_manager.initialize(*this, config.terrain_length);
+    mushroom_manager.initialize(*this, config.terrain_length);
+    mosquito.initialize(*this, config.terrain_length);
+    snake.initialize(*this, config.terrain_length);
+    skull.initialize(*this, config.terrain_length);
+
+    // Decode the images requested by the scene objects and send them to the GPU
+    texture_manager.upload_pending();
+
+    // Start the simulation of the animated elements
+    simulation.start(*this);
 }
 
 void scene_structure::display_frame() {
+    CGP_PROFILE_SCOPE("scene_structure::display_frame");
     const vec3 BACKGROUND_COLOR = {175 / 256.0f, 238 / 256.0f, 238 / 256.0f};
 
     // Set the light to the current position of the camera
@@ -36,17 +54,20 @@ void scene_structure::display_frame() {
     // Update the environment background color
     environment.background_color = BACKGROUND_COLOR;
 
-    // Update time
-    timer.update();
-    environment.uniform_generic.uniform_float["time"] = timer.t;
+    // Get the state of the animated elements at the current time
+    simulation.update(animation);
+    environment.uniform_generic.uniform_float["time"] = animation.t;
 
     // Display objects
-    earth_block.display(*this);
-    tree_manager.display(*this);
-    mushroom_manager.display(*this);
-    mosquito.display(*this);
-    snake.display(*this, TERRAIN_LENGTH);
-    skull.display(*this);
+    {
+        CGP_PROFILE_GPU_SCOPE("opaque pass");
+        earth_block.display(*this);
+        tree_manager.display(*this);
+        mushroom_manager.display(*this);
+        mosquito.display(*this);
+        snake.display(*this);
+        skull.display(*this);
+    }
 
     display_semiTransparent();
 }
@@ -55,6 +76,10 @@ void scene_structure::display_frame() {
 void scene_structure::display_gui() {
     ImGui::Checkbox("Frame", &gui.display_frame);
     ImGui::Checkbox("Wireframe", &gui.display_wireframe);
+    ImGui::Text("Simulation: %d ticks (%d skipped), last tick %.3f ms", simulation.tick_counter(),
+                simulation.tick_skipped(), 1000 * simulation.tick_duration());
+    ImGui::Text("Scene: %d grass, %d trees, %d mushrooms, %d mosquitoes, %d snakes, %d skulls", config.grass_quantity,
+                config.n_tree, config.mushroom_quantity, config.n_mosquito, 2 * config.n_snake, config.n_skull);
 }
 
 void scene_structure::idle_frame() {
@@ -70,6 +95,8 @@ void scene_structure::display_info() {
 
 
 void scene_structure::display_semiTransparent() {
+    CGP_PROFILE_SCOPE("scene_structure::display_semiTransparent");
+    CGP_PROFILE_GPU_SCOPE("semi-transparent pass");
     // Enable transparency
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -89,12 +116,25 @@ void scene_structure::display_semiTransparent() {
 
 void scene_structure::initialize_shader() {
     const std::string SHADER_PATH = project::path + "shaders/mesh_custom/";
-
-    shader_snake_y.load(SHADER_PATH + "snake_y.vert.glsl", SHADER_PATH + "mesh_custom.frag.glsl");
-    shader_snake_x.load(SHADER_PATH + "snake_x.vert.glsl", SHADER_PATH + "mesh_custom.frag.glsl");
-    shader_birch.load(SHADER_PATH + "birch.vert.glsl", SHADER_PATH + "mesh_custom.frag.glsl");
-    shader_grass.load(SHADER_PATH + "grass.vert.glsl", SHADER_PATH + "mesh_custom.frag.glsl");
-    shader_earth.load(SHADER_PATH + "earth.vert.glsl", SHADER_PATH + "mesh_custom.frag.glsl");
+    const std::string VERTEX_SHADER = SHADER_PATH + "mesh_custom.vert.glsl";
+    const std::string FRAGMENT_SHADER = SHADER_PATH + "mesh_custom.frag.glsl";
+
+    // A single vertex shader is used, the deformation is selected by a define
+    shader_snake_y = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"DEFORMATION_SNAKE_Y", ""}});
+    shader_snake_x = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"DEFORMATION_SNAKE_X", ""}});
+    shader_birch = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"DEFORMATION_BIRCH", ""}});
+    shader_grass = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"DEFORMATION_GRASS", ""}, {"TEXTURE_ARRAY", ""}});
+    shader_earth = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"DEFORMATION_EARTH", ""}});
+
+    // Static meshes sampling a texture array (the layer is given per vertex)
+    shader_texture_array = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"TEXTURE_ARRAY", ""}});
+
+    // Hierarchies drawn as instances: the transform of each instance is read at location 5
+    shader_instanced = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"INSTANCED", ""}});
+    shader_birch_instanced = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"DEFORMATION_BIRCH", ""}, {"INSTANCED", ""}, {"TEXTURE_ARRAY", ""}});
+    shader_snake_x_instanced = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"DEFORMATION_SNAKE_X", ""}, {"INSTANCED", ""}});
+    shader_snake_y_instanced = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"DEFORMATION_SNAKE_Y", ""}, {"INSTANCED", ""}});
+    shader_snake_y_instanced_texture_array = shader_builder.load(VERTEX_SHADER, FRAGMENT_SHADER, {{"DEFORMATION_SNAKE_Y", ""}, {"INSTANCED", ""}, {"TEXTURE_ARRAY", ""}});
 }
 
 
@@ -111,8 +151,17 @@ void scene_structure::initialize_mesh_with_texture(mesh_drawable &part, const me
     // Common initialization
     initialize_mesh_common(part, part_mesh);
 
-    // Load texture
-    part.texture.load_and_initialize_texture_2d_on_gpu(texture_path, GL_MIRRORED_REPEAT, GL_MIRRORED_REPEAT);
+    // Load texture (shared with the other parts using the same file)
+    part.texture = texture_manager.load(texture_path, GL_MIRRORED_REPEAT, GL_MIRRORED_REPEAT);
+}
+
+void scene_structure::initialize_mesh_with_texture(mesh_drawable &part, const mesh_view &part_mesh,
+                                                   const std::string &texture_path) {
+    // Common initialization
+    initialize_mesh_common(part, part_mesh);
+
+    // Load texture (shared with the other parts using the same file)
+    part.texture = texture_manager.load(texture_path, GL_MIRRORED_REPEAT, GL_MIRRORED_REPEAT);
 }
 
 void scene_structure::initialize_mesh_with_texture_and_color(mesh_drawable &part, const mesh &part_mesh,
@@ -123,8 +172,44 @@ void scene_structure::initialize_mesh_with_texture_and_color(mesh_drawable &part
     // Set color
     part.material.color = color;
 
-    // Load texture
-    part.texture.load_and_initialize_texture_2d_on_gpu(texture_path, GL_MIRRORED_REPEAT, GL_MIRRORED_REPEAT);
+    // Load texture (shared with the other parts using the same file)
+    part.texture = texture_manager.load(texture_path, GL_MIRRORED_REPEAT, GL_MIRRORED_REPEAT);
+}
+
+void scene_structure::initialize_mesh_with_texture_layers(mesh_drawable &part, const std::vector<mesh> &part_meshes,
+                                                          const std::vector<float> &layers,
+                                                          const opengl_texture_image_structure &texture_array) {
+    // Merge the meshes and store the texture layer of each vertex (buffers allocated once for all the parts)
+    int number_of_vertex = 0;
+    int number_of_triangle = 0;
+    for (const mesh &part_mesh : part_meshes) {
+        number_of_vertex += part_mesh.position.size();
+        number_of_triangle += part_mesh.connectivity.size();
+    }
+    mesh merged_mesh;
+    merged_mesh.position.reserve(number_of_vertex);
+    merged_mesh.normal.reserve(number_of_vertex);
+    merged_mesh.color.reserve(number_of_vertex);
+    merged_mesh.uv.reserve(number_of_vertex);
+    merged_mesh.connectivity.reserve(number_of_triangle);
+    numarray<float> vertex_layer;
+    vertex_layer.reserve(number_of_vertex);
+    for (size_t k = 0; k < part_meshes.size(); ++k) {
+        mesh part_mesh = part_meshes[k];
+        part_mesh.fill_empty_field();
+        merged_mesh.push_back(part_mesh);
+        for (size_t i = 0; i < part_mesh.position.size(); ++i) {
+            vertex_layer.push_back(layers[k]);
+        }
+    }
+
+    // Common initialization
+    initialize_mesh_common(part, merged_mesh);
+
+    // The layer is read by the shader at location 4
+    part.initialize_supplementary_data_on_gpu(vertex_layer, 4);
+    part.texture = texture_array;
+    part.shader = shader_texture_array;
 }
 
 void scene_structure::initialize_mesh_common(mesh_drawable &part, const mesh &part_mesh) {
@@ -134,3 +219,11 @@ void scene_structure::initialize_mesh_common(mesh_drawable &part, const mesh &pa
     // Set material properties
     part.material.phong = MATERIAL_PHONG;
 }
+
+void scene_structure::initialize_mesh_common(mesh_drawable &part, const mesh_view &part_mesh) {
+    // Initialize mesh part
+    part.initialize_data_on_gpu(part_mesh);
+
+    // Set material properties
+    part.material.phong = MATERIAL_PHONG;
+}
@@ -12,32 +12,58 @@
 #include "grass.hpp"
 #include "tree.hpp"
 #include "mushroom.hpp"
+#include "simulation.hpp"
+#include "scene_config.hpp"
 
 // Using cgp structures without explicitly mentioning cgp::
 using cgp::mesh;
+using cgp::mesh_view;
 using cgp::mesh_drawable;
 using cgp::vec3;
 using cgp::numarray;
-using cgp::timer_basic;
 
 // Main scene structure
 struct scene_structure : cgp::scene_inputs_generic {
     camera_controller_orbit_euler camera_control;        // Controls for the camera
     camera_projection_perspective camera_projection;    // Projection for the camera
     window_structure window;                             // Window structure
-    timer_basic timer;                                   // Basic timer
+
+    // Simulation of the animated elements at a fixed time step (on its own thread)
+    simulation_structure simulation;
+    // State of the animated elements interpolated for the current frame (time and transforms)
+    simulation_state animation;
+
+    // Builder compiling each shader permutation once (programs are shared between identical requests)
+    opengl_shader_builder_structure shader_builder;
+
+    // Cache of the textures loaded from files (each image is decoded once, in parallel, at the end of initialize())
+    opengl_texture_manager_structure texture_manager;
 
     // Shader structures for different elements
-    opengl_shader_structure shader_grass;
+    opengl_shader_structure shader_grass; // samples the vegetation texture array
     opengl_shader_structure shader_birch;
     opengl_shader_structure shader_snake_x;
     opengl_shader_structure shader_snake_y;
     opengl_shader_structure shader_earth;
+    opengl_shader_structure shader_texture_array;
+    // Same shaders for the hierarchies drawn as instances (hierarchy_mesh_drawable_instances)
+    opengl_shader_structure shader_instanced;
+    opengl_shader_structure shader_birch_instanced; // samples the vegetation texture array
+    opengl_shader_structure shader_snake_x_instanced;
+    opengl_shader_structure shader_snake_y_instanced;
+    opengl_shader_structure shader_snake_y_instanced_texture_array; // pine foliage
+
+    // Texture array shared by the grass and the tree foliage (one layer per image)
+    static constexpr float VEGETATION_LAYER_GRASS = 0;
+    static constexpr float VEGETATION_LAYER_PINE_FOLIAGE = 1;
+    static constexpr float VEGETATION_LAYER_BIRCH_FOLIAGE = 2;
+    opengl_texture_image_structure vegetation_texture_array;
 
     // Phong material parameters
     const phong_parameters MATERIAL_PHONG = {0.4f, 0.6f, 0.0f, 1.0f};
 
-    static constexpr float TERRAIN_LENGTH = 200.0f;
+    // Number of elements and size of the terrain (set before initialize(), see scene_config.hpp)
+    scene_config_structure config;
 
     // Scene elements
     mesh_drawable global_frame;
@@ -61,14 +87,24 @@ struct scene_structure : cgp::scene_inputs_generic {
 
     void initialize_mesh_common(mesh_drawable &part, const mesh &part_mesh);
 
+    // Same as above, reading the buffers directly from a view (ex. a binary mesh file mapped in memory)
+    void initialize_mesh_common(mesh_drawable &part, const mesh_view &part_mesh);
+
     void initialize_mesh_with_color(mesh_drawable &part, const mesh &part_mesh, const vec3 &color);
 
     void initialize_mesh_with_texture(mesh_drawable &part, const mesh &part_mesh, const std::string &texture_path);
 
+    void initialize_mesh_with_texture(mesh_drawable &part, const mesh_view &part_mesh, const std::string &texture_path);
+
     void
     initialize_mesh_with_texture_and_color(mesh_drawable &part, const mesh &part_mesh, const std::string &texture_path,
                                            const vec3 &color);
 
+    // Merge several meshes in a single drawable, each mesh being textured by one layer of the texture array
+    void initialize_mesh_with_texture_layers(mesh_drawable &part, const std::vector<mesh> &part_meshes,
+                                             const std::vector<float> &layers,
+                                             const opengl_texture_image_structure &texture_array);
+
     // Display the scene frame
     void display_frame();
 
@@ -0,0 +1,161 @@
+#include "scene_config.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    // Integer parameters: key in the file, member, and name of the subsystem (empty if it is not a number of elements)
+    struct config_entry {
+        const char *key;
+        int scene_config_structure::*value;
+        const char *subsystem;
+    };
+
+    const std::vector<config_entry> &config_entries() {
+        static const std::vector<config_entry> entries = {
+            {"GRASS_QUANTITY", &scene_config_structure::grass_quantity, "grass"},
+            {"N_TREE", &scene_config_structure::n_tree, "tree"},
+            {"MUSHROOM_QUANTITY", &scene_config_structure::mushroom_quantity, "mushroom"},
+            {"N_MOSQUITO", &scene_config_structure::n_mosquito, "mosquito"},
+            {"N_SNAKE", &scene_config_structure::n_snake, "snake"},
+            {"N_SKULL", &scene_config_structure::n_skull, "skull"},
+            {"N_VERTICES_TERRAIN", &scene_config_structure::n_vertices_terrain, ""}};
+        return entries;
+    }
+
+    std::string trim(const std::string &s) {
+        size_t const first = s.find_first_not_of(" \t\r");
+        if (first == std::string::npos)
+            return "";
+        size_t const last = s.find_last_not_of(" \t\r");
+        return s.substr(first, last - first + 1);
+    }
+}
+
+bool scene_config_structure::set(const std::string &key, const std::string &value) {
+    char *end = nullptr;
+    if (key == "TERRAIN_LENGTH") {
+        double const x = std::strtod(value.c_str(), &end);
+        if (end == value.c_str() || *end != '\0' || !(x > 2.0)) {
+            std::cerr << "Scene configuration: invalid value " << value << " for TERRAIN_LENGTH (number larger than 2 expected)" << std::endl;
+            return false;
+        }
+        terrain_length = float(x);
+        return true;
+    }
+
+    if (key == "TEXTURE_COMPRESSION") {
+        if (value != "0" && value != "1") {
+            std::cerr << "Scene configuration: invalid value " << value << " for TEXTURE_COMPRESSION (0 or 1 expected)" << std::endl;
+            return false;
+        }
+        texture_compression = value == "1";
+        return true;
+    }
+
+    for (const config_entry &entry : config_entries()) {
+        if (key != entry.key)
+            continue;
+        long const n = std::strtol(value.c_str(), &end, 10);
+        if (end == value.c_str() || *end != '\0' || n < 1 || n > 100000000) {
+            std::cerr << "Scene configuration: invalid value " << value << " for " << key << " (positive integer expected)" << std::endl;
+            return false;
+        }
+        this->*entry.value = int(n);
+        return true;
+    }
+
+    std::cerr << "Scene configuration: unknown parameter " << key << std::endl;
+    return false;
+}
+
+bool scene_config_structure::load(const std::string &filename) {
+    std::ifstream stream(filename);
+    if (!stream) {
+        std::cerr << "Scene configuration: cannot read " << filename << std::endl;
+        return false;
+    }
+
+    bool valid = true;
+    std::string line;
+    while (std::getline(stream, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+        size_t const equal = line.find('=');
+        if (equal == std::string::npos) {
+            std::cerr << "Scene configuration: invalid line \"" << line << "\" in " << filename << " (KEY = value expected)" << std::endl;
+            valid = false;
+            continue;
+        }
+        valid = set(trim(line.substr(0, equal)), trim(line.substr(equal + 1))) && valid;
+    }
+    return valid;
+}
+
+bool scene_config_structure::scale(const std::string &subsystem, float factor) {
+    bool found = false;
+    for (const config_entry &entry : config_entries()) {
+        if (*entry.subsystem == '\0' || (subsystem != "all" && subsystem != entry.subsystem))
+            continue;
+        int &n = this->*entry.value;
+        n = std::max(1, int(std::lround(n * double(factor))));
+        found = true;
+    }
+    return found;
+}
+
+int scene_config_structure::count(const std::string &subsystem) const {
+    int total = 0;
+    for (const config_entry &entry : config_entries()) {
+        if (*entry.subsystem == '\0')
+            continue;
+        if (subsystem == entry.subsystem)
+            return this->*entry.value;
+        total += this->*entry.value;
+    }
+    return subsystem == "all" ? total : -1;
+}
+
+std::string scene_config_structure::to_string() const {
+    std::ostringstream out;
+    for (const config_entry &entry : config_entries())
+        out << entry.key << " = " << this->*entry.value << "\n";
+    out << "TERRAIN_LENGTH = " << terrain_length << "\n";
+    out << "TEXTURE_COMPRESSION = " << (texture_compression ? 1 : 0) << "\n";
+    return out.str();
+}
+
+std::vector<std::string> scene_config_structure::subsystems() {
+    std::vector<std::string> names;
+    for (const config_entry &entry : config_entries())
+        if (*entry.subsystem != '\0')
+            names.push_back(entry.subsystem);
+    return names;
+}
+
+bool scene_config_parse_arguments(int argc, char *argv[], scene_config_structure &config) {
+    bool valid = true;
+    // The file is read first, so that --set overrides its values whatever the order of the arguments
+    for (int k = 1; k + 1 < argc; ++k)
+        if (std::string(argv[k]) == "--config")
+            valid = config.load(argv[++k]) && valid;
+
+    for (int k = 1; k + 1 < argc; ++k) {
+        if (std::string(argv[k]) != "--set")
+            continue;
+        std::string const assignment = argv[++k];
+        size_t const equal = assignment.find('=');
+        if (equal == std::string::npos) {
+            std::cerr << "Scene configuration: invalid argument --set " << assignment << " (--set KEY=value expected)" << std::endl;
+            valid = false;
+            continue;
+        }
+        valid = config.set(trim(assignment.substr(0, equal)), trim(assignment.substr(equal + 1))) && valid;
+    }
+    return valid;
+}
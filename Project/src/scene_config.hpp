@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Parameters of the scene read before its initialization (number of elements and size of the terrain)
+//  The default values describe the original scene. Each value can be changed from a file with one "KEY = value" per line
+//  (the text after a # is a comment), and from the command line (the file is read first, then the --set are applied):
+//  ./floating_forest [--config file] [--set KEY=value] ...
+//
+//  Keys: GRASS_QUANTITY, N_TREE, MUSHROOM_QUANTITY, N_MOSQUITO, N_SNAKE, N_SKULL, N_VERTICES_TERRAIN, TERRAIN_LENGTH,
+//  TEXTURE_COMPRESSION
+//
+//  Usage:
+//  | scene_config_structure config;
+//  | config.load("scene.cfg");
+//  | config.set("N_TREE", "2000");
+//  | config.scale("mosquito", 10); // 10x more mosquitoes
+struct scene_config_structure {
+    int grass_quantity = 1000;     // GRASS_QUANTITY
+    int n_tree = 500;              // N_TREE
+    int mushroom_quantity = 600;   // MUSHROOM_QUANTITY
+    int n_mosquito = 300;          // N_MOSQUITO
+    int n_snake = 25;              // N_SNAKE
+    int n_skull = 10;              // N_SKULL
+    int n_vertices_terrain = 200;  // N_VERTICES_TERRAIN: number of gaussian bumps of the terrain
+    float terrain_length = 200.0f; // TERRAIN_LENGTH
+    bool texture_compression = false; // TEXTURE_COMPRESSION (0 or 1): lossy block compression of the cached textures
+
+    // Set the value associated to the key. Return false (with a warning) if the key is unknown or the value is invalid.
+    bool set(const std::string &key, const std::string &value);
+    // Read the "KEY = value" lines of a file. Return false if the file cannot be read or contains an invalid line.
+    bool load(const std::string &filename);
+
+    // Multiply the number of elements of a subsystem (one of subsystems(), or "all") by factor
+    //  Return false if the subsystem is unknown.
+    bool scale(const std::string &subsystem, float factor);
+    // Number of elements of a subsystem, or of all of them with "all" (-1 if unknown)
+    int count(const std::string &subsystem) const;
+
+    // "KEY = value" lines (readable by load)
+    std::string to_string() const;
+
+    // Names of the subsystems whose number of elements can be scaled: grass, tree, mushroom, mosquito, snake, skull
+    static std::vector<std::string> subsystems();
+};
+
+// Read --config and --set from the command line. Return false if one of them is invalid.
+bool scene_config_parse_arguments(int argc, char *argv[], scene_config_structure &config);
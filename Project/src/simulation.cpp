@@ -0,0 +1,146 @@
+#include "simulation.hpp"
+#include "scene.hpp"
+
+#include <algorithm>
+
+using namespace cgp;
+
+static affine_rts interpolate_transform(const affine_rts &T0, const affine_rts &T1, float alpha, float max_distance) {
+    if (norm(T1.translation - T0.translation) > max_distance)
+        return T1;
+
+    return affine_rts(rotation_transform::lerp(T0.rotation, T1.rotation, alpha),
+                      (1 - alpha) * T0.translation + alpha * T1.translation,
+                      (1 - alpha) * T0.scaling + alpha * T1.scaling);
+}
+
+static void interpolate_transforms(vector<affine_rts> &result, const vector<affine_rts> &T0,
+                                   const vector<affine_rts> &T1, float alpha, float max_distance) {
+    result.resize(T1.size());
+    for (size_t k = 0; k < T1.size(); ++k)
+        result[k] = interpolate_transform(T0[k], T1[k], alpha, max_distance);
+}
+
+void interpolate(simulation_state &result, const simulation_state &s0, const simulation_state &s1, float alpha,
+                 float max_distance) {
+    result.t = (1 - alpha) * s0.t + alpha * s1.t;
+
+    interpolate_transforms(result.mosquito_body, s0.mosquito_body, s1.mosquito_body, alpha, max_distance);
+    interpolate_transforms(result.snake_head_x, s0.snake_head_x, s1.snake_head_x, alpha, max_distance);
+    interpolate_transforms(result.snake_head_y, s0.snake_head_y, s1.snake_head_y, alpha, max_distance);
+
+    result.mosquito_wing_angle.resize(s1.mosquito_wing_angle.size());
+    for (size_t k = 0; k < s1.mosquito_wing_angle.size(); ++k)
+        result.mosquito_wing_angle[k] = (1 - alpha) * s0.mosquito_wing_angle[k] + alpha * s1.mosquito_wing_angle[k];
+}
+
+simulation_structure::~simulation_structure() {
+    stop();
+}
+
+void simulation_structure::compute(simulation_state &state, float t) {
+    clock::time_point const t0 = clock::now();
+
+    state.t = t;
+    scene->mosquito.simulate(state, t);
+    scene->snake.simulate(state, t, scene->config.terrain_length);
+
+    last_tick_duration = std::chrono::duration<float>(clock::now() - t0).count();
+    ++ticks;
+}
+
+void simulation_structure::set_time(double t) {
+    manual_time = t;
+}
+
+double simulation_structure::elapsed() const {
+    if (manual_clock)
+        return manual_time;
+    return std::chrono::duration<double>(clock::now() - start_time).count();
+}
+
+void simulation_structure::start(scene_structure &scene_arg) {
+    stop();
+    scene = &scene_arg;
+    ticks = 0;
+    skipped = 0;
+
+    // The two first states are identical: the interpolation is valid from the beginning
+    compute(current, 0.0f);
+    previous = current;
+    back = current;
+    next_tick = 1;
+    start_time = clock::now();
+    manual_time = 0;
+
+    if (!threaded || manual_clock)
+        return;
+
+    running = true;
+    thread = std::thread([this]() {
+        while (running) {
+            if (!advance()) {
+                clock::time_point const next_time = start_time + std::chrono::duration_cast<clock::duration>(
+                        std::chrono::duration<double>(next_tick * double(time_step)));
+                std::this_thread::sleep_until(std::min(next_time, clock::now() + std::chrono::milliseconds(5)));
+            }
+        }
+    });
+}
+
+void simulation_structure::stop() {
+    running = false;
+    if (thread.joinable())
+        thread.join();
+}
+
+bool simulation_structure::advance() {
+    long const due_tick = long(elapsed() / time_step);
+    if (due_tick < next_tick)
+        return false;
+
+    // Too late: skip the ticks that cannot be computed in time
+    if (due_tick - next_tick >= max_catch_up) {
+        skipped += int(due_tick - next_tick);
+        next_tick = due_tick;
+    }
+
+    for (int k = 0; k < max_catch_up && next_tick <= due_tick; ++k) {
+        compute(back, next_tick * time_step);
+        ++next_tick;
+
+        // Publish the new state: previous <- current <- back (the old previous becomes the next back buffer)
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(previous, current);
+        std::swap(current, back);
+    }
+    return true;
+}
+
+void simulation_structure::update(simulation_state &render_state) {
+    if (scene == nullptr)
+        return;
+    if (!threaded || manual_clock)
+        advance();
+
+    // The displayed time is one tick late, so that it lies between the two last states
+    float const render_time = float(elapsed()) - time_step;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    float const duration = current.t - previous.t;
+    float alpha = duration > 0 ? (render_time - previous.t) / duration : 1.0f;
+    alpha = std::max(0.0f, std::min(alpha, 1.0f));
+    interpolate(render_state, previous, current, alpha);
+}
+
+int simulation_structure::tick_counter() const {
+    return ticks;
+}
+
+int simulation_structure::tick_skipped() const {
+    return skipped;
+}
+
+float simulation_structure::tick_duration() const {
+    return last_tick_duration;
+}
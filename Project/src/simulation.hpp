@@ -0,0 +1,109 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// Forward declaration of scene_structure to avoid circular dependencies
+struct scene_structure;
+
+using cgp::affine_rts;
+using std::vector;
+
+// Transforms of the animated elements at a given time of the simulation
+struct simulation_state {
+    // Time of the simulation (also sent to the shaders and used by the elements animated directly from the time)
+    float t = 0.0f;
+
+    // Global transform of the body and rotation angle of the wings of each mosquito
+    vector<affine_rts> mosquito_body;
+    vector<float> mosquito_wing_angle;
+
+    // Transform of the head of each snake moving along the x and y axes
+    vector<affine_rts> snake_head_x;
+    vector<affine_rts> snake_head_y;
+};
+
+// Interpolate two states of the simulation (alpha=0: s0, alpha=1: s1) in result
+//  An element moving further than max_distance between the two states is teleported (no interpolation).
+void interpolate(simulation_state &result, const simulation_state &s0, const simulation_state &s1, float alpha,
+                 float max_distance = 5.0f);
+
+// Simulation of the animated elements with a fixed time step, decoupled from the rendering
+//  - The ticks are computed on a dedicated thread (or during update() when threaded is false, ex. with emscripten)
+//    at the times k*time_step, independently of the frame rate.
+//  - Each tick is written in a back buffer, then swapped with the two last states under a lock:
+//    the rendering never waits for the simulation, and the simulation never waits for the rendering.
+//  - update() returns the state interpolated at the current time minus one time step (always enclosed by the two last ticks).
+//  If the simulation is too slow, at most max_catch_up ticks are computed in a row, then the simulation time jumps to the current time.
+struct simulation_structure {
+    // Duration of a tick of the simulation (in seconds)
+    float time_step = 1.0f / 60.0f;
+
+    // Compute the ticks on a dedicated thread (must be set before start())
+#ifndef __EMSCRIPTEN__
+    bool threaded = true;
+#else
+    bool threaded = false;
+#endif
+
+    // Maximal number of late ticks computed before skipping the simulation time to the current time
+    int max_catch_up = 5;
+
+    // Use the time given to set_time() instead of the real time (ex. reproducible benchmark)
+    //  Must be set before start(): the ticks are then computed during update(), without thread.
+    bool manual_clock = false;
+
+    ~simulation_structure();
+
+    // Compute the first state and start the ticks (the elements of the scene must be initialized)
+    void start(scene_structure &scene);
+
+    // Stop the simulation thread
+    void stop();
+
+    // Interpolated state at the current time, to be displayed
+    void update(simulation_state &render_state);
+
+    // Set the current time since start() (in seconds) when manual_clock is true
+    void set_time(double t);
+
+    // Statistics
+    int tick_counter() const;       // number of ticks computed since start()
+    int tick_skipped() const;       // number of ticks skipped as the simulation was late
+    float tick_duration() const;    // time spent to compute the last tick (in seconds)
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    scene_structure *scene = nullptr;
+    clock::time_point start_time;
+    double manual_time = 0;
+
+    // Two last ticks (previous, current) and the state being computed (back)
+    simulation_state previous;
+    simulation_state current;
+    simulation_state back;
+    std::mutex mutex;
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<int> ticks{0};
+    std::atomic<int> skipped{0};
+    std::atomic<float> last_tick_duration{0.0f};
+
+    // Index of the next tick to compute
+    long next_tick = 0;
+
+    // Compute the state at time t
+    void compute(simulation_state &state, float t);
+
+    // Compute the ticks up to the current time (at most max_catch_up), return false if no tick was due
+    bool advance();
+
+    // Current time since start() (in seconds)
+    double elapsed() const;
+};
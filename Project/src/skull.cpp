@@ -9,8 +9,9 @@
 using namespace cgp;
 
 void skull::initialize(scene_structure& scene, const float terrain_length) {
+    CGP_PROFILE_SCOPE("skull::initialize");
     // Generate positions for skulls on the terrain
-    skull_position = generate_positions_on_terrain(N_SKULL, terrain_length * 0.9, false, true);
+    skull_position = generate_positions_on_terrain(scene.config.n_skull, terrain_length * 0.9, false, true);
 
     // Define paths to textures
     const std::string SKULL_TEXTURE_PATH = project::path + "assets/skull/skull.jpg";
@@ -18,9 +19,10 @@ void skull::initialize(scene_structure& scene, const float terrain_length) {
 
     constexpr float ROTATION_ANGLE_X = -3.14 / 7;
 
-    // Initialize skull
-    mesh skull_mesh = mesh_load_file_obj(SKULL_MESH_PATH);
-    scene.initialize_mesh_with_texture(skull, skull_mesh, SKULL_TEXTURE_PATH);
+    // Initialize skull (the OBJ is converted once to a binary file, which is then mapped and sent directly to the GPU)
+    mesh_binary_structure skull_file;
+    skull_file.open_cached_obj(SKULL_MESH_PATH);
+    scene.initialize_mesh_with_texture(skull, skull_file.view(), SKULL_TEXTURE_PATH);
 
     // Set skull scaling and rotation
     skull.model.scaling = 0.1;
@@ -28,6 +30,8 @@ void skull::initialize(scene_structure& scene, const float terrain_length) {
 }
 
 void skull::display(scene_structure& scene){
+    CGP_PROFILE_SCOPE("skull::display");
+    CGP_RENDER_STATS_SCOPE("skull");
     // Display all skulls
     for (vec3 position :skull_position){
         skull.model.translation = position;
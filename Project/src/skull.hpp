@@ -13,9 +13,6 @@ using std::vector;
 
 // Structure representing a collection of skulls in the scene
 struct skull {
-    // Define the number of skulls
-    static constexpr int N_SKULL = 10;
-
     // Hierarchical drawable for skull components
     hierarchy_mesh_drawable hierarchy;
 
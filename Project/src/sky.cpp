@@ -4,6 +4,7 @@
 #include "scene.hpp"
 
 void sky_structure::initialize(scene_structure& scene){
+    CGP_PROFILE_SCOPE("sky_structure::initialize");
     // Define constants for the sky dimensions and position
     const vec3 SKY_TRANSLATION = {0.0f, 0.0f, 20.0f};
     const std::vector<float> SKY_SCALE = {900.0f, 500.0f};
@@ -12,11 +13,11 @@ void sky_structure::initialize(scene_structure& scene){
 
     // Initialize the farest sky cube
     initialize_sky_cube(scene, sky, SKY_SCALE[0], SKY_TRANSLATION);
-    hierarchy.add(sky, "layer_1");
+    layer_1_node = hierarchy.add(sky, "layer_1");
 
     // Initialize the closest sky cube
     initialize_sky_cube(scene, sky, SKY_SCALE[1], SKY_TRANSLATION);
-    hierarchy.add(sky, "layer_2", "layer_1");
+    layer_2_node = hierarchy.add(sky, "layer_2", "layer_1");
 }
 
 void sky_structure::initialize_sky_cube(scene_structure& scene, mesh_drawable& sky_part, const float SKY_SCALE, const vec3& SKY_TRANSLATION){
@@ -31,13 +32,15 @@ void sky_structure::initialize_sky_cube(scene_structure& scene, mesh_drawable& s
 }
 
 void sky_structure::display(scene_structure &scene) {
+    CGP_PROFILE_SCOPE("sky_structure::display");
+    CGP_RENDER_STATS_SCOPE("sky_structure");
     // Define rotation angle
-    const std::vector<float> ROTATION_ANGLE = {scene.timer.t / 10, scene.timer.t / 15};
+    const std::vector<float> ROTATION_ANGLE = {scene.animation.t / 10, scene.animation.t / 15};
 
     // Rotation around its axis
-    hierarchy["layer_1"].transform_local.rotation =
+    hierarchy[layer_1_node].transform_local.rotation =
             rotation_transform::from_axis_angle({0, 0, 1}, ROTATION_ANGLE[0]);
-    hierarchy["layer_2"].transform_local.rotation =
+    hierarchy[layer_2_node].transform_local.rotation =
             rotation_transform::from_axis_angle({0, 0, 1}, ROTATION_ANGLE[1]);
 
     // Update the hierarchy and draw the amanite
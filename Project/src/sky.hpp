@@ -9,6 +9,9 @@ using namespace cgp;
 
 struct sky_structure{
     cgp::hierarchy_mesh_drawable hierarchy;
+    // Handles of the two layers of clouds
+    int layer_1_node = -1;
+    int layer_2_node = -1;
 
     void initialize(scene_structure& scene);
     void initialize_sky_cube(scene_structure& scene, mesh_drawable& sky_part, const float SKY_SCALE, const vec3& SKY_TRANSLATION);
@@ -23,6 +23,7 @@ void snake_structure::initialize_snake(scene_structure& scene, mesh_drawable& he
     head_mesh.scale(1.0, 2.0, 1.0);
     head_mesh.rotate(rotation_axis, rotation_angle);
     scene.initialize_mesh_with_texture(head, head_mesh, texture_path);
+    head.shader = scene.shader_instanced;
 
     // Initialize snake body. The body mesh is built separately, since a different shader is used for the body.
     // This is necessary to simulate the wriggling of the snake's body.
@@ -47,7 +48,7 @@ void snake_structure::initialize_snake_x(scene_structure& scene) {
 
     // Initialize snake head and body
     initialize_snake(scene, head_x, body_x, hierarchy_x, SNAKE_TEXTURE_PATH,
-                     scene.shader_snake_x, {0, 0, 1}, ROTATION_ANGLE, BODY_TRANSLATION);
+                     scene.shader_snake_x_instanced, {0, 0, 1}, ROTATION_ANGLE, BODY_TRANSLATION);
 }
 
 void snake_structure::initialize_snake_y(scene_structure& scene) {
@@ -59,23 +60,21 @@ void snake_structure::initialize_snake_y(scene_structure& scene) {
 
     // Initialize snake head and body
     initialize_snake(scene, head_y, body_y, hierarchy_y, SNAKE_TEXTURE_PATH,
-                     scene.shader_snake_y, {0, 0, 1}, ROTATION_ANGLE, BODY_TRANSLATION);
+                     scene.shader_snake_y_instanced, {0, 0, 1}, ROTATION_ANGLE, BODY_TRANSLATION);
 }
 
 void snake_structure::initialize(scene_structure& scene, const float TERRAIN_LENGTH) {
+    CGP_PROFILE_SCOPE("snake_structure::initialize");
     // Generate positions for snakes on the terrain
+    const int N_SNAKE = scene.config.n_snake;
     snake_position_y = generate_positions_on_terrain(N_SNAKE, TERRAIN_LENGTH * 0.9, false, true);
     snake_position_x = generate_positions_on_terrain(N_SNAKE, TERRAIN_LENGTH * 0.9, false, true);
 
     // Initialize previous positions and angles
-    for (int i = 0; i < N_SNAKE; ++i) {
-        snake_position_previous_y.push_back(snake_position_y[i]);
-        if (snake_angle_x.size() < N_SNAKE)
-            snake_angle_x.push_back(0.0f);
-        snake_position_previous_x.push_back(snake_position_x[i]);
-        if (snake_angle_y.size() < N_SNAKE)
-            snake_angle_y.push_back(0.0f);
-    }
+    snake_position_previous_y = snake_position_y;
+    snake_position_previous_x = snake_position_x;
+    snake_angle_x.assign(N_SNAKE, 0.0f);
+    snake_angle_y.assign(N_SNAKE, 0.0f);
 
     // Initialize the snake along the x and y axes
     initialize_snake_x(scene);
@@ -83,28 +82,50 @@ void snake_structure::initialize(scene_structure& scene, const float TERRAIN_LEN
 }
 
 
-void snake_structure::display(scene_structure& scene, const float TERRAIN_LENGTH){
-    display_snake_x(scene, TERRAIN_LENGTH);
-    display_snake_y(scene, TERRAIN_LENGTH);
+void snake_structure::simulate(simulation_state& state, float t, const float TERRAIN_LENGTH) {
+    CGP_PROFILE_SCOPE("snake_structure::simulate");
+    simulate_snake_x(state.snake_head_x, t, TERRAIN_LENGTH);
+    simulate_snake_y(state.snake_head_y, t, TERRAIN_LENGTH);
+}
+
+void snake_structure::display(scene_structure& scene) {
+    CGP_PROFILE_SCOPE("snake_structure::display");
+    CGP_RENDER_STATS_SCOPE("snake_structure");
+    display_snakes(scene, hierarchy_x, instances_x, scene.animation.snake_head_x);
+    display_snakes(scene, hierarchy_y, instances_y, scene.animation.snake_head_y);
+}
+
+void snake_structure::display_snakes(scene_structure& scene, hierarchy_mesh_drawable& hierarchy, hierarchy_mesh_drawable_instances& instances,
+                                     const vector<affine_rts>& heads) {
+    // The head keeps the identity as local transform, the body follows it
+    instances.resize(int(heads.size()));
+    for (size_t snake_index = 0; snake_index < heads.size(); ++snake_index)
+        instances.root.set(int(snake_index), heads[snake_index]);
+
+    instances.update(hierarchy);
+    instances.update_gpu(hierarchy);
+    draw(hierarchy, instances, scene.environment);
 }
 
-void snake_structure::display_snake_x(scene_structure& scene, const float TERRAIN_LENGTH) {
+void snake_structure::simulate_snake_x(vector<affine_rts>& heads, float t, const float TERRAIN_LENGTH) {
     // Index used to vary moving type and size of snake
     int snake_index = 0;
 
     constexpr float MIN_Z_DIFF = 0.07f;
     constexpr float MIN_X_DIFF = 0.001f;
-    const float TIME = scene.timer.t;
+    const float TIME = t;
 
+    heads.resize(snake_position_x.size());
     for (const vec3& position : snake_position_x) {
         float x, y, z; // New x, y, z coordinates of the snake head
-        hierarchy_x["head"].transform_local.translation = position;
+        affine_rts& head = heads[snake_index];
+        head.translation = position;
 
         // Varying the size and moving type of the snake
         switch (snake_index % 2) {
             case 0: {
                 // Snake_0 moves in a straight line along the x-axis.
-                hierarchy_x["head"].transform_local.rotation =
+                head.rotation =
                         rotation_transform::from_axis_angle({0, 1, 0}, snake_angle_x[snake_index]);
 
                 const float TERRAIN_HALF_LENGTH = TERRAIN_LENGTH / 2 * 0.9f;
@@ -124,17 +145,17 @@ void snake_structure::display_snake_x(scene_structure& scene, const float TERRAI
                 if (fabs(z - snake_position_previous_x[snake_index].z) > MIN_Z_DIFF) {
                     if (fabs(snake_position_previous_x[snake_index].x - x) > MIN_X_DIFF) {
                         float angle = atan((z - snake_position_previous_x[snake_index].z) / (snake_position_previous_x[snake_index].x - x)) - snake_angle_x[snake_index];
-                        hierarchy_x["head"].transform_local.rotation =
+                        head.rotation =
                                 rotation_transform::from_axis_angle({0, 1, 0}, angle);
 
-                        // Save the new angle and the new position into an array for use in the next drawing
+                        // Save the new angle and the new position into an array for use in the next tick
                         snake_angle_x[snake_index] = angle;
                         snake_position_previous_x[snake_index] = {x, y, z};
                     }
                 }
 
-                hierarchy_x["head"].transform_local.translation = {x, y, z};
-                hierarchy_x["head"].transform_local.scaling = 1.6f;
+                head.translation = {x, y, z};
+                head.scaling = 1.6f;
                 break;
             }
             case 1: {
@@ -143,23 +164,20 @@ void snake_structure::display_snake_x(scene_structure& scene, const float TERRAI
                 y = position[1];
                 z = evaluate_terrain_height(x, y) + HEAD_RADIUS;
 
-                hierarchy_x["head"].transform_local.rotation =
+                head.rotation =
                         rotation_transform::from_axis_angle({0, 0, 1}, 2 * position[0] - 6 * position[1] + position[2]);
 
-                hierarchy_x["head"].transform_local.translation = {x, y, z};
-                hierarchy_x["head"].transform_local.scaling = 1.1f;
+                head.translation = {x, y, z};
+                head.scaling = 1.1f;
                 break;
             }
         }
 
         snake_index++;
-
-        hierarchy_x.update_local_to_global_coordinates();
-        draw(hierarchy_x, scene.environment);
     }
 }
 
-void snake_structure::display_snake_y(scene_structure& scene, const float TERRAIN_LENGTH) {
+void snake_structure::simulate_snake_y(vector<affine_rts>& heads, float t, const float TERRAIN_LENGTH) {
     // Index used to vary moving type and size of snake
     int snake_index = 0;
 
@@ -170,17 +188,19 @@ void snake_structure::display_snake_y(scene_structure& scene, const float TERRAI
     const float TERRAIN_OFFSET = TERRAIN_HALF_LENGTH * 0.9f;
     constexpr float MIN_Z_DIFF = 0.07f;
     constexpr float MIN_Y_DIFF = 0.001f;
-    const float TIME = scene.timer.t;
+    const float TIME = t;
 
+    heads.resize(snake_position_y.size());
     for (const vec3& position : snake_position_y) {
         float x, y, z; // New x, y, z coordinates of the snake head
-        hierarchy_y["head"].transform_local.translation = position;
+        affine_rts& head = heads[snake_index];
+        head.translation = position;
 
         // Varying the size and moving type of the snake
         switch (snake_index % 2) {
             case 0: {
                 // Snake_0 moves in a straight line along the y-axis.
-                hierarchy_y["head"].transform_local.rotation =
+                head.rotation =
                         rotation_transform::from_axis_angle({1, 0, 0}, snake_angle_y[snake_index]);
 
                 x = position[0];
@@ -200,17 +220,17 @@ void snake_structure::display_snake_y(scene_structure& scene, const float TERRAI
                 if (fabs(z - snake_position_previous_y[snake_index].z) > MIN_Z_DIFF) {
                     if (fabs(y - snake_position_previous_y[snake_index].y) > MIN_Y_DIFF) {
                         float angle = atan((z - snake_position_previous_y[snake_index].z) / (y - snake_position_previous_y[snake_index].y)) - snake_angle_y[snake_index];
-                        hierarchy_y["head"].transform_local.rotation =
+                        head.rotation =
                                 rotation_transform::from_axis_angle({1, 0, 0}, angle);
 
-                        // Save the new angle and the new position into an array for use in the next drawing
+                        // Save the new angle and the new position into an array for use in the next tick
                         snake_angle_y[snake_index] = angle;
                         snake_position_previous_y[snake_index] = {x, y, z};
                     }
                 }
 
-                hierarchy_y["head"].transform_local.translation = {x, y, z};
-                hierarchy_y["head"].transform_local.scaling = HEAD_SCALING_0;
+                head.translation = {x, y, z};
+                head.scaling = HEAD_SCALING_0;
                 break;
             }
             case 1: {
@@ -219,17 +239,14 @@ void snake_structure::display_snake_y(scene_structure& scene, const float TERRAI
                 y = position[1];
                 z = evaluate_terrain_height(x, y) + HEAD_RADIUS_HALF;
 
-                hierarchy_y["head"].transform_local.rotation =
+                head.rotation =
                         rotation_transform::from_axis_angle({0, 0, 1}, 2 * position[0] - 6 * position[1] + position[2]);
-                hierarchy_y["head"].transform_local.translation = {x, y, z};
-                hierarchy_y["head"].transform_local.scaling = HEAD_SCALING_1;
+                head.translation = {x, y, z};
+                head.scaling = HEAD_SCALING_1;
                 break;
             }
         }
 
         snake_index++;
-
-        hierarchy_y.update_local_to_global_coordinates();
-        draw(hierarchy_y, scene.environment);
     }
 }
\ No newline at end of file
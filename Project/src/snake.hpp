@@ -4,20 +4,22 @@
 
 // Forward declaration of scene_structure to avoid circular dependencies
 struct scene_structure;
+struct simulation_state;
 
 // Explicitly using cgp namespace to avoid conflicts and improve clarity
 using cgp::hierarchy_mesh_drawable;
+using cgp::hierarchy_mesh_drawable_instances;
 using cgp::mesh_drawable;
 using cgp::vec3;
+using cgp::affine_rts;
 using cgp::opengl_shader_structure;
 using std::vector;
 using std::string;
 
 // Structure representing a collection of snakes in the scene
 struct snake_structure {
-    // Define constants for snake head radius and number of snakes
+    // Define constant for snake head radius
     static constexpr float HEAD_RADIUS = 0.2f;
-    static constexpr int N_SNAKE = 25;
 
     // Position vectors for snakes on different axes
     vector<vec3> snake_position_y;
@@ -38,6 +40,10 @@ struct snake_structure {
     mesh_drawable body_y;
     mesh_drawable head_y;
 
+    // All the snakes of a hierarchy are drawn as its instances (the transform of the head is the root of each instance)
+    hierarchy_mesh_drawable_instances instances_x;
+    hierarchy_mesh_drawable_instances instances_y;
+
     // Initializes the snakes in the given scene with the specified terrain length
     void initialize(scene_structure& scene, float terrain_length);
 
@@ -52,12 +58,19 @@ struct snake_structure {
     // Initializes snakes moving along the y-axis
     void initialize_snake_y(scene_structure& scene);
 
-    // Displays the snakes moving along the x-axis
-    void display_snake_x(scene_structure& scene, float terrain_length);
+    // Computes the head transforms of the snakes moving along the x-axis at time t
+    void simulate_snake_x(vector<affine_rts>& heads, float t, float terrain_length);
+
+    // Computes the head transforms of the snakes moving along the y-axis at time t
+    void simulate_snake_y(vector<affine_rts>& heads, float t, float terrain_length);
+
+    // Computes the transforms of all the snakes at time t (called by the simulation thread)
+    void simulate(simulation_state& state, float t, float terrain_length);
 
-    // Displays the snakes moving along the y-axis
-    void display_snake_y(scene_structure& scene, float terrain_length);
+    // Displays the snakes of a hierarchy at the given head transforms
+    void display_snakes(scene_structure& scene, hierarchy_mesh_drawable& hierarchy, hierarchy_mesh_drawable_instances& instances,
+                        const vector<affine_rts>& heads);
 
-    // Displays the snakes in the scene
-    void display(scene_structure& scene, float terrain_length);
+    // Displays the snakes in the scene, at their interpolated transforms
+    void display(scene_structure& scene);
 };
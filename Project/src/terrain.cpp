@@ -4,8 +4,59 @@ using namespace cgp;
 
 #include <vector>
 #include <cmath>
+#include <set>
 #include <cgp/cgp.hpp>
 
+namespace {
+    // Minimal distance between two positions: 6 units, reduced when the quantity could not fit on the terrain
+    //  (the random insertion stops progressing when quantity * distance^2 approaches 0.7 * terrain_length^2)
+    float spacing_distance(int quantity, float terrain_length) {
+        return std::min(6.0f, 0.75f * terrain_length / std::sqrt(float(std::max(quantity, 1))));
+    }
+
+    // Positions already placed, stored in square cells at least as large as the minimal distance:
+    //  a new position is only compared to the positions of the 3x3 neighboring cells.
+    struct spacing_grid {
+        float min_distance;
+        float origin;
+        float cell_size;
+        int N;
+        std::vector<std::vector<cgp::vec2>> cells;
+
+        spacing_grid(int quantity, float terrain_length, float min_distance)
+            : min_distance(min_distance), origin(-terrain_length / 2),
+              cell_size(std::max(min_distance, terrain_length / std::ceil(std::sqrt(float(std::max(quantity, 1)))))),
+              N(std::max(1, int(terrain_length / cell_size) + 1)), cells(size_t(N) * N) {}
+
+        int cell(float x) const {
+            return std::max(0, std::min(N - 1, int((x - origin) / cell_size)));
+        }
+
+        bool is_free(float x, float y) const {
+            const int kx = cell(x), ky = cell(y);
+            for (int i = std::max(0, kx - 1); i <= std::min(N - 1, kx + 1); ++i) {
+                for (int j = std::max(0, ky - 1); j <= std::min(N - 1, ky + 1); ++j) {
+                    for (const cgp::vec2 &p : cells[i + N * j]) {
+                        if ((p.x - x) * (p.x - x) + (p.y - y) * (p.y - y) < min_distance * min_distance)
+                            return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        void add(float x, float y) {
+            cells[cell(x) + N * cell(y)].push_back({x, y});
+        }
+    };
+
+    // True if no value is strictly closer than min_diff to v
+    bool is_free_on_axis(const std::set<float> &values, float v, float min_diff) {
+        auto it = values.upper_bound(v - min_diff);
+        return it == values.end() || *it >= v + min_diff;
+    }
+}
+
 
 std::vector<float> generate_float(int quantity, float max) {
     std::vector<float> floats;
@@ -29,35 +80,37 @@ std::vector<int> generate_int(int quantity, int min, int max) {
 }
 
 
-void generate_const_gaussian_function(float terrain_length) {
+void generate_const_gaussian_function(float terrain_length, int n_vertices) {
     constexpr float HEIGHT_MAX = 6.0f;
     constexpr int SIGMA_MIN = 4;
     constexpr int SIGMA_MAX = 10;
 
-    vertices_terrain_position = generate_positions_on_terrain_x_y(N_VERTICES_TERRAIN, terrain_length * 0.8f);
-    heights_terrain = generate_float(N_VERTICES_TERRAIN, HEIGHT_MAX);
-    sigmas_terrain = generate_int(N_VERTICES_TERRAIN, SIGMA_MIN, SIGMA_MAX);
+    vertices_terrain_position = generate_positions_on_terrain_x_y(n_vertices, terrain_length * 0.8f);
+    heights_terrain = generate_float(n_vertices, HEIGHT_MAX);
+    sigmas_terrain = generate_int(n_vertices, SIGMA_MIN, SIGMA_MAX);
 }
 
 
 float evaluate_terrain_height(float x, float y) {
     float z = 0.0f;
-    for (int i = 0; i < N_VERTICES_TERRAIN; ++i) {
+    const int N_VERTICES = int(vertices_terrain_position.size());
+    for (int i = 0; i < N_VERTICES; ++i) {
         float d_i = norm(cgp::vec2(x, y) - vertices_terrain_position[i]) / sigmas_terrain[i];
         z += heights_terrain[i] * std::exp(-d_i * d_i);
     }
     return z;
 }
 
-cgp::mesh create_terrain_mesh(int quantity, float terrain_length) {
-    generate_const_gaussian_function(terrain_length);
+cgp::mesh create_terrain_mesh(int quantity, float terrain_length, int n_vertices) {
+    generate_const_gaussian_function(terrain_length, n_vertices);
 
     cgp::mesh terrain;
     terrain.position.resize(quantity * quantity);
     terrain.uv.resize(quantity * quantity);
 
-    // Fill terrain geometry
-    for (int ku = 0; ku < quantity; ++ku) {
+    // Fill terrain geometry (each row is evaluated independently on the job system)
+    cgp::parallel_for(0, quantity, [&](size_t row) {
+        const int ku = int(row);
         for (int kv = 0; kv < quantity; ++kv) {
             // Compute local parametric coordinates (u, v) \in [0,1]
             float u = ku / (quantity - 1.0f);
@@ -74,7 +127,7 @@ cgp::mesh create_terrain_mesh(int quantity, float terrain_length) {
             terrain.position[kv + quantity * ku] = {x, y, z};
             terrain.uv[kv + quantity * ku] = {u * 50, v * 50};
         }
-    }
+    });
 
     // Generate triangle organization
     // Parametric surface with uniform grid sampling: generate 2 triangles for each grid cell
@@ -99,8 +152,11 @@ cgp::mesh create_terrain_mesh(int quantity, float terrain_length) {
 std::vector<cgp::vec3> generate_positions_on_terrain(int quantity, float terrain_length, bool is_flying, bool distance_check) {
     std::vector<cgp::vec3> positions;
     positions.reserve(quantity); // Reserve space to improve performance
-    constexpr float MIN_DISTANCE = 6.0f;
-    constexpr float MIN_DIFF = 0.2f;
+    const float MIN_DISTANCE = spacing_distance(quantity, terrain_length);
+    const float MIN_DIFF = std::min(0.2f, 0.6f * terrain_length / std::max(quantity, 1));
+
+    spacing_grid grid(quantity, terrain_length, MIN_DISTANCE);
+    std::set<float> x_values, y_values;
 
     while (positions.size() < quantity) {
         float x = rand_uniform(-terrain_length / 2 + 1, terrain_length / 2 - 1);
@@ -109,12 +165,11 @@ std::vector<cgp::vec3> generate_positions_on_terrain(int quantity, float terrain
 
         bool valid_position = true;
         if (distance_check) {
-            for (const auto& pos : positions) {
-                float distance = std::sqrt((pos.x - x) * (pos.x - x) + (pos.y - y) * (pos.y - y));
-                if (distance < MIN_DISTANCE || std::fabs(pos.x - x) < MIN_DIFF || std::fabs(pos.y - y) < MIN_DIFF) {
-                    valid_position = false;
-                    break;
-                }
+            valid_position = grid.is_free(x, y) && is_free_on_axis(x_values, x, MIN_DIFF) && is_free_on_axis(y_values, y, MIN_DIFF);
+            if (valid_position) {
+                grid.add(x, y);
+                x_values.insert(x);
+                y_values.insert(y);
             }
         }
 
@@ -133,22 +188,14 @@ std::vector<cgp::vec3> generate_positions_on_terrain(int quantity, float terrain
 std::vector<cgp::vec2> generate_positions_on_terrain_x_y(int quantity, float terrain_length) {
     std::vector<cgp::vec2> positions;
     positions.reserve(quantity); // Reserve space to improve performance
-    constexpr float MIN_DISTANCE = 6.0f;
+    spacing_grid grid(quantity, terrain_length, spacing_distance(quantity, terrain_length));
 
     while (positions.size() < quantity) {
         float x = rand_uniform(-terrain_length / 2 + 1, terrain_length / 2 - 1);
         float y = rand_uniform(-terrain_length / 2 + 1, terrain_length / 2 - 1);
 
-        bool valid_position = true;
-        for (const auto& pos : positions) {
-            float distance = std::sqrt((pos.x - x) * (pos.x - x) + (pos.y - y) * (pos.y - y));
-            if (distance < MIN_DISTANCE) {
-                valid_position = false;
-                break;
-            }
-        }
-
-        if (valid_position) {
+        if (grid.is_free(x, y)) {
+            grid.add(x, y);
             positions.push_back(cgp::vec2(x, y));
         }
     }
@@ -7,15 +7,16 @@
 static std::vector<cgp::vec2> vertices_terrain_position;
 static std::vector<float> heights_terrain;
 static std::vector<int> sigmas_terrain;
-static constexpr int N_VERTICES_TERRAIN = 200;
 
 // Evaluates the height of the terrain at the given (x, y) coordinates using Gaussian function.
 float evaluate_terrain_height(float x, float y);
 
-// Creates a mesh object representing the terrain.
-cgp::mesh create_terrain_mesh(int quantity, float length);
+// Creates a mesh object representing the terrain (made of n_vertices gaussian bumps).
+cgp::mesh create_terrain_mesh(int quantity, float length, int n_vertices);
 
 // Generates a vector of 3D positions (vec3)
+//  With distance_check, the positions are at least 6 units apart (and 0.2 on each axis). These spacings are reduced
+//  when the quantity could not fit on the terrain, so that any quantity can be generated.
 std::vector<cgp::vec3> generate_positions_on_terrain(int quantity, float terrain_length, bool is_flying, bool distance_check);
 
 // Generates a vector of 2D positions (vec2).
@@ -28,4 +29,4 @@ std::vector<float> generate_float(int quantity, float max);
 std::vector<int> generate_int(int quantity, int min, int max);
 
 // Generates the constants for Gaussian function.
-void generate_const_gaussian_function(float terrain_length);
+void generate_const_gaussian_function(float terrain_length, int n_vertices);
@@ -5,27 +5,36 @@
 #include "scene.hpp"
 
 void tree_manager::initialize(scene_structure &scene, const float TERRAIN_LENGTH) {
+    CGP_PROFILE_SCOPE("tree_manager::initialize");
     // Generate positions for trees
-    tree_position = generate_positions_on_terrain(N_TREE, TERRAIN_LENGTH, false, true);
+    tree_position = generate_positions_on_terrain(scene.config.n_tree, TERRAIN_LENGTH, false, true);
 
     // Initialize different types of trees
     pine_tree.initialize(scene);
     birch_tree.initialize(scene);
-}
 
-void tree_manager::display(scene_structure &scene) {
     // using tree_index to vary tree type, tree size and tree angle
-    int tree_index = 0;
-
     // A single variable tree_position is used for the positions of all tree types to avoid the problem of rendering
     // two different trees in approximately the same place.
-    for (const vec3 &position: tree_position) {
-        if (tree_index < N_TREE / 2) {
-            pine_tree.display(scene, tree_index, position);
+    vector<affine_rts> pine_transforms;
+    vector<affine_rts> birch_transforms;
+    for (int tree_index = 0; tree_index < int(tree_position.size()); ++tree_index) {
+        const vec3 &position = tree_position[tree_index];
+        if (tree_index < int(tree_position.size()) / 2) {
+            pine_transforms.push_back(pine_tree::tree_transform(tree_index, position));
         } else {
-            birch_tree.display(scene, tree_index, position);
+            birch_transforms.push_back(birch_tree::tree_transform(tree_index, position));
         }
-        tree_index++;
     }
+
+    // The trees do not move: their instances are computed once
+    pine_tree.place(pine_transforms);
+    birch_tree.place(birch_transforms);
 }
 
+void tree_manager::display(scene_structure &scene) {
+    CGP_PROFILE_SCOPE("tree_manager::display");
+    CGP_RENDER_STATS_SCOPE("tree_manager");
+    pine_tree.display(scene);
+    birch_tree.display(scene);
+}
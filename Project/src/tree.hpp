@@ -20,9 +20,6 @@ struct tree_manager {
     pine_tree pine_tree;
     birch_tree birch_tree;
 
-    // Number of trees to manage
-    static constexpr int N_TREE = 500;
-
     // Initializes the tree elements in the given scene with the specified terrain length
     void initialize(scene_structure& scene, float terrain_length);
 
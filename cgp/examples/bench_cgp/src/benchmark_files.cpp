@@ -0,0 +1,67 @@
+#include "benchmark_kernels.hpp"
+
+using namespace cgp;
+
+void benchmark_files(benchmark_runner& runner, bool quick, std::string const& directory)
+{
+	if (!create_directory(directory)) {
+		std::cerr << "Cannot create the directory " << directory << ": the loading of files is not measured" << std::endl;
+		return;
+	}
+
+	// OBJ files of spheres (size = number of vertices)
+	std::vector<int> const resolutions = quick ? std::vector<int>{ 32 } : std::vector<int>{ 32, 256 };
+	for (int resolution : resolutions) {
+		mesh sphere = mesh_primitive_sphere(1.0f, { 0,0,0 }, resolution, resolution / 2);
+		std::string const filename = directory + "sphere_" + str(resolution) + ".obj";
+		save_file_obj(filename, sphere);
+
+		runner.run("load obj (mesh_load_file_obj)", int(sphere.position.size()), [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				mesh const m = mesh_load_file_obj(filename);
+				do_not_optimize(m.position.size());
+			}
+		});
+	}
+
+	// PNG and JPEG images (size = number of pixels)
+	std::vector<int> const image_sizes = quick ? std::vector<int>{ 256 } : std::vector<int>{ 256, 1024 };
+	for (int S : image_sizes) {
+		numarray<unsigned char> data(4 * S * S);
+		for (int y = 0; y < S; ++y) {
+			for (int x = 0; x < S; ++x) {
+				// Smooth pattern with some noise: compresses like a texture, not like a flat color
+				float const value = 0.5f + 0.35f * noise_perlin(vec2(x, y) * (4.0f / S), 4) + 0.1f * rand_uniform();
+				unsigned char const c = (unsigned char)(std::min(std::max(255 * value, 0.0f), 255.0f));
+				int const offset = 4 * (x + S * y);
+				data[offset + 0] = c;
+				data[offset + 1] = (unsigned char)(x * 255 / S);
+				data[offset + 2] = (unsigned char)(y * 255 / S);
+				data[offset + 3] = 255;
+			}
+		}
+		image_structure const im_rgba = image_structure(S, S, image_color_type::rgba, data);
+		std::string const png_filename = directory + "image_" + str(S) + ".png";
+		image_save_png(png_filename, im_rgba);
+
+		numarray<unsigned char> data_rgb(3 * S * S);
+		for (int k = 0; k < S * S; ++k)
+			for (int c = 0; c < 3; ++c)
+				data_rgb[3 * k + c] = data[4 * k + c];
+		std::string const jpg_filename = directory + "image_" + str(S) + ".jpg";
+		image_save_jpg(jpg_filename, image_structure(S, S, image_color_type::rgb, data_rgb));
+
+		runner.run("load png (image_load_file)", S * S, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				image_structure const im = image_load_file(png_filename);
+				do_not_optimize(im.width);
+			}
+		});
+		runner.run("load jpg (image_load_file)", S * S, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				image_structure const im = image_load_file(jpg_filename);
+				do_not_optimize(im.width);
+			}
+		});
+	}
+}
@@ -0,0 +1,145 @@
+#include "benchmark_harness.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	double measure_seconds(std::function<void(long)> const& fn, long iterations)
+	{
+		auto const start = std::chrono::steady_clock::now();
+		fn(iterations);
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	std::string format(char const* pattern, double value)
+	{
+		char buffer[64];
+		std::snprintf(buffer, sizeof(buffer), pattern, value);
+		return buffer;
+	}
+
+	// Value following "key": in a line of the JSON file written by save_json
+	bool find_value(std::string const& line, std::string const& key, std::string& value)
+	{
+		size_t position = line.find("\"" + key + "\":");
+		if (position == std::string::npos)
+			return false;
+		position += key.size() + 3;
+		while (position < line.size() && line[position] == ' ')
+			position++;
+		if (position < line.size() && line[position] == '"') {
+			size_t const end = line.find('"', position + 1);
+			value = line.substr(position + 1, end - position - 1);
+		}
+		else {
+			size_t const end = line.find_first_of(",}", position);
+			value = line.substr(position, end - position);
+		}
+		return true;
+	}
+}
+
+bool benchmark_runner::is_selected(std::string const& name) const
+{
+	return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+void benchmark_runner::run(std::string const& name, int size, std::function<void(long)> const& fn)
+{
+	if (!is_selected(name))
+		return;
+
+	// Calibration: the number of iterations grows until a measure is long enough to be estimated
+	long iterations = 1;
+	double duration = measure_seconds(fn, iterations);
+	while (duration < min_time / 10 && iterations < (1L << 40)) {
+		iterations *= 10;
+		duration = measure_seconds(fn, iterations);
+	}
+	iterations = std::max(1L, long(double(iterations) * min_time / std::max(duration, 1e-9)));
+
+	std::vector<double> ns_per_op(std::max(1, repetitions));
+	for (double& t : ns_per_op)
+		t = 1e9 * measure_seconds(fn, iterations) / double(iterations);
+	std::sort(ns_per_op.begin(), ns_per_op.end());
+
+	benchmark_result result;
+	result.name = name;
+	result.size = size;
+	result.iterations = iterations;
+	result.ns_per_op = ns_per_op[ns_per_op.size() / 2];
+	result.ns_per_op_min = ns_per_op[0];
+	result.items_per_second = result.ns_per_op > 0 ? 1e9 * size / result.ns_per_op : 0;
+	results.push_back(result);
+
+	std::printf("%-42s %8d %14.1f ns/op %14.4g items/s\n", name.c_str(), size, result.ns_per_op, result.items_per_second);
+	std::fflush(stdout);
+}
+
+bool benchmark_runner::save_json(std::string const& filename) const
+{
+	std::ofstream stream(filename);
+	if (!stream)
+		return false;
+
+	// One benchmark per line (read back by compare())
+	stream << "{\n";
+#ifdef CGP_NO_DEBUG
+	stream << "  \"assertions\": false,\n";
+#else
+	stream << "  \"assertions\": true,\n";
+#endif
+	stream << "  \"benchmarks\": [\n";
+	for (size_t k = 0; k < results.size(); ++k) {
+		benchmark_result const& r = results[k];
+		stream << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"iterations\": " << r.iterations
+			<< ", \"ns_per_op\": " << format("%.3f", r.ns_per_op) << ", \"ns_per_op_min\": " << format("%.3f", r.ns_per_op_min)
+			<< ", \"items_per_second\": " << format("%.6g", r.items_per_second) << "}" << (k + 1 < results.size() ? "," : "") << "\n";
+	}
+	stream << "  ]\n}\n";
+	return bool(stream);
+}
+
+bool benchmark_runner::save_csv(std::string const& filename) const
+{
+	std::ofstream stream(filename);
+	if (!stream)
+		return false;
+	stream << "name,size,iterations,ns_per_op,ns_per_op_min,items_per_second\n";
+	for (benchmark_result const& r : results)
+		stream << "\"" << r.name << "\"," << r.size << "," << r.iterations << "," << format("%.3f", r.ns_per_op) << ","
+			<< format("%.3f", r.ns_per_op_min) << "," << format("%.6g", r.items_per_second) << "\n";
+	return bool(stream);
+}
+
+int benchmark_runner::compare(std::string const& baseline_filename, double tolerance) const
+{
+	std::ifstream stream(baseline_filename);
+	if (!stream)
+		return -1;
+
+	int slower = 0;
+	std::string line;
+	while (std::getline(stream, line)) {
+		std::string name, size, ns;
+		if (!find_value(line, "name", name) || !find_value(line, "size", size) || !find_value(line, "ns_per_op", ns))
+			continue;
+		double const reference = std::atof(ns.c_str());
+		for (benchmark_result const& r : results) {
+			if (r.name != name || r.size != std::atoi(size.c_str()) || reference <= 0)
+				continue;
+			double const change = r.ns_per_op / reference - 1.0;
+			if (change > tolerance) {
+				std::printf("Slower: %s (size %d) %.1f ns/op, baseline %.1f ns/op (+%.1f%%)\n", r.name.c_str(), r.size, r.ns_per_op, reference, 100 * change);
+				slower++;
+			}
+		}
+	}
+	return slower;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Minimal harness measuring the time per operation of a kernel
+//  - The kernel is given as a function running a number of operations: the harness first calibrates this number
+//    such that a measure lasts at least min_time, then repeats the measure and keeps the median (and the minimum).
+//  - Each measure is reported in ns per operation, and as a throughput in elements per second, where size is the
+//    number of elements processed by one operation (ex. number of vertices of the mesh).
+//  - The results can be saved in JSON or CSV, and compared with the JSON of a previous run.
+//
+//  Usage:
+//  | benchmark_runner runner;
+//  | runner.run("inverse(mat4)", N, [&](long iterations) {
+//  |     for (long it = 0; it < iterations; ++it)
+//  |         for (int k = 0; k < N; ++k)
+//  |             do_not_optimize(inverse(M[k]));
+//  | });
+//  | runner.save_json("bench.json");
+
+// Prevent the compiler from removing a computation whose result is not used
+template <typename T>
+inline void do_not_optimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	char const volatile* p = reinterpret_cast<char const volatile*>(&value);
+	(void)*p;
+#endif
+}
+
+struct benchmark_result
+{
+	std::string name;
+	int size = 0;              // number of elements processed by one operation
+	long iterations = 0;       // number of operations of each measure
+	double ns_per_op = 0;      // median over the repetitions
+	double ns_per_op_min = 0;  // best repetition
+	double items_per_second = 0; // size / ns_per_op
+};
+
+struct benchmark_runner
+{
+	// Minimal duration of a measure (in seconds)
+	double min_time = 0.1;
+	// Number of measures for each kernel and size
+	int repetitions = 5;
+	// Only the kernels containing this string are measured (empty: all the kernels)
+	std::string filter;
+
+	std::vector<benchmark_result> results;
+
+	bool is_selected(std::string const& name) const;
+
+	// Measure the kernel, where fn(iterations) runs iterations operations on a problem of the given size
+	void run(std::string const& name, int size, std::function<void(long)> const& fn);
+
+	// Save all the results. Return false if the file cannot be written.
+	bool save_json(std::string const& filename) const;
+	bool save_csv(std::string const& filename) const;
+
+	// Compare with the JSON file of a previous run. The kernels slower than the baseline by more than the tolerance
+	//  (relative) are listed, and the number of slower kernels is returned (-1 if the file cannot be read).
+	int compare(std::string const& baseline_filename, double tolerance) const;
+};
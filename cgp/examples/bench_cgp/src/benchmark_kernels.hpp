@@ -0,0 +1,22 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+#include "benchmark_harness.hpp"
+
+#include <string>
+#include <vector>
+
+// Sets of kernels measured by bench_cgp
+//  Each function runs its kernels for several problem sizes (the larger sizes are skipped when quick is true).
+
+// mat4 product and inverse, affine_rts composition, rotation from axis/angle, batch transforms, numarray expressions, Perlin noise, grid_3D stencil and ray-march per layout
+void benchmark_math(benchmark_runner& runner, bool quick);
+// normal_per_vertex, mesh::push_back, mesh::apply_transform
+void benchmark_mesh(benchmark_runner& runner, bool quick);
+// marching_cube, intersection_ray_spheres_closest
+void benchmark_shape(benchmark_runner& runner, bool quick);
+// Loading of OBJ, PNG and JPEG files (the files are generated in the directory)
+void benchmark_files(benchmark_runner& runner, bool quick, std::string const& directory);
+
+// Random transform (rotation around a random axis, translation in [-1,1]^3, scaling in [0.5,2])
+cgp::affine_rts benchmark_random_transform();
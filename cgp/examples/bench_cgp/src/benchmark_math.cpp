@@ -0,0 +1,232 @@
+#include "benchmark_kernels.hpp"
+
+using namespace cgp;
+
+affine_rts benchmark_random_transform()
+{
+	vec3 const axis = normalize(vec3(rand_uniform(-1, 1), rand_uniform(-1, 1), rand_uniform(-1, 1)) + vec3(0, 0, 1e-3f));
+	vec3 const translation = { rand_uniform(-1, 1), rand_uniform(-1, 1), rand_uniform(-1, 1) };
+	return affine_rts(rotation_transform::from_axis_angle(axis, rand_uniform(0, 2 * Pi)), translation, rand_uniform(0.5f, 2.0f));
+}
+
+// 7-point Laplacian of the interior of a grid (the output has the same layout)
+//  The neighbors are found from the offset of the element and the strides of the layout (at k and k-1 for the previous neighbors).
+template <typename Layout>
+static void benchmark_laplacian(grid_3D<float, Layout> const& f, grid_3D<float, Layout>& r)
+{
+	int const N1 = f.dimension.x, N2 = f.dimension.y, N3 = f.dimension.z;
+	for (int k3 = 1; k3 < N3 - 1; ++k3) {
+		for (int k2 = 1; k2 < N2 - 1; ++k2) {
+			for (int k1 = 1; k1 < N1 - 1; ++k1) {
+				int const offset = f.index_to_offset(k1, k2, k3);
+				int3 const next = f.index_to_stride(k1, k2, k3);
+				int3 const previous = f.index_to_stride(k1 - 1, k2 - 1, k3 - 1);
+				r.at_unsafe(offset) = f.at_unsafe(offset - previous.x) + f.at_unsafe(offset + next.x) + f.at_unsafe(offset - previous.y) + f.at_unsafe(offset + next.y)
+					+ f.at_unsafe(offset - previous.z) + f.at_unsafe(offset + next.z) - 6 * f.at_unsafe(offset);
+			}
+		}
+	}
+}
+
+// Sum of the trilinear samples along rays that cross the grid mostly along k3 (ex. density integrated toward a light above a volume)
+//  Each sample gathers 8 elements in 2 slabs of the grid: N1*N2 elements apart with the linear layout, in the same brick most of the time with the tiled one.
+template <typename Layout>
+static float benchmark_ray_march(grid_3D<float, Layout> const& f, std::vector<vec3> const& origins, vec3 const& step)
+{
+	float const x_max = f.dimension.x - 1.0f, y_max = f.dimension.y - 1.0f, z_max = f.dimension.z - 1.0f;
+	float sum = 0.0f;
+	for (vec3 p : origins) {
+		while (p.x >= 0 && p.y >= 0 && p.z >= 0 && p.x < x_max && p.y < y_max && p.z < z_max) {
+			int const k1 = int(p.x), k2 = int(p.y), k3 = int(p.z);
+			float const u = p.x - k1, v = p.y - k2, w = p.z - k3;
+			int const o = f.index_to_offset(k1, k2, k3);
+			int3 const s = f.index_to_stride(k1, k2, k3);
+			float const c00 = (1 - u) * f.at_unsafe(o) + u * f.at_unsafe(o + s.x);
+			float const c10 = (1 - u) * f.at_unsafe(o + s.y) + u * f.at_unsafe(o + s.x + s.y);
+			float const c01 = (1 - u) * f.at_unsafe(o + s.z) + u * f.at_unsafe(o + s.x + s.z);
+			float const c11 = (1 - u) * f.at_unsafe(o + s.y + s.z) + u * f.at_unsafe(o + s.x + s.y + s.z);
+			sum += (1 - w) * ((1 - v) * c00 + v * c10) + w * ((1 - v) * c01 + v * c11);
+			p += step;
+		}
+	}
+	return sum;
+}
+
+void benchmark_math(benchmark_runner& runner, bool quick)
+{
+	std::vector<int> const sizes = quick ? std::vector<int>{ 64, 4096 } : std::vector<int>{ 64, 4096, 262144 };
+
+	for (int N : sizes) {
+		std::vector<mat4> A(N), B(N), C(N);
+		std::vector<affine_rts> TA(N), TB(N), TC(N);
+		std::vector<vec3> axis(N);
+		std::vector<float> angle(N);
+		for (int k = 0; k < N; ++k) {
+			TA[k] = benchmark_random_transform();
+			TB[k] = benchmark_random_transform();
+			A[k] = TA[k].matrix();
+			B[k] = TB[k].matrix();
+			axis[k] = normalize(vec3(rand_uniform(-1, 1), rand_uniform(-1, 1), 1.0f));
+			angle[k] = rand_uniform(0, 2 * Pi);
+		}
+
+		runner.run("mat4 * mat4", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				for (int k = 0; k < N; ++k)
+					C[k] = A[k] * B[k];
+				do_not_optimize(C[0]);
+			}
+		});
+		runner.run("inverse(mat4)", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				for (int k = 0; k < N; ++k)
+					C[k] = inverse(A[k]);
+				do_not_optimize(C[0]);
+			}
+		});
+		runner.run("affine_rts * affine_rts", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				for (int k = 0; k < N; ++k)
+					TC[k] = TA[k] * TB[k];
+				do_not_optimize(TC[0]);
+			}
+		});
+		runner.run("affine_rts::matrix", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				for (int k = 0; k < N; ++k)
+					C[k] = TA[k].matrix();
+				do_not_optimize(C[0]);
+			}
+		});
+		runner.run("rotation_transform::from_axis_angle", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				for (int k = 0; k < N; ++k)
+					TC[k].rotation = rotation_transform::from_axis_angle(axis[k], angle[k]);
+				do_not_optimize(TC[0]);
+			}
+		});
+
+		// Batch transforms on structure of arrays, compared with the loops on the elements
+		numarray<vec3> points(N);
+		for (int k = 0; k < N; ++k)
+			points[k] = TB[k].translation;
+		soa_vec3 const points_soa = to_soa(points);
+		soa_vec3 points_out;
+		numarray<vec3> points_aos_out(N);
+		soa_affine_rts const local = to_soa(numarray<affine_rts>(TB));
+		soa_affine_rts world;
+		numarray<mat4> matrices;
+		affine_rts const parent = TA[0];
+
+		runner.run("affine_rts * vec3", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				for (int k = 0; k < N; ++k)
+					points_aos_out[k] = parent * points[k];
+				do_not_optimize(points_aos_out[0]);
+			}
+		});
+		runner.run("batch_transform_points(soa_vec3)", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				batch_transform_points(parent, points_soa, points_out);
+				do_not_optimize(points_out.x[0]);
+			}
+		});
+		runner.run("batch_compose(affine_rts, soa_affine_rts)", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				batch_compose(parent, local, world);
+				do_not_optimize(world.qx[0]);
+			}
+		});
+		runner.run("batch_matrix(affine_rts, soa_affine_rts)", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				batch_matrix(parent, local, matrices);
+				do_not_optimize(matrices[0]);
+			}
+		});
+
+		// Element-wise expression on numarray: one temporary per operator, compared with a single lazy loop
+		numarray<float> u(N), v(N), w(N), r(N);
+		for (int k = 0; k < N; ++k) {
+			u[k] = rand_uniform(-1, 1);
+			v[k] = rand_uniform(-1, 1);
+			w[k] = rand_uniform(0.5f, 2.0f);
+		}
+		runner.run("numarray a*s+b/c (operators)", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				r = u * 0.5f + v / w;
+				do_not_optimize(r[0]);
+			}
+		});
+		runner.run("numarray a*s+b/c (lazy)", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				r = lazy(u) * 0.5f + lazy(v) / w;
+				do_not_optimize(r[0]);
+			}
+		});
+	}
+
+	// Perlin noise: one operation evaluates the noise on N points (default parameters: 5 octaves)
+	std::vector<int> const sizes_noise = quick ? std::vector<int>{ 1024 } : std::vector<int>{ 1024, 65536 };
+	for (int N : sizes_noise) {
+		std::vector<vec3> p(N);
+		for (int k = 0; k < N; ++k)
+			p[k] = { rand_uniform(-10, 10), rand_uniform(-10, 10), rand_uniform(-10, 10) };
+
+		runner.run("noise_perlin(vec2)", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				float sum = 0;
+				for (int k = 0; k < N; ++k)
+					sum += noise_perlin(vec2(p[k].x, p[k].y));
+				do_not_optimize(sum);
+			}
+		});
+		runner.run("noise_perlin(vec3)", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				float sum = 0;
+				for (int k = 0; k < N; ++k)
+					sum += noise_perlin(p[k]);
+				do_not_optimize(sum);
+			}
+		});
+	}
+
+	// Stencil and ray-march on a 3D grid stored linearly, or by bricks of 8^3 elements
+	//  The stencil sweeps the grid in storage order, where the incremental linear offsets win over the bricks.
+	//  The ray-march gathers across the slabs of the grid (one operation = one ray of 2n samples), where the bricks win once the grid exceeds the caches.
+	std::vector<int> const sizes_grid = quick ? std::vector<int>{ 64 } : std::vector<int>{ 64, 256 };
+	for (int n : sizes_grid) {
+		grid_3D<float> f(n), r(n);
+		for (float& v : f)
+			v = rand_uniform(-1, 1);
+		grid_3D<float, grid_layout_tiled<8> > const f_tiled(f);
+		grid_3D<float, grid_layout_tiled<8> > r_tiled(f_tiled);
+
+		runner.run("grid_3D laplacian (linear)", n * n * n, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				benchmark_laplacian(f, r);
+				do_not_optimize(r.data[n * n + n + 1]);
+			}
+		});
+		runner.run("grid_3D laplacian (tiled<8>)", n * n * n, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				benchmark_laplacian(f_tiled, r_tiled);
+				do_not_optimize(r_tiled.data[1]);
+			}
+		});
+
+		int const rays = 4096;
+		std::vector<vec3> origins(rays);
+		for (vec3& p : origins)
+			p = { rand_uniform(0.05f, 0.95f) * n, rand_uniform(0.05f, 0.95f) * n, 0.5f };
+		vec3 const step = 0.5f * normalize(vec3(0.1f, 0.1f, 1.0f));
+
+		runner.run("grid_3D ray-march along k3 (linear)", rays, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it)
+				do_not_optimize(benchmark_ray_march(f, origins, step));
+		});
+		runner.run("grid_3D ray-march along k3 (tiled<8>)", rays, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it)
+				do_not_optimize(benchmark_ray_march(f_tiled, origins, step));
+		});
+	}
+}
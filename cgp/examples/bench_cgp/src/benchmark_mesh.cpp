@@ -0,0 +1,42 @@
+#include "benchmark_kernels.hpp"
+
+using namespace cgp;
+
+void benchmark_mesh(benchmark_runner& runner, bool quick)
+{
+	// Spheres of increasing resolution (size = number of vertices)
+	std::vector<int> const resolutions = quick ? std::vector<int>{ 32, 128 } : std::vector<int>{ 32, 128, 512 };
+
+	for (int resolution : resolutions) {
+		mesh const sphere = mesh_primitive_sphere(1.0f, { 0,0,0 }, resolution, resolution / 2);
+		int const N = int(sphere.position.size());
+
+		numarray<vec3> normals;
+		runner.run("normal_per_vertex", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				normal_per_vertex(sphere.position, sphere.connectivity, normals);
+				do_not_optimize(normals[0]);
+			}
+		});
+
+		// Concatenation of the sphere to a mesh that already contains it
+		mesh merged;
+		runner.run("mesh::push_back", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				merged = sphere;
+				merged.push_back(sphere);
+				do_not_optimize(merged.position[0]);
+			}
+		});
+
+		// A rigid transform with a unit scaling keeps the coordinates bounded over the iterations
+		mesh transformed = sphere;
+		affine_rts const T = affine_rts(rotation_transform::from_axis_angle({ 0,0,1 }, 0.1f), { 0,0,0 }, 1.0f);
+		runner.run("mesh::apply_transform(affine_rts)", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				transformed.apply_transform(T);
+				do_not_optimize(transformed.position[0]);
+			}
+		});
+	}
+}
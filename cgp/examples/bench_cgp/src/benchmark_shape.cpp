@@ -0,0 +1,66 @@
+#include "benchmark_kernels.hpp"
+
+using namespace cgp;
+
+void benchmark_shape(benchmark_runner& runner, bool quick)
+{
+	// Marching cubes on a noisy sphere (size = number of voxels)
+	std::vector<int> const resolutions = quick ? std::vector<int>{ 16, 32 } : std::vector<int>{ 16, 32, 64, 128 };
+	for (int R : resolutions) {
+		spatial_domain_grid_3D const domain = spatial_domain_grid_3D::from_center_length({ 0,0,0 }, { 2,2,2 }, { R,R,R });
+		grid_3D<float> field(R, R, R);
+		for (int kz = 0; kz < R; ++kz)
+			for (int ky = 0; ky < R; ++ky)
+				for (int kx = 0; kx < R; ++kx) {
+					vec3 const p = domain.position({ kx,ky,kz });
+					field(kx, ky, kz) = norm(p) + 0.2f * noise_perlin(2.0f * p, 3);
+				}
+
+		runner.run("marching_cube", R * R * R, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				mesh const m = marching_cube(field, domain, 0.7f);
+				do_not_optimize(m.position.size());
+			}
+		});
+	}
+
+	// Marching cubes on a large grid (sphere, the field is cheap to build)
+	if (!quick) {
+		int const R = 512;
+		spatial_domain_grid_3D const domain = spatial_domain_grid_3D::from_center_length({ 0,0,0 }, { 2,2,2 }, { R,R,R });
+		grid_3D<float> field(R, R, R);
+		for (int kz = 0; kz < R; ++kz)
+			for (int ky = 0; ky < R; ++ky)
+				for (int kx = 0; kx < R; ++kx)
+					field.at_unsafe(kx, ky, kz) = norm(domain.position({ kx,ky,kz }));
+
+		runner.run("marching_cube (sphere)", R * R * R, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				mesh const m = marching_cube(field, domain, 0.7f);
+				do_not_optimize(m.position.size());
+			}
+		});
+	}
+
+	// Closest intersection of a ray with a set of spheres (size = number of spheres)
+	std::vector<int> const sizes = quick ? std::vector<int>{ 16, 1024 } : std::vector<int>{ 16, 1024, 65536 };
+	for (int N : sizes) {
+		numarray<vec3> centers(N);
+		for (int k = 0; k < N; ++k)
+			centers[k] = { rand_uniform(-10, 10), rand_uniform(-10, 10), rand_uniform(-10, 10) };
+
+		int const number_of_rays = 64;
+		std::vector<vec3> directions(number_of_rays);
+		for (int k = 0; k < number_of_rays; ++k)
+			directions[k] = normalize(vec3(rand_uniform(-1, 1), rand_uniform(-1, 1), rand_uniform(-1, 1)) + vec3(1e-3f, 0, 0));
+
+		int ray = 0;
+		runner.run("intersection_ray_spheres_closest", N, [&](long iterations) {
+			for (long it = 0; it < iterations; ++it) {
+				intersection_structure const intersection = intersection_ray_spheres_closest({ 0,0,-20 }, directions[ray], centers, 0.5f);
+				ray = (ray + 1) % number_of_rays;
+				do_not_optimize(intersection);
+			}
+		});
+	}
+}
@@ -0,0 +1,79 @@
+#include "cgp/cgp.hpp"
+#include "benchmark_kernels.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <string>
+
+using namespace cgp;
+
+// Microbenchmarks of the kernels of the cgp library
+//  ./bench_cgp [--quick] [--filter name] [--min-time seconds] [--repetitions N]
+//              [--output results.json] [--csv results.csv] [--baseline previous.json] [--tolerance 0.1]
+//  The return value is 1 if a kernel is slower than the baseline (beyond the relative tolerance).
+int main(int argc, char* argv[])
+{
+	std::cout << "Run " << argv[0] << std::endl;
+
+	benchmark_runner runner;
+	bool quick = false;
+	std::string output = "bench_cgp.json";
+	std::string output_csv;
+	std::string baseline;
+	double tolerance = 0.1;
+
+	for (int k = 1; k < argc; ++k) {
+		std::string const argument = argv[k];
+		bool const has_value = k + 1 < argc;
+		if (argument == "--quick")
+			quick = true;
+		else if (argument == "--filter" && has_value)
+			runner.filter = argv[++k];
+		else if (argument == "--min-time" && has_value)
+			runner.min_time = std::atof(argv[++k]);
+		else if (argument == "--repetitions" && has_value)
+			runner.repetitions = std::atoi(argv[++k]);
+		else if (argument == "--output" && has_value)
+			output = argv[++k];
+		else if (argument == "--csv" && has_value)
+			output_csv = argv[++k];
+		else if (argument == "--baseline" && has_value)
+			baseline = argv[++k];
+		else if (argument == "--tolerance" && has_value)
+			tolerance = std::atof(argv[++k]);
+		else {
+			std::cerr << "Unknown argument " << argument << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	if (quick)
+		runner.min_time = std::min(runner.min_time, 0.02);
+
+#ifndef CGP_NO_DEBUG
+	std::cout << "Warning: the assertions of cgp are active (define CGP_NO_DEBUG to measure the kernels without the checks)" << std::endl;
+#endif
+
+	benchmark_math(runner, quick);
+	benchmark_mesh(runner, quick);
+	benchmark_shape(runner, quick);
+	benchmark_files(runner, quick, "bench_cgp_files/");
+
+	if (!output.empty() && !runner.save_json(output))
+		std::cerr << "Cannot write " << output << std::endl;
+	if (!output_csv.empty() && !runner.save_csv(output_csv))
+		std::cerr << "Cannot write " << output_csv << std::endl;
+
+	if (!baseline.empty()) {
+		int const slower = runner.compare(baseline, tolerance);
+		if (slower < 0) {
+			std::cerr << "Cannot read the baseline " << baseline << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::cout << slower << " kernel(s) slower than the baseline" << std::endl;
+		if (slower > 0)
+			return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
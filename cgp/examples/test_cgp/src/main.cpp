@@ -6,13 +6,23 @@
 #include <iostream> 
 
 #include "cgp/09_geometric_transformation/rotation_transform/test/test_rotation.hpp"
+#include "cgp/09_geometric_transformation/affine/affine_rts/test/test_affine_rts.hpp"
+#include "cgp/09_geometric_transformation/batch_transform/test/test_batch_transform.hpp"
+#include "cgp/16_drawable/hierarchy_mesh_drawable/test/test_hierarchy_mesh_drawable.hpp"
 #include "cgp/04_grid_container/grid_stack/grid_stack_2D/test/test_grid_stack_2D.hpp"
 #include "cgp/04_grid_container/grid/test/test_grid.hpp"
 #include "cgp/02_numarray/numarray/test/test_numarray.hpp"
+#include "cgp/02_numarray/numarray_expression/test/test_numarray_expression.hpp"
+#include "cgp/02_numarray/numarray_allocator/test/test_numarray_allocator.hpp"
 #include "cgp/02_numarray/numarray_stack/test/test_numarray_stack.hpp"
 #include "cgp/19_camera_controller/test/test_camera_controller.hpp"
 #include "cgp/06_mat/test/test_matrix_stack.hpp"
 #include "cgp/06_mat/functions/test/test_vec_mat.hpp"
+#include "cgp/13_opengl/render_stats/test/test_render_stats.hpp"
+#include "cgp/13_opengl/frame_capture/test/test_frame_capture.hpp"
+#include "cgp/22_jobs/test/test_jobs.hpp"
+#include "cgp/23_profiler/profiler/test/test_profiler.hpp"
+#include "cgp/12_shape/implicit/marching_cube/test/test_marching_cube.hpp"
 
 
 using namespace cgp;
@@ -22,14 +32,24 @@ int main(int, char* argv[])
 	std::cout << "Run " << argv[0] << std::endl;
 
 	cgp_test::test_rotation();
+	cgp_test::test_affine_rts();
+	cgp_test::test_batch_transform();
+	cgp_test::test_hierarchy_mesh_drawable();
 	cgp_test::test_grid_stack_2D();
 	cgp_test::test_grid_2D();
 	cgp_test::test_grid_3D();
 	cgp_test::test_numarray();
+	cgp_test::test_numarray_expression();
+	cgp_test::test_numarray_allocator();
 	cgp_test::test_numarray_stack();
 	cgp_test::test_camera_controller();
 	cgp_test::test_matrix_stack();
 	cgp_test::test_vec_mat();
+	cgp_test::test_render_stats();
+	cgp_test::test_frame_capture();
+	cgp_test::test_jobs();
+	cgp_test::test_profiler();
+	cgp_test::test_marching_cube();
 
 
 	return 0;
@@ -0,0 +1,33 @@
+#include "hash.hpp"
+
+namespace cgp
+{
+	uint64_t hash_fnv1a(void const* data, size_t size, uint64_t seed)
+	{
+		uint64_t const prime = 1099511628211ull;
+		unsigned char const* bytes = static_cast<unsigned char const*>(data);
+
+		uint64_t h = seed;
+		for (size_t k = 0; k < size; ++k) {
+			h ^= bytes[k];
+			h *= prime;
+		}
+		return h;
+	}
+
+	uint64_t hash_fnv1a(std::string const& text, uint64_t seed)
+	{
+		return hash_fnv1a(text.data(), text.size(), seed);
+	}
+
+	std::string str_hex(uint64_t value)
+	{
+		char const digits[] = "0123456789abcdef";
+		std::string s(16, '0');
+		for (int k = 15; k >= 0; --k) {
+			s[k] = digits[value & 0xF];
+			value >>= 4;
+		}
+		return s;
+	}
+}
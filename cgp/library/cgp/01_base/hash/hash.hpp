@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Non-cryptographic hash functions used to identify cached data (shader binaries, converted assets, etc.)
+
+namespace cgp
+{
+	// Default seed (offset basis) of the 64-bit FNV-1a hash
+	constexpr uint64_t hash_fnv1a_seed = 14695981039346656037ull;
+
+	// 64-bit FNV-1a hash of a raw buffer
+	//  The seed allows to chain several buffers: hash_fnv1a(b, sb, hash_fnv1a(a, sa))
+	uint64_t hash_fnv1a(void const* data, size_t size, uint64_t seed = hash_fnv1a_seed);
+	uint64_t hash_fnv1a(std::string const& text, uint64_t seed = hash_fnv1a_seed);
+
+	// Fixed size (16 characters) hexadecimal representation of a hash value
+	std::string str_hex(uint64_t value);
+}
@@ -0,0 +1,25 @@
+#include "parallel.hpp"
+
+#include <atomic>
+
+namespace cgp
+{
+	static std::atomic<parallel_chunks_scheduler> installed_scheduler(nullptr);
+
+	parallel_chunks_scheduler set_parallel_chunks_scheduler(parallel_chunks_scheduler scheduler)
+	{
+		return installed_scheduler.exchange(scheduler);
+	}
+
+	void parallel_chunks(size_t begin, size_t end, std::function<void(size_t, size_t)> const& function, size_t grain_size)
+	{
+		if (end <= begin)
+			return;
+
+		parallel_chunks_scheduler const scheduler = installed_scheduler.load();
+		if (scheduler != nullptr)
+			scheduler(begin, end, function, grain_size);
+		else
+			function(begin, end);
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Parallel loops of the low-level modules (numarray expressions, batch transforms, marching cubes)
+//  The modules below 22_jobs cannot depend on the job system: they call parallel_chunks(), which runs the loop on the installed scheduler.
+//  22_jobs installs the work-stealing job system (parallel_for_range on default_job_system()) at static initialization.
+//  Without a scheduler (ex. a program built without 22_jobs) the loop is sequential.
+//
+//  Usage:
+//  | parallel_chunks(0, N, [&](size_t k0, size_t k1) { for (size_t k = k0; k < k1; ++k) ... }, 1024);
+
+namespace cgp
+{
+	// Scheduler calling function(chunk_begin, chunk_end) on chunks covering [begin, end[, and returning when all the chunks are processed
+	//  grain_size is the maximal number of indices of a chunk (0: chosen by the scheduler)
+	using parallel_chunks_scheduler = void (*)(size_t begin, size_t end, std::function<void(size_t, size_t)> const& function, size_t grain_size);
+
+	// Install the scheduler of the parallel loops (nullptr: sequential loops) and return the previous one
+	parallel_chunks_scheduler set_parallel_chunks_scheduler(parallel_chunks_scheduler scheduler);
+
+	// Call function(chunk_begin, chunk_end) on chunks covering [begin, end[, in parallel if a scheduler is installed
+	void parallel_chunks(size_t begin, size_t end, std::function<void(size_t, size_t)> const& function, size_t grain_size = 0);
+
+	// Call function(k) for each k in [begin, end[ (same splitting as parallel_chunks)
+	template <typename F>
+	void parallel_indices(size_t begin, size_t end, F const& function, size_t grain_size = 0)
+	{
+		parallel_chunks(begin, end, [&function](size_t chunk_begin, size_t chunk_end) {
+			for (size_t k = chunk_begin; k < chunk_end; ++k)
+				function(k);
+		}, grain_size);
+	}
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+// Minimal abstraction on registers of 4 floats, used by the hot matrix and transform kernels (mat4, affine_rts)
+//  The implementation is selected at compile time:
+//   - CGP_SIMD_SSE  : x86/x64 with SSE2 (always available on x64). When AVX is enabled (ex. -mavx), the compiler emits the VEX encoding of the same instructions.
+//   - CGP_SIMD_NEON : ARM with NEON (ex. aarch64, Apple silicon)
+//  CGP_SIMD is defined if one of them is available. Otherwise, or if CGP_NO_SIMD is defined, the callers use their generic scalar code.
+//
+//  The loads and stores are unaligned: the cgp types (vec4, mat4, etc.) keep their natural alignment of float.
+//
+//  Usage:
+//  | #ifdef CGP_SIMD
+//  | simd::float4 const a = simd::load(M.begin());
+//  | simd::store(M.begin(), simd::mul(a, simd::broadcast(2.0f)));
+//  | #else
+//  | // scalar version
+//  | #endif
+
+#if !defined(CGP_NO_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define CGP_SIMD_SSE
+		#include <emmintrin.h>
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#define CGP_SIMD_NEON
+		#include <arm_neon.h>
+	#endif
+#endif
+
+#if defined(CGP_SIMD_SSE) || defined(CGP_SIMD_NEON)
+#define CGP_SIMD
+
+namespace cgp { namespace simd {
+
+#ifdef CGP_SIMD_SSE
+
+	using float4 = __m128;
+
+	inline float4 load(float const* p) { return _mm_loadu_ps(p); }
+	inline void store(float* p, float4 a) { _mm_storeu_ps(p, a); }
+	inline float4 set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+	inline float4 broadcast(float x) { return _mm_set1_ps(x); }
+
+	inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+	inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+	inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+	inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+
+	inline float first(float4 a) { return _mm_cvtss_f32(a); }
+
+	// (a[i0], a[i1], b[i2], b[i3])
+	template <int i0, int i1, int i2, int i3>
+	inline float4 shuffle(float4 a, float4 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(i3, i2, i1, i0)); }
+
+#else // CGP_SIMD_NEON
+
+	using float4 = float32x4_t;
+
+	inline float4 load(float const* p) { return vld1q_f32(p); }
+	inline void store(float* p, float4 a) { vst1q_f32(p, a); }
+	inline float4 set(float x, float y, float z, float w) { float const v[4] = { x, y, z, w }; return vld1q_f32(v); }
+	inline float4 broadcast(float x) { return vdupq_n_f32(x); }
+
+	inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+	inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+	inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+	inline float4 div(float4 a, float4 b) {
+		float va[4], vb[4];
+		vst1q_f32(va, a); vst1q_f32(vb, b);
+		return set(va[0] / vb[0], va[1] / vb[1], va[2] / vb[2], va[3] / vb[3]);
+	}
+
+	inline float first(float4 a) { return vgetq_lane_f32(a, 0); }
+
+	// (a[i0], a[i1], b[i2], b[i3])
+	template <int i0, int i1, int i2, int i3>
+	inline float4 shuffle(float4 a, float4 b) {
+		float4 r = vdupq_n_f32(vgetq_lane_f32(a, i0));
+		r = vsetq_lane_f32(vgetq_lane_f32(a, i1), r, 1);
+		r = vsetq_lane_f32(vgetq_lane_f32(b, i2), r, 2);
+		return vsetq_lane_f32(vgetq_lane_f32(b, i3), r, 3);
+	}
+
+#endif
+
+	// (a[i0], a[i1], a[i2], a[i3])
+	template <int i0, int i1, int i2, int i3>
+	inline float4 swizzle(float4 a) { return shuffle<i0, i1, i2, i3>(a, a); }
+
+	// (a[i], a[i], a[i], a[i])
+	template <int i>
+	inline float4 splat(float4 a) { return shuffle<i, i, i, i>(a, a); }
+
+	// Sum of the 4 components, in all the components
+	inline float4 horizontal_sum(float4 a) {
+		float4 const s = add(a, swizzle<1, 0, 3, 2>(a));
+		return add(s, swizzle<2, 3, 0, 1>(s));
+	}
+
+	// Transpose the 4x4 matrix whose rows are a, b, c, d
+	inline void transpose(float4& a, float4& b, float4& c, float4& d) {
+		float4 const t0 = shuffle<0, 1, 0, 1>(a, b);
+		float4 const t1 = shuffle<2, 3, 2, 3>(a, b);
+		float4 const t2 = shuffle<0, 1, 0, 1>(c, d);
+		float4 const t3 = shuffle<2, 3, 2, 3>(c, d);
+		a = shuffle<0, 2, 0, 2>(t0, t2);
+		b = shuffle<1, 3, 1, 3>(t0, t2);
+		c = shuffle<0, 2, 0, 2>(t1, t3);
+		d = shuffle<1, 3, 1, 3>(t1, t3);
+	}
+
+	// Load 4 consecutive vec3 (x0 y0 z0 x1 y1 z1 ... z3) as x=(x0,x1,x2,x3), y=(y0,...), z=(z0,...)
+	inline void load_vec3x4(float const* p, float4& x, float4& y, float4& z) {
+		float4 const a = load(p), b = load(p + 4), c = load(p + 8);
+		x = shuffle<0, 1, 0, 2>(shuffle<0, 3, 0, 3>(a, a), shuffle<2, 2, 1, 1>(b, c));
+		y = shuffle<0, 2, 0, 2>(shuffle<1, 1, 0, 0>(a, b), shuffle<3, 3, 2, 2>(b, c));
+		z = shuffle<0, 2, 0, 2>(shuffle<2, 2, 1, 1>(a, b), shuffle<0, 0, 3, 3>(c, c));
+	}
+	// Store x=(x0,x1,x2,x3), y, z as 4 consecutive vec3 (inverse of load_vec3x4)
+	inline void store_vec3x4(float* p, float4 x, float4 y, float4 z) {
+		store(p, shuffle<0, 2, 0, 2>(shuffle<0, 0, 0, 0>(x, y), shuffle<0, 0, 1, 1>(z, x)));
+		store(p + 4, shuffle<0, 2, 0, 2>(shuffle<1, 1, 1, 1>(y, z), shuffle<2, 2, 2, 2>(x, y)));
+		store(p + 8, shuffle<0, 2, 0, 2>(shuffle<2, 2, 3, 3>(z, x), shuffle<3, 3, 3, 3>(y, z)));
+	}
+
+	// Cross product of the xyz components (the w component is 0 if it is finite in a and b)
+	inline float4 cross(float4 a, float4 b) {
+		return sub(mul(swizzle<1, 2, 0, 3>(a), swizzle<2, 0, 1, 3>(b)), mul(swizzle<2, 0, 1, 3>(a), swizzle<1, 2, 0, 3>(b)));
+	}
+
+}}
+
+#endif
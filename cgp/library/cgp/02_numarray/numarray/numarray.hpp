@@ -1,7 +1,11 @@
 #pragma once
 
 #include "cgp/01_base/base.hpp"
+#include "numarray_fwd.hpp"
+#include "../numarray_allocator/numarray_allocator.hpp"
+#include "../numarray_expression/numarray_expression.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
@@ -21,37 +25,49 @@ namespace cgp
  * Numarray follows the main syntax than std::vector
  * Elements in a numarray are stored contiguously in memory (use std::vector internally)
  *
+ * The storage uses std::allocator by default. The second parameter can be an aligned_allocator, or an arena_allocator
+ * taking the memory in a pre-reserved monotonic_arena (see numarray_allocator.hpp).
  **/
-template <typename T>
+template <typename T, typename Allocator>
 struct numarray
 {
     /** Internal data stored as std::vector */
-    std::vector<T> data;
+    std::vector<T, Allocator> data;
 
     // Constructors
     numarray();                             // Empty numarray - no elements 
     numarray(int size);                     // numarray with a given size 
     numarray(std::initializer_list<T> arg); // Inline initialization using { } 
     numarray(std::vector<T> const& arg);    // Direct initialization from std::vector 
+    explicit numarray(Allocator const& allocator);     // Empty numarray using the given allocator (ex. an arena)
+    numarray(int size, Allocator const& allocator);    // numarray with a given size using the given allocator
+
+    /** Evaluation of a lazy expression in a single loop (see numarray_expression.hpp) */
+    template <typename E> numarray(numarray_expression<E> const& expression);
+    template <typename E> numarray<T, Allocator>& operator=(numarray_expression<E> const& expression);
 
     /** Similar to matlab linespace 
     * Linear interpolation between p1 and p2 along N variable */
-    static numarray<T> linespace(T const& p1, T const& p2, int N);
+    static numarray<T, Allocator> linespace(T const& p1, T const& p2, int N);
 
     /** Container size similar to vector.size() */
     int size() const;
     /** Resize container to a new size (similar to vector.resize()) */
-    numarray<T>& resize(int size);
+    numarray<T, Allocator>& resize(int size);
+    /** Allocate the storage for size elements without changing the size (similar to vector.reserve()) */
+    numarray<T, Allocator>& reserve(int size);
+    /** Number of elements that can be stored without reallocation */
+    int capacity() const;
     /** Resize container to a new size, and clear it initialy to delete previous values */
-    numarray<T>& resize_clear(int size);
+    numarray<T, Allocator>& resize_clear(int size);
     /** Add an element at the end of the container (similar to vector.push_back()) */
-    numarray<T>& push_back(T const& value);
+    numarray<T, Allocator>& push_back(T const& value);
     /** Add an numarray of elements at the end of the container */
-    numarray<T>& push_back(numarray<T> const& value);
+    numarray<T, Allocator>& push_back(numarray<T, Allocator> const& value);
     /** Remove all elements of the container, new size is 0 (similar to vector.clear()) */
-    numarray<T>& clear();
+    numarray<T, Allocator>& clear();
     /** Fill the container with the same element (from index 0 to size-1) */
-    numarray<T>& fill(T const& value);
+    numarray<T, Allocator>& fill(T const& value);
 
 
     /** Element access
@@ -69,12 +85,12 @@ struct numarray
     /** Iterators
      * Iterators on numarray are compatible with STL syntax
      * allows "forall" loops (for(auto& e : numarray) {...}) */
-    typename std::vector<T>::iterator begin();
-    typename std::vector<T>::iterator end();
-    typename std::vector<T>::const_iterator begin() const;
-    typename std::vector<T>::const_iterator end() const;
-    typename std::vector<T>::const_iterator cbegin() const;
-    typename std::vector<T>::const_iterator cend() const;
+    typename std::vector<T, Allocator>::iterator begin();
+    typename std::vector<T, Allocator>::iterator end();
+    typename std::vector<T, Allocator>::const_iterator begin() const;
+    typename std::vector<T, Allocator>::const_iterator end() const;
+    typename std::vector<T, Allocator>::const_iterator cbegin() const;
+    typename std::vector<T, Allocator>::const_iterator cend() const;
 
     /** Direct access to the value - doesn't check index bounds*/
     // Depreciated function - use at() instead
@@ -82,70 +98,89 @@ struct numarray
     T& at_unsafe(int index);
 };
 
-template <typename T> std::string type_str(numarray<T> const&);
+/** numarray with the elements aligned on Alignment bytes */
+template <typename T, size_t Alignment = 32> using aligned_numarray = numarray<T, aligned_allocator<T, Alignment> >;
+/** numarray taking its memory in a monotonic_arena */
+template <typename T> using arena_numarray = numarray<T, arena_allocator<T> >;
+
+template <typename T, typename Allocator> std::string type_str(numarray<T, Allocator> const&);
 
 /** Display all elements of the numarray.*/
-template <typename T> std::ostream& operator<<(std::ostream& s, numarray<T> const& v);
+template <typename T, typename Allocator> std::ostream& operator<<(std::ostream& s, numarray<T, Allocator> const& v);
 
 /** Convert all elements of the numarray to a string.
  * \param numarray: the input numarray
  * \param separator: the separator between each element 
  * \param begin/end: character added in the beginning/end of the display
  */
-template <typename T> std::string str(numarray<T> const& v, std::string const& separator=" ", std::string const& begin="", std::string const& end="");
+template <typename T, typename Allocator> std::string str(numarray<T, Allocator> const& v, std::string const& separator=" ", std::string const& begin="", std::string const& end="");
 
-template <typename T> int size_in_memory(numarray<T> const& v);
-template <typename T> auto const* ptr(numarray<T> const& v);
+template <typename T, typename Allocator> int size_in_memory(numarray<T, Allocator> const& v);
+template <typename T, typename Allocator> auto const* ptr(numarray<T, Allocator> const& v);
 
 /** Equality check
  * Check equality (element by element) between two numarrays.
  * numarrays with different size are always considered as not equal.
  * Only approximated equality is performed for comprison with float (absolute value between floats) */
-template <typename T> bool is_equal(numarray<T> const& a, numarray<T> const& b);
+template <typename T, typename Allocator> bool is_equal(numarray<T, Allocator> const& a, numarray<T, Allocator> const& b);
 /** Allows to check value equality between different type (float and int for instance). */
-template <typename T1, typename T2> bool is_equal(numarray<T1> const& a, numarray<T2> const& b);
+template <typename T1, typename Allocator1, typename T2, typename Allocator2> bool is_equal(numarray<T1, Allocator1> const& a, numarray<T2, Allocator2> const& b);
 
 
-template <typename T> T max(numarray<T> const& v);
-template <typename T> T min(numarray<T> const& v);
+template <typename T, typename Allocator> T max(numarray<T, Allocator> const& v);
+template <typename T, typename Allocator> T min(numarray<T, Allocator> const& v);
 
 
 /** Compute average value of all elements of the numarray.*/
-template <typename T> T average(numarray<T> const& a);
-template <typename T> T sum(numarray<T> const& a);
+template <typename T, typename Allocator> T average(numarray<T, Allocator> const& a);
+template <typename T, typename Allocator> T sum(numarray<T, Allocator> const& a);
 
 
 /** Math operators
  * Common mathematical operations between numarrays, and scalar or element values. */
-template <typename T> numarray<T>  operator-(numarray<T> const& a);
+template <typename T, typename Allocator> numarray<T, Allocator>  operator-(numarray<T, Allocator> const& a);
+
+template <typename T, typename Allocator> numarray<T, Allocator>& operator+=(numarray<T, Allocator>& a, numarray<T, Allocator> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  operator+(numarray<T, Allocator> const& a, numarray<T, Allocator> const& b);
+
+template <typename T, typename Allocator> numarray<T, Allocator>& operator-=(numarray<T, Allocator>& a, numarray<T, Allocator> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  operator-(numarray<T, Allocator> const& a, numarray<T, Allocator> const& b);
 
-template <typename T> numarray<T>& operator+=(numarray<T>& a, numarray<T> const& b);
-template <typename T> numarray<T>  operator+(numarray<T> const& a, numarray<T> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>& operator*=(numarray<T, Allocator>& a, numarray<T, Allocator> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  operator*(numarray<T, Allocator> const& a, numarray<T, Allocator> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>& operator*=(numarray<T, Allocator>& a, float b);
+template <typename T, typename Allocator> numarray<T, Allocator>  operator*(numarray<T, Allocator> const& a, float b);
+template <typename T, typename Allocator> numarray<T, Allocator>  operator*(float a, numarray<T, Allocator> const& b);
 
-template <typename T> numarray<T>& operator-=(numarray<T>& a, numarray<T> const& b);
-template <typename T> numarray<T>  operator-(numarray<T> const& a, numarray<T> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>& operator/=(numarray<T, Allocator>& a, numarray<T, Allocator> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>& operator/=(numarray<T, Allocator>& a, float b);
+template <typename T, typename Allocator> numarray<T, Allocator>  operator/(numarray<T, Allocator> const& a, numarray<T, Allocator> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  operator/(numarray<T, Allocator> const& a, float b);
 
-template <typename T> numarray<T>& operator*=(numarray<T>& a, numarray<T> const& b);
-template <typename T> numarray<T>  operator*(numarray<T> const& a, numarray<T> const& b);
-template <typename T> numarray<T>& operator*=(numarray<T>& a, float b);
-template <typename T> numarray<T>  operator*(numarray<T> const& a, float b);
-template <typename T> numarray<T>  operator*(float a, numarray<T> const& b);
+/** Compound operators with a lazy expression (a += lazy(b)*c; is evaluated in a single loop) */
+template <typename T, typename Allocator, typename E> numarray<T, Allocator>& operator+=(numarray<T, Allocator>& a, numarray_expression<E> const& b);
+template <typename T, typename Allocator, typename E> numarray<T, Allocator>& operator-=(numarray<T, Allocator>& a, numarray_expression<E> const& b);
+template <typename T, typename Allocator, typename E> numarray<T, Allocator>& operator*=(numarray<T, Allocator>& a, numarray_expression<E> const& b);
+template <typename T, typename Allocator, typename E> numarray<T, Allocator>& operator/=(numarray<T, Allocator>& a, numarray_expression<E> const& b);
 
-template <typename T> numarray<T>& operator/=(numarray<T>& a, numarray<T> const& b);
-template <typename T> numarray<T>& operator/=(numarray<T>& a, float b);
-template <typename T> numarray<T>  operator/(numarray<T> const& a, numarray<T> const& b);
-template <typename T> numarray<T>  operator/(numarray<T> const& a, float b);
+/** Conversion of a numarray into an operand of a lazy expression */
+template <typename T, typename Allocator>
+struct numarray_expression_operand<numarray<T, Allocator> >
+{
+    using type = numarray_expression_leaf<T>;
+    static type convert(numarray<T, Allocator> const& a) { return type(a.data.data(), { a.size(),1,1 }); }
+};
 
 // Allow componentwise operations
-template <typename T> numarray<T>  sub(numarray<T> const& a, T const& b);
-template <typename T> numarray<T>  add(numarray<T> const& a, T const& b);
-template <typename T> numarray<T>  mul(numarray<T> const& a, T const& b);
-template <typename T> numarray<T>  div(numarray<T> const& a, T const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  sub(numarray<T, Allocator> const& a, T const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  add(numarray<T, Allocator> const& a, T const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  mul(numarray<T, Allocator> const& a, T const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  div(numarray<T, Allocator> const& a, T const& b);
 
-template <typename T> numarray<T>  sub(T const& a, numarray<T> const& b);
-template <typename T> numarray<T>  add(T const& a, numarray<T> const& b);
-template <typename T> numarray<T>  mul(T const& a, numarray<T> const& b);
-template <typename T> numarray<T>  div(T const& a, numarray<T> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  sub(T const& a, numarray<T, Allocator> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  add(T const& a, numarray<T, Allocator> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  mul(T const& a, numarray<T, Allocator> const& b);
+template <typename T, typename Allocator> numarray<T, Allocator>  div(T const& a, numarray<T, Allocator> const& b);
 
 }
 
@@ -158,72 +193,116 @@ template <typename T> numarray<T>  div(T const& a, numarray<T> const& b);
 namespace cgp
 {
 
-template <typename T>
-numarray<T>::numarray()
+template <typename T, typename Allocator>
+numarray<T, Allocator>::numarray()
     :data()
 {}
 
-template <typename T>
-numarray<T>::numarray(int size)
+template <typename T, typename Allocator>
+numarray<T, Allocator>::numarray(int size)
     :data(size)
 {}
 
-template <typename T>
-numarray<T>::numarray(std::initializer_list<T> arg)
+template <typename T, typename Allocator>
+numarray<T, Allocator>::numarray(std::initializer_list<T> arg)
     :data(arg)
 {}
 
-template <typename T>
-numarray<T>::numarray(const std::vector<T>& arg)
-    :data(arg)
+template <typename T, typename Allocator>
+numarray<T, Allocator>::numarray(const std::vector<T>& arg)
+    :data(arg.begin(), arg.end())
+{}
+
+template <typename T, typename Allocator>
+numarray<T, Allocator>::numarray(Allocator const& allocator)
+    :data(allocator)
+{}
+
+template <typename T, typename Allocator>
+numarray<T, Allocator>::numarray(int size, Allocator const& allocator)
+    :data(size, T(), allocator)
 {}
 
-template <typename T>
-int numarray<T>::size() const
+template <typename T, typename Allocator> template <typename E>
+numarray<T, Allocator>::numarray(numarray_expression<E> const& expression)
+    :data(numarray_expression_size(expression.self().dimension))
+{
+    numarray_expression_evaluate(data.data(), expression, size());
+}
+
+template <typename T, typename Allocator> template <typename E>
+numarray<T, Allocator>& numarray<T, Allocator>::operator=(numarray_expression<E> const& expression)
+{
+    // The size is unchanged when the numarray is also an operand of the expression: its elements are not moved before they are read
+    resize(numarray_expression_size(expression.self().dimension));
+    numarray_expression_evaluate(data.data(), expression, size());
+    return *this;
+}
+
+template <typename T, typename Allocator>
+int numarray<T, Allocator>::size() const
 {
     return data.size();
 }
 
-template <typename T>
-numarray<T>& numarray<T>::resize(int size)
+template <typename T, typename Allocator>
+numarray<T, Allocator>& numarray<T, Allocator>::resize(int size)
 {
     assert_cgp_no_msg(size>=0);
     data.resize(size);
     return *this;
 }
 
-template <typename T>
-numarray<T>& numarray<T>::resize_clear(int size)
+template <typename T, typename Allocator>
+numarray<T, Allocator>& numarray<T, Allocator>::reserve(int size)
+{
+    assert_cgp_no_msg(size>=0);
+    data.reserve(size);
+    return *this;
+}
+
+template <typename T, typename Allocator>
+int numarray<T, Allocator>::capacity() const
+{
+    return int(data.capacity());
+}
+
+template <typename T, typename Allocator>
+numarray<T, Allocator>& numarray<T, Allocator>::resize_clear(int size)
 {
     clear();
     resize(size);
     return *this;
 }
 
-template <typename T>
-numarray<T>& numarray<T>::push_back(T const& value)
+template <typename T, typename Allocator>
+numarray<T, Allocator>& numarray<T, Allocator>::push_back(T const& value)
 {
     data.push_back(value);
     return *this;
 }
 
-template <typename T>
-numarray<T>& numarray<T>::push_back(numarray<T> const& value)
+template <typename T, typename Allocator>
+numarray<T, Allocator>& numarray<T, Allocator>::push_back(numarray<T, Allocator> const& value)
 {
+    // At most one reallocation for the concatenation, keeping the geometric growth of the capacity (also valid when value is *this)
+    size_t const required = data.size() + value.data.size();
+    if (required > data.capacity())
+        data.reserve(std::max(required, 2 * data.capacity()));
     for(T const& element : value)
         data.push_back(element);
     return *this;
 }
 
-template <typename T>
-numarray<T>& numarray<T>::clear()
+template <typename T, typename Allocator>
+numarray<T, Allocator>& numarray<T, Allocator>::clear()
 {
     data.clear();
     return *this;
 }
 
-template <typename T>
-numarray<T>& numarray<T>::fill(T const& value)
+template <typename T, typename Allocator>
+numarray<T, Allocator>& numarray<T, Allocator>::fill(T const& value)
 {
     int const N = size();
     for (int k = 0; k < N; ++k)
@@ -231,7 +310,7 @@ numarray<T>& numarray<T>::fill(T const& value)
     return *this;
 }
 
-template <typename T> std::string type_str(numarray<T> const&)
+template <typename T, typename Allocator> std::string type_str(numarray<T, Allocator> const&)
 {
     using cgp::type_str;
     return "numarray<" + type_str(T()) + ">";
@@ -239,8 +318,8 @@ template <typename T> std::string type_str(numarray<T> const&)
 
 
 #ifndef cgp_NO_DEBUG
-template <typename T>
-void check_index_bounds(int index, numarray<T> const& data)
+template <typename T, typename Allocator>
+void check_index_bounds(int index, numarray<T, Allocator> const& data)
 {
 
     int const N = data.size();
@@ -295,33 +374,33 @@ void check_index_bounds(int index, numarray<T> const& data)
     }
 }
 #else
-template <typename T> void check_index_bounds(int , numarray<T> const& ) {}
+template <typename T, typename Allocator> void check_index_bounds(int , numarray<T, Allocator> const& ) {}
 #endif
 
 
-template <typename T>
-T const& numarray<T>::operator[](int index) const
+template <typename T, typename Allocator>
+T const& numarray<T, Allocator>::operator[](int index) const
 {
     check_index_bounds(index, *this);
     return data[index];
 }
 
-template <typename T>
-T& numarray<T>::operator[](int index)
+template <typename T, typename Allocator>
+T& numarray<T, Allocator>::operator[](int index)
 {
     check_index_bounds(index, *this);
     return data[index];
 }
 
-template <typename T>
-T const& numarray<T>::operator()(int index) const
+template <typename T, typename Allocator>
+T const& numarray<T, Allocator>::operator()(int index) const
 {
     check_index_bounds(index, *this);
     return data[index];
 }
 
-template <typename T>
-T& numarray<T>::operator()(int index)
+template <typename T, typename Allocator>
+T& numarray<T, Allocator>::operator()(int index)
 {
     check_index_bounds(index, *this);
     return data[index];
@@ -330,14 +409,14 @@ T& numarray<T>::operator()(int index)
 
 
 
-template <typename T>
-T const& numarray<T>::at_unsafe(int index) const
+template <typename T, typename Allocator>
+T const& numarray<T, Allocator>::at_unsafe(int index) const
 {
     return data[index];
 }
 
-template <typename T>
-T& numarray<T>::at_unsafe(int index)
+template <typename T, typename Allocator>
+T& numarray<T, Allocator>::at_unsafe(int index)
 {
     return data[index];
 }
@@ -345,55 +424,55 @@ T& numarray<T>::at_unsafe(int index)
 
 
 
-template <typename T>
-typename std::vector<T>::iterator numarray<T>::begin()
+template <typename T, typename Allocator>
+typename std::vector<T, Allocator>::iterator numarray<T, Allocator>::begin()
 {
     return data.begin();
 }
 
-template <typename T>
-typename std::vector<T>::iterator numarray<T>::end()
+template <typename T, typename Allocator>
+typename std::vector<T, Allocator>::iterator numarray<T, Allocator>::end()
 {
     return data.end();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator numarray<T>::begin() const
+template <typename T, typename Allocator>
+typename std::vector<T, Allocator>::const_iterator numarray<T, Allocator>::begin() const
 {
     return data.begin();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator numarray<T>::end() const
+template <typename T, typename Allocator>
+typename std::vector<T, Allocator>::const_iterator numarray<T, Allocator>::end() const
 {
     return data.end();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator numarray<T>::cbegin() const
+template <typename T, typename Allocator>
+typename std::vector<T, Allocator>::const_iterator numarray<T, Allocator>::cbegin() const
 {
     return data.cbegin();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator numarray<T>::cend() const
+template <typename T, typename Allocator>
+typename std::vector<T, Allocator>::const_iterator numarray<T, Allocator>::cend() const
 {
     return data.cend();
 }
 
 
-template <typename T> std::ostream& operator<<(std::ostream& s, numarray<T> const& v)
+template <typename T, typename Allocator> std::ostream& operator<<(std::ostream& s, numarray<T, Allocator> const& v)
 {
     std::string const s_out = str(v);
     s << s_out;
     return s;
 }
-template <typename T> std::string str(numarray<T> const& v, std::string const& separator, std::string const& begin, std::string const& end)
+template <typename T, typename Allocator> std::string str(numarray<T, Allocator> const& v, std::string const& separator, std::string const& begin, std::string const& end)
 {
     return cgp::detail::str_container(v, separator, begin, end);
 }
 
-template <typename T> int size_in_memory(numarray<T> const& v)
+template <typename T, typename Allocator> int size_in_memory(numarray<T, Allocator> const& v)
 {
     int s = 0;
     int const N = v.size();
@@ -402,7 +481,7 @@ template <typename T> int size_in_memory(numarray<T> const& v)
     return s;
 }
 
-template <typename T> T average(numarray<T> const& a)
+template <typename T, typename Allocator> T average(numarray<T, Allocator> const& a)
 {
     int const N = a.size();
     assert_cgp(N>0, "Cannot compute average on empty numarray");
@@ -414,7 +493,7 @@ template <typename T> T average(numarray<T> const& a)
 
     return value;
 }
-template <typename T> T sum(numarray<T> const& a) {
+template <typename T, typename Allocator> T sum(numarray<T, Allocator> const& a) {
     int const N = a.size();
     assert_cgp(N>0, "Cannot compute sum on empty numarray");
 
@@ -426,7 +505,7 @@ template <typename T> T sum(numarray<T> const& a) {
 }
 
 
-template <typename T> T max(numarray<T> const& v)
+template <typename T, typename Allocator> T max(numarray<T, Allocator> const& v)
 {
     int const N = v.size();
     assert_cgp(N>0, "Cannot get max on empty numarray");
@@ -440,7 +519,7 @@ template <typename T> T max(numarray<T> const& v)
         
     return current_max;
 }
-template <typename T> T min(numarray<T> const& v)
+template <typename T, typename Allocator> T min(numarray<T, Allocator> const& v)
 {
     int const N = v.size();
     assert_cgp(N>0, "Cannot get max on empty numarray");
@@ -456,8 +535,8 @@ template <typename T> T min(numarray<T> const& v)
 }
 
 
-template <typename T>
-numarray<T>& operator+=(numarray<T>& a, numarray<T> const& b)
+template <typename T, typename Allocator>
+numarray<T, Allocator>& operator+=(numarray<T, Allocator>& a, numarray<T, Allocator> const& b)
 {
     assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
     assert_cgp(a.size()==b.size(), "Size do not agree");
@@ -470,43 +549,34 @@ numarray<T>& operator+=(numarray<T>& a, numarray<T> const& b)
 
 
 
-template <typename T>
-numarray<T>  operator+(numarray<T> const& a, numarray<T> const& b)
+// The binary operators build the result in a single loop through a lazy expression (no copy of the first operand)
+template <typename T, typename Allocator>
+numarray<T, Allocator>  operator+(numarray<T, Allocator> const& a, numarray<T, Allocator> const& b)
 {
-    numarray<T> res = a;
-    res += b;
-    return res;
+    assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
+    assert_cgp(a.size()==b.size(), "Size do not agree");
+    return lazy(a) + b;
 }
 
-template <typename T>
-numarray<T>  operator+(numarray<T> const& a, T const& b)
+template <typename T, typename Allocator>
+numarray<T, Allocator>  operator+(numarray<T, Allocator> const& a, T const& b)
 {
-    numarray<T> res = a;
-    res += b;
-    return res;
+    return lazy(a) + b;
 }
 
-template <typename T>
-numarray<T>  operator+(T const& a, numarray<T> const& b)
+template <typename T, typename Allocator>
+numarray<T, Allocator>  operator+(T const& a, numarray<T, Allocator> const& b)
 {
-    int const N = b.size();
-    numarray<T> res(N);
-    for(int k=0; k<N; ++k)
-        res[k] = a+b[k];
-    return res;
+    return lazy(a) + b;
 }
 
-template <typename T> numarray<T>  operator-(numarray<T> const& a)
+template <typename T, typename Allocator> numarray<T, Allocator>  operator-(numarray<T, Allocator> const& a)
 {
-    int const N = a.size();
-    numarray<T> b(N);
-    for(int k=0; k<N; ++k)
-        b[k] = -a[k];
-    return b;
+    return -lazy(a);
 }
 
 
-template <typename T> numarray<T>& operator-=(numarray<T>& a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>& operator-=(numarray<T, Allocator>& a, numarray<T, Allocator> const& b)
 {
     assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
     assert_cgp(a.size()==b.size(), "Size do not agree");
@@ -517,15 +587,15 @@ template <typename T> numarray<T>& operator-=(numarray<T>& a, numarray<T> const&
     return a;
 }
 
-template <typename T> numarray<T>  operator-(numarray<T> const& a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>  operator-(numarray<T, Allocator> const& a, numarray<T, Allocator> const& b)
 {
-    numarray<T> res = a;
-    res -= b;
-    return res;
+    assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
+    assert_cgp(a.size()==b.size(), "Size do not agree");
+    return lazy(a) - b;
 }
 
 
-template <typename T> numarray<T>& operator*=(numarray<T>& a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>& operator*=(numarray<T, Allocator>& a, numarray<T, Allocator> const& b)
 {
     assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
     assert_cgp(a.size()==b.size(), "Size do not agree");
@@ -535,41 +605,33 @@ template <typename T> numarray<T>& operator*=(numarray<T>& a, numarray<T> const&
         a[k] *= b[k];
     return a;
 }
-template <typename T> numarray<T>  operator*(numarray<T> const& a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>  operator*(numarray<T, Allocator> const& a, numarray<T, Allocator> const& b)
 {
-    numarray<T> res = a;
-    res *= b;
-    return res;
+    assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
+    assert_cgp(a.size()==b.size(), "Size do not agree");
+    return lazy(a) * b;
 }
 
 
 
 
-template <typename T> numarray<T>& operator*=(numarray<T>& a, float b)
+template <typename T, typename Allocator> numarray<T, Allocator>& operator*=(numarray<T, Allocator>& a, float b)
 {
     int const N = a.size();
     for(int k=0; k<N; ++k)
         a[k] *= b;
     return a;
 }
-template <typename T> numarray<T>  operator*(numarray<T> const& a, float b)
+template <typename T, typename Allocator> numarray<T, Allocator>  operator*(numarray<T, Allocator> const& a, float b)
 {
-    int const N = a.size();
-    numarray<T> res(N);
-    for(int k=0; k<N; ++k)
-        res[k] = a[k]*b;
-    return res;
+    return lazy(a) * b;
 }
-template <typename T> numarray<T>  operator*(float a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>  operator*(float a, numarray<T, Allocator> const& b)
 {
-    int const N = b.size();
-    numarray<T> res(N);
-    for(int k=0; k<N; ++k)
-        res[k] = a*b[k];
-    return res;
+    return lazy(a) * b;
 }
 
-template <typename T> numarray<T>& operator/=(numarray<T>& a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>& operator/=(numarray<T, Allocator>& a, numarray<T, Allocator> const& b)
 {
     assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
     assert_cgp(a.size()==b.size(), "Size do not agree");
@@ -579,7 +641,7 @@ template <typename T> numarray<T>& operator/=(numarray<T>& a, numarray<T> const&
         a[k] /= b[k];
     return a;
 }
-template <typename T> numarray<T>& operator/=(numarray<T>& a, float b)
+template <typename T, typename Allocator> numarray<T, Allocator>& operator/=(numarray<T, Allocator>& a, float b)
 {
     assert_cgp(a.size()>0, "Size must be >0");
     const int N = a.size();
@@ -587,22 +649,38 @@ template <typename T> numarray<T>& operator/=(numarray<T>& a, float b)
         a[k] /= b;
     return a;
 }
-template <typename T> numarray<T>  operator/(numarray<T> const& a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>  operator/(numarray<T, Allocator> const& a, numarray<T, Allocator> const& b)
 {
-    numarray<T> res = a;
-    res /= b;
-    return res;
+    assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
+    assert_cgp(a.size()==b.size(), "Size do not agree");
+    return lazy(a) / b;
 }
-template <typename T> numarray<T>  operator/(numarray<T> const& a, float b)
+template <typename T, typename Allocator> numarray<T, Allocator>  operator/(numarray<T, Allocator> const& a, float b)
 {
-    numarray<T> res = a;
-    res /= b;
-    return res;
+    assert_cgp(a.size()>0, "Size must be >0");
+    return lazy(a) / b;
+}
+
+template <typename T, typename Allocator, typename E> numarray<T, Allocator>& operator+=(numarray<T, Allocator>& a, numarray_expression<E> const& b)
+{
+    return a = lazy(a) + b.self();
+}
+template <typename T, typename Allocator, typename E> numarray<T, Allocator>& operator-=(numarray<T, Allocator>& a, numarray_expression<E> const& b)
+{
+    return a = lazy(a) - b.self();
+}
+template <typename T, typename Allocator, typename E> numarray<T, Allocator>& operator*=(numarray<T, Allocator>& a, numarray_expression<E> const& b)
+{
+    return a = lazy(a) * b.self();
+}
+template <typename T, typename Allocator, typename E> numarray<T, Allocator>& operator/=(numarray<T, Allocator>& a, numarray_expression<E> const& b)
+{
+    return a = lazy(a) / b.self();
 }
 
 
 
-template <typename T1, typename T2> bool is_equal(numarray<T1> const& a, numarray<T2> const& b)
+template <typename T1, typename Allocator1, typename T2, typename Allocator2> bool is_equal(numarray<T1, Allocator1> const& a, numarray<T2, Allocator2> const& b)
 {
     int const N = a.size();
     if(b.size()!=N)
@@ -614,15 +692,15 @@ template <typename T1, typename T2> bool is_equal(numarray<T1> const& a, numarra
             return false;
     return true;
 }
-template <typename T> bool is_equal(numarray<T> const& a, numarray<T> const& b)
+template <typename T, typename Allocator> bool is_equal(numarray<T, Allocator> const& a, numarray<T, Allocator> const& b)
 {
-    return is_equal<T,T>(a,b);
+    return is_equal<T,Allocator,T,Allocator>(a,b);
 }
 
-template <typename T>
-numarray<T> numarray<T>::linespace(T const& p1, T const& p2, int N)
+template <typename T, typename Allocator>
+numarray<T, Allocator> numarray<T, Allocator>::linespace(T const& p1, T const& p2, int N)
 {
-    numarray<T> buf; 
+    numarray<T, Allocator> buf; 
     buf.resize(N);
 
     T const increment = (p2 - p1) / float(N - 1);
@@ -636,16 +714,16 @@ numarray<T> numarray<T>::linespace(T const& p1, T const& p2, int N)
 
 }
 
-template <typename T> auto const* ptr(numarray<T> const& v)
+template <typename T, typename Allocator> auto const* ptr(numarray<T, Allocator> const& v)
 {
     using cgp::ptr;
     return ptr(v[0]);
 }
 
-template <typename T> numarray<T> sub(numarray<T> const& a, T const& b)
+template <typename T, typename Allocator> numarray<T, Allocator> sub(numarray<T, Allocator> const& a, T const& b)
 {
     int N= a.size();
-    numarray<T> res;
+    numarray<T, Allocator> res;
     res.resize(N);
 
     for(int k=0; k<N; ++k){
@@ -654,10 +732,10 @@ template <typename T> numarray<T> sub(numarray<T> const& a, T const& b)
 
     return res;
 }
-template <typename T> numarray<T> add(numarray<T> const& a, T const& b)
+template <typename T, typename Allocator> numarray<T, Allocator> add(numarray<T, Allocator> const& a, T const& b)
 {
     int N= a.size();
-    numarray<T> res;
+    numarray<T, Allocator> res;
     res.resize(N);
 
     for(int k=0; k<N; ++k){
@@ -666,10 +744,10 @@ template <typename T> numarray<T> add(numarray<T> const& a, T const& b)
 
     return res;
 }
-template <typename T> numarray<T> mul(numarray<T> const& a, T const& b)
+template <typename T, typename Allocator> numarray<T, Allocator> mul(numarray<T, Allocator> const& a, T const& b)
 {
     int N= a.size();
-    numarray<T> res;
+    numarray<T, Allocator> res;
     res.resize(N);
 
     for(int k=0; k<N; ++k){
@@ -678,10 +756,10 @@ template <typename T> numarray<T> mul(numarray<T> const& a, T const& b)
 
     return res;
 }
-template <typename T> numarray<T> div(numarray<T> const& a, T const& b)
+template <typename T, typename Allocator> numarray<T, Allocator> div(numarray<T, Allocator> const& a, T const& b)
 {
     int N= a.size();
-    numarray<T> res;
+    numarray<T, Allocator> res;
     res.resize(N);
 
     for(int k=0; k<N; ++k){
@@ -691,10 +769,10 @@ template <typename T> numarray<T> div(numarray<T> const& a, T const& b)
     return res;
 }
 
-template <typename T> numarray<T>  sub(T const& a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>  sub(T const& a, numarray<T, Allocator> const& b)
 {
     int N= a.size();
-    numarray<T> res;
+    numarray<T, Allocator> res;
     res.resize(N);
 
     for(int k=0; k<N; ++k){
@@ -703,10 +781,10 @@ template <typename T> numarray<T>  sub(T const& a, numarray<T> const& b)
 
     return res;
 }
-template <typename T> numarray<T>  add(T const& a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>  add(T const& a, numarray<T, Allocator> const& b)
 {
     int N= a.size();
-    numarray<T> res;
+    numarray<T, Allocator> res;
     res.resize(N);
 
     for(int k=0; k<N; ++k){
@@ -715,10 +793,10 @@ template <typename T> numarray<T>  add(T const& a, numarray<T> const& b)
 
     return res;
 }
-template <typename T> numarray<T>  mul(T const& a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>  mul(T const& a, numarray<T, Allocator> const& b)
 {
     int N= a.size();
-    numarray<T> res;
+    numarray<T, Allocator> res;
     res.resize(N);
 
     for(int k=0; k<N; ++k){
@@ -727,10 +805,10 @@ template <typename T> numarray<T>  mul(T const& a, numarray<T> const& b)
 
     return res;
 }
-template <typename T> numarray<T>  div(T const& a, numarray<T> const& b)
+template <typename T, typename Allocator> numarray<T, Allocator>  div(T const& a, numarray<T, Allocator> const& b)
 {
     int N= a.size();
-    numarray<T> res;
+    numarray<T, Allocator> res;
     res.resize(N);
 
     for(int k=0; k<N; ++k){
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <memory>
+
+namespace cgp
+{
+	template <typename T, typename Allocator = std::allocator<T> > struct numarray;
+}
@@ -0,0 +1,101 @@
+#include "cgp/01_base/base.hpp"
+#include "numarray_allocator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace cgp
+{
+    // The block returned by malloc is over-allocated by alignment bytes: the aligned pointer is shifted by at least
+    // sizeof(void*) bytes, and the pointer given by malloc is stored just before it to be released by aligned_free.
+    void* aligned_malloc(size_t size, size_t alignment)
+    {
+        assert_cgp(alignment >= sizeof(void*) && (alignment & (alignment - 1)) == 0, "The alignment must be a power of 2, at least " + str(sizeof(void*)));
+        if (size > size_t(-1) - alignment)
+            throw std::bad_alloc();
+
+        void* const raw = std::malloc(size + alignment);
+        if (raw == nullptr)
+            throw std::bad_alloc();
+
+        std::uintptr_t const aligned = (reinterpret_cast<std::uintptr_t>(raw) + alignment) & ~std::uintptr_t(alignment - 1);
+        void* const ptr = reinterpret_cast<void*>(aligned);
+        static_cast<void**>(ptr)[-1] = raw;
+        return ptr;
+    }
+
+    void aligned_free(void* ptr)
+    {
+        if (ptr != nullptr)
+            std::free(static_cast<void**>(ptr)[-1]);
+    }
+
+
+    // Blocks are aligned on a cache line: the alignments up to 64 bytes only depend on the offset in the block
+    static size_t const arena_block_alignment = 64;
+
+    monotonic_arena::monotonic_arena(size_t capacity)
+        :blocks(), offset(0), used_bytes(0)
+    {
+        if (capacity > 0)
+            blocks.push_back({ static_cast<char*>(aligned_malloc(capacity, arena_block_alignment)), capacity });
+    }
+
+    monotonic_arena::~monotonic_arena()
+    {
+        for (block& b : blocks)
+            aligned_free(b.data);
+    }
+
+    void* monotonic_arena::allocate(size_t size, size_t alignment)
+    {
+        assert_cgp(alignment > 0 && alignment <= arena_block_alignment && (alignment & (alignment - 1)) == 0, "The alignment in a monotonic_arena must be a power of 2 <= 64");
+
+        size_t start = (offset + alignment - 1) & ~(alignment - 1);
+        if (blocks.empty() || start + size > blocks.back().size) {
+            // New block, at least twice the previous one (and at least 4kB)
+            size_t const previous = blocks.empty() ? 0 : blocks.back().size;
+            size_t const block_size = std::max(std::max(2 * previous, size), size_t(4096));
+            blocks.push_back({ static_cast<char*>(aligned_malloc(block_size, arena_block_alignment)), block_size });
+            offset = 0;
+            start = 0;
+        }
+
+        used_bytes += start - offset + size;
+        offset = start + size;
+        return blocks.back().data + start;
+    }
+
+    void monotonic_arena::reset()
+    {
+        if (blocks.size() > 1) {
+            // Replace the blocks by a single one holding everything used so far
+            size_t const total = capacity();
+            for (block& b : blocks)
+                aligned_free(b.data);
+            blocks.clear();
+            blocks.push_back({ static_cast<char*>(aligned_malloc(total, arena_block_alignment)), total });
+        }
+        offset = 0;
+        used_bytes = 0;
+    }
+
+    size_t monotonic_arena::used() const
+    {
+        return used_bytes;
+    }
+
+    size_t monotonic_arena::capacity() const
+    {
+        size_t total = 0;
+        for (block const& b : blocks)
+            total += b.size;
+        return total;
+    }
+
+    int monotonic_arena::number_of_blocks() const
+    {
+        return int(blocks.size());
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+/** Allocators for the storage of numarray (second template parameter, std::allocator by default)
+ *
+ * - aligned_allocator<T, Alignment>: the elements start on an address multiple of Alignment bytes (32 for AVX, 64 for a cache line)
+ * - arena_allocator<T>: the memory is taken in a monotonic_arena, a pre-reserved block where the allocation only moves an offset.
+ *   The memory is not given back element by element: it is released all at once by monotonic_arena::reset() or at the destruction of the arena.
+ *   Meant for the scoped construction of many temporary buffers (the numarrays must not outlive the arena, nor be used after reset()).
+ *
+ * A numarray with another allocator is another type: the functions taking a numarray<T> only accept the default one.
+ * The results of the operators (a+b, etc.) are allocated with a default constructed allocator (aligned, or on the heap for arena_allocator).
+ *
+ * Usage:
+ * | numarray<float, aligned_allocator<float, 64> > v(N);   // or aligned_numarray<float, 64>
+ * |
+ * | monotonic_arena arena(1 << 20);                         // 1MB reserved once
+ * | arena_numarray<vec3> p = arena_numarray<vec3>(arena);   // every buffer of the scope uses the arena
+ * | p.reserve(N);
+ * | ...
+ * | arena.reset();                                          // all the buffers built in the arena are released at once
+ **/
+
+namespace cgp
+{
+
+/** Allocation of size bytes aligned on alignment (a power of 2). The memory must be released with aligned_free. */
+void* aligned_malloc(size_t size, size_t alignment);
+void aligned_free(void* ptr);
+
+/** std-compatible allocator aligning the elements on Alignment bytes */
+template <typename T, size_t Alignment = 32>
+struct aligned_allocator
+{
+    static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "The alignment must be a power of 2, at least the alignment of the type");
+
+    using value_type = T;
+    template <typename U> struct rebind { using other = aligned_allocator<U, Alignment>; };
+
+    aligned_allocator() = default;
+    template <typename U> aligned_allocator(aligned_allocator<U, Alignment> const&) {}
+
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n);
+};
+template <typename T, typename U, size_t Alignment> bool operator==(aligned_allocator<T, Alignment> const&, aligned_allocator<U, Alignment> const&) { return true; }
+template <typename T, typename U, size_t Alignment> bool operator!=(aligned_allocator<T, Alignment> const&, aligned_allocator<U, Alignment> const&) { return false; }
+
+
+/** Monotonic memory arena: successive allocations are placed one after the other in pre-reserved blocks
+ * A new block (twice larger) is added when the current one is full. reset() releases everything and keeps a single block
+ * large enough for all the memory used so far, so that the next construction of the same buffers does not allocate.
+ * The arena is not thread safe. */
+struct monotonic_arena
+{
+    /** Arena with an initial block of capacity bytes (0: the first block is created at the first allocation) */
+    explicit monotonic_arena(size_t capacity = 0);
+    ~monotonic_arena();
+    monotonic_arena(monotonic_arena const&) = delete;
+    monotonic_arena& operator=(monotonic_arena const&) = delete;
+
+    /** Memory of size bytes aligned on alignment (a power of 2, at most 64) */
+    void* allocate(size_t size, size_t alignment);
+    /** Release all the allocations at once */
+    void reset();
+
+    /** Bytes given by allocate() since the last reset (including the alignment padding) */
+    size_t used() const;
+    /** Total size of the blocks */
+    size_t capacity() const;
+    /** Number of blocks (1 when the reserved capacity was sufficient) */
+    int number_of_blocks() const;
+
+    // Internal state
+    struct block { char* data; size_t size; };
+    std::vector<block> blocks;
+    size_t offset;      // position in the last block
+    size_t used_bytes;
+};
+
+/** std-compatible allocator taking its memory in a monotonic_arena (the elements are aligned on 32 bytes)
+ * A default constructed arena_allocator is not attached to an arena, and allocates on the heap. */
+template <typename T>
+struct arena_allocator
+{
+    using value_type = T;
+    static constexpr size_t alignment = alignof(T) > 32 ? alignof(T) : 32;
+
+    monotonic_arena* arena = nullptr;
+
+    arena_allocator() = default;
+    arena_allocator(monotonic_arena& arena_arg) : arena(&arena_arg) {}
+    template <typename U> arena_allocator(arena_allocator<U> const& other) : arena(other.arena) {}
+
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n);
+};
+template <typename T, typename U> bool operator==(arena_allocator<T> const& a, arena_allocator<U> const& b) { return a.arena == b.arena; }
+template <typename T, typename U> bool operator!=(arena_allocator<T> const& a, arena_allocator<U> const& b) { return a.arena != b.arena; }
+
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+
+template <typename T, size_t Alignment>
+T* aligned_allocator<T, Alignment>::allocate(size_t n)
+{
+    if (n > size_t(-1) / sizeof(T))
+        throw std::bad_alloc();
+    return static_cast<T*>(aligned_malloc(n * sizeof(T), Alignment));
+}
+
+template <typename T, size_t Alignment>
+void aligned_allocator<T, Alignment>::deallocate(T* p, size_t)
+{
+    aligned_free(p);
+}
+
+template <typename T>
+T* arena_allocator<T>::allocate(size_t n)
+{
+    if (n > size_t(-1) / sizeof(T))
+        throw std::bad_alloc();
+    if (arena == nullptr)
+        return static_cast<T*>(aligned_malloc(n * sizeof(T), alignment));
+    return static_cast<T*>(arena->allocate(n * sizeof(T), alignment));
+}
+
+template <typename T>
+void arena_allocator<T>::deallocate(T* p, size_t)
+{
+    // The memory of the arena is only released by reset() or by its destructor
+    if (arena == nullptr)
+        aligned_free(p);
+}
+
+}
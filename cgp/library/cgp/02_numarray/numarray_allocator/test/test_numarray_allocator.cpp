@@ -0,0 +1,93 @@
+#include "cgp/02_numarray/numarray.hpp"
+#include "test_numarray_allocator.hpp"
+
+#include <cstdint>
+
+namespace cgp_test
+{
+	using namespace cgp;
+
+	static bool is_aligned(void const* ptr, size_t alignment)
+	{
+		return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+	}
+
+	void test_numarray_allocator()
+	{
+		// Aligned storage, with the same operators as the default numarray
+		{
+			aligned_numarray<float, 64> a(100);
+			assert_cgp_no_msg(is_aligned(a.data.data(), 64));
+			for (int k = 0; k < a.size(); ++k)
+				a[k] = float(k);
+			a.push_back(a);
+			assert_cgp_no_msg(a.size() == 200);
+			assert_cgp_no_msg(is_aligned(a.data.data(), 64));
+			assert_cgp_no_msg(a[150] == 50.0f);
+
+			aligned_numarray<float, 64> const b = a * 2.0f + a;
+			assert_cgp_no_msg(is_aligned(b.data.data(), 64));
+			assert_cgp_no_msg(is_equal(b[3], 9.0f));
+			assert_cgp_no_msg(is_equal(sum(b), 3 * sum(a)));
+
+			aligned_numarray<vec3> p = { {1,2,3}, {4,5,6} };
+			assert_cgp_no_msg(is_aligned(p.data.data(), 32));
+			assert_cgp_no_msg(is_equal(p, aligned_numarray<vec3>{ {1,2,3}, {4,5,6} }));
+		}
+
+		// Buffers built in an arena: a single block when the reserved capacity is sufficient
+		{
+			monotonic_arena arena(1 << 16);
+			arena_numarray<vec3> position = arena_numarray<vec3>(arena);
+			arena_numarray<uint3> connectivity = arena_numarray<uint3>(arena);
+			position.reserve(100);
+			connectivity.reserve(100);
+			for (int k = 0; k < 100; ++k) {
+				position.push_back(vec3{ float(k), 0, 0 });
+				connectivity.push_back(uint3{ unsigned(k), unsigned(k), unsigned(k) });
+			}
+			assert_cgp_no_msg(arena.number_of_blocks() == 1);
+			assert_cgp_no_msg(arena.used() >= 100 * (sizeof(vec3) + sizeof(uint3)));
+			assert_cgp_no_msg(is_aligned(position.data.data(), 32));
+			assert_cgp_no_msg(is_aligned(connectivity.data.data(), 32));
+			assert_cgp_no_msg(is_equal(position[42], vec3{ 42,0,0 }));
+
+			// The result of an operator is not attached to the arena
+			arena_numarray<vec3> const q = position * 2.0f;
+			assert_cgp_no_msg(q.data.get_allocator().arena == nullptr);
+			assert_cgp_no_msg(is_equal(q[42], vec3{ 84,0,0 }));
+		}
+
+		// Growth over several blocks, then a single block after reset
+		{
+			monotonic_arena arena;
+			{
+				arena_numarray<float> a = arena_numarray<float>(arena);
+				for (int k = 0; k < 10000; ++k)
+					a.push_back(float(k));
+				assert_cgp_no_msg(is_equal(a[9999], 9999.0f));
+			}
+			assert_cgp_no_msg(arena.number_of_blocks() > 1);
+			size_t const capacity = arena.capacity();
+
+			arena.reset();
+			assert_cgp_no_msg(arena.number_of_blocks() == 1);
+			assert_cgp_no_msg(arena.capacity() == capacity);
+			assert_cgp_no_msg(arena.used() == 0);
+			{
+				arena_numarray<float> a = arena_numarray<float>(arena);
+				for (int k = 0; k < 10000; ++k)
+					a.push_back(float(k));
+			}
+			assert_cgp_no_msg(arena.number_of_blocks() == 1);
+		}
+
+		// Reservation on the default numarray
+		{
+			numarray<int> a;
+			a.reserve(64);
+			assert_cgp_no_msg(a.size() == 0);
+			assert_cgp_no_msg(a.capacity() >= 64);
+		}
+	}
+}
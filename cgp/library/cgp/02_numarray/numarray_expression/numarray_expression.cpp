@@ -0,0 +1,7 @@
+#include "cgp/01_base/base.hpp"
+#include "numarray_expression.hpp"
+
+namespace cgp
+{
+    size_t numarray_expression_parallel_threshold = 65536;
+}
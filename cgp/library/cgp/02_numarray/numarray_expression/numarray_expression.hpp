@@ -0,0 +1,241 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/01_base/parallel/parallel.hpp"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+/** Lazy element-wise expressions on numarray (and on grid_2D, grid_3D)
+ *
+ * The operators + - * / on containers return a new container for each operation: a*s + b - c allocates and traverses the memory three times.
+ * An expression started with lazy() is instead a tree of small objects (pointers to the operands), evaluated in a single loop
+ * when it is assigned to a container, without intermediate allocation. The loop runs in parallel (parallel_chunks, on the job system)
+ * above numarray_expression_parallel_threshold elements.
+ *
+ * The usual operators keep returning containers, so that existing code (auto variables, generic functions taking a numarray<T>) is unchanged.
+ * They are evaluated with the same single loop.
+ *
+ * An expression only references its operands: it must be assigned before they are destroyed (do not keep it in an auto variable).
+ * The assigned container can be one of the operands (each element only depends on the elements of the operands at the same index).
+ *
+ * Usage:
+ * | numarray<float> r = lazy(a)*s + b - c;   // one allocation, one loop
+ * | r = lazy(r)*0.5f + b;                     // in place
+ * | r += lazy(b)*c;
+ * | grid_3D<float> g = lazy(g1)*2.0f + g2;    // the dimensions of the grids must agree
+ **/
+
+namespace cgp
+{
+
+/** Base of all the expressions (CRTP) */
+template <typename E>
+struct numarray_expression
+{
+    using numarray_expression_tag = void;
+    E const& self() const { return static_cast<E const&>(*this); }
+};
+
+/** Dimension of the container an expression has the shape of: {N,1,1} for a numarray, {N1,N2,1} for a grid_2D, {-1,-1,-1} for a scalar
+ * The fourth component identifies the storage order of the grids (0: linear, see grid_layout.hpp): grids with different layouts cannot be combined. */
+using numarray_expression_dimension = std::array<int, 4>;
+
+/** Elements of a container (contiguous data) */
+template <typename T>
+struct numarray_expression_leaf : numarray_expression<numarray_expression_leaf<T> >
+{
+    using value_type = T;
+    T const* data;
+    numarray_expression_dimension dimension;
+
+    numarray_expression_leaf(T const* data_arg, numarray_expression_dimension const& dimension_arg) : data(data_arg), dimension(dimension_arg) {}
+    T const& at(int k) const { return data[k]; }
+};
+
+/** Value broadcast to all the elements */
+template <typename S>
+struct numarray_expression_scalar : numarray_expression<numarray_expression_scalar<S> >
+{
+    using value_type = S;
+    S value;
+    numarray_expression_dimension dimension;
+
+    explicit numarray_expression_scalar(S const& value_arg) : value(value_arg), dimension({ -1,-1,-1,0 }) {}
+    S const& at(int) const { return value; }
+};
+
+/** Element-wise operation between two expressions */
+template <typename A, typename B, typename Op>
+struct numarray_expression_binary : numarray_expression<numarray_expression_binary<A, B, Op> >
+{
+    using value_type = typename std::decay<decltype(Op::apply(std::declval<typename A::value_type>(), std::declval<typename B::value_type>()))>::type;
+    A a;
+    B b;
+    numarray_expression_dimension dimension;
+
+    numarray_expression_binary(A const& a_arg, B const& b_arg);
+    value_type at(int k) const { return Op::apply(a.at(k), b.at(k)); }
+};
+
+/** Element-wise negation */
+template <typename A>
+struct numarray_expression_negate : numarray_expression<numarray_expression_negate<A> >
+{
+    using value_type = typename std::decay<decltype(-std::declval<typename A::value_type>())>::type;
+    A a;
+    numarray_expression_dimension dimension;
+
+    explicit numarray_expression_negate(A const& a_arg) : a(a_arg), dimension(a_arg.dimension) {}
+    value_type at(int k) const { return -a.at(k); }
+};
+
+namespace detail
+{
+    template <typename X> struct numarray_expression_void { using type = void; };
+}
+
+/** True if X is an expression */
+template <typename X, typename Enable = void>
+struct is_numarray_expression : std::false_type {};
+template <typename X>
+struct is_numarray_expression<X, typename detail::numarray_expression_void<typename X::numarray_expression_tag>::type> : std::true_type {};
+
+/** Conversion of an operand into an expression
+ * Expressions are kept, containers become leaves (numarray here, grid_2D and grid_3D in their own headers), and the other values are scalars. */
+template <typename X, typename Enable = void>
+struct numarray_expression_operand
+{
+    using type = numarray_expression_scalar<X>;
+    static type convert(X const& x) { return type(x); }
+};
+template <typename E>
+struct numarray_expression_operand<E, typename std::enable_if<is_numarray_expression<E>::value>::type>
+{
+    using type = E;
+    static E const& convert(E const& e) { return e; }
+};
+
+/** Start a lazy expression from a container (or a scalar) */
+template <typename X> typename numarray_expression_operand<X>::type lazy(X const& x);
+
+/** Element-wise operations */
+struct numarray_expression_add { template <typename X, typename Y> static auto apply(X const& x, Y const& y) -> decltype(x + y) { return x + y; } };
+struct numarray_expression_sub { template <typename X, typename Y> static auto apply(X const& x, Y const& y) -> decltype(x - y) { return x - y; } };
+struct numarray_expression_mul { template <typename X, typename Y> static auto apply(X const& x, Y const& y) -> decltype(x * y) { return x * y; } };
+struct numarray_expression_div { template <typename X, typename Y> static auto apply(X const& x, Y const& y) -> decltype(x / y) { return x / y; } };
+
+/** Type of the expression (a Op b), only defined if at least one of the operands is an expression */
+template <typename A, typename B, typename Op>
+struct numarray_expression_result : std::enable_if<is_numarray_expression<A>::value || is_numarray_expression<B>::value,
+    numarray_expression_binary<typename numarray_expression_operand<A>::type, typename numarray_expression_operand<B>::type, Op> > {};
+
+/** Operators between an expression and an expression, a container, or a scalar */
+template <typename A, typename B> typename numarray_expression_result<A, B, numarray_expression_add>::type operator+(A const& a, B const& b);
+template <typename A, typename B> typename numarray_expression_result<A, B, numarray_expression_sub>::type operator-(A const& a, B const& b);
+template <typename A, typename B> typename numarray_expression_result<A, B, numarray_expression_mul>::type operator*(A const& a, B const& b);
+template <typename A, typename B> typename numarray_expression_result<A, B, numarray_expression_div>::type operator/(A const& a, B const& b);
+template <typename E> numarray_expression_negate<E> operator-(numarray_expression<E> const& a);
+
+/** Number of elements of an expression of the given dimension (the expression must contain at least one container) */
+int numarray_expression_size(numarray_expression_dimension const& dimension);
+
+/** Expressions with at least this number of elements are evaluated in parallel (default: 65536) */
+extern size_t numarray_expression_parallel_threshold;
+
+/** out[k] = expression[k] for k in [0,N[, in a single loop (split in parallel chunks above the threshold) */
+template <typename T, typename E> void numarray_expression_evaluate(T* out, numarray_expression<E> const& expression, int N);
+
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+
+namespace detail
+{
+    inline std::string str_expression_dimension(numarray_expression_dimension const& d)
+    {
+        return "(" + str(d[0]) + "," + str(d[1]) + "," + str(d[2]) + ")" + (d[3] != 0 ? " with layout " + str(d[3]) : "");
+    }
+
+    // Dimension of the result of a binary operation (a scalar takes the dimension of the other operand)
+    inline numarray_expression_dimension merge_expression_dimension(numarray_expression_dimension const& a, numarray_expression_dimension const& b)
+    {
+        if (a[0] < 0)
+            return b;
+        if (b[0] < 0)
+            return a;
+        assert_cgp(a == b, "Dimensions of the operands do not agree: " + str_expression_dimension(a) + " and " + str_expression_dimension(b));
+        return a;
+    }
+}
+
+template <typename A, typename B, typename Op>
+numarray_expression_binary<A, B, Op>::numarray_expression_binary(A const& a_arg, B const& b_arg)
+    :a(a_arg), b(b_arg), dimension(detail::merge_expression_dimension(a_arg.dimension, b_arg.dimension))
+{}
+
+template <typename X> typename numarray_expression_operand<X>::type lazy(X const& x)
+{
+    return numarray_expression_operand<X>::convert(x);
+}
+
+template <typename A, typename B> typename numarray_expression_result<A, B, numarray_expression_add>::type operator+(A const& a, B const& b)
+{
+    return { numarray_expression_operand<A>::convert(a), numarray_expression_operand<B>::convert(b) };
+}
+template <typename A, typename B> typename numarray_expression_result<A, B, numarray_expression_sub>::type operator-(A const& a, B const& b)
+{
+    return { numarray_expression_operand<A>::convert(a), numarray_expression_operand<B>::convert(b) };
+}
+template <typename A, typename B> typename numarray_expression_result<A, B, numarray_expression_mul>::type operator*(A const& a, B const& b)
+{
+    return { numarray_expression_operand<A>::convert(a), numarray_expression_operand<B>::convert(b) };
+}
+template <typename A, typename B> typename numarray_expression_result<A, B, numarray_expression_div>::type operator/(A const& a, B const& b)
+{
+    return { numarray_expression_operand<A>::convert(a), numarray_expression_operand<B>::convert(b) };
+}
+template <typename E> numarray_expression_negate<E> operator-(numarray_expression<E> const& a)
+{
+    return numarray_expression_negate<E>(a.self());
+}
+
+inline int numarray_expression_size(numarray_expression_dimension const& dimension)
+{
+    assert_cgp(dimension[0] >= 0, "An expression must contain at least one container to be evaluated");
+    return dimension[0] * dimension[1] * dimension[2];
+}
+
+template <typename T, typename E> void numarray_expression_evaluate(T* out, numarray_expression<E> const& expression, int N)
+{
+    E const& e = expression.self();
+    // Plain loop on pointers (the compiler can vectorize it for arithmetic types)
+    auto const loop = [out, &e](size_t k0, size_t k1) {
+        for (size_t k = k0; k < k1; ++k)
+            out[k] = static_cast<T>(e.at(int(k)));
+    };
+
+    if (N <= 0)
+        return;
+    if (size_t(N) >= numarray_expression_parallel_threshold)
+        parallel_chunks(0, size_t(N), loop);
+    else
+        loop(0, size_t(N));
+}
+
+}
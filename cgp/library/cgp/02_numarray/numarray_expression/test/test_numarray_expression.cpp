@@ -0,0 +1,66 @@
+#include "cgp/02_numarray/numarray.hpp"
+#include "test_numarray_expression.hpp"
+
+namespace cgp_test
+{
+	using namespace cgp;
+
+	static void test_numarray_expression_size(int N)
+	{
+		numarray<float> a(N), b(N), c(N);
+		for (int k = 0; k < N; ++k) {
+			a[k] = 0.5f * k;
+			b[k] = 1.0f + k % 7;
+			c[k] = 2.0f - 0.25f * (k % 3);
+		}
+
+		// Single expression, compared to the element-wise computation
+		numarray<float> const r = lazy(a) * 2.0f + b - lazy(c) / b;
+		assert_cgp_no_msg(r.size() == N);
+		for (int k = 0; k < N; ++k)
+			assert_cgp_no_msg(is_equal(r[k], a[k] * 2.0f + b[k] - c[k] / b[k]));
+
+		// Result of the eager operators (evaluated with the same loop, defined for non-empty numarrays)
+		if (N > 0)
+			assert_cgp_no_msg(is_equal(a * 2.0f + b - c / b, r));
+
+		// In place update, where the assigned numarray is an operand
+		numarray<float> s = a;
+		s = lazy(s) * s - 1.0f;
+		for (int k = 0; k < N; ++k)
+			assert_cgp_no_msg(is_equal(s[k], a[k] * a[k] - 1.0f));
+
+		numarray<float> t = a;
+		t += lazy(b) * c;
+		t -= -lazy(c);
+		for (int k = 0; k < N; ++k)
+			assert_cgp_no_msg(is_equal(t[k], a[k] + b[k] * c[k] + c[k]));
+	}
+
+	void test_numarray_expression()
+	{
+		for (int N : { 0, 1, 5, 1000 })
+			test_numarray_expression_size(N);
+
+		// Parallel evaluation of the chunks
+		{
+			size_t const threshold = numarray_expression_parallel_threshold;
+			numarray_expression_parallel_threshold = 16;
+			test_numarray_expression_size(5003);
+			numarray_expression_parallel_threshold = threshold;
+		}
+
+		// Elements of different types than the scalars
+		{
+			numarray<vec3> p = { {1,0,0}, {0,2,0}, {0,0,3} };
+			numarray<vec3> const q = lazy(p) * 2.0f + vec3{ 1,1,1 };
+			assert_cgp_no_msg(is_equal(q[0], vec3{ 3,1,1 }));
+			assert_cgp_no_msg(is_equal(q[1], vec3{ 1,5,1 }));
+			assert_cgp_no_msg(is_equal(q[2], vec3{ 1,1,7 }));
+
+			numarray<int> i = { 1,2,3 };
+			numarray<int> const j = lazy(i) * 3 - i;
+			assert_cgp_no_msg(is_equal(j, { 2,4,6 }));
+		}
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cgp/01_base/base.hpp"
+#include "cgp/02_numarray/numarray/numarray_fwd.hpp"
 #include <array>
 #include <cmath>
 
@@ -8,8 +9,6 @@
 
 namespace cgp
 {
-    template <typename T> struct numarray;
-
     // Implementation of generic size numarray_stack
     //   numarray_stack is a constant size structure (size known at compile time).
     //   Internal data is stored as std::array, and numarray_stack is compatible with std::array syntax.
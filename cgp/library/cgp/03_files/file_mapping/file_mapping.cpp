@@ -0,0 +1,157 @@
+#include "file_mapping.hpp"
+
+#include <sys/stat.h>
+#include <fstream>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define CGP_FILE_MAPPING_MMAP
+#endif
+
+namespace cgp
+{
+	file_mapping_structure::~file_mapping_structure()
+	{
+		close();
+	}
+
+	file_mapping_structure::file_mapping_structure(file_mapping_structure&& other)
+	{
+		*this = std::move(other);
+	}
+
+	file_mapping_structure& file_mapping_structure::operator=(file_mapping_structure&& other)
+	{
+		if (this != &other) {
+			close();
+			std::swap(mapped_data, other.mapped_data);
+			std::swap(mapped_size, other.mapped_size);
+#ifdef _WIN32
+			std::swap(file_handle, other.file_handle);
+			std::swap(mapping_handle, other.mapping_handle);
+#endif
+			std::swap(buffer, other.buffer);
+			if (!buffer.empty())
+				mapped_data = buffer.data();
+		}
+		return *this;
+	}
+
+	bool file_mapping_structure::open(std::string const& filename)
+	{
+		close();
+
+#if defined(CGP_FILE_MAPPING_MMAP)
+		int const fd = ::open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+			::close(fd);
+			return false;
+		}
+		void* p = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd); // the mapping remains valid after closing the descriptor
+		if (p == MAP_FAILED)
+			return false;
+		mapped_data = static_cast<char const*>(p);
+		mapped_size = size_t(info.st_size);
+		return true;
+
+#elif defined(_WIN32)
+		HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) {
+			CloseHandle(file);
+			return false;
+		}
+		void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (p == nullptr) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+		file_handle = file;
+		mapping_handle = mapping;
+		mapped_data = static_cast<char const*>(p);
+		mapped_size = size_t(file_size.QuadPart);
+		return true;
+
+#else
+		std::ifstream stream(filename, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!stream.is_open())
+			return false;
+		std::streamsize const N = stream.tellg();
+		if (N <= 0)
+			return false;
+		buffer.resize(size_t(N));
+		stream.seekg(0, std::ios::beg);
+		if (!stream.read(buffer.data(), N)) {
+			buffer.clear();
+			return false;
+		}
+		mapped_data = buffer.data();
+		mapped_size = buffer.size();
+		return true;
+#endif
+	}
+
+	void file_mapping_structure::close()
+	{
+		if (mapped_data == nullptr)
+			return;
+
+#if defined(CGP_FILE_MAPPING_MMAP)
+		munmap(const_cast<char*>(mapped_data), mapped_size);
+#elif defined(_WIN32)
+		UnmapViewOfFile(mapped_data);
+		CloseHandle(static_cast<HANDLE>(mapping_handle));
+		CloseHandle(static_cast<HANDLE>(file_handle));
+		mapping_handle = nullptr;
+		file_handle = nullptr;
+#else
+		buffer.clear();
+		buffer.shrink_to_fit();
+#endif
+		mapped_data = nullptr;
+		mapped_size = 0;
+	}
+
+	char const* file_mapping_structure::data() const
+	{
+		return mapped_data;
+	}
+
+	size_t file_mapping_structure::size() const
+	{
+		return mapped_size;
+	}
+
+	bool file_mapping_structure::is_open() const
+	{
+		return mapped_data != nullptr;
+	}
+
+	long long file_get_modification_time(std::string const& filename)
+	{
+		struct stat info;
+		if (stat(filename.c_str(), &info) != 0)
+			return 0;
+		return (long long)(info.st_mtime);
+	}
+}
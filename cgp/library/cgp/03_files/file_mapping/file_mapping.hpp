@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace cgp
+{
+	/** Read-only view of the content of a file mapped in memory (mmap on Unix, MapViewOfFile on Windows)
+	 * The pages are loaded lazily by the system when they are accessed. The data remains valid until close() or the destruction of the structure.
+	 * On platforms without memory mapping (ex. Emscripten) the file is read entirely in memory with the same interface.
+	 *
+	 * Usage:
+	 * | file_mapping_structure file;
+	 * | if( file.open("data.bin") ) {
+	 * |     char const* p = file.data();
+	 * |     size_t N = file.size();
+	 * | }
+	 */
+	struct file_mapping_structure
+	{
+		file_mapping_structure() = default;
+		~file_mapping_structure();
+
+		// The mapping is not copyable, but it can be moved
+		file_mapping_structure(file_mapping_structure const&) = delete;
+		file_mapping_structure& operator=(file_mapping_structure const&) = delete;
+		file_mapping_structure(file_mapping_structure&& other);
+		file_mapping_structure& operator=(file_mapping_structure&& other);
+
+		/** Map the file in memory. Return false if the file cannot be opened (or is empty) */
+		bool open(std::string const& filename);
+		/** Release the mapping */
+		void close();
+
+		char const* data() const;
+		size_t size() const;
+		bool is_open() const;
+
+	private:
+		char const* mapped_data = nullptr;
+		size_t mapped_size = 0;
+#ifdef _WIN32
+		void* file_handle = nullptr;
+		void* mapping_handle = nullptr;
+#endif
+		std::vector<char> buffer; // used when memory mapping is not available
+	};
+
+	/** Return the last modification time of a file (0 if the file cannot be accessed) */
+	long long file_get_modification_time(std::string const& filename);
+}
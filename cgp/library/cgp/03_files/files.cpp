@@ -5,6 +5,9 @@
 #include <fstream>
 #include <iostream>
 #include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
 
 #if defined(__linux__) || defined(__EMSCRIPTEN__)
 #pragma GCC diagnostic ignored "-Wunused-variable"
@@ -31,6 +34,24 @@ namespace cgp
         return (stat(pathname.c_str(), &buffer) == 0);
     }
 
+    bool create_directory(std::string const& pathname)
+    {
+        if (pathname.empty() || check_path_exist(pathname))
+            return true;
+
+        // Create the parent directories first
+        std::size_t const pos = pathname.find_last_of("/\\", pathname.size() - 2);
+        if (pos != std::string::npos && pos > 0)
+            create_directory(pathname.substr(0, pos));
+
+#ifdef _WIN32
+        _mkdir(pathname.c_str());
+#else
+        mkdir(pathname.c_str(), 0755);
+#endif
+        return check_path_exist(pathname);
+    }
+
     void assert_file_exist(std::string const& filename)
     {
         // Open file
@@ -2,6 +2,7 @@
 
 
 #include "cgp/02_numarray/numarray.hpp"
+#include "file_mapping/file_mapping.hpp"
 
 #include <string>
 #include <sstream>
@@ -19,6 +20,9 @@ namespace cgp
 	/** Return true if a path (file or directory) exists, false otherwise */
 	bool check_path_exist(std::string const& pathname);
 
+	/** Create a directory (and its missing parents). Return true if the directory exists at the end of the call */
+	bool create_directory(std::string const& pathname);
+
 	/** Return the size in octets of a file*/
 	size_t file_get_size(std::string const& filename);
 
@@ -3,6 +3,7 @@
 #include "cgp/01_base/base.hpp"
 #include "cgp/02_numarray/numarray.hpp"
 #include "../../offset_grid/offset_grid.hpp"
+#include "../../grid_layout/grid_layout.hpp"
 
 
 
@@ -16,10 +17,12 @@ namespace cgp
 /** Container for 2D-grid like structure storing numerical element
  *
  * The grid_2D structure provide convenient access for 2D-grid organization where an element can be queried as grid_2D(i,j).
- * The indexing is obtained as grid_2D(k1,k2) = k1 + N1*k2
+ * The indexing is obtained as grid_2D(k1,k2) = k1 + N1*k2 with the default linear Layout,
+ *  or by bricks of BxB elements with grid_layout_tiled<B> (see grid_layout.hpp). The iterators, data, and from_buffer follow the storage order,
+ *  which has Layout::storage_size(dimension) elements (more than size() for a tiled grid whose dimensions are not multiples of B).
  * Elements of grid_2D are stored contiguously in heap memory and remain fully compatible with std::vector and pointers.
  **/
-template <typename T>
+template <typename T, typename Layout = grid_layout_linear>
 struct grid_2D
 {
     /** 2D dimension (Nx,Ny) of the container */
@@ -33,9 +36,18 @@ struct grid_2D
     grid_2D(int2 const& size);        // Build a grid_2D with specified dimension
     grid_2D(int size_1, int size_2);  // Build a grid_2D with specified dimension
 
+    /** Copy of a grid stored with another layout (conversion to/from the linear layout) */
+    template <typename Layout_other> explicit grid_2D(grid_2D<T, Layout_other> const& other);
+
+    /** Evaluation of a lazy expression in a single loop (see numarray_expression.hpp)
+    * The grids of the expression must have the same layout as this one. */
+    template <typename E> grid_2D(numarray_expression<E> const& expression);
+    template <typename E> grid_2D<T, Layout>& operator=(numarray_expression<E> const& expression);
+
     /** Direct build a grid_2D from a given 1D-buffer and its 2D-dimension
-    * \note: the size of the 1D-buffer must satisfy arg.size = size_1 * size_2 */
-    static grid_2D<T> from_buffer(numarray<T> const& arg, int size_1, int size_2);
+    * \note: the size of the 1D-buffer must satisfy arg.size = Layout::storage_size({size_1, size_2}) (size_1 * size_2 for the linear layout)
+    * \note: the buffer is in the storage order of the Layout */
+    static grid_2D<T, Layout> from_buffer(numarray<T> const& arg, int size_1, int size_2);
 
 
     /** Remove all elements from the grid_2D */
@@ -64,6 +76,9 @@ struct grid_2D
 
     int index_to_offset(int k1, int k2) const;
     int2 offset_to_index(int offset) const;
+    /** Offsets from the element (k1,k2) to (k1+1,k2) and (k1,k2+1)
+    * The offset of (k1+a,k2+b), a,b in {0,1}, is index_to_offset(k1,k2) + a*stride.x + b*stride.y */
+    int2 index_to_stride(int k1, int k2) const;
 
     /** Iterators
      * 1D-type iterators on grid_2D are compatible with STL syntax
@@ -83,46 +98,54 @@ struct grid_2D
 };
 
 
-template <typename T> std::string type_str(grid_2D<T> const&);
+template <typename T, typename Layout> std::string type_str(grid_2D<T, Layout> const&);
 
 /** Display all elements of the buffer.*/
-template <typename T> std::ostream& operator<<(std::ostream& s, grid_2D<T> const& v);
+template <typename T, typename Layout> std::ostream& operator<<(std::ostream& s, grid_2D<T, Layout> const& v);
 
 /** Convert all elements of the buffer to a string.
  * \param buffer: the input buffer
  * \param separator: the separator between each element
  */
-template <typename T> std::string str(grid_2D<T> const& v, std::string const& separator=" ", std::string const& begin = "", std::string const& end = "");
+template <typename T, typename Layout> std::string str(grid_2D<T, Layout> const& v, std::string const& separator=" ", std::string const& begin = "", std::string const& end = "");
 
 
 /** Equality test between grid_2D */
-template <typename T1, typename T2> bool is_equal(grid_2D<T1> const& a, grid_2D<T2> const& b);
+template <typename T1, typename T2, typename Layout> bool is_equal(grid_2D<T1, Layout> const& a, grid_2D<T2, Layout> const& b);
 
 /** Math operators
  * Common mathematical operations between buffers, and scalar or element values. */
-template <typename T> grid_2D<T>& operator+=(grid_2D<T>& a, grid_2D<T> const& b);
-
-template <typename T> grid_2D<T>& operator+=(grid_2D<T>& a, T const& b);
-template <typename T> grid_2D<T>  operator+(grid_2D<T> const& a, grid_2D<T> const& b);
-template <typename T> grid_2D<T>  operator+(grid_2D<T> const& a, T const& b);
-template <typename T> grid_2D<T>  operator+(T const& a, grid_2D<T> const& b);
-
-template <typename T> grid_2D<T>& operator-=(grid_2D<T>& a, grid_2D<T> const& b);
-template <typename T> grid_2D<T>& operator-=(grid_2D<T>& a, T const& b);
-template <typename T> grid_2D<T>  operator-(grid_2D<T> const& a, grid_2D<T> const& b);
-template <typename T> grid_2D<T>  operator-(grid_2D<T> const& a, T const& b);
-template <typename T> grid_2D<T>  operator-(T const& a, grid_2D<T> const& b);
-
-template <typename T> grid_2D<T>& operator*=(grid_2D<T>& a, grid_2D<T> const& b);
-template <typename T> grid_2D<T>& operator*=(grid_2D<T>& a, float b);
-template <typename T> grid_2D<T>  operator*(grid_2D<T> const& a, grid_2D<T> const& b);
-template <typename T> grid_2D<T>  operator*(grid_2D<T> const& a, float b);
-template <typename T> grid_2D<T>  operator*(float a, grid_2D<T> const& b);
-
-template <typename T> grid_2D<T>& operator/=(grid_2D<T>& a, grid_2D<T> const& b);
-template <typename T> grid_2D<T>& operator/=(grid_2D<T>& a, float b);
-template <typename T> grid_2D<T>  operator/(grid_2D<T> const& a, grid_2D<T> const& b);
-template <typename T> grid_2D<T>  operator/(grid_2D<T> const& a, float b);
+template <typename T, typename Layout> grid_2D<T, Layout>& operator+=(grid_2D<T, Layout>& a, grid_2D<T, Layout> const& b);
+
+template <typename T, typename Layout> grid_2D<T, Layout>& operator+=(grid_2D<T, Layout>& a, T const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator+(grid_2D<T, Layout> const& a, grid_2D<T, Layout> const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator+(grid_2D<T, Layout> const& a, T const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator+(T const& a, grid_2D<T, Layout> const& b);
+
+template <typename T, typename Layout> grid_2D<T, Layout>& operator-=(grid_2D<T, Layout>& a, grid_2D<T, Layout> const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>& operator-=(grid_2D<T, Layout>& a, T const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator-(grid_2D<T, Layout> const& a, grid_2D<T, Layout> const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator-(grid_2D<T, Layout> const& a, T const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator-(T const& a, grid_2D<T, Layout> const& b);
+
+template <typename T, typename Layout> grid_2D<T, Layout>& operator*=(grid_2D<T, Layout>& a, grid_2D<T, Layout> const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>& operator*=(grid_2D<T, Layout>& a, float b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator*(grid_2D<T, Layout> const& a, grid_2D<T, Layout> const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator*(grid_2D<T, Layout> const& a, float b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator*(float a, grid_2D<T, Layout> const& b);
+
+template <typename T, typename Layout> grid_2D<T, Layout>& operator/=(grid_2D<T, Layout>& a, grid_2D<T, Layout> const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>& operator/=(grid_2D<T, Layout>& a, float b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator/(grid_2D<T, Layout> const& a, grid_2D<T, Layout> const& b);
+template <typename T, typename Layout> grid_2D<T, Layout>  operator/(grid_2D<T, Layout> const& a, float b);
+
+/** Conversion of a grid_2D into an operand of a lazy expression */
+template <typename T, typename Layout>
+struct numarray_expression_operand<grid_2D<T, Layout> >
+{
+    using type = numarray_expression_leaf<T>;
+    static type convert(grid_2D<T, Layout> const& a) { return type(a.data.data.data(), { a.dimension.x,a.dimension.y,1,Layout::id }); }
+};
 
 
 
@@ -139,79 +162,108 @@ namespace cgp
 
 
 
-template <typename T>
-grid_2D<T>::grid_2D()
+template <typename T, typename Layout>
+grid_2D<T, Layout>::grid_2D()
     :dimension(int2{0,0}),data()
 {}
 
-template <typename T>
-grid_2D<T>::grid_2D(int size)
-    :dimension({size,size}),data(size*size)
+template <typename T, typename Layout>
+grid_2D<T, Layout>::grid_2D(int size)
+    :dimension({size,size}),data(Layout::storage_size(int2{size,size}))
 {
     assert_cgp_no_msg(size>0);
 }
 
-template <typename T>
-grid_2D<T>::grid_2D(int2 const& size)
-    :dimension(size),data(size[0]*size[1])
+template <typename T, typename Layout>
+grid_2D<T, Layout>::grid_2D(int2 const& size)
+    :dimension(size),data(Layout::storage_size(size))
 {
     assert_cgp_no_msg(size[0]>=0 && size[1]>=0);
 }
 
-template <typename T>
-grid_2D<T>::grid_2D(int size_1, int size_2)
-    :dimension({size_1,size_2}),data(size_1*size_2)
+template <typename T, typename Layout>
+grid_2D<T, Layout>::grid_2D(int size_1, int size_2)
+    :dimension({size_1,size_2}),data(Layout::storage_size(int2{size_1,size_2}))
 {
     assert_cgp_no_msg(size_1>=0 && size_2>=0);
 }
 
+template <typename T, typename Layout> template <typename Layout_other>
+grid_2D<T, Layout>::grid_2D(grid_2D<T, Layout_other> const& other)
+    :dimension(other.dimension),data(Layout::storage_size(other.dimension))
+{
+    int const N1 = dimension.x, N2 = dimension.y;
+    for (int k2 = 0; k2 < N2; ++k2)
+        for (int k1 = 0; k1 < N1; ++k1)
+            data.at_unsafe(Layout::offset(k1, k2, dimension)) = other.data.at_unsafe(Layout_other::offset(k1, k2, dimension));
+}
 
+template <typename T, typename Layout> template <typename E>
+grid_2D<T, Layout>::grid_2D(numarray_expression<E> const& expression)
+    :dimension(),data()
+{
+    *this = expression;
+}
 
-template <typename T>
-int grid_2D<T>::size() const
+template <typename T, typename Layout> template <typename E>
+grid_2D<T, Layout>& grid_2D<T, Layout>::operator=(numarray_expression<E> const& expression)
+{
+    numarray_expression_dimension const& d = expression.self().dimension;
+    assert_cgp(d[0]>=0, "An expression must contain at least one container to be evaluated");
+    assert_cgp(d[2]==1, "A grid_2D cannot be assigned a 3D expression");
+    assert_cgp(d[3]==Layout::id, "A grid_2D cannot be assigned an expression on grids stored with another layout");
+    resize(d[0], d[1]);
+    numarray_expression_evaluate(data.data.data(), expression, int(data.size()));
+    return *this;
+}
+
+
+
+template <typename T, typename Layout>
+int grid_2D<T, Layout>::size() const
 {
     return dimension[0]*dimension[1];
 }
 
-template <typename T>
-void grid_2D<T>::clear()
+template <typename T, typename Layout>
+void grid_2D<T, Layout>::clear()
 {
     resize(0, 0);
 }
 
-template <typename T>
-void grid_2D<T>::resize(int size)
+template <typename T, typename Layout>
+void grid_2D<T, Layout>::resize(int size)
 {
     assert_cgp_no_msg(size>=0);
     resize(size,size);
 }
 
-template <typename T>
-void grid_2D<T>::resize(int2 const& size)
+template <typename T, typename Layout>
+void grid_2D<T, Layout>::resize(int2 const& size)
 {
     assert_cgp_no_msg(size[0]>=0 && size[1]>=0);
     dimension = size;
-    data.resize(size[0]*size[1]);
+    data.resize(Layout::storage_size(size));
 }
 
-template <typename T>
-void grid_2D<T>::resize(int size_1, int size_2)
+template <typename T, typename Layout>
+void grid_2D<T, Layout>::resize(int size_1, int size_2)
 {
     assert_cgp_no_msg(size_1>=0 && size_2>=0);
     dimension = {size_1,size_2};
     resize({size_1,size_2});
 }
 
-template <typename T>
-void grid_2D<T>::fill(T const& value)
+template <typename T, typename Layout>
+void grid_2D<T, Layout>::fill(T const& value)
 {
     data.fill(value);
 }
 
 
 #ifndef CGP_NO_DEBUG
-template <typename T>
-void check_index_bounds(int index1, int index2, grid_2D<T> const& data)
+template <typename T, typename Layout>
+void check_index_bounds(int index1, int index2, grid_2D<T, Layout> const& data)
 {
     size_t const N1 = data.dimension.x;
     size_t const N2 = data.dimension.y;
@@ -249,56 +301,56 @@ void check_index_bounds(int index1, int index2, grid_2D<T> const& data)
     }
 }
 #else
-template <typename T>
-void check_index_bounds(int , int , grid_2D<T> const& ) {}
+template <typename T, typename Layout>
+void check_index_bounds(int , int , grid_2D<T, Layout> const& ) {}
 #endif
 
 
 
-template <typename T>
-T const& grid_2D<T>::operator[](int2 const& index) const
+template <typename T, typename Layout>
+T const& grid_2D<T, Layout>::operator[](int2 const& index) const
 {
     check_index_bounds(index.x, index.y, *this);
-    int const idx = offset_grid(index.x, index.y, dimension.x);
+    int const idx = Layout::offset(index.x, index.y, dimension);
     return data[idx];
 }
 
-template <typename T>
-T& grid_2D<T>::operator[](int2 const& index)
+template <typename T, typename Layout>
+T& grid_2D<T, Layout>::operator[](int2 const& index)
 {
     check_index_bounds(index.x, index.y, *this);
-    int const idx = offset_grid(index.x, index.y, dimension.x);
+    int const idx = Layout::offset(index.x, index.y, dimension);
 
     return data[idx];
 }
 
-template <typename T>
-T const& grid_2D<T>::operator()(int2 const& index) const
+template <typename T, typename Layout>
+T const& grid_2D<T, Layout>::operator()(int2 const& index) const
 {
     return (*this)[index];
 }
 
-template <typename T>
-T& grid_2D<T>::operator()(int2 const& index)
+template <typename T, typename Layout>
+T& grid_2D<T, Layout>::operator()(int2 const& index)
 {
     return (*this)[index];
 }
 
 
-template <typename T>
-T const& grid_2D<T>::operator()(int k1, int k2) const
+template <typename T, typename Layout>
+T const& grid_2D<T, Layout>::operator()(int k1, int k2) const
 {
     check_index_bounds(k1, k2, *this);
-    int const idx = offset_grid(k1, k2, dimension.x);
+    int const idx = Layout::offset(k1, k2, dimension);
 
     return data[idx];
 }
 
-template <typename T>
-T& grid_2D<T>::operator()(int k1, int k2)
+template <typename T, typename Layout>
+T& grid_2D<T, Layout>::operator()(int k1, int k2)
 {
     check_index_bounds(k1, k2, *this);
-    int const idx = offset_grid(k1, k2, dimension.x);
+    int const idx = Layout::offset(k1, k2, dimension);
 
     return data[idx];
 }
@@ -306,38 +358,38 @@ T& grid_2D<T>::operator()(int k1, int k2)
 
 
 
-template <typename T>
-typename std::vector<T>::iterator grid_2D<T>::begin()
+template <typename T, typename Layout>
+typename std::vector<T>::iterator grid_2D<T, Layout>::begin()
 {
     return data.begin();
 }
 
-template <typename T>
-typename std::vector<T>::iterator grid_2D<T>::end()
+template <typename T, typename Layout>
+typename std::vector<T>::iterator grid_2D<T, Layout>::end()
 {
     return data.end();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator grid_2D<T>::begin() const
+template <typename T, typename Layout>
+typename std::vector<T>::const_iterator grid_2D<T, Layout>::begin() const
 {
     return data.begin();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator grid_2D<T>::end() const
+template <typename T, typename Layout>
+typename std::vector<T>::const_iterator grid_2D<T, Layout>::end() const
 {
     return data.end();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator grid_2D<T>::cbegin() const
+template <typename T, typename Layout>
+typename std::vector<T>::const_iterator grid_2D<T, Layout>::cbegin() const
 {
     return data.cbegin();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator grid_2D<T>::cend() const
+template <typename T, typename Layout>
+typename std::vector<T>::const_iterator grid_2D<T, Layout>::cend() const
 {
     return data.cend();
 }
@@ -351,170 +403,163 @@ typename std::vector<T>::const_iterator grid_2D<T>::cend() const
 
 
 
-template <typename T> std::string type_str(grid_2D<T> const&)
+template <typename T, typename Layout> std::string type_str(grid_2D<T, Layout> const&)
 {
-    return "grid_2D<" + type_str(T()) + ">";
+    std::string const layout = Layout::name();
+    return "grid_2D<" + type_str(T()) + (layout.empty() ? "" : ", " + layout) + ">";
 }
 
 
-template <typename T1, typename T2> bool is_equal(grid_2D<T1> const& a, grid_2D<T2> const& b)
+template <typename T1, typename T2, typename Layout> bool is_equal(grid_2D<T1, Layout> const& a, grid_2D<T2, Layout> const& b)
 {
     if (is_equal(a.dimension, b.dimension)==false)
         return false;
-    return is_equal(a.data, b.data);
+    if (Layout::storage_size(a.dimension) == a.size())
+        return is_equal(a.data, b.data);
+
+    // The padding elements of the storage are not compared
+    for (int k2 = 0; k2 < a.dimension.y; ++k2)
+        for (int k1 = 0; k1 < a.dimension.x; ++k1)
+            if (is_equal(a(k1, k2), b(k1, k2)) == false)
+                return false;
+    return true;
 }
 
 
 
 
-template <typename T> std::ostream& operator<<(std::ostream& s, grid_2D<T> const& v)
+template <typename T, typename Layout> std::ostream& operator<<(std::ostream& s, grid_2D<T, Layout> const& v)
 {
     return s << v.data;
 }
-template <typename T> std::string str(grid_2D<T> const& v, std::string const& separator, std::string const& begin, std::string const& end)
+template <typename T, typename Layout> std::string str(grid_2D<T, Layout> const& v, std::string const& separator, std::string const& begin, std::string const& end)
 {
     return to_string(v.data, separator, begin, end);
 }
 
 
-template <typename T> grid_2D<T>& operator+=(grid_2D<T>& a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>& operator+=(grid_2D<T, Layout>& a, grid_2D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
     a.data += b.data;
+    return a;
 }
-template <typename T> grid_2D<T>& operator+=(grid_2D<T>& a, T const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>& operator+=(grid_2D<T, Layout>& a, T const& b)
 {
     a.data += b;
     return a;
 }
-template <typename T> grid_2D<T>  operator+(grid_2D<T> const& a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator+(grid_2D<T, Layout> const& a, grid_2D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
-    grid_2D<T> res(a.dimension);
-    res.data = a.data+b.data;
-    return res;
-
+    return lazy(a) + b;
 }
-template <typename T> grid_2D<T>  operator+(grid_2D<T> const& a, T const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator+(grid_2D<T, Layout> const& a, T const& b)
 {
-    grid_2D<T> res(a.dimension);
-    res.data = a.data+b;
-    return res;
+    return lazy(a) + b;
 }
-template <typename T> grid_2D<T>  operator+(T const& a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator+(T const& a, grid_2D<T, Layout> const& b)
 {
-    grid_2D<T> res(b.dimension);
-    res.data = a + b.data;
-    return res;
+    return lazy(a) + b;
 }
 
-template <typename T> grid_2D<T>& operator-=(grid_2D<T>& a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>& operator-=(grid_2D<T, Layout>& a, grid_2D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
     a.data -= b.data;
+    return a;
 }
-template <typename T> grid_2D<T>& operator-=(grid_2D<T>& a, T const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>& operator-=(grid_2D<T, Layout>& a, T const& b)
 {
     a.data -= b;
     return a;
 }
-template <typename T> grid_2D<T>  operator-(grid_2D<T> const& a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator-(grid_2D<T, Layout> const& a, grid_2D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
-    grid_2D<T> res(a.dimension);
-    res.data = a.data-b.data;
-    return res;
+    return lazy(a) - b;
 }
-template <typename T> grid_2D<T>  operator-(grid_2D<T> const& a, T const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator-(grid_2D<T, Layout> const& a, T const& b)
 {
-    grid_2D<T> res(a.dimension);
-    res.data = a.data-b;
-    return res;
+    return lazy(a) - b;
 }
-template <typename T> grid_2D<T>  operator-(T const& a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator-(T const& a, grid_2D<T, Layout> const& b)
 {
-    grid_2D<T> res(a.dimension);
-    res.data = a-b.data;
-    return res;
+    return lazy(a) - b;
 }
 
-template <typename T> grid_2D<T>& operator*=(grid_2D<T>& a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>& operator*=(grid_2D<T, Layout>& a, grid_2D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
     a.data *= b.data;
+    return a;
 }
-template <typename T> grid_2D<T>& operator*=(grid_2D<T>& a, float b)
+template <typename T, typename Layout> grid_2D<T, Layout>& operator*=(grid_2D<T, Layout>& a, float b)
 {
     a.data *= b;
     return a;
 }
-template <typename T> grid_2D<T>  operator*(grid_2D<T> const& a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator*(grid_2D<T, Layout> const& a, grid_2D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
-    grid_2D<T> res(a.dimension);
-    res.data = a.data*b.data;
-    return res;
+    return lazy(a) * b;
 }
-template <typename T> grid_2D<T>  operator*(grid_2D<T> const& a, float b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator*(grid_2D<T, Layout> const& a, float b)
 {
-    grid_2D<T> res(a.dimension);
-    res.data = a.data*b;
-    return res;
+    return lazy(a) * b;
 }
-template <typename T> grid_2D<T>  operator*(float a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator*(float a, grid_2D<T, Layout> const& b)
 {
-    grid_2D<T> res(b.dimension);
-    res.data = a*b.data;
-    return res;
+    return lazy(a) * b;
 }
 
-template <typename T> grid_2D<T>& operator/=(grid_2D<T>& a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>& operator/=(grid_2D<T, Layout>& a, grid_2D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
     a.data /= b.data;
     return a;
 }
-template <typename T> grid_2D<T>& operator/=(grid_2D<T>& a, float b)
+template <typename T, typename Layout> grid_2D<T, Layout>& operator/=(grid_2D<T, Layout>& a, float b)
 {
     a.data /= b;
     return a;
 }
-template <typename T> grid_2D<T>  operator/(grid_2D<T> const& a, grid_2D<T> const& b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator/(grid_2D<T, Layout> const& a, grid_2D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
-    grid_2D<T> res(a.dimension);
-    res.data = a.data/b.data;
-    return res;
+    return lazy(a) / b;
 }
-template <typename T> grid_2D<T>  operator/(grid_2D<T> const& a, float b)
+template <typename T, typename Layout> grid_2D<T, Layout>  operator/(grid_2D<T, Layout> const& a, float b)
 {
-    grid_2D<T> res(a.dimension);
-    res.data = a.data/b;
-    return res;
+    return lazy(a) / b;
 }
 
 
-template <typename T>
-grid_2D<T> grid_2D<T>::from_buffer(numarray<T> const& arg, int size_1, int size_2)
+template <typename T, typename Layout>
+grid_2D<T, Layout> grid_2D<T, Layout>::from_buffer(numarray<T> const& arg, int size_1, int size_2)
 {
-    assert_cgp(arg.size()==size_1*size_2, "Incoherent size to generate grid_2D");
+    assert_cgp(int(arg.size())==Layout::storage_size(int2{size_1,size_2}), "Incoherent size to generate grid_2D");
 
-    grid_2D<T> b(size_1, size_2);
+    grid_2D<T, Layout> b(size_1, size_2);
     b.data = arg;
 
     return b;
 }
 
-template <typename T>
-int grid_2D<T>::index_to_offset(int k1, int k2) const
+template <typename T, typename Layout>
+int grid_2D<T, Layout>::index_to_offset(int k1, int k2) const
+{
+    return Layout::offset(k1, k2, dimension);
+}
+template <typename T, typename Layout>
+int2 grid_2D<T, Layout>::offset_to_index(int offset) const
 {
-    return offset_grid(k1,k2,dimension.x);
+    return Layout::index(offset, dimension);
 }
-template <typename T>
-int2 grid_2D<T>::offset_to_index(int offset) const
+template <typename T, typename Layout>
+int2 grid_2D<T, Layout>::index_to_stride(int k1, int k2) const
 {
-    int2 idx = index_grid_from_offset(offset,dimension.x);
-    return {idx.x, idx.y};
+    return Layout::stride(k1, k2, dimension);
 }
 
 
@@ -3,6 +3,7 @@
 #include "cgp/01_base/base.hpp"
 #include "cgp/02_numarray/numarray.hpp"
 #include "../../offset_grid/offset_grid.hpp"
+#include "../../grid_layout/grid_layout.hpp"
 
 
 /* ************************************************** */
@@ -16,8 +17,12 @@ namespace cgp
 *
 * The grid_3D structure provide convenient access for 3D-grid organization where an element can be queried as grid_3D(i,j).
 * Elements of grid_3D are stored contiguously in heap memory and remain fully compatible with std::vector and pointers.
+* The order of the elements in the storage is given by the Layout (see grid_layout.hpp): linear by default (k1 + N1*(k2 + N2*k3)),
+*  or grid_layout_tiled<B> to store the grid as bricks of B^3 elements, where the neighbors of an element are close in memory.
+*  The iterators, data, and from_array follow the storage order, which has Layout::storage_size(dimension) elements
+*  (more than size() for a tiled grid whose dimensions are not multiples of B).
 **/
-template <typename T>
+template <typename T, typename Layout = grid_layout_linear>
 struct grid_3D
 {
     /** 3D dimension (Nx,Ny,Nz) of the container */
@@ -31,9 +36,18 @@ struct grid_3D
     grid_3D(int3 const& size); // Generate a grid of dimension size.x size.y size.z
     grid_3D(int size_1, int size_2, int size_3); // Generate a grid of dimension size_1 x size_2 x size_3
 
+    /** Copy of a grid stored with another layout (conversion to/from the linear layout) */
+    template <typename Layout_other> explicit grid_3D(grid_3D<T, Layout_other> const& other);
+
+    /** Evaluation of a lazy expression in a single loop (see numarray_expression.hpp)
+    * The grids of the expression must have the same layout as this one. */
+    template <typename E> grid_3D(numarray_expression<E> const& expression);
+    template <typename E> grid_3D<T, Layout>& operator=(numarray_expression<E> const& expression);
+
     /** Direct build a grid_3D from a given 1D-buffer and its 3D-dimension
-    * \note: the size of the 3D-buffer must satisfy arg.size = size_1 * size_2 * size_3 */
-    static grid_3D<T> from_array(numarray<T> const& arg, int size_1, int size_2, int size_3);
+    * \note: the size of the buffer must satisfy arg.size = Layout::storage_size({size_1, size_2, size_3}) (size_1 * size_2 * size_3 for the linear layout)
+    * \note: the buffer is in the storage order of the Layout */
+    static grid_3D<T, Layout> from_array(numarray<T> const& arg, int size_1, int size_2, int size_3);
 
     /** Remove all elements from the grid_2D */
     void clear();
@@ -60,6 +74,9 @@ struct grid_3D
     int index_to_offset(int k1, int k2, int k3) const;
     int index_to_offset(int3 const& index) const;
     int3 offset_to_index(int offset) const;
+    /** Offsets from the element (k1,k2,k3) to (k1+1,k2,k3), (k1,k2+1,k3) and (k1,k2,k3+1)
+    * The offset of (k1+a,k2+b,k3+c), a,b,c in {0,1}, is index_to_offset(k1,k2,k3) + a*stride.x + b*stride.y + c*stride.z */
+    int3 index_to_stride(int k1, int k2, int k3) const;
 
     typename std::vector<T>::iterator begin();
     typename std::vector<T>::iterator end();
@@ -75,35 +92,43 @@ struct grid_3D
 
 };
 
-template <typename T> std::string type_str(grid_3D<T> const&);
-template <typename T1, typename T2> bool is_equal(grid_3D<T1> const& a, grid_3D<T2> const& b);
-
-template <typename T> std::ostream& operator<<(std::ostream& s, grid_3D<T> const& v);
-template <typename T> std::string str(grid_3D<T> const& v, std::string const& separator=" ", std::string const& begin="", std::string const& end="");
-
-template <typename T> grid_3D<T>& operator+=(grid_3D<T>& a, grid_3D<T> const& b);
-template <typename T> grid_3D<T>& operator+=(grid_3D<T>& a, T const& b);
-template <typename T> grid_3D<T>  operator+(grid_3D<T> const& a, grid_3D<T> const& b);
-template <typename T> grid_3D<T>  operator+(grid_3D<T> const& a, T const& b);
-template <typename T> grid_3D<T>  operator+(T const& a, grid_3D<T> const& b);
-
-template <typename T> grid_3D<T>& operator-=(grid_3D<T>& a, grid_3D<T> const& b);
-template <typename T> grid_3D<T>& operator-=(grid_3D<T>& a, T const& b);
-template <typename T> grid_3D<T>  operator-(grid_3D<T> const& a, grid_3D<T> const& b);
-template <typename T> grid_3D<T>  operator-(grid_3D<T> const& a, T const& b);
-template <typename T> grid_3D<T>  operator-(T const& a, grid_3D<T> const& b);
-
-template <typename T> grid_3D<T>& operator*=(grid_3D<T>& a, grid_3D<T> const& b);
-template <typename T> grid_3D<T>& operator*=(grid_3D<T>& a, float b);
-template <typename T> grid_3D<T>  operator*(grid_3D<T> const& a, grid_3D<T> const& b);
-template <typename T> grid_3D<T>  operator*(grid_3D<T> const& a, float b);
-template <typename T> grid_3D<T>  operator*(float a, grid_3D<T> const& b);
-
-template <typename T> grid_3D<T>& operator/=(grid_3D<T>& a, grid_3D<T> const& b);
-template <typename T> grid_3D<T>& operator/=(grid_3D<T>& a, float b);
-template <typename T> grid_3D<T>  operator/(grid_3D<T> const& a, grid_3D<T> const& b);
-template <typename T> grid_3D<T>  operator/(grid_3D<T> const& a, float b);
-template <typename T> grid_3D<T>  operator/(float a, grid_3D<T> const& b);
+template <typename T, typename Layout> std::string type_str(grid_3D<T, Layout> const&);
+template <typename T1, typename T2, typename Layout> bool is_equal(grid_3D<T1, Layout> const& a, grid_3D<T2, Layout> const& b);
+
+template <typename T, typename Layout> std::ostream& operator<<(std::ostream& s, grid_3D<T, Layout> const& v);
+template <typename T, typename Layout> std::string str(grid_3D<T, Layout> const& v, std::string const& separator=" ", std::string const& begin="", std::string const& end="");
+
+template <typename T, typename Layout> grid_3D<T, Layout>& operator+=(grid_3D<T, Layout>& a, grid_3D<T, Layout> const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>& operator+=(grid_3D<T, Layout>& a, T const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator+(grid_3D<T, Layout> const& a, grid_3D<T, Layout> const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator+(grid_3D<T, Layout> const& a, T const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator+(T const& a, grid_3D<T, Layout> const& b);
+
+template <typename T, typename Layout> grid_3D<T, Layout>& operator-=(grid_3D<T, Layout>& a, grid_3D<T, Layout> const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>& operator-=(grid_3D<T, Layout>& a, T const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator-(grid_3D<T, Layout> const& a, grid_3D<T, Layout> const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator-(grid_3D<T, Layout> const& a, T const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator-(T const& a, grid_3D<T, Layout> const& b);
+
+template <typename T, typename Layout> grid_3D<T, Layout>& operator*=(grid_3D<T, Layout>& a, grid_3D<T, Layout> const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>& operator*=(grid_3D<T, Layout>& a, float b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator*(grid_3D<T, Layout> const& a, grid_3D<T, Layout> const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator*(grid_3D<T, Layout> const& a, float b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator*(float a, grid_3D<T, Layout> const& b);
+
+template <typename T, typename Layout> grid_3D<T, Layout>& operator/=(grid_3D<T, Layout>& a, grid_3D<T, Layout> const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>& operator/=(grid_3D<T, Layout>& a, float b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator/(grid_3D<T, Layout> const& a, grid_3D<T, Layout> const& b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator/(grid_3D<T, Layout> const& a, float b);
+template <typename T, typename Layout> grid_3D<T, Layout>  operator/(float a, grid_3D<T, Layout> const& b);
+
+/** Conversion of a grid_3D into an operand of a lazy expression */
+template <typename T, typename Layout>
+struct numarray_expression_operand<grid_3D<T, Layout> >
+{
+    using type = numarray_expression_leaf<T>;
+    static type convert(grid_3D<T, Layout> const& a) { return type(a.data.data.data(), { a.dimension.x,a.dimension.y,a.dimension.z,Layout::id }); }
+};
 
 }
 
@@ -117,88 +142,117 @@ namespace cgp
 {
 
 
-template <typename T>
-grid_3D<T>::grid_3D()
+template <typename T, typename Layout>
+grid_3D<T, Layout>::grid_3D()
     :dimension(int3{0,0,0}),data()
 {}
 
-template <typename T>
-grid_3D<T>::grid_3D(int size)
-    :dimension({size,size,size}),data(size*size*size)
+template <typename T, typename Layout>
+grid_3D<T, Layout>::grid_3D(int size)
+    :dimension({size,size,size}),data(Layout::storage_size(int3{size,size,size}))
 {
     assert_cgp_no_msg(size>=0);
 }
 
-template <typename T>
-grid_3D<T>::grid_3D(int3 const& size)
-    :dimension(size),data(size[0]*size[1]*size[2])
+template <typename T, typename Layout>
+grid_3D<T, Layout>::grid_3D(int3 const& size)
+    :dimension(size),data(Layout::storage_size(size))
 {
     assert_cgp_no_msg(size[0]>=0 && size[1]>=0 && size[2]>=0);
 }
 
-template <typename T>
-grid_3D<T>::grid_3D(int size_1, int size_2, int size_3)
-    :dimension({size_1,size_2, size_3}),data(size_1*size_2*size_3)
+template <typename T, typename Layout>
+grid_3D<T, Layout>::grid_3D(int size_1, int size_2, int size_3)
+    :dimension({size_1,size_2, size_3}),data(Layout::storage_size(int3{size_1,size_2,size_3}))
 {
     assert_cgp_no_msg(size_1>=0 && size_2>=0 && size_3>=0);
 }
 
-template <typename T>
-int grid_3D<T>::size() const
+template <typename T, typename Layout> template <typename Layout_other>
+grid_3D<T, Layout>::grid_3D(grid_3D<T, Layout_other> const& other)
+    :dimension(other.dimension),data(Layout::storage_size(other.dimension))
+{
+    int const N1 = dimension.x, N2 = dimension.y, N3 = dimension.z;
+    for (int k3 = 0; k3 < N3; ++k3)
+        for (int k2 = 0; k2 < N2; ++k2)
+            for (int k1 = 0; k1 < N1; ++k1)
+                data.at_unsafe(Layout::offset(k1, k2, k3, dimension)) = other.data.at_unsafe(Layout_other::offset(k1, k2, k3, dimension));
+}
+
+template <typename T, typename Layout> template <typename E>
+grid_3D<T, Layout>::grid_3D(numarray_expression<E> const& expression)
+    :dimension(),data()
+{
+    *this = expression;
+}
+
+template <typename T, typename Layout> template <typename E>
+grid_3D<T, Layout>& grid_3D<T, Layout>::operator=(numarray_expression<E> const& expression)
+{
+    numarray_expression_dimension const& d = expression.self().dimension;
+    assert_cgp(d[0]>=0, "An expression must contain at least one container to be evaluated");
+    assert_cgp(d[3]==Layout::id, "A grid_3D cannot be assigned an expression on grids stored with another layout");
+    resize(d[0], d[1], d[2]);
+    numarray_expression_evaluate(data.data.data(), expression, int(data.size()));
+    return *this;
+}
+
+template <typename T, typename Layout>
+int grid_3D<T, Layout>::size() const
 {
     return dimension[0]*dimension[1]*dimension[2];
 }
 
-template <typename T>
-void grid_3D<T>::resize(int size)
+template <typename T, typename Layout>
+void grid_3D<T, Layout>::resize(int size)
 {
     assert_cgp_no_msg(size>=0);
     resize(size,size,size);
 }
 
-template <typename T>
-void grid_3D<T>::resize(int3 const& size)
+template <typename T, typename Layout>
+void grid_3D<T, Layout>::resize(int3 const& size)
 {
     assert_cgp_no_msg(size[0]>=0 && size[1]>=0 && size[2]>=0);
     dimension = size;
-    data.resize(size[0]*size[1]*size[2]);
+    data.resize(Layout::storage_size(size));
 }
 
-template <typename T>
-void grid_3D<T>::resize(int size_1, int size_2, int size_3)
+template <typename T, typename Layout>
+void grid_3D<T, Layout>::resize(int size_1, int size_2, int size_3)
 {
     assert_cgp_no_msg(size_1>=0 && size_2>=0 && size_3>=0);
     dimension = {size_1, size_2, size_3};
     resize({size_1, size_2, size_3});
 }
 
-template <typename T>
-void grid_3D<T>::fill(T const& value)
+template <typename T, typename Layout>
+void grid_3D<T, Layout>::fill(T const& value)
 {
     data.fill(value);
 }
 
 
-template <typename T>
-grid_3D<T> grid_3D<T>::from_array(numarray<T> const& arg, int size_1, int size_2, int size_3)
+template <typename T, typename Layout>
+grid_3D<T, Layout> grid_3D<T, Layout>::from_array(numarray<T> const& arg, int size_1, int size_2, int size_3)
 {
-    assert_cgp(arg.size()==size_1*size_2*size_3, "Incoherent size to generate grid_2D");
+    assert_cgp(int(arg.size())==Layout::storage_size(int3{size_1,size_2,size_3}), "Incoherent size to generate grid_3D");
 
-    grid_3D<T> b(size_1, size_2, size_3);
+    grid_3D<T, Layout> b(size_1, size_2, size_3);
     b.data = arg;
 
     return b;
 }
 
-template <typename T>
-void grid_3D<T>::clear()
+template <typename T, typename Layout>
+void grid_3D<T, Layout>::clear()
 {
     data.clear();
 }
 
 
-template <typename T>
-static void check_index_bounds(int index1, int index2, int index3, grid_3D<T> const& data)
+template <typename T, typename Layout>
+static void check_index_bounds(int index1, int index2, int index3, grid_3D<T, Layout> const& data)
 {
 #ifndef cgp_NO_DEBUG
     int const N1 = data.dimension.x;
@@ -240,95 +294,100 @@ static void check_index_bounds(int index1, int index2, int index3, grid_3D<T> co
 }
 
 
-template <typename T> T const& grid_3D<T>::operator[](int3 const& index) const
+template <typename T, typename Layout> T const& grid_3D<T, Layout>::operator[](int3 const& index) const
 {
     check_index_bounds(index.x, index.y, index.z, *this);
-    int const  idx = offset_grid(index.x, index.y, index.z, dimension.x, dimension.y);
+    int const  idx = Layout::offset(index.x, index.y, index.z, dimension);
     return data[idx];
 }
-template <typename T> T& grid_3D<T>::operator[](int3 const& index)
+template <typename T, typename Layout> T& grid_3D<T, Layout>::operator[](int3 const& index)
 {
     check_index_bounds(index.x, index.y, index.z, *this);
-    int const  idx = offset_grid(index.x, index.y, index.z, dimension.x, dimension.y);
+    int const  idx = Layout::offset(index.x, index.y, index.z, dimension);
     return data[idx];
 }
-template <typename T> T const& grid_3D<T>::operator()(int3 const& index) const
+template <typename T, typename Layout> T const& grid_3D<T, Layout>::operator()(int3 const& index) const
 {
     check_index_bounds(index.x, index.y, index.z, *this);
-    int const  idx = offset_grid(index.x, index.y, index.z, dimension.x, dimension.y);
+    int const  idx = Layout::offset(index.x, index.y, index.z, dimension);
     return data[idx];
 }
-template <typename T> T& grid_3D<T>::operator()(int3 const& index)
+template <typename T, typename Layout> T& grid_3D<T, Layout>::operator()(int3 const& index)
 {
     check_index_bounds(index.x, index.y, index.z, *this);
-    int const  idx = offset_grid(index.x, index.y, index.z, dimension.x, dimension.y);
+    int const  idx = Layout::offset(index.x, index.y, index.z, dimension);
     return data[idx];
 }
-template <typename T> T const& grid_3D<T>::operator()(int k1, int k2, int k3) const
+template <typename T, typename Layout> T const& grid_3D<T, Layout>::operator()(int k1, int k2, int k3) const
 {
     check_index_bounds(k1, k2, k3, *this);
-    int const  idx = offset_grid(k1, k2, k3, dimension.x, dimension.y);
+    int const  idx = Layout::offset(k1, k2, k3, dimension);
     return data[idx];
 }
-template <typename T> T& grid_3D<T>::operator()(int k1, int k2, int k3)
+template <typename T, typename Layout> T& grid_3D<T, Layout>::operator()(int k1, int k2, int k3)
 {
     check_index_bounds(k1, k2, k3, *this);
-    int const  idx = offset_grid(k1, k2, k3, dimension.x, dimension.y);
+    int const  idx = Layout::offset(k1, k2, k3, dimension);
     return data[idx];
 }
 
 
 
-template <typename T>
-typename std::vector<T>::iterator grid_3D<T>::begin()
+template <typename T, typename Layout>
+typename std::vector<T>::iterator grid_3D<T, Layout>::begin()
 {
     return data.begin();
 }
 
-template <typename T>
-typename std::vector<T>::iterator grid_3D<T>::end()
+template <typename T, typename Layout>
+typename std::vector<T>::iterator grid_3D<T, Layout>::end()
 {
     return data.end();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator grid_3D<T>::begin() const
+template <typename T, typename Layout>
+typename std::vector<T>::const_iterator grid_3D<T, Layout>::begin() const
 {
     return data.begin();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator grid_3D<T>::end() const
+template <typename T, typename Layout>
+typename std::vector<T>::const_iterator grid_3D<T, Layout>::end() const
 {
     return data.end();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator grid_3D<T>::cbegin() const
+template <typename T, typename Layout>
+typename std::vector<T>::const_iterator grid_3D<T, Layout>::cbegin() const
 {
     return data.cbegin();
 }
 
-template <typename T>
-typename std::vector<T>::const_iterator grid_3D<T>::cend() const
+template <typename T, typename Layout>
+typename std::vector<T>::const_iterator grid_3D<T, Layout>::cend() const
 {
     return data.cend();
 }
 
-template <typename T>
-int grid_3D<T>::index_to_offset(int k1, int k2, int k3) const
+template <typename T, typename Layout>
+int grid_3D<T, Layout>::index_to_offset(int k1, int k2, int k3) const
 {
-    return offset_grid(k1, k2, k3, dimension.x, dimension.y);
+    return Layout::offset(k1, k2, k3, dimension);
 }
-template <typename T>
-int grid_3D<T>::index_to_offset(int3 const& index) const
+template <typename T, typename Layout>
+int grid_3D<T, Layout>::index_to_offset(int3 const& index) const
 {
-    return offset_grid(index, dimension.x, dimension.y);
+    return Layout::offset(index.x, index.y, index.z, dimension);
 }
-template <typename T>
-int3 grid_3D<T>::offset_to_index(int offset) const
+template <typename T, typename Layout>
+int3 grid_3D<T, Layout>::offset_to_index(int offset) const
 {
-    return index_grid_from_offset(offset, dimension.x, dimension.y);
+    return Layout::index(offset, dimension);
+}
+template <typename T, typename Layout>
+int3 grid_3D<T, Layout>::index_to_stride(int k1, int k2, int k3) const
+{
+    return Layout::stride(k1, k2, k3, dimension);
 }
 
 
@@ -338,180 +397,166 @@ int3 grid_3D<T>::offset_to_index(int offset) const
 
 
 
-template <typename T> std::string type_str(grid_3D<T> const&)
+template <typename T, typename Layout> std::string type_str(grid_3D<T, Layout> const&)
 {
-    return "grid_3D<" + type_str(T()) + ">";
+    std::string const layout = Layout::name();
+    return "grid_3D<" + type_str(T()) + (layout.empty() ? "" : ", " + layout) + ">";
 }
 
-template <typename T1, typename T2> bool is_equal(grid_3D<T1> const& a, grid_3D<T2> const& b)
+template <typename T1, typename T2, typename Layout> bool is_equal(grid_3D<T1, Layout> const& a, grid_3D<T2, Layout> const& b)
 {
     if (is_equal(a.dimension, b.dimension) == false)
         return false;
-    return is_equal(a.data, b.data);
+    if (Layout::storage_size(a.dimension) == a.size())
+        return is_equal(a.data, b.data);
+
+    // The padding elements of the storage are not compared
+    for (int k3 = 0; k3 < a.dimension.z; ++k3)
+        for (int k2 = 0; k2 < a.dimension.y; ++k2)
+            for (int k1 = 0; k1 < a.dimension.x; ++k1)
+                if (is_equal(a.at_unsafe(k1, k2, k3), b.at_unsafe(k1, k2, k3)) == false)
+                    return false;
+    return true;
 }
 
 
-template <typename T> std::ostream& operator<<(std::ostream& s, grid_3D<T> const& v)
+template <typename T, typename Layout> std::ostream& operator<<(std::ostream& s, grid_3D<T, Layout> const& v)
 {
     return s << v.data;
 }
-template <typename T> std::string str(grid_3D<T> const& v, std::string const& separator, std::string const& begin, std::string const& end)
+template <typename T, typename Layout> std::string str(grid_3D<T, Layout> const& v, std::string const& separator, std::string const& begin, std::string const& end)
 {
     return str(v.data, separator, begin, end);
 }
 
 
-template <typename T> grid_3D<T>& operator+=(grid_3D<T>& a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>& operator+=(grid_3D<T, Layout>& a, grid_3D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
     a.data += b.data;
+    return a;
 }
-template <typename T> grid_3D<T>& operator+=(grid_3D<T>& a, T const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>& operator+=(grid_3D<T, Layout>& a, T const& b)
 {
     a.data += b;
     return a;
 }
-template <typename T> grid_3D<T>  operator+(grid_3D<T> const& a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator+(grid_3D<T, Layout> const& a, grid_3D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
-    grid_3D<T> res(a.dimension);
-    res.data = a.data+b.data;
-    return res;
-
+    return lazy(a) + b;
 }
-template <typename T> grid_3D<T>  operator+(grid_3D<T> const& a, T const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator+(grid_3D<T, Layout> const& a, T const& b)
 {
-    grid_3D<T> res(a.dimension);
-    res.data = a.data+b;
-    return res;
+    return lazy(a) + b;
 }
-template <typename T> grid_3D<T>  operator+(T const& a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator+(T const& a, grid_3D<T, Layout> const& b)
 {
-    grid_3D<T> res(b.dimension);
-    res.data = a + b.data;
-    return res;
+    return lazy(a) + b;
 }
 
-template <typename T> grid_3D<T>& operator-=(grid_3D<T>& a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>& operator-=(grid_3D<T, Layout>& a, grid_3D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
     a.data -= b.data;
     return a;
 }
-template <typename T> grid_3D<T>& operator-=(grid_3D<T>& a, T const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>& operator-=(grid_3D<T, Layout>& a, T const& b)
 {
     a.data -= b;
     return a;
 }
-template <typename T> grid_3D<T>  operator-(grid_3D<T> const& a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator-(grid_3D<T, Layout> const& a, grid_3D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
-    grid_3D<T> res(a.dimension);
-    res.data = a.data-b.data;
-    return res;
+    return lazy(a) - b;
 }
-template <typename T> grid_3D<T>  operator-(grid_3D<T> const& a, T const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator-(grid_3D<T, Layout> const& a, T const& b)
 {
-    grid_3D<T> res(a.dimension);
-    res.data = a.data-b;
-    return res;
+    return lazy(a) - b;
 }
-template <typename T> grid_3D<T>  operator-(T const& a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator-(T const& a, grid_3D<T, Layout> const& b)
 {
-    grid_3D<T> res(a.dimension);
-    res.data = a-b.data;
-    return res;
+    return lazy(a) - b;
 }
 
-template <typename T> grid_3D<T>& operator*=(grid_3D<T>& a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>& operator*=(grid_3D<T, Layout>& a, grid_3D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
     a.data *= b.data;
     return a;
 }
-template <typename T> grid_3D<T>& operator*=(grid_3D<T>& a, float b)
+template <typename T, typename Layout> grid_3D<T, Layout>& operator*=(grid_3D<T, Layout>& a, float b)
 {
     a.data *= b;
     return a;
 }
-template <typename T> grid_3D<T>  operator*(grid_3D<T> const& a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator*(grid_3D<T, Layout> const& a, grid_3D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
-    grid_3D<T> res(a.dimension);
-    res.data = a.data*b.data;
-    return res;
+    return lazy(a) * b;
 }
-template <typename T> grid_3D<T>  operator*(grid_3D<T> const& a, float b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator*(grid_3D<T, Layout> const& a, float b)
 {
-    grid_3D<T> res(a.dimension);
-    res.data = a.data*b;
-    return res;
+    return lazy(a) * b;
 }
-template <typename T> grid_3D<T>  operator*(float a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator*(float a, grid_3D<T, Layout> const& b)
 {
-    grid_3D<T> res(b.dimension);
-    res.data = a*b.data;
-    return res;
+    return lazy(a) * b;
 }
 
-template <typename T> grid_3D<T>& operator/=(grid_3D<T>& a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>& operator/=(grid_3D<T, Layout>& a, grid_3D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
     a.data /= b.data;
     return a;
 }
-template <typename T> grid_3D<T>& operator/=(grid_3D<T>& a, float b)
+template <typename T, typename Layout> grid_3D<T, Layout>& operator/=(grid_3D<T, Layout>& a, float b)
 {
     a.data /= b;
     return a;
 }
-template <typename T> grid_3D<T>  operator/(grid_3D<T> const& a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator/(grid_3D<T, Layout> const& a, grid_3D<T, Layout> const& b)
 {
     assert_cgp( is_equal(a.dimension,b.dimension), "Dimension do not agree: a:"+str(a.dimension)+", b:"+str(b.dimension) );
-    grid_3D<T> res(a.dimension);
-    res.data = a.data/b.data;
-    return res;
+    return lazy(a) / b;
 }
-template <typename T> grid_3D<T>  operator/(grid_3D<T> const& a, float b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator/(grid_3D<T, Layout> const& a, float b)
 {
-    grid_3D<T> res(a.dimension);
-    res.data = a.data/b;
-    return res;
+    return lazy(a) / b;
 }
-template <typename T> grid_3D<T>  operator/(float a, grid_3D<T> const& b)
+template <typename T, typename Layout> grid_3D<T, Layout>  operator/(float a, grid_3D<T, Layout> const& b)
 {
-    grid_3D<T> res(b.dimension);
-    res.data = a/b.data;
-    return res;
+    return lazy(a) / b;
 }
 
 
 
 
 
-template <typename T>
-T const& grid_3D<T>::at_unsafe(int index) const
+template <typename T, typename Layout>
+T const& grid_3D<T, Layout>::at_unsafe(int index) const
 {
     return data.at_unsafe(index);
 }
 
 
-template <typename T>
-T & grid_3D<T>::at_unsafe(int index)
+template <typename T, typename Layout>
+T & grid_3D<T, Layout>::at_unsafe(int index)
 {
     return data.at_unsafe(index);
 }
 
-template <typename T>
-T const& grid_3D<T>::at_unsafe(int index1, int index2, int index3) const
+template <typename T, typename Layout>
+T const& grid_3D<T, Layout>::at_unsafe(int index1, int index2, int index3) const
 {
-    return data.at_unsafe(offset_grid(index1, index2, index3, dimension.x, dimension.y));
+    return data.at_unsafe(Layout::offset(index1, index2, index3, dimension));
 }
 
-template <typename T>
-T & grid_3D<T>::at_unsafe(int index1, int index2, int index3)
+template <typename T, typename Layout>
+T & grid_3D<T, Layout>::at_unsafe(int index1, int index2, int index3)
 {
-    return data.at_unsafe(offset_grid(index1, index2, index3, dimension.x, dimension.y));
+    return data.at_unsafe(Layout::offset(index1, index2, index3, dimension));
 }
 
 }
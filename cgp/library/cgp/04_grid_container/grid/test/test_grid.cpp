@@ -62,7 +62,43 @@ namespace cgp_test {
 			assert_cgp_no_msg(is_equal(a + b, c));
 		}
 
-
+		{
+			// Tiled layout: same indexing as the linear one, dimensions that are not a multiple of the brick size
+			cgp::grid_2D<int> a(11, 6);
+			for (int k = 0; k < a.size(); ++k)
+				a.data[k] = k;
+			cgp::grid_2D<int, cgp::grid_layout_tiled<4> > t(a);
+			assert_cgp_no_msg(type_str(t) == "grid_2D<int, tiled<4>>");
+			assert_cgp_no_msg(t.data.size() == 3 * 2 * 16); // 3x2 bricks of 4x4 elements, the ones on the upper boundaries are padded
+			for (int k2 = 0; k2 < 6; ++k2)
+				for (int k1 = 0; k1 < 11; ++k1)
+					assert_cgp_no_msg(t(k1, k2) == a(k1, k2));
+
+			// The first brick is stored first
+			assert_cgp_no_msg(t.data[1] == a(1, 0));
+			assert_cgp_no_msg(t.data[4] == a(0, 1));
+			int inside = 0;
+			for (int k = 0; k < int(t.data.size()); ++k) {
+				cgp::int2 const index = t.offset_to_index(k);
+				assert_cgp_no_msg(t.index_to_offset(index.x, index.y) == k);
+				if (index.x < 11 && index.y < 6) {
+					assert_cgp_no_msg(t.data[k] == a(index.x, index.y));
+					++inside;
+				}
+			}
+			assert_cgp_no_msg(inside == a.size());
+
+			// The strides give the offset of the next element along each axis, inside a brick or across two bricks
+			for (int k2 = 0; k2 < 5; ++k2) {
+				for (int k1 = 0; k1 < 10; ++k1) {
+					cgp::int2 const stride = t.index_to_stride(k1, k2);
+					assert_cgp_no_msg(t.index_to_offset(k1, k2) + stride.x == t.index_to_offset(k1 + 1, k2));
+					assert_cgp_no_msg(t.index_to_offset(k1, k2) + stride.y == t.index_to_offset(k1, k2 + 1));
+				}
+			}
+
+			assert_cgp_no_msg(is_equal(cgp::grid_2D<int>(t), a));
+		}
 	}
 
 
@@ -90,6 +126,79 @@ namespace cgp_test {
 			assert_cgp_no_msg(type_str(a) == "grid_3D<int>");
 		}
 
+		{
+			// Lazy expression on grids: evaluated in one loop, keeps the 3D dimension
+			cgp::grid_3D<float> a(2, 3, 4), b(2, 3, 4);
+			for (int k = 0; k < a.size(); ++k) {
+				a.data[k] = float(k);
+				b.data[k] = 1.0f;
+			}
+			cgp::grid_3D<float> const c = cgp::lazy(a) * 2.0f - b;
+			assert_cgp_no_msg(is_equal(c.dimension, cgp::int3{ 2,3,4 }));
+			assert_cgp_no_msg(cgp::is_equal(c(1, 2, 3), 2.0f * a(1, 2, 3) - 1.0f));
+			assert_cgp_no_msg(is_equal(a * 2.0f - b, c));
+		}
+
+		{
+			// Tiled layout: same indexing as the linear one, dimensions that are not a multiple of the brick size
+			cgp::grid_3D<int> a(5, 7, 6);
+			for (int k = 0; k < a.size(); ++k)
+				a.data[k] = k;
+			cgp::grid_3D<int, cgp::grid_layout_tiled<4> > t(a);
+			assert_cgp_no_msg(type_str(t) == "grid_3D<int, tiled<4>>");
+			assert_cgp_no_msg(t.data.size() == 2 * 2 * 2 * 64);
+
+			int counter = 0;
+			for (int k3 = 0; k3 < 6; ++k3) {
+				for (int k2 = 0; k2 < 7; ++k2) {
+					for (int k1 = 0; k1 < 5; ++k1) {
+						assert_cgp_no_msg(t(k1, k2, k3) == a(k1, k2, k3));
+						assert_cgp_no_msg(is_equal(a.offset_to_index(counter), cgp::int3{ k1,k2,k3 }));
+						++counter;
+					}
+				}
+			}
+
+			// Iteration in storage order: every element is visited once, the padding elements are skipped by their index, and the first 4x4x4 brick comes first
+			int k = 0;
+			cgp::numarray<int> visited(a.size());
+			for (int value : t) {
+				cgp::int3 const index = t.offset_to_index(k);
+				assert_cgp_no_msg(t.index_to_offset(index) == k);
+				if (k < 64)
+					assert_cgp_no_msg(index.x < 4 && index.y < 4 && index.z < 4);
+				if (index.x < 5 && index.y < 7 && index.z < 6) {
+					assert_cgp_no_msg(value == a(index));
+					visited[value]++;
+				}
+				++k;
+			}
+			for (int v : visited)
+				assert_cgp_no_msg(v == 1);
+
+			// The strides give the offset of the next element along each axis, inside a brick or across two bricks
+			for (int k3 = 0; k3 < 5; ++k3) {
+				for (int k2 = 0; k2 < 6; ++k2) {
+					for (int k1 = 0; k1 < 4; ++k1) {
+						int const offset = t.index_to_offset(k1, k2, k3);
+						cgp::int3 const stride = t.index_to_stride(k1, k2, k3);
+						assert_cgp_no_msg(offset + stride.x == t.index_to_offset(k1 + 1, k2, k3));
+						assert_cgp_no_msg(offset + stride.y == t.index_to_offset(k1, k2 + 1, k3));
+						assert_cgp_no_msg(offset + stride.z == t.index_to_offset(k1, k2, k3 + 1));
+						assert_cgp_no_msg(offset + stride.x + stride.y + stride.z == t.index_to_offset(k1 + 1, k2 + 1, k3 + 1));
+						assert_cgp_no_msg(a.index_to_offset(k1, k2, k3) + a.index_to_stride(k1, k2, k3).z == a.index_to_offset(k1, k2, k3 + 1));
+					}
+				}
+			}
+
+			// Conversion back to linear, operators between tiled grids
+			assert_cgp_no_msg(is_equal(cgp::grid_3D<int>(t), a));
+			cgp::grid_3D<int, cgp::grid_layout_tiled<4> > const t2 = t + t;
+			assert_cgp_no_msg(t2(4, 6, 5) == 2 * a(4, 6, 5));
+			assert_cgp_no_msg(is_equal(t2 - t, t));
+			assert_cgp_no_msg(is_equal(cgp::grid_3D<int, cgp::grid_layout_tiled<4> >::from_array(t.data, 5, 7, 6), t));
+		}
+
 	}
 
 }
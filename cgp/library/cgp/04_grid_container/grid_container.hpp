@@ -9,6 +9,7 @@
 
 
 #include "offset_grid/offset_grid.hpp"
+#include "grid_layout/grid_layout.hpp"
 #include "grid_stack/grid_stack.hpp"
 #include "grid/grid.hpp"
 #include "matrix_stack/matrix_stack.hpp"
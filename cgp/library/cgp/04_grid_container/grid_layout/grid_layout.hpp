@@ -0,0 +1,160 @@
+#pragma once
+
+#include <string>
+
+#include "cgp/02_numarray/numarray_stack/numarray_stack.hpp"
+#include "../offset_grid/offset_grid.hpp"
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+/** Storage layouts of grid_2D and grid_3D (second template parameter, grid_layout_linear by default)
+ *
+ * A layout maps an index (k1,k2[,k3]) of a grid of given dimension to the offset of the element in the 1D storage, and back.
+ * - grid_layout_linear: offset = k1 + N1*(k2 + N2*k3). Neighbors along k3 are N1*N2 elements apart.
+ * - grid_layout_tiled<B>: the grid is cut into bricks of B x B (x B) elements (B a power of 2) stored one after the other,
+ *   each brick being stored linearly. The neighbors of an element are in the same brick (a few cache lines) except on the brick boundary.
+ *   Every brick is complete: each dimension of the storage is rounded up to a multiple of B, and the offset is only made of shifts and masks.
+ *   The padding elements (when a dimension is not a multiple of B) are never reached by an index, but they are part of the storage.
+ *   The stride to the next element along an axis is 1, B or B^2 inside a brick: the neighbors of an element cost one offset and a few comparisons.
+ *   The tiled layout pays off on gathers that cross the slabs of the grid (ex. sampling along k3, see the grid_3D ray-march in bench_cgp),
+ *   not on a full sweep in storage order such as a stencil, where the linear offsets are incremental and cheaper.
+ *
+ * The layout is only a change of the storage order: element access, size, resize and fill are unchanged.
+ * The iterators walk the storage (data), including the padding elements of the tiled layout.
+ * A layout provides:
+ *  static int offset(int k1, int k2, int2 const& dimension);
+ *  static int offset(int k1, int k2, int k3, int3 const& dimension);
+ *  static int2 index(int offset, int2 const& dimension);
+ *  static int3 index(int offset, int3 const& dimension);
+ *  static int2 stride(int k1, int k2, int2 const& dimension);         // offsets from (k1,k2[,k3]) to the next element along each axis:
+ *  static int3 stride(int k1, int k2, int k3, int3 const& dimension); //  the neighbors of an element (ex. the 8 corners of a trilinear interpolation) follow from a single offset
+ *  static int storage_size(int2 const& dimension); // number of elements of the storage (N1*N2 for linear)
+ *  static int storage_size(int3 const& dimension);
+ *  static constexpr int id;   // identifier of the storage order in lazy expressions (0 for linear)
+ *  static std::string name(); // used by type_str ("" for linear)
+ **/
+
+namespace cgp
+{
+
+	/** Row-major storage: k1 + N1*(k2 + N2*k3) */
+	struct grid_layout_linear
+	{
+		static constexpr int id = 0;
+
+		static int offset(int k1, int k2, int2 const& dimension) { return offset_grid(k1, k2, dimension.x); }
+		static int offset(int k1, int k2, int k3, int3 const& dimension) { return offset_grid(k1, k2, k3, dimension.x, dimension.y); }
+		static int2 index(int offset, int2 const& dimension) { return index_grid_from_offset(offset, dimension.x); }
+		static int3 index(int offset, int3 const& dimension) { return index_grid_from_offset(offset, dimension.x, dimension.y); }
+		static int2 stride(int, int, int2 const& dimension) { return { 1, dimension.x }; }
+		static int3 stride(int, int, int, int3 const& dimension) { return { 1, dimension.x, dimension.x * dimension.y }; }
+		static int storage_size(int2 const& dimension) { return dimension.x * dimension.y; }
+		static int storage_size(int3 const& dimension) { return dimension.x * dimension.y * dimension.z; }
+		static std::string name() { return ""; }
+	};
+
+	/** Brick storage: bricks of B^2 (2D) or B^3 (3D) elements, B being a power of 2 (8: a brick of float is 2kB in 3D) */
+	template <int B = 8>
+	struct grid_layout_tiled
+	{
+		static_assert(B >= 2 && (B & (B - 1)) == 0, "The size of the bricks must be a power of 2");
+
+		static constexpr int id = B;
+		static constexpr int shift = B == 2 ? 1 : B == 4 ? 2 : B == 8 ? 3 : B == 16 ? 4 : B == 32 ? 5 : 6; // log2(B)
+		static constexpr int mask = B - 1;
+		static_assert((1 << shift) == B, "The size of the bricks must be at most 64");
+
+		static inline int offset(int k1, int k2, int2 const& dimension);
+		static inline int offset(int k1, int k2, int k3, int3 const& dimension);
+		static int2 index(int offset, int2 const& dimension);
+		static int3 index(int offset, int3 const& dimension);
+		static inline int2 stride(int k1, int k2, int2 const& dimension);
+		static inline int3 stride(int k1, int k2, int k3, int3 const& dimension);
+		static int storage_size(int2 const& dimension);
+		static int storage_size(int3 const& dimension);
+		static std::string name() { return "tiled<" + str(B) + ">"; }
+
+		/** Number of bricks along a dimension of N elements */
+		static int bricks(int N) { return (N + mask) >> shift; }
+	};
+
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+
+	// The bricks are ordered by (k3,k2,k1), and all of them have B^2 (B^3) elements:
+	//  offset = brick_index * B^3 + lx + B*(ly + B*lz), with brick_index = bx + nbx*(by + nby*bz) and the local index l = k & (B-1).
+
+	template <int B>
+	inline int grid_layout_tiled<B>::offset(int k1, int k2, int2 const& dimension)
+	{
+		int const brick = (k2 >> shift) * bricks(dimension.x) + (k1 >> shift);
+		return (brick << (2 * shift)) | ((k2 & mask) << shift) | (k1 & mask);
+	}
+
+	template <int B>
+	inline int grid_layout_tiled<B>::offset(int k1, int k2, int k3, int3 const& dimension)
+	{
+		int const brick = ((k3 >> shift) * bricks(dimension.y) + (k2 >> shift)) * bricks(dimension.x) + (k1 >> shift);
+		return (brick << (3 * shift)) | ((k3 & mask) << (2 * shift)) | ((k2 & mask) << shift) | (k1 & mask);
+	}
+
+	template <int B>
+	int2 grid_layout_tiled<B>::index(int offset, int2 const& dimension)
+	{
+		int const brick = offset >> (2 * shift);
+		int const nbx = bricks(dimension.x);
+		return { ((brick % nbx) << shift) | (offset & mask), ((brick / nbx) << shift) | ((offset >> shift) & mask) };
+	}
+
+	template <int B>
+	int3 grid_layout_tiled<B>::index(int offset, int3 const& dimension)
+	{
+		int const brick = offset >> (3 * shift);
+		int const nbx = bricks(dimension.x), nby = bricks(dimension.y);
+		int const bx = brick % nbx, by = (brick / nbx) % nby, bz = brick / (nbx * nby);
+		return { (bx << shift) | (offset & mask), (by << shift) | ((offset >> shift) & mask), (bz << shift) | ((offset >> (2 * shift)) & mask) };
+	}
+
+	// The next element along an axis is in the same brick unless the local index is B-1: then the offset jumps to the next brick (one brick
+	//  further along k1, a row of bricks along k2, a slab of bricks along k3) and back to the local index 0.
+
+	template <int B>
+	inline int2 grid_layout_tiled<B>::stride(int k1, int k2, int2 const& dimension)
+	{
+		int const brick = 1 << (2 * shift);
+		return { (k1 & mask) != mask ? 1 : brick - mask,
+			(k2 & mask) != mask ? B : bricks(dimension.x) * brick - (mask << shift) };
+	}
+
+	template <int B>
+	inline int3 grid_layout_tiled<B>::stride(int k1, int k2, int k3, int3 const& dimension)
+	{
+		int const brick = 1 << (3 * shift);
+		return { (k1 & mask) != mask ? 1 : brick - mask,
+			(k2 & mask) != mask ? B : bricks(dimension.x) * brick - (mask << shift),
+			(k3 & mask) != mask ? B * B : bricks(dimension.x) * bricks(dimension.y) * brick - (mask << (2 * shift)) };
+	}
+
+	template <int B>
+	int grid_layout_tiled<B>::storage_size(int2 const& dimension)
+	{
+		return (bricks(dimension.x) * bricks(dimension.y)) << (2 * shift);
+	}
+
+	template <int B>
+	int grid_layout_tiled<B>::storage_size(int3 const& dimension)
+	{
+		return (bricks(dimension.x) * bricks(dimension.y) * bricks(dimension.z)) << (3 * shift);
+	}
+
+}
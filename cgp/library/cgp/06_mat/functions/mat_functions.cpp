@@ -1,4 +1,5 @@
 #include "cgp/01_base/base.hpp"
+#include "cgp/01_base/simd/simd.hpp"
 #include "mat_functions.hpp"
 
 namespace cgp
@@ -107,6 +108,76 @@ namespace cgp
 		return -m(3,0)*det(m.remove_row_column(3,0)) + m(3,1)*det(m.remove_row_column(3,1)) - m(3,2)*det(m.remove_row_column(3,2)) + m(3,3)*det(m.remove_row_column(3,3));
 	}
 
+#ifdef CGP_SIMD
+	// Product of 2x2 matrices stored row by row in a register (a00,a01,a10,a11)
+	//  A*B, adj(A)*B, and A*adj(B), with adj(A) = (a11,-a01,-a10,a00)
+	static simd::float4 mat2_mul(simd::float4 a, simd::float4 b)
+	{
+		return simd::add(simd::mul(a, simd::swizzle<0,3,0,3>(b)), simd::mul(simd::swizzle<1,0,3,2>(a), simd::swizzle<2,1,2,1>(b)));
+	}
+	static simd::float4 mat2_adj_mul(simd::float4 a, simd::float4 b)
+	{
+		return simd::sub(simd::mul(simd::swizzle<3,3,0,0>(a), b), simd::mul(simd::swizzle<1,1,2,2>(a), simd::swizzle<2,3,0,1>(b)));
+	}
+	static simd::float4 mat2_mul_adj(simd::float4 a, simd::float4 b)
+	{
+		return simd::sub(simd::mul(a, simd::swizzle<3,0,3,0>(b)), simd::mul(simd::swizzle<1,0,3,2>(a), simd::swizzle<2,1,2,1>(b)));
+	}
+
+	// Inverse by blocks: m = |A B|  and  inverse(m) = 1/det(m) |adj(X) adj(Y)|
+	//                        |C D|                              |adj(Z) adj(W)|
+	//  with X = det(D)A - B adj(D)C, W = det(A)D - C adj(A)B, Y = det(B)C - D adj(adj(A)B), Z = det(C)B - A adj(adj(D)C)
+	//  and det(m) = det(A)det(D) + det(B)det(C) - trace(adj(A)B adj(D)C)
+	mat4 inverse(mat4 const& m)
+	{
+		float const* p = m.begin();
+		simd::float4 const r0 = simd::load(p);
+		simd::float4 const r1 = simd::load(p + 4);
+		simd::float4 const r2 = simd::load(p + 8);
+		simd::float4 const r3 = simd::load(p + 12);
+
+		// 2x2 blocks
+		simd::float4 const A = simd::shuffle<0,1,0,1>(r0, r1);
+		simd::float4 const B = simd::shuffle<2,3,2,3>(r0, r1);
+		simd::float4 const C = simd::shuffle<0,1,0,1>(r2, r3);
+		simd::float4 const D = simd::shuffle<2,3,2,3>(r2, r3);
+
+		// (det(A), det(B), det(C), det(D))
+		simd::float4 const det_blocks = simd::sub(
+			simd::mul(simd::shuffle<0,2,0,2>(r0, r2), simd::shuffle<1,3,1,3>(r1, r3)),
+			simd::mul(simd::shuffle<1,3,1,3>(r0, r2), simd::shuffle<0,2,0,2>(r1, r3)));
+		simd::float4 const det_A = simd::splat<0>(det_blocks);
+		simd::float4 const det_B = simd::splat<1>(det_blocks);
+		simd::float4 const det_C = simd::splat<2>(det_blocks);
+		simd::float4 const det_D = simd::splat<3>(det_blocks);
+
+		simd::float4 const adjD_C = mat2_adj_mul(D, C);
+		simd::float4 const adjA_B = mat2_adj_mul(A, B);
+		simd::float4 X = simd::sub(simd::mul(det_D, A), mat2_mul(B, adjD_C));
+		simd::float4 W = simd::sub(simd::mul(det_A, D), mat2_mul(C, adjA_B));
+		simd::float4 Y = simd::sub(simd::mul(det_B, C), mat2_mul_adj(D, adjA_B));
+		simd::float4 Z = simd::sub(simd::mul(det_C, B), mat2_mul_adj(A, adjD_C));
+
+		simd::float4 const trace = simd::horizontal_sum(simd::mul(adjA_B, simd::swizzle<0,2,1,3>(adjD_C)));
+		simd::float4 const d = simd::sub(simd::add(simd::mul(det_A, det_D), simd::mul(det_B, det_C)), trace);
+		assert_cgp( std::abs(simd::first(d))>1e-5f , "Determinant is null");
+
+		// The signs of the adjugate are applied with the division by the determinant
+		simd::float4 const inv_d = simd::div(simd::set(1.0f, -1.0f, -1.0f, 1.0f), d);
+		X = simd::mul(X, inv_d);
+		Y = simd::mul(Y, inv_d);
+		Z = simd::mul(Z, inv_d);
+		W = simd::mul(W, inv_d);
+
+		mat4 inv;
+		float* q = inv.begin();
+		simd::store(q, simd::shuffle<3,1,3,1>(X, Y));
+		simd::store(q + 4, simd::shuffle<2,0,2,0>(X, Y));
+		simd::store(q + 8, simd::shuffle<3,1,3,1>(Z, W));
+		simd::store(q + 12, simd::shuffle<2,0,2,0>(Z, W));
+		return inv;
+	}
+#else
 	mat4 inverse(mat4 const& m)
 	{
 		float const d = det(m);
@@ -122,6 +193,7 @@ namespace cgp
 		return inv;
 
 	}
+#endif
 
 	mat2 tensor_product(vec2 const& a, vec2 const& b)
 	{
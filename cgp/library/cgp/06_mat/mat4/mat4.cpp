@@ -1,4 +1,5 @@
 #include "cgp/01_base/base.hpp"
+#include "cgp/01_base/simd/simd.hpp"
 
 #include "mat4.hpp"
 #include "cgp/09_geometric_transformation/rotation_transform/rotation_transform.hpp"
@@ -472,6 +473,32 @@ namespace cgp
     }
 
 
+#ifdef CGP_SIMD
+    // Rows of res = a*b: res(k,:) = a(k,0) b(0,:) + a(k,1) b(1,:) + a(k,2) b(2,:) + a(k,3) b(3,:)
+    //  The operations are done in the same order as the scalar version (same result). res can be a or b.
+    static void multiply_mat4_simd(float const* a, float const* b, float* res)
+    {
+        simd::float4 const b0 = simd::load(b);
+        simd::float4 const b1 = simd::load(b + 4);
+        simd::float4 const b2 = simd::load(b + 8);
+        simd::float4 const b3 = simd::load(b + 12);
+        for (int k = 0; k < 4; ++k) {
+            simd::float4 const ak = simd::load(a + 4 * k);
+            simd::float4 r = simd::mul(simd::splat<0>(ak), b0);
+            r = simd::add(r, simd::mul(simd::splat<1>(ak), b1));
+            r = simd::add(r, simd::mul(simd::splat<2>(ak), b2));
+            r = simd::add(r, simd::mul(simd::splat<3>(ak), b3));
+            simd::store(res + 4 * k, r);
+        }
+    }
+
+    mat4 operator*(mat4 const& a, mat4 const& b)
+    {
+        mat4 res;
+        multiply_mat4_simd(a.begin(), b.begin(), res.begin());
+        return res;
+    }
+#else
     mat4 operator*(mat4 const& a, mat4 const& b)
     {
         float const axx=get<0,0>(a), axy=get<0,1>(a), axz=get<0,2>(a), axw=get<0,3>(a);
@@ -491,6 +518,7 @@ namespace cgp
             awx*bxx+awy*byx+awz*bzx+aww*bwx, awx*bxy+awy*byy+awz*bzy+aww*bwy, awx*bxz+awy*byz+awz*bzz+aww*bwz, awx*bxw+awy*byw+awz*bzw+aww*bww
         };
     }
+#endif
     mat4 operator*(float s, mat4 const& M)
     {
         return mat4{
@@ -500,6 +528,13 @@ namespace cgp
             s*get<3,0>(M), s*get<3,1>(M), s*get<3,2>(M), s*get<3,3>(M),
         };
     }
+#ifdef CGP_SIMD
+    mat4& operator*=(mat4& a, mat4 const& b)
+    {
+        multiply_mat4_simd(a.begin(), b.begin(), a.begin());
+        return a;
+    }
+#else
     mat4& operator*=(mat4& a, mat4 const& b)
     {
         float* pa = a.begin();
@@ -537,6 +572,7 @@ namespace cgp
 
         return a;
     }
+#endif
     mat4& operator*=(mat4& M, float s)
     {
         float* pM = M.begin();
@@ -8,6 +8,8 @@
 
 #include "cgp/13_opengl/opengl.hpp"
 
+#include <algorithm>
+
 #if defined(__linux__) || defined(__EMSCRIPTEN__)
 #pragma GCC diagnostic ignored "-Wunused-variable"
 #endif
@@ -292,4 +294,68 @@ namespace cgp
     }
         
 
-}
\ No newline at end of file
+
+    image_structure image_structure::resize(int new_width, int new_height) const
+    {
+        assert_cgp(new_width > 0 && new_height > 0, "Incorrect size to resize the image");
+        assert_cgp(width > 0 && height > 0, "Cannot resize an empty image");
+
+        int const d = size_of_component(color_type);
+
+        image_structure resized;
+        resized.width = new_width;
+        resized.height = new_height;
+        resized.color_type = color_type;
+        resized.data.resize(new_width * new_height * d);
+
+        for (int ky = 0; ky < new_height; ++ky) {
+            // Position of the pixel center in the original image
+            float const y = std::max(0.0f, (ky + 0.5f) * height / float(new_height) - 0.5f);
+            int const y0 = std::min(int(y), height - 1);
+            int const y1 = std::min(y0 + 1, height - 1);
+            float const ry = y - y0;
+            for (int kx = 0; kx < new_width; ++kx) {
+                float const x = std::max(0.0f, (kx + 0.5f) * width / float(new_width) - 0.5f);
+                int const x0 = std::min(int(x), width - 1);
+                int const x1 = std::min(x0 + 1, width - 1);
+                float const rx = x - x0;
+
+                for (int kd = 0; kd < d; ++kd) {
+                    float const c00 = data[kd + d * (x0 + width * y0)];
+                    float const c10 = data[kd + d * (x1 + width * y0)];
+                    float const c01 = data[kd + d * (x0 + width * y1)];
+                    float const c11 = data[kd + d * (x1 + width * y1)];
+                    float const c = (1 - ry) * ((1 - rx) * c00 + rx * c10) + ry * ((1 - rx) * c01 + rx * c11);
+                    resized.data[kd + d * (kx + new_width * ky)] = (unsigned char)(std::min(255.0f, c + 0.5f));
+                }
+            }
+        }
+
+        return resized;
+    }
+
+    image_structure image_structure::convert_color_type(image_color_type new_color_type) const
+    {
+        if (new_color_type == color_type)
+            return *this;
+
+        int const d_in = size_of_component(color_type);
+        int const d_out = size_of_component(new_color_type);
+        int const N = width * height;
+
+        image_structure converted;
+        converted.width = width;
+        converted.height = height;
+        converted.color_type = new_color_type;
+        converted.data.resize(N * d_out);
+        for (int k = 0; k < N; ++k) {
+            for (int kd = 0; kd < 3; ++kd)
+                converted.data[kd + d_out * k] = data[kd + d_in * k];
+            if (d_out == 4)
+                converted.data[3 + d_out * k] = 255;
+        }
+
+        return converted;
+    }
+
+}
@@ -33,6 +33,12 @@ namespace cgp
 		image_structure rotate_90_degrees_counterclockwise() const;
 		image_structure rotate_90_degrees_clockwise() const;
 
+		// Return the image resampled to the new resolution (bilinear interpolation)
+		image_structure resize(int new_width, int new_height) const;
+
+		// Return the image with the given color type (the alpha channel is set to 255 when converting rgb to rgba)
+		image_structure convert_color_type(image_color_type new_color_type) const;
+
 
 
 	};
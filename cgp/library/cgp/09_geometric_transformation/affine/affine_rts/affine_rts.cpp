@@ -1,4 +1,5 @@
 #include "cgp/01_base/base.hpp"
+#include "cgp/01_base/simd/simd.hpp"
 #include "affine_rts.hpp"
 
 #include "../affine_rt/affine_rt.hpp"
@@ -15,6 +16,54 @@ namespace cgp
 		:rotation(rotation_arg), translation(translation_arg), scaling(scaling_arg)
 	{}
 
+#ifdef CGP_SIMD
+	// Unit quaternions q=(x,y,z,w) and vectors (x,y,z,0) in SIMD registers
+	//  Product: q1 q2 = w1 q2 + x1 (w2,-z2,y2,-x2) + y1 (z2,w2,-x2,-y2) + z1 (-y2,x2,w2,-z2)
+	static simd::float4 quaternion_product_simd(simd::float4 q1, simd::float4 q2)
+	{
+		simd::float4 r = simd::mul(simd::splat<3>(q1), q2);
+		r = simd::add(r, simd::mul(simd::splat<0>(q1), simd::mul(simd::swizzle<3,2,1,0>(q2), simd::set(1,-1,1,-1))));
+		r = simd::add(r, simd::mul(simd::splat<1>(q1), simd::mul(simd::swizzle<2,3,0,1>(q2), simd::set(1,1,-1,-1))));
+		r = simd::add(r, simd::mul(simd::splat<2>(q1), simd::mul(simd::swizzle<1,0,3,2>(q2), simd::set(-1,1,1,-1))));
+		return r;
+	}
+	//  Rotation of p: q p q* = p + w t + q.xyz x t, with t = 2 q.xyz x p
+	static simd::float4 quaternion_rotate_simd(simd::float4 q, simd::float4 p)
+	{
+		simd::float4 const t = simd::cross(simd::add(q, q), p);
+		return simd::add(simd::add(p, simd::mul(simd::splat<3>(q), t)), simd::cross(q, t));
+	}
+
+	mat4 affine_rts::matrix() const
+	{
+		// Each row of the rotation matrix is computed as c + s0 t0 + s1 t1, where t0, t1 are products of components of q and 2q
+		//  ex. first row (1-2(yy+zz), 2(xy-wz), 2(xz+wy)) = (1,0,0) + (-1,1,1)(y 2y, x 2y, x 2z) + (-1,-1,1)(z 2z, w 2z, w 2y)
+		quaternion const& r = rotation.data;
+		simd::float4 const q = simd::set(r.x, r.y, r.z, r.w);
+		simd::float4 const q2 = simd::add(q, q);
+		simd::float4 const s = simd::broadcast(scaling);
+
+		simd::float4 const tx0 = simd::mul(simd::swizzle<1,0,0,3>(q), simd::swizzle<1,1,2,3>(q2));
+		simd::float4 const tx1 = simd::mul(simd::swizzle<2,3,3,3>(q), simd::swizzle<2,2,1,3>(q2));
+		simd::float4 row_x = simd::add(simd::set(1,0,0,0), simd::add(simd::mul(simd::set(-1,1,1,0), tx0), simd::mul(simd::set(-1,-1,1,0), tx1)));
+
+		simd::float4 const ty0 = simd::mul(simd::swizzle<0,0,1,3>(q), simd::swizzle<1,0,2,3>(q2));
+		simd::float4 const ty1 = simd::mul(simd::swizzle<3,2,3,3>(q), simd::swizzle<2,2,0,3>(q2));
+		simd::float4 row_y = simd::add(simd::set(0,1,0,0), simd::add(simd::mul(simd::set(1,-1,1,0), ty0), simd::mul(simd::set(1,-1,-1,0), ty1)));
+
+		simd::float4 const tz0 = simd::mul(simd::swizzle<0,1,0,3>(q), simd::swizzle<2,2,0,3>(q2));
+		simd::float4 const tz1 = simd::mul(simd::swizzle<3,3,1,3>(q), simd::swizzle<1,0,1,3>(q2));
+		simd::float4 row_z = simd::add(simd::set(0,0,1,0), simd::add(simd::mul(simd::set(1,1,-1,0), tz0), simd::mul(simd::set(-1,1,-1,0), tz1)));
+
+		mat4 M;
+		float* p = M.begin();
+		simd::store(p, simd::add(simd::mul(s, row_x), simd::set(0, 0, 0, translation.x)));
+		simd::store(p + 4, simd::add(simd::mul(s, row_y), simd::set(0, 0, 0, translation.y)));
+		simd::store(p + 8, simd::add(simd::mul(s, row_z), simd::set(0, 0, 0, translation.z)));
+		simd::store(p + 12, simd::set(0, 0, 0, 1));
+		return M;
+	}
+#else
 	mat4 affine_rts::matrix() const
 	{
 		mat3 const& R = rotation.matrix();
@@ -26,6 +75,7 @@ namespace cgp
 		};
 		
 	}
+#endif
 
 	vec3 operator*(affine_rts const& T, vec3 const& p)
 	{
@@ -50,14 +100,34 @@ namespace cgp
 
 	affine_rts inverse(affine_rts const& T)
 	{
+		/** (s R | t)^-1 = (R^-1/s | -R^-1 t/s)
+		*   (  0 | 1)      (     0 |        1) */
 		rotation_transform const R_inv = inverse(T.rotation);
-		return affine_rts(R_inv, -(R_inv*T.translation), 1.0f/T.scaling);
+		float const s_inv = 1.0f/T.scaling;
+		return affine_rts(R_inv, -s_inv*(R_inv*T.translation), s_inv);
 	}
 
+#ifdef CGP_SIMD
+	affine_rts operator*(affine_rts const& T1, affine_rts const& T2)
+	{
+		quaternion const& r1 = T1.rotation.data;
+		quaternion const& r2 = T2.rotation.data;
+		simd::float4 const q1 = simd::set(r1.x, r1.y, r1.z, r1.w);
+		simd::float4 const q2 = simd::set(r2.x, r2.y, r2.z, r2.w);
+		simd::float4 const t2 = simd::set(T2.translation.x, T2.translation.y, T2.translation.z, 0.0f);
+		simd::float4 const t1 = simd::set(T1.translation.x, T1.translation.y, T1.translation.z, 0.0f);
+
+		float q[4], t[4];
+		simd::store(q, quaternion_product_simd(q1, q2));
+		simd::store(t, simd::add(simd::mul(simd::broadcast(T1.scaling), quaternion_rotate_simd(q1, t2)), t1));
+		return affine_rts(rotation_transform(quaternion(q[0], q[1], q[2], q[3])), vec3(t[0], t[1], t[2]), T1.scaling*T2.scaling);
+	}
+#else
 	affine_rts operator*(affine_rts const& T1, affine_rts const& T2)
 	{
 		return affine_rts( T1.rotation * T2.rotation, T1.scaling*(T1.rotation*T2.translation)+T1.translation, T1.scaling*T2.scaling);
 	}
+#endif
 
 
 	affine_rts operator*(affine_rts const& T, rotation_transform const& R)
@@ -0,0 +1,83 @@
+#include "test_affine_rts.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../affine_rts.hpp"
+
+#include <cmath>
+#include <iostream>
+using namespace cgp;
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	// Deterministic transform with a rotation around a non-trivial axis
+	static affine_rts transform_example(int k)
+	{
+		vec3 const axis = normalize(vec3{ std::cos(1.3f*k), std::sin(0.7f*k), 0.5f+0.1f*k });
+		return affine_rts(rotation_transform::from_axis_angle(axis, 0.4f+0.9f*k), vec3{ 1.5f-k, 0.3f*k, -2.0f+0.5f*k }, 0.5f+0.25f*k);
+	}
+
+	// Product with the definition of the matrix product
+	static mat4 product_reference(mat4 const& a, mat4 const& b)
+	{
+		mat4 res;
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				for (int k = 0; k < 4; ++k)
+					res(i, j) += a(i, k) * b(k, j);
+		return res;
+	}
+
+	void test_affine_rts()
+	{
+		// Matrix of the transform
+		{
+			for (int k = 0; k < 5; ++k) {
+				affine_rts const T = transform_example(k);
+				mat4 const M = mat4::build_affine(T.scaling * T.rotation.matrix(), T.translation);
+				assert_cgp_no_msg( is_equal(T.matrix(), M) );
+			}
+		}
+
+		// Composition of transforms
+		{
+			for (int k = 0; k < 4; ++k) {
+				affine_rts const T1 = transform_example(k);
+				affine_rts const T2 = transform_example(k+1);
+				affine_rts const T = T1 * T2;
+				assert_cgp_no_msg( is_equal(T.matrix(), T1.matrix() * T2.matrix()) );
+				assert_cgp_no_msg( is_equal(T * vec3{ 0.2f,-1.0f,3.0f }, T1 * (T2 * vec3{ 0.2f,-1.0f,3.0f })) );
+				assert_cgp_no_msg( is_equal(T1.rotation * T2.translation, T1.rotation.matrix() * T2.translation) );
+			}
+		}
+
+		// Product of mat4
+		{
+			mat4 a{1.0f,1.5f,2.5f,-2.4f, 3.1f,-1.5f,2.2f,4.0f, 3.1f,1.4f,-2.4f,-3.5f, 5.1f,0.2f,0.5f,-0.4f};
+			mat4 const b = transform_example(2).matrix();
+			assert_cgp_no_msg( is_equal(a * b, product_reference(a, b)) );
+			assert_cgp_no_msg( is_equal(b * a, product_reference(b, a)) );
+
+			// In place product, including with itself
+			mat4 c = a;
+			c *= b;
+			assert_cgp_no_msg( is_equal(c, product_reference(a, b)) );
+			c = a;
+			c *= c;
+			assert_cgp_no_msg( is_equal(c, product_reference(a, a)) );
+		}
+
+		// Inverse of mat4
+		{
+			for (int k = 0; k < 5; ++k) {
+				affine_rts const T = transform_example(k);
+				mat4 const M = T.matrix();
+				assert_cgp_no_msg( is_equal(inverse(M), inverse(T).matrix()) );
+				assert_cgp_no_msg( norm(inverse(M) * M - mat4::build_identity()) < 1e-4f );
+			}
+		}
+	}
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+namespace cgp_test
+{
+	void test_affine_rts();
+}
\ No newline at end of file
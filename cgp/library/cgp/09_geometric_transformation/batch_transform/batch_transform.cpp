@@ -0,0 +1,483 @@
+#include "cgp/01_base/base.hpp"
+#include "cgp/01_base/simd/simd.hpp"
+#include "cgp/01_base/parallel/parallel.hpp"
+#include "batch_transform.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace cgp
+{
+	size_t batch_transform_parallel_threshold = 16384;
+
+	int soa_vec3::size() const
+	{
+		return x.size();
+	}
+	soa_vec3& soa_vec3::resize(int N)
+	{
+		x.resize(N);
+		y.resize(N);
+		z.resize(N);
+		return *this;
+	}
+	vec3 soa_vec3::get(int k) const
+	{
+		return vec3{ x[k], y[k], z[k] };
+	}
+	void soa_vec3::set(int k, vec3 const& p)
+	{
+		x[k] = p.x;
+		y[k] = p.y;
+		z[k] = p.z;
+	}
+
+	int soa_affine_rts::size() const
+	{
+		return scaling.size();
+	}
+	soa_affine_rts& soa_affine_rts::resize(int N)
+	{
+		qx.resize(N); qy.resize(N); qz.resize(N); qw.resize(N);
+		tx.resize(N); ty.resize(N); tz.resize(N);
+		scaling.resize(N);
+		return *this;
+	}
+	affine_rts soa_affine_rts::get(int k) const
+	{
+		return affine_rts(rotation_transform(quaternion(qx[k], qy[k], qz[k], qw[k])), vec3{ tx[k], ty[k], tz[k] }, scaling[k]);
+	}
+	void soa_affine_rts::set(int k, affine_rts const& T)
+	{
+		quaternion const& q = T.rotation.data;
+		qx[k] = q.x; qy[k] = q.y; qz[k] = q.z; qw[k] = q.w;
+		tx[k] = T.translation.x; ty[k] = T.translation.y; tz[k] = T.translation.z;
+		scaling[k] = T.scaling;
+	}
+
+	soa_vec3 to_soa(numarray<vec3> const& v)
+	{
+		int const N = v.size();
+		soa_vec3 res;
+		res.resize(N);
+		for (int k = 0; k < N; ++k)
+			res.set(k, v[k]);
+		return res;
+	}
+	soa_affine_rts to_soa(numarray<affine_rts> const& T)
+	{
+		int const N = T.size();
+		soa_affine_rts res;
+		res.resize(N);
+		for (int k = 0; k < N; ++k)
+			res.set(k, T[k]);
+		return res;
+	}
+	numarray<vec3> to_aos(soa_vec3 const& v)
+	{
+		int const N = v.size();
+		numarray<vec3> res;
+		res.resize(N);
+		for (int k = 0; k < N; ++k)
+			res[k] = v.get(k);
+		return res;
+	}
+	numarray<affine_rts> to_aos(soa_affine_rts const& T)
+	{
+		int const N = T.size();
+		numarray<affine_rts> res;
+		res.resize(N);
+		for (int k = 0; k < N; ++k)
+			res[k] = T.get(k);
+		return res;
+	}
+
+	namespace
+	{
+		// Operations on lanes of 1 element (float) and, with the same names, of 4 elements (simd::float4)
+		//  The kernels are written once as templates on the type of lane, so that the elements of the SIMD blocks
+		//  and of the scalar remainder are computed with the same sequence of operations.
+		namespace lane
+		{
+			inline float add(float a, float b) { return a + b; }
+			inline float sub(float a, float b) { return a - b; }
+			inline float mul(float a, float b) { return a * b; }
+			inline void store(float* p, float a) { *p = a; }
+
+			template <typename R> R load(float const* p);
+			template <typename R> R broadcast(float a);
+			template <> inline float load<float>(float const* p) { return *p; }
+			template <> inline float broadcast<float>(float a) { return a; }
+
+			inline void load_vec3(float const* p, float& x, float& y, float& z) { x = p[0]; y = p[1]; z = p[2]; }
+			inline void store_vec3(float* p, float x, float y, float z) { p[0] = x; p[1] = y; p[2] = z; }
+
+#ifdef CGP_SIMD
+			using simd::add;
+			using simd::sub;
+			using simd::mul;
+			using simd::store;
+			template <> inline simd::float4 load<simd::float4>(float const* p) { return simd::load(p); }
+			template <> inline simd::float4 broadcast<simd::float4>(float a) { return simd::broadcast(a); }
+
+			inline void load_vec3(float const* p, simd::float4& x, simd::float4& y, simd::float4& z) { simd::load_vec3x4(p, x, y, z); }
+			inline void store_vec3(float* p, simd::float4 x, simd::float4 y, simd::float4 z) { simd::store_vec3x4(p, x, y, z); }
+#endif
+		}
+
+		// Call function(k0, k1) on chunks covering [0, N[. The chunks are processed in parallel when N*cost (cost: number of
+		//  transforms computed per element) is large enough. Their boundaries are multiples of 4, so that only the last one ends with a scalar remainder.
+		template <typename F>
+		void for_each_chunk(size_t N, F const& function, size_t cost = 1)
+		{
+			if (N * cost < batch_transform_parallel_threshold) {
+				function(size_t(0), N);
+				return;
+			}
+			size_t const grain = std::max(size_t(1), 1024 / cost);
+			parallel_chunks(0, (N + 3) / 4, [&function, N](size_t b0, size_t b1) { function(4 * b0, std::min(N, 4 * b1)); }, grain);
+		}
+
+		// Call kernel(k, lane) on [k0, k1[: by blocks of 4 elements with a lane of type simd::float4, then one by one with a lane of type float
+		template <typename F>
+		void for_each_lane(size_t k0, size_t k1, F const& kernel)
+		{
+			size_t k = k0;
+#ifdef CGP_SIMD
+			for (; k + 4 <= k1; k += 4)
+				kernel(k, simd::float4());
+#endif
+			for (; k < k1; ++k)
+				kernel(k, 0.0f);
+		}
+
+		// 3 first rows of an affine matrix, stored row by row
+		using affine_coefficients = std::array<float, 12>;
+
+		affine_coefficients coefficients(mat4 const& M)
+		{
+			affine_coefficients m;
+			std::copy(M.begin(), M.begin() + 12, m.begin());
+			return m;
+		}
+		affine_coefficients coefficients(rotation_transform const& R)
+		{
+			mat3 const M = R.matrix();
+			return affine_coefficients{ {
+				get<0,0>(M), get<0,1>(M), get<0,2>(M), 0.0f,
+				get<1,0>(M), get<1,1>(M), get<1,2>(M), 0.0f,
+				get<2,0>(M), get<2,1>(M), get<2,2>(M), 0.0f } };
+		}
+
+		template <typename R>
+		void apply_affine(affine_coefficients const& m, R& x, R& y, R& z)
+		{
+			using namespace lane;
+			R const px = x, py = y, pz = z;
+			x = add(add(add(mul(broadcast<R>(m[0]), px), mul(broadcast<R>(m[1]), py)), mul(broadcast<R>(m[2]), pz)), broadcast<R>(m[3]));
+			y = add(add(add(mul(broadcast<R>(m[4]), px), mul(broadcast<R>(m[5]), py)), mul(broadcast<R>(m[6]), pz)), broadcast<R>(m[7]));
+			z = add(add(add(mul(broadcast<R>(m[8]), px), mul(broadcast<R>(m[9]), py)), mul(broadcast<R>(m[10]), pz)), broadcast<R>(m[11]));
+		}
+
+		void transform_soa(affine_coefficients const& m, soa_vec3 const& p, soa_vec3& out)
+		{
+			size_t const N = p.size();
+			out.resize(int(N));
+			float const* x = p.x.data.data();
+			float const* y = p.y.data.data();
+			float const* z = p.z.data.data();
+			float* ox = out.x.data.data();
+			float* oy = out.y.data.data();
+			float* oz = out.z.data.data();
+
+			for_each_chunk(N, [&](size_t k0, size_t k1) {
+				for_each_lane(k0, k1, [&](size_t k, auto l) {
+					using R = decltype(l);
+					R px = lane::load<R>(x + k), py = lane::load<R>(y + k), pz = lane::load<R>(z + k);
+					apply_affine(m, px, py, pz);
+					lane::store(ox + k, px);
+					lane::store(oy + k, py);
+					lane::store(oz + k, pz);
+				});
+			});
+		}
+
+		void transform_aos(affine_coefficients const& m, numarray<vec3>& p)
+		{
+			static_assert(sizeof(vec3) == 3 * sizeof(float), "vec3 is expected to be stored as 3 contiguous float");
+			float* data = reinterpret_cast<float*>(p.data.data());
+
+			for_each_chunk(p.size(), [&](size_t k0, size_t k1) {
+				for_each_lane(k0, k1, [&](size_t k, auto l) {
+					using R = decltype(l);
+					R x, y, z;
+					lane::load_vec3(data + 3 * k, x, y, z);
+					apply_affine(m, x, y, z);
+					lane::store_vec3(data + 3 * k, x, y, z);
+				});
+			});
+		}
+
+		// Components of a transform, in the order of the streams of soa_affine_rts: qx, qy, qz, qw, tx, ty, tz, scaling
+		std::array<float, 8> components(affine_rts const& T)
+		{
+			quaternion const& q = T.rotation.data;
+			return std::array<float, 8>{ { q.x, q.y, q.z, q.w, T.translation.x, T.translation.y, T.translation.z, T.scaling } };
+		}
+		std::array<float const*, 8> streams(soa_affine_rts const& T)
+		{
+			return std::array<float const*, 8>{ { T.qx.data.data(), T.qy.data.data(), T.qz.data.data(), T.qw.data.data(),
+				T.tx.data.data(), T.ty.data.data(), T.tz.data.data(), T.scaling.data.data() } };
+		}
+		std::array<float*, 8> streams(soa_affine_rts& T)
+		{
+			return std::array<float*, 8>{ { T.qx.data.data(), T.qy.data.data(), T.qz.data.data(), T.qw.data.data(),
+				T.tx.data.data(), T.ty.data.data(), T.tz.data.data(), T.scaling.data.data() } };
+		}
+
+		template <typename R>
+		void broadcast_components(std::array<float, 8> const& c, R* T)
+		{
+			for (int i = 0; i < 8; ++i)
+				T[i] = lane::broadcast<R>(c[i]);
+		}
+		template <typename R>
+		void load_components(std::array<float const*, 8> const& s, size_t k, R* T)
+		{
+			for (int i = 0; i < 8; ++i)
+				T[i] = lane::load<R>(s[i] + k);
+		}
+		template <typename R>
+		void store_components(std::array<float*, 8> const& s, size_t k, R const* T)
+		{
+			for (int i = 0; i < 8; ++i)
+				lane::store(s[i] + k, T[i]);
+		}
+
+		// out = a * b (same as the product of affine_rts)
+		//  rotation: quaternion product qa qb, translation: sa (qa tb qa*) + ta, scaling: sa sb
+		template <typename R>
+		void compose(R const* a, R const* b, R* out)
+		{
+			using namespace lane;
+			out[0] = sub(add(add(mul(a[3], b[0]), mul(a[0], b[3])), mul(a[1], b[2])), mul(a[2], b[1]));
+			out[1] = add(add(sub(mul(a[3], b[1]), mul(a[0], b[2])), mul(a[1], b[3])), mul(a[2], b[0]));
+			out[2] = add(sub(add(mul(a[3], b[2]), mul(a[0], b[1])), mul(a[1], b[0])), mul(a[2], b[3]));
+			out[3] = sub(sub(sub(mul(a[3], b[3]), mul(a[0], b[0])), mul(a[1], b[1])), mul(a[2], b[2]));
+
+			// Rotation of v = tb: v + w t + q x t, with t = 2 q x v
+			R const cx = sub(mul(a[1], b[6]), mul(a[2], b[5]));
+			R const cy = sub(mul(a[2], b[4]), mul(a[0], b[6]));
+			R const cz = sub(mul(a[0], b[5]), mul(a[1], b[4]));
+			R const t0 = add(cx, cx), t1 = add(cy, cy), t2 = add(cz, cz);
+			R const rx = add(add(b[4], mul(a[3], t0)), sub(mul(a[1], t2), mul(a[2], t1)));
+			R const ry = add(add(b[5], mul(a[3], t1)), sub(mul(a[2], t0), mul(a[0], t2)));
+			R const rz = add(add(b[6], mul(a[3], t2)), sub(mul(a[0], t1), mul(a[1], t0)));
+
+			out[4] = add(mul(a[7], rx), a[4]);
+			out[5] = add(mul(a[7], ry), a[5]);
+			out[6] = add(mul(a[7], rz), a[6]);
+			out[7] = mul(a[7], b[7]);
+		}
+
+		// 3 first rows of the matrix of the transform T (same as affine_rts::matrix)
+		template <typename R>
+		void matrix_rows(R const* T, R* m)
+		{
+			using namespace lane;
+			R const x = T[0], y = T[1], z = T[2], w = T[3], s = T[7];
+			R const x2 = add(x, x), y2 = add(y, y), z2 = add(z, z);
+			R const xx = mul(x, x2), yy = mul(y, y2), zz = mul(z, z2);
+			R const xy = mul(x, y2), xz = mul(x, z2), yz = mul(y, z2);
+			R const wx = mul(w, x2), wy = mul(w, y2), wz = mul(w, z2);
+			R const one = broadcast<R>(1.0f);
+
+			m[0] = mul(s, sub(one, add(yy, zz))); m[1] = mul(s, sub(xy, wz));            m[2] = mul(s, add(xz, wy));             m[3] = T[4];
+			m[4] = mul(s, add(xy, wz));            m[5] = mul(s, sub(one, add(xx, zz))); m[6] = mul(s, sub(yz, wx));             m[7] = T[5];
+			m[8] = mul(s, sub(xz, wy));            m[9] = mul(s, add(yz, wx));            m[10] = mul(s, sub(one, add(xx, yy))); m[11] = T[6];
+		}
+
+		// Write the matrices whose 3 first rows are m (1 or 4 matrices)
+		inline void store_matrices(float* M, float const* m)
+		{
+			std::copy(m, m + 12, M);
+			M[12] = 0.0f; M[13] = 0.0f; M[14] = 0.0f; M[15] = 1.0f;
+		}
+#ifdef CGP_SIMD
+		inline void store_matrices(float* M, simd::float4 const* m)
+		{
+			// m[4r+c] contains the coefficient (r,c) of the 4 matrices: the transposition of each row gives the rows of the matrices
+			for (int r = 0; r < 3; ++r) {
+				simd::float4 a = m[4 * r], b = m[4 * r + 1], c = m[4 * r + 2], d = m[4 * r + 3];
+				simd::transpose(a, b, c, d);
+				simd::store(M + 4 * r, a);
+				simd::store(M + 16 + 4 * r, b);
+				simd::store(M + 32 + 4 * r, c);
+				simd::store(M + 48 + 4 * r, d);
+			}
+			simd::float4 const last_row = simd::set(0, 0, 0, 1);
+			for (int j = 0; j < 4; ++j)
+				simd::store(M + 16 * j + 12, last_row);
+		}
+#endif
+	}
+
+	void batch_transform_points(affine_rts const& T, soa_vec3 const& p, soa_vec3& out)
+	{
+		transform_soa(coefficients(T.matrix()), p, out);
+	}
+	void batch_transform_points(mat4 const& M, soa_vec3 const& p, soa_vec3& out)
+	{
+		transform_soa(coefficients(M), p, out);
+	}
+	void batch_rotate_vectors(rotation_transform const& R, soa_vec3 const& v, soa_vec3& out)
+	{
+		transform_soa(coefficients(R), v, out);
+	}
+
+	void batch_transform_points(affine_rts const& T, numarray<vec3>& p)
+	{
+		transform_aos(coefficients(T.matrix()), p);
+	}
+	void batch_transform_points(mat4 const& M, numarray<vec3>& p)
+	{
+		transform_aos(coefficients(M), p);
+	}
+	void batch_rotate_vectors(rotation_transform const& R, numarray<vec3>& v)
+	{
+		transform_aos(coefficients(R), v);
+	}
+
+	void batch_compose(affine_rts const& parent, soa_affine_rts const& local, soa_affine_rts& out)
+	{
+		size_t const N = local.size();
+		out.resize(int(N));
+		std::array<float, 8> const p = components(parent);
+		std::array<float const*, 8> const in = streams(local);
+		std::array<float*, 8> const res = streams(out);
+
+		for_each_chunk(N, [&](size_t k0, size_t k1) {
+			for_each_lane(k0, k1, [&](size_t k, auto l) {
+				using R = decltype(l);
+				R a[8], b[8], c[8];
+				broadcast_components(p, a);
+				load_components(in, k, b);
+				compose(a, b, c);
+				store_components(res, k, c);
+			});
+		});
+	}
+
+	void batch_compose(soa_affine_rts const& parent, soa_affine_rts const& local, soa_affine_rts& out)
+	{
+		assert_cgp(parent.size() == local.size(), "Parent and local transforms must have the same size (parent: " + str(parent.size()) + ", local: " + str(local.size()) + ")");
+		size_t const N = local.size();
+		out.resize(int(N));
+		std::array<float const*, 8> const in_parent = streams(parent);
+		std::array<float const*, 8> const in_local = streams(local);
+		std::array<float*, 8> const res = streams(out);
+
+		for_each_chunk(N, [&](size_t k0, size_t k1) {
+			for_each_lane(k0, k1, [&](size_t k, auto l) {
+				using R = decltype(l);
+				R a[8], b[8], c[8];
+				load_components(in_parent, k, a);
+				load_components(in_local, k, b);
+				compose(a, b, c);
+				store_components(res, k, c);
+			});
+		});
+	}
+
+	void batch_matrix(soa_affine_rts const& T, numarray<mat4>& out)
+	{
+		static_assert(sizeof(mat4) == 16 * sizeof(float), "mat4 is expected to be stored as 16 contiguous float");
+		size_t const N = T.size();
+		out.resize(int(N));
+		std::array<float const*, 8> const in = streams(T);
+		float* res = reinterpret_cast<float*>(out.data.data());
+
+		for_each_chunk(N, [&](size_t k0, size_t k1) {
+			for_each_lane(k0, k1, [&](size_t k, auto l) {
+				using R = decltype(l);
+				R a[8], m[12];
+				load_components(in, k, a);
+				matrix_rows(a, m);
+				store_matrices(res + 16 * k, m);
+			});
+		});
+	}
+
+	void batch_matrix(affine_rts const& parent, soa_affine_rts const& local, numarray<mat4>& out)
+	{
+		size_t const N = local.size();
+		out.resize(int(N));
+		std::array<float, 8> const p = components(parent);
+		std::array<float const*, 8> const in = streams(local);
+		float* res = reinterpret_cast<float*>(out.data.data());
+
+		for_each_chunk(N, [&](size_t k0, size_t k1) {
+			for_each_lane(k0, k1, [&](size_t k, auto l) {
+				using R = decltype(l);
+				R a[8], b[8], c[8], m[12];
+				broadcast_components(p, a);
+				load_components(in, k, b);
+				compose(a, b, c);
+				matrix_rows(c, m);
+				store_matrices(res + 16 * k, m);
+			});
+		});
+	}
+
+	void batch_hierarchy_matrix(std::vector<int> const& parent, std::vector<affine_rts> const& local, soa_affine_rts const& root, std::vector<soa_affine_rts const*> const& local_override, std::vector<numarray<mat4> >& matrix)
+	{
+		size_t const N = root.size();
+		size_t const N_node = parent.size();
+		assert_cgp(local.size() == N_node && local_override.size() == N_node, "The hierarchy must have one parent, one local transform and one (possibly null) override per node");
+
+		std::vector<std::array<float, 8> > local_components(N_node);
+		std::vector<std::array<float const*, 8> > override_streams(N_node);
+		std::vector<float*> res(N_node);
+		matrix.resize(N_node);
+		for (size_t k = 0; k < N_node; ++k) {
+			assert_cgp(parent[k] < int(k), "The parent of node " + str(k) + " must be stored before it (parent: " + str(parent[k]) + ")");
+			local_components[k] = components(local[k]);
+			if (local_override[k] != nullptr) {
+				assert_cgp(local_override[k]->size() == int(N), "The override of node " + str(k) + " must have one transform per instance (size: " + str(local_override[k]->size()) + ", instances: " + str(N) + ")");
+				override_streams[k] = streams(*local_override[k]);
+			}
+			matrix[k].resize(int(N));
+			res[k] = reinterpret_cast<float*>(matrix[k].data.data());
+		}
+		std::array<float const*, 8> const in_root = streams(root);
+
+		// All the nodes of a block of instances are computed before the next block: the global transforms of the parents
+		//  stay in a small buffer (8 components x 4 lanes per node) instead of being stored for all the instances.
+		for_each_chunk(N, [&](size_t k0, size_t k1) {
+			std::vector<float> global(N_node * 8 * 4);
+			for_each_lane(k0, k1, [&](size_t i, auto l) {
+				using R = decltype(l);
+				R a[8], b[8], c[8], m[12];
+				for (size_t k = 0; k < N_node; ++k) {
+					if (parent[k] < 0)
+						load_components(in_root, i, a);
+					else
+						for (int j = 0; j < 8; ++j)
+							a[j] = lane::load<R>(&global[(parent[k] * 8 + j) * 4]);
+
+					if (local_override[k] != nullptr)
+						load_components(override_streams[k], i, b);
+					else
+						broadcast_components(local_components[k], b);
+
+					compose(a, b, c);
+					for (int j = 0; j < 8; ++j)
+						lane::store(&global[(k * 8 + j) * 4], c[j]);
+					matrix_rows(c, m);
+					store_matrices(res[k] + 16 * i, m);
+				}
+			});
+		}, N_node);
+	}
+}
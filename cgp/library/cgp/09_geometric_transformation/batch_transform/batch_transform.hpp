@@ -0,0 +1,92 @@
+#pragma once
+
+#include "cgp/02_numarray/numarray.hpp"
+#include "cgp/05_vec/vec.hpp"
+#include "cgp/06_mat/mat.hpp"
+#include "cgp/09_geometric_transformation/affine/affine_rts/affine_rts.hpp"
+
+#include <vector>
+
+// Transforms applied to large arrays of points, vectors and instances at once
+//  The arrays are stored as structure of arrays (SoA): one contiguous stream of float per component, so that consecutive
+//  elements fill the SIMD registers (4 elements per operation, see simd.hpp). Arrays of at least batch_transform_parallel_threshold
+//  elements are also split in chunks processed in parallel on the job system (see parallel_chunks).
+//  The output can be the input (in-place transform). The result does not depend on the number of threads.
+//
+//  Usage:
+//  | soa_vec3 p = to_soa(mesh.position);
+//  | batch_transform_points(T, p, p);           // p = T*p for each point
+//  |
+//  | soa_affine_rts local = to_soa(instances);  // numarray<affine_rts>
+//  | soa_affine_rts world;
+//  | batch_compose(parent, local, world);       // world = parent*local for each instance
+//  | numarray<mat4> M;
+//  | batch_matrix(world, M);                     // matrices to be sent to the GPU
+
+namespace cgp
+{
+	// N vectors stored as 3 streams of coordinates
+	struct soa_vec3
+	{
+		numarray<float> x;
+		numarray<float> y;
+		numarray<float> z;
+
+		int size() const;
+		soa_vec3& resize(int N);
+
+		vec3 get(int k) const;
+		void set(int k, vec3 const& p);
+	};
+
+	// N transforms (unit quaternion of the rotation, translation, scaling) stored as 8 streams
+	struct soa_affine_rts
+	{
+		numarray<float> qx, qy, qz, qw;
+		numarray<float> tx, ty, tz;
+		numarray<float> scaling;
+
+		int size() const;
+		soa_affine_rts& resize(int N);
+
+		affine_rts get(int k) const;
+		void set(int k, affine_rts const& T);
+	};
+
+	soa_vec3 to_soa(numarray<vec3> const& v);
+	soa_affine_rts to_soa(numarray<affine_rts> const& T);
+	numarray<vec3> to_aos(soa_vec3 const& v);
+	numarray<affine_rts> to_aos(soa_affine_rts const& T);
+
+	// Arrays with at least this number of elements are processed in parallel (default: 16384)
+	extern size_t batch_transform_parallel_threshold;
+
+	// out[k] = T p[k]
+	void batch_transform_points(affine_rts const& T, soa_vec3 const& p, soa_vec3& out);
+	// out[k] = M p[k], where M is an affine matrix (its last row is assumed to be (0,0,0,1))
+	void batch_transform_points(mat4 const& M, soa_vec3 const& p, soa_vec3& out);
+	// out[k] = R v[k] (ex. normals)
+	void batch_rotate_vectors(rotation_transform const& R, soa_vec3 const& v, soa_vec3& out);
+
+	// In-place versions on the usual arrays of vec3 (the vec3 are transposed by blocks of 4 in the SIMD registers)
+	void batch_transform_points(affine_rts const& T, numarray<vec3>& p);
+	void batch_transform_points(mat4 const& M, numarray<vec3>& p);
+	void batch_rotate_vectors(rotation_transform const& R, numarray<vec3>& v);
+
+	// out[k] = parent * local[k]
+	void batch_compose(affine_rts const& parent, soa_affine_rts const& local, soa_affine_rts& out);
+	// out[k] = parent[k] * local[k] (parent and local have the same size)
+	void batch_compose(soa_affine_rts const& parent, soa_affine_rts const& local, soa_affine_rts& out);
+
+	// out[k] = T[k].matrix()
+	void batch_matrix(soa_affine_rts const& T, numarray<mat4>& out);
+	// out[k] = (parent * local[k]).matrix(), without storing the intermediate transforms
+	void batch_matrix(affine_rts const& parent, soa_affine_rts const& local, numarray<mat4>& out);
+
+	// Global matrices of the nodes of a hierarchy evaluated for N instances, in a single pass over the instances
+	//  parent[k]: index of the parent of the node k (-1 for a root), stored before k. local[k]: local transform of the node k.
+	//  root[i]: transform of the instance i, applied above the roots of the hierarchy.
+	//  local_override[k]: null, or the N local transforms replacing local[k] for each instance.
+	//  matrix[k][i] = (root[i] * local(root node) * ... * local(parent of k) * local(k)).matrix()
+	void batch_hierarchy_matrix(std::vector<int> const& parent, std::vector<affine_rts> const& local, soa_affine_rts const& root, std::vector<soa_affine_rts const*> const& local_override, std::vector<numarray<mat4> >& matrix);
+}
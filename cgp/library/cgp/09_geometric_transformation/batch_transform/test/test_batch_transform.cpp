@@ -0,0 +1,138 @@
+#include "test_batch_transform.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../batch_transform.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+using namespace cgp;
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	// Deterministic transforms and points with bounded coordinates (is_equal compares with an absolute tolerance)
+	static affine_rts transform_example(int k)
+	{
+		vec3 const axis = normalize(vec3{ std::cos(1.3f*k), std::sin(0.7f*k), 0.5f+0.1f*k });
+		return affine_rts(rotation_transform::from_axis_angle(axis, 0.4f+0.9f*k), vec3{ 1.5f-std::cos(0.1f*k), std::sin(0.3f*k), -2.0f+0.5f*std::sin(float(k)) }, 0.5f+0.25f*std::cos(0.1f*k));
+	}
+	static numarray<vec3> points_example(int N)
+	{
+		numarray<vec3> p;
+		p.resize(N);
+		for (int k = 0; k < N; ++k)
+			p[k] = vec3{ std::cos(0.3f*k), 0.01f*(k%100), std::sin(1.7f*k) };
+		return p;
+	}
+
+	// Compare each batch function with the element by element computation, for a given size
+	static void test_batch_transform_size(int N)
+	{
+		affine_rts const T = transform_example(3);
+		numarray<vec3> const p = points_example(N);
+
+		// Points and vectors: SoA and AoS
+		{
+			soa_vec3 q;
+			batch_transform_points(T, to_soa(p), q);
+			numarray<vec3> r = p;
+			batch_transform_points(T, r);
+			soa_vec3 n = to_soa(p);
+			batch_rotate_vectors(T.rotation, n, n);
+			numarray<vec3> m = p;
+			batch_rotate_vectors(T.rotation, m);
+
+			assert_cgp_no_msg( q.size() == N );
+			for (int k = 0; k < N; ++k) {
+				assert_cgp_no_msg( is_equal(q.get(k), T * p[k]) );
+				assert_cgp_no_msg( is_equal(r[k], T * p[k]) );
+				assert_cgp_no_msg( is_equal(n.get(k), T.rotation * p[k]) );
+				assert_cgp_no_msg( is_equal(m[k], T.rotation * p[k]) );
+			}
+
+			numarray<vec3> s = p;
+			batch_transform_points(T.matrix(), s);
+			for (int k = 0; k < N; ++k)
+				assert_cgp_no_msg( is_equal(s[k], T * p[k]) );
+		}
+
+		// Instances
+		{
+			numarray<affine_rts> local, parent;
+			for (int k = 0; k < N; ++k) {
+				local.push_back(transform_example(k));
+				parent.push_back(transform_example(k + 7));
+			}
+			soa_affine_rts const local_soa = to_soa(local);
+
+			soa_affine_rts world;
+			batch_compose(T, local_soa, world);
+			soa_affine_rts world_each;
+			batch_compose(to_soa(parent), local_soa, world_each);
+			numarray<mat4> M, M_world;
+			batch_matrix(local_soa, M);
+			batch_matrix(T, local_soa, M_world);
+
+			assert_cgp_no_msg( world.size() == N && M.size() == N );
+			for (int k = 0; k < N; ++k) {
+				assert_cgp_no_msg( is_equal(world.get(k).matrix(), (T * local[k]).matrix()) );
+				assert_cgp_no_msg( is_equal(world_each.get(k).matrix(), (parent[k] * local[k]).matrix()) );
+				assert_cgp_no_msg( is_equal(M[k], local[k].matrix()) );
+				assert_cgp_no_msg( is_equal(M_world[k], (T * local[k]).matrix()) );
+			}
+		}
+
+		// Hierarchy of 4 nodes (two roots), evaluated for N instances, with a per-instance local transform on the node 2
+		{
+			std::vector<int> const parent = { -1, 0, 1, -1 };
+			std::vector<affine_rts> const local = { transform_example(1), transform_example(2), transform_example(5), transform_example(8) };
+			numarray<affine_rts> root, local_2;
+			for (int k = 0; k < N; ++k) {
+				root.push_back(transform_example(k + 11));
+				local_2.push_back(transform_example(2 * k));
+			}
+			soa_affine_rts const root_soa = to_soa(root);
+			soa_affine_rts const local_2_soa = to_soa(local_2);
+
+			std::vector<numarray<mat4> > M;
+			batch_hierarchy_matrix(parent, local, root_soa, { nullptr, nullptr, &local_2_soa, nullptr }, M);
+
+			assert_cgp_no_msg( M.size() == 4 );
+			for (int k = 0; k < N; ++k) {
+				affine_rts const global_1 = root[k] * local[0] * local[1];
+				assert_cgp_no_msg( is_equal(M[0][k], (root[k] * local[0]).matrix()) );
+				assert_cgp_no_msg( is_equal(M[1][k], global_1.matrix()) );
+				assert_cgp_no_msg( is_equal(M[2][k], (global_1 * local_2[k]).matrix()) );
+				assert_cgp_no_msg( is_equal(M[3][k], (root[k] * local[3]).matrix()) );
+			}
+		}
+	}
+
+	void test_batch_transform()
+	{
+		// Sizes with and without a remainder after the blocks of 4 elements
+		for (int N : { 0, 1, 3, 4, 7, 64, 1001 })
+			test_batch_transform_size(N);
+
+		// Parallel processing of the chunks
+		{
+			size_t const threshold = batch_transform_parallel_threshold;
+			batch_transform_parallel_threshold = 16;
+			test_batch_transform_size(5003);
+			batch_transform_parallel_threshold = threshold;
+		}
+
+		// Conversion between AoS and SoA
+		{
+			numarray<vec3> const p = points_example(5);
+			numarray<vec3> const q = to_aos(to_soa(p));
+			assert_cgp_no_msg( q.size() == 5 );
+			for (int k = 0; k < 5; ++k)
+				assert_cgp_no_msg( is_equal(p[k], q[k]) );
+		}
+	}
+}
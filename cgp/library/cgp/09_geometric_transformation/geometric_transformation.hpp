@@ -1,6 +1,7 @@
 #pragma once
 
 #include "affine/affine.hpp"
+#include "batch_transform/batch_transform.hpp"
 #include "frame/frame.hpp"
 #include "interpolation/interpolation.hpp"
 #include "projection/projection.hpp"
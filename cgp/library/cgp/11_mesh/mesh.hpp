@@ -1,4 +1,5 @@
 #pragma once
 
 #include "mesh/mesh.hpp"
+#include "mesh_view/mesh_view.hpp"
 #include "primitive/primitive.hpp"
@@ -228,8 +228,7 @@ namespace cgp
 
 	mesh& mesh::translate(vec3 const& t)
 	{
-		for (vec3& p : position)
-			p += t;
+		batch_transform_points(affine_rts(rotation_transform(), t, 1.0f), position);
 		return *this;
 	}
 	mesh& mesh::translate(float tx, float ty, float tz)
@@ -238,8 +237,7 @@ namespace cgp
 	}
 	mesh& mesh::scale(float s)
 	{
-		for (vec3& p : position)
-			p *= s;
+		batch_transform_points(affine_rts(rotation_transform(), vec3{ 0,0,0 }, s), position);
 		return *this;
 	}
 	mesh& mesh::scale(float sx,float sy, float sz)
@@ -255,16 +253,13 @@ namespace cgp
 	mesh& mesh::rotate(vec3 const& axis, float angle)
 	{
 		rotation_transform R = rotation_transform::from_axis_angle(axis, angle);
-		for (vec3& p : position)
-			p = R*p;
-		for(vec3& n : normal)
-			n = R*n;
+		batch_rotate_vectors(R, position);
+		batch_rotate_vectors(R, normal);
 		return *this;
 	}
 	mesh& mesh::apply_transform(mat3 const& M)
 	{
-		for (vec3& p : position)
-			p = M * p;
+		batch_transform_points(mat4::build_affine(M, vec3{ 0,0,0 }), position);
 		normal_update();
 		return *this;
 	}
@@ -278,28 +273,17 @@ namespace cgp
 		return *this;
 	}
 	mesh& mesh::apply_transform(cgp::affine const& M) {
-		for (vec3& p : position)
-			p = M*p;
-		for(vec3& n : normal) {
-			n = M.rotation*n;
-		}
+		batch_transform_points(M.matrix(), position);
+		batch_rotate_vectors(M.rotation, normal);
 		return *this;
 	}
 	mesh& mesh::apply_transform(cgp::affine_rt const& M) {
-		for (vec3& p : position)
-			p = M*p;
-		for(vec3& n : normal) {
-			n = M.rotation*n;
-		}
-		return *this;
+		return apply_transform(affine_rts(M));
 	}
 	mesh& mesh::apply_transform(cgp::affine_rts const& M)
 	{
-		for (vec3& p : position)
-			p = M*p;
-		for(vec3& n : normal) {
-			n = M.rotation*n;
-		}
+		batch_transform_points(M, position);
+		batch_rotate_vectors(M.rotation, normal);
 		return *this;
 	}
 
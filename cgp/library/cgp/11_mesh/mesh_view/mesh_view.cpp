@@ -0,0 +1,46 @@
+#include "mesh_view.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+namespace cgp
+{
+	mesh_view::mesh_view(mesh const& m)
+	{
+		number_of_vertex = m.position.size();
+		number_of_triangle = m.connectivity.size();
+		assert_cgp(m.normal.size() == number_of_vertex && m.color.size() == number_of_vertex && m.uv.size() == number_of_vertex, "Cannot create a mesh_view with empty per-vertex fields - call fill_empty_field() first");
+
+		position = m.position.data.data();
+		normal = m.normal.data.data();
+		color = m.color.data.data();
+		uv = m.uv.data.data();
+		connectivity = m.connectivity.data.data();
+	}
+
+	mesh mesh_view::to_mesh() const
+	{
+		mesh m;
+		m.position.data.assign(position, position + number_of_vertex);
+		m.normal.data.assign(normal, normal + number_of_vertex);
+		m.color.data.assign(color, color + number_of_vertex);
+		m.uv.data.assign(uv, uv + number_of_vertex);
+		m.connectivity.data.assign(connectivity, connectivity + number_of_triangle);
+		return m;
+	}
+
+	bool mesh_view_check(mesh_view const& view)
+	{
+		if (view.number_of_vertex == 0 || view.number_of_triangle == 0)
+			return false;
+		if (view.position == nullptr || view.normal == nullptr || view.color == nullptr || view.uv == nullptr || view.connectivity == nullptr)
+			return false;
+
+		size_t const N = view.number_of_vertex;
+		for (size_t k = 0; k < view.number_of_triangle; ++k) {
+			uint3 const& f = view.connectivity[k];
+			if (f[0] >= N || f[1] >= N || f[2] >= N)
+				return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "cgp/11_mesh/mesh/mesh.hpp"
+
+namespace cgp
+{
+	/** Non-owning view on the per-vertex buffers and connectivity of a mesh
+	* The pointers can refer to the numarray of a mesh, or to any contiguous memory (ex. a file mapped in memory, see mesh_binary_structure).
+	* All the per-vertex buffers have number_of_vertex elements. The viewed memory must remain valid while the view is used.
+	*
+	*  Usage:
+	*  | mesh_view view = mesh_view(m); // or binary_file.view()
+	*  | drawable.initialize_data_on_gpu(view, shader); */
+	struct mesh_view
+	{
+		vec3 const* position = nullptr;
+		vec3 const* normal = nullptr;
+		vec3 const* color = nullptr;
+		vec2 const* uv = nullptr;
+		uint3 const* connectivity = nullptr;
+
+		size_t number_of_vertex = 0;
+		size_t number_of_triangle = 0;
+
+		mesh_view() = default;
+		/** View on the buffers of a mesh. All the per-vertex fields must be filled (see mesh::fill_empty_field) */
+		explicit mesh_view(mesh const& m);
+
+		/** Copy of the viewed data in a mesh */
+		mesh to_mesh() const;
+	};
+
+	/** Check if the view can be sent to the GPU: non empty buffers, and triangle indices referring to existing vertices */
+	bool mesh_view_check(mesh_view const& view);
+}
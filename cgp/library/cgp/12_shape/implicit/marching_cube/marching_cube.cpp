@@ -1,17 +1,16 @@
 #include "marching_cube.hpp"
 
 #include "cgp/09_geometric_transformation/interpolation/interpolation.hpp"
+#include "cgp/01_base/parallel/parallel.hpp"
 #include "helper/marching_cubes_lut.hpp"
-#include <unordered_map>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 namespace cgp
 {
 
-	// Helper structure to hash a pair of index (a,b) as a unique number
-	struct hash_edge {
-		size_t operator()(std::pair<int, int> const& key) const;
-	};
-
 	// Helper structure to store voxels information
 	struct cube_parameters {
 		std::array<size_t, 8> index;
@@ -20,61 +19,246 @@ namespace cgp
 	};
 
 
-	mesh marching_cube(grid_3D<float> const& field, spatial_domain_grid_3D const& domain, float iso)
+	// Vertices and triangles extracted from a slab of voxel layers
+	//  The connectivity uses the local indices of the slab. An index with the flag marching_cube_next_slab refers to the
+	//  vertices created first by the next slab (the edges along x and y of the plane shared by the two slabs).
+	struct marching_cube_slab {
+		std::vector<vec3> position;
+		std::vector<uint3> connectivity;
+	};
+	static unsigned int const marching_cube_next_slab = 0x80000000u;
+
+	// Sample positions and field values of the grid, shared by all the slabs
+	struct marching_cube_grid {
+		float const* field;
+		float iso;
+		int Nx, Ny, Nz;
+		vec3 domain_min;
+		vec3 step; // distance between two samples along each axis
+	};
+
+	// Vertex on the edge between the samples p0 and p0+offset, whose first sample has the index (kx,ky,kz)
+	static vec3 marching_cube_edge_vertex(marching_cube_grid const& grid, size_t p0, size_t offset, int kx, int ky, int kz, int axis)
 	{
-		assert_cgp_no_msg(is_equal(field.dimension, domain.samples));
+		float const v0 = grid.field[p0] - grid.iso;
+		float const v1 = grid.field[p0 + offset] - grid.iso;
+		float const alpha = v0 / (v0 - v1);
 
-		// Compute the marching cube
-		std::vector<vec3> position;
-		std::vector<marching_cube_relative_coordinates> relative;
-		int const N = marching_cube(position, field.data.data, domain, iso, &relative);
+		vec3 u = { float(kx), float(ky), float(kz) };
+		u[axis] += alpha;
+		return grid.domain_min + u * grid.step;
+	}
 
+	// True if the 8 bytes starting at a and b are equal (used to skip the parts of the grid away from the surface)
+	static bool marching_cube_same_8(unsigned char const* a, unsigned char const* b)
+	{
+		uint64_t wa, wb;
+		std::memcpy(&wa, a, 8);
+		std::memcpy(&wb, b, 8);
+		return wa == wb;
+	}
 
-		// Compute the mesh with non-duplicated vertices
-		mesh m;
-		int const N_triangle = N / 3;
+	// inside[p] = 1 if the field is below the iso-value at the sample p of the layer kz
+	// code[p] = the four bits of the face of the voxel p in this layer (vertices 0,1,2,3 of the tables)
+	static void marching_cube_layer_sign(marching_cube_grid const& grid, int kz, std::vector<unsigned char>& inside, std::vector<unsigned char>& code)
+	{
+		// Local copies: the writes of bytes could otherwise alias the parameters and prevent the vectorization
+		size_t const Nx = grid.Nx;
+		size_t const Nxy = Nx * grid.Ny;
+		float const iso = grid.iso;
+		float const* layer = grid.field + Nxy * kz;
+		unsigned char* const in = inside.data();
+		unsigned char* const c = code.data();
+
+		for (size_t p = 0; p < Nxy; ++p)
+			in[p] = (layer[p] - iso < 0) ? 1 : 0;
+
+		// Codes of 8 voxels at once: the bytes of inside are 0 or 1, the shifted bits stay in their byte
+		size_t p = 0;
+		for (; p + Nx + 9 <= Nxy; p += 8) {
+			uint64_t w0, w1, w2, w3;
+			std::memcpy(&w0, in + p, 8);
+			std::memcpy(&w1, in + p + 1, 8);
+			std::memcpy(&w2, in + p + 1 + Nx, 8);
+			std::memcpy(&w3, in + p + Nx, 8);
+			uint64_t const w = w0 | (w1 << 1) | (w2 << 2) | (w3 << 3);
+			std::memcpy(c + p, &w, 8);
+		}
+		for (; p + Nx + 1 < Nxy; ++p)
+			c[p] = in[p] | (in[p + 1] << 1) | (in[p + 1 + Nx] << 2) | (in[p + Nx] << 3);
+	}
+
+	// Index of the vertices on the edges along x and y of the layer kz: edge[2p] for the edge (p,p+1), edge[2p+1] for the edge (p,p+Nx)
+	//  The vertices are visited in the order of the samples. If create is true, they are appended to the slab,
+	//  otherwise they are only numbered (from 0, with the flag marching_cube_next_slab) as the next slab creates them.
+	//  Only the edges crossing the iso-surface are written: they are the only ones referenced by the triangles.
+	static void marching_cube_layer_edge_xy(marching_cube_grid const& grid, int kz, std::vector<unsigned char> const& inside, std::vector<unsigned int>& edge, bool create, marching_cube_slab& slab)
+	{
+		int const Nx = grid.Nx, Ny = grid.Ny;
+		size_t const offset_layer = size_t(Nx) * Ny * kz;
+		unsigned int counter = 0;
+		for (int ky = 0; ky < Ny; ++ky) {
+			for (int kx = 0; kx < Nx; ++kx) {
+				size_t const p = size_t(kx) + size_t(Nx) * ky;
+				if ((kx & 7) == 0 && kx + 9 <= Nx && marching_cube_same_8(&inside[p], &inside[p + 1]) && (ky == Ny - 1 || marching_cube_same_8(&inside[p], &inside[p + Nx]))) {
+					kx += 7;
+					continue;
+				}
+
+				if (kx < Nx - 1 && inside[p] != inside[p + 1]) {
+					if (create) {
+						edge[2 * p] = unsigned(slab.position.size());
+						slab.position.push_back(marching_cube_edge_vertex(grid, offset_layer + p, 1, kx, ky, kz, 0));
+					}
+					else
+						edge[2 * p] = marching_cube_next_slab | counter++;
+				}
+				if (ky < Ny - 1 && inside[p] != inside[p + Nx]) {
+					if (create) {
+						edge[2 * p + 1] = unsigned(slab.position.size());
+						slab.position.push_back(marching_cube_edge_vertex(grid, offset_layer + p, Nx, kx, ky, kz, 1));
+					}
+					else
+						edge[2 * p + 1] = marching_cube_next_slab | counter++;
+				}
+			}
+		}
+	}
 
-		// Storage avoiding to duplicate vertices at the same position if they are on the same voxel edge
-		std::unordered_map<std::pair<int, int>, int, hash_edge> unique_edge;
+	// Index of the vertices on the edges along z between the layers kz and kz+1
+	static void marching_cube_layer_edge_z(marching_cube_grid const& grid, int kz, std::vector<unsigned char> const& inside_lower, std::vector<unsigned char> const& inside_upper, std::vector<unsigned int>& edge, marching_cube_slab& slab)
+	{
+		int const Nx = grid.Nx, Ny = grid.Ny;
+		size_t const Nxy = size_t(Nx) * Ny;
+		for (int ky = 0; ky < Ny; ++ky) {
+			for (int kx = 0; kx < Nx; ++kx) {
+				size_t const p = size_t(kx) + size_t(Nx) * ky;
+				if ((kx & 7) == 0 && kx + 8 <= Nx && marching_cube_same_8(&inside_lower[p], &inside_upper[p])) {
+					kx += 7;
+					continue;
+				}
 
-		for (int k_tri = 0; k_tri < N_triangle; ++k_tri) {
+				if (inside_lower[p] != inside_upper[p]) {
+					edge[p] = unsigned(slab.position.size());
+					slab.position.push_back(marching_cube_edge_vertex(grid, Nxy * kz + p, Nxy, kx, ky, kz, 2));
+				}
+			}
+		}
+	}
 
-			uint3 triangle_index;
-			for (int k = 0; k < 3; ++k) {
+	// Marching cube on the voxel layers [kz_begin, kz_end[
+	//  The slab creates the vertices on the edges of the sample layers kz_begin to kz_end-1 (and kz_end for the last slab).
+	//  Only two layers of edge indices are stored at a time.
+	static void marching_cube_slab_extract(marching_cube_grid const& grid, int kz_begin, int kz_end, marching_cube_slab& slab)
+	{
+		static std::array<std::array<int, 16>, 256> const triTable = marching_cube_lut_triTable();
 
-				int const idx = 3 * k_tri + k;
+		int const Nx = grid.Nx, Ny = grid.Ny;
+		size_t const Nxy = size_t(Nx) * Ny;
+		bool const is_last_slab = (kz_end == grid.Nz - 1);
+
+		std::vector<unsigned char> inside_lower(Nxy), inside_upper(Nxy), code_lower(Nxy), code_upper(Nxy);
+		std::vector<unsigned int> edge_lower(2 * Nxy), edge_upper(2 * Nxy), edge_z(Nxy);
+
+		marching_cube_layer_sign(grid, kz_begin, inside_lower, code_lower);
+		marching_cube_layer_edge_xy(grid, kz_begin, inside_lower, edge_lower, true, slab);
+
+		std::array<unsigned int, 12> edge_cube;
+		for (int kz = kz_begin; kz < kz_end; ++kz) {
+			marching_cube_layer_sign(grid, kz + 1, inside_upper, code_upper);
+			marching_cube_layer_edge_z(grid, kz, inside_lower, inside_upper, edge_z, slab);
+			marching_cube_layer_edge_xy(grid, kz + 1, inside_upper, edge_upper, kz + 1 < kz_end || is_last_slab, slab);
+
+			for (int ky = 0; ky < Ny - 1; ++ky) {
+				for (int kx = 0; kx < Nx - 1; ++kx) {
+					size_t const p = size_t(kx) + size_t(Nx) * ky;
+
+					// Skip 8 voxels at once when they are all inside or all outside (most of the grid)
+					if ((kx & 7) == 0 && kx + 8 <= Nx - 1) {
+						uint64_t lower, upper;
+						std::memcpy(&lower, &code_lower[p], 8);
+						std::memcpy(&upper, &code_upper[p], 8);
+						if ((lower | upper) == 0 || (lower & upper) == 0x0F0F0F0F0F0F0F0Full) {
+							kx += 7;
+							continue;
+						}
+					}
 
-				// The indices of the edge of the current vertex
-				std::pair<int, int> const edge = { relative[3 * k_tri+k].k0, relative[3 * k_tri+k].k1 };
+					// Same vertex numbering and type as the tables (bit set for the vertices below the iso-value)
+					int const type = code_lower[p] | (code_upper[p] << 4);
+					if (type == 0 || type == 255)
+						continue;
 
-				// Check if this edge has already been encountered
-				auto const it = unique_edge.find(edge);
+					edge_cube = { {
+						edge_lower[2 * p], edge_lower[2 * (p + 1) + 1], edge_lower[2 * (p + Nx)], edge_lower[2 * p + 1],
+						edge_upper[2 * p], edge_upper[2 * (p + 1) + 1], edge_upper[2 * (p + Nx)], edge_upper[2 * p + 1],
+						edge_z[p], edge_z[p + 1], edge_z[p + 1 + Nx], edge_z[p + Nx] } };
 
-				// if it is a new edge, add this vertex as a new one in the mesh
-				if (it == unique_edge.end()) {
-					int const idx_new_vertex = m.position.size(); // create a new vertex index
-					triangle_index[k] = idx_new_vertex; // set the current index to the triangle connectivity
-					m.position.push_back(position[idx]); // add this vertex in the mesh
-					unique_edge[edge] = idx_new_vertex; // add the edge in the unique structure for further check
-				}
-				// if the edge has already been encountered - only reuse the index in the connectivity but do not add the vertex again
-				else {
-					int const idx_existing_vertex = it->second;   // the index that has already be defined
-					triangle_index[k] = idx_existing_vertex;      // set this existing index in the triangle connectivity
+					std::array<int, 16> const& triangles = triTable[type];
+					for (int k = 0; triangles[k] != -1; k += 3)
+						slab.connectivity.push_back({ edge_cube[triangles[k]], edge_cube[triangles[k + 1]], edge_cube[triangles[k + 2]] });
 				}
 			}
-			m.connectivity.push_back(triangle_index); // add the new triangle
-			
-			
-		}
 
-		m.fill_empty_field();
-		return m;
+			std::swap(inside_lower, inside_upper);
+			std::swap(code_lower, code_upper);
+			std::swap(edge_lower, edge_upper);
+		}
 	}
 
 
-	size_t hash_edge::operator()(std::pair<int, int> const& key) const {
-		return std::hash<int>{}(key.first) ^ std::hash<int>{}(key.second);
+	mesh marching_cube(grid_3D<float> const& field, spatial_domain_grid_3D const& domain, float iso)
+	{
+		assert_cgp_no_msg(is_equal(field.dimension, domain.samples));
+
+		mesh m;
+		int const Nx = field.dimension.x, Ny = field.dimension.y, Nz = field.dimension.z;
+		if (Nx >= 2 && Ny >= 2 && Nz >= 2) {
+			marching_cube_grid grid;
+			grid.field = field.data.data.data();
+			grid.iso = iso;
+			grid.Nx = Nx; grid.Ny = Ny; grid.Nz = Nz;
+			grid.domain_min = domain.center - domain.length / 2.0f;
+			grid.step = domain.length / vec3(Nx - 1.0f, Ny - 1.0f, Nz - 1.0f);
+
+			// The slabs only depend on the grid (not on the number of threads), so that the mesh is always the same
+			int const N_layer = Nz - 1;
+			int const slab_thickness = std::max(4, (N_layer + 63) / 64);
+			int const N_slab = (N_layer + slab_thickness - 1) / slab_thickness;
+
+			std::vector<marching_cube_slab> slabs(N_slab);
+			parallel_indices(0, N_slab, [&](size_t s) {
+				int const kz_begin = int(s) * slab_thickness;
+				marching_cube_slab_extract(grid, kz_begin, std::min(kz_begin + slab_thickness, N_layer), slabs[s]);
+			}, 1);
+
+			// Concatenate the slabs in order: the vertices referenced with marching_cube_next_slab are the first ones of the next slab
+			std::vector<unsigned int> offset_vertex(N_slab + 1, 0);
+			std::vector<size_t> offset_triangle(N_slab + 1, 0);
+			for (int s = 0; s < N_slab; ++s) {
+				offset_vertex[s + 1] = offset_vertex[s] + unsigned(slabs[s].position.size());
+				offset_triangle[s + 1] = offset_triangle[s] + slabs[s].connectivity.size();
+			}
+			m.position.resize(int(offset_vertex[N_slab]));
+			m.connectivity.resize(int(offset_triangle[N_slab]));
+
+			parallel_indices(0, N_slab, [&](size_t s) {
+				marching_cube_slab const& slab = slabs[s];
+				std::copy(slab.position.begin(), slab.position.end(), m.position.begin() + offset_vertex[s]);
+
+				unsigned int const offset = offset_vertex[s];
+				unsigned int const offset_next = offset_vertex[std::min(int(s) + 1, N_slab)];
+				for (size_t k = 0; k < slab.connectivity.size(); ++k) {
+					uint3 triangle = slab.connectivity[k];
+					for (int i = 0; i < 3; ++i)
+						triangle[i] = (triangle[i] & marching_cube_next_slab) ? offset_next + (triangle[i] & ~marching_cube_next_slab) : offset + triangle[i];
+					m.connectivity[int(offset_triangle[s] + k)] = triangle;
+				}
+			}, 1);
+		}
+
+		m.fill_empty_field();
+		return m;
 	}
 
 
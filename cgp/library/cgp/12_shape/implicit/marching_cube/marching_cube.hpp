@@ -7,6 +7,9 @@
 namespace cgp {
 
 	/** A simple-to-use marching cube that takes as input a discrete field, a 3D domain, and the iso-value, and returns a mesh without duplicating the vertices at the same position. 
+	* The grid is cut into slabs of voxel layers along z, extracted in parallel on the job system. Each vertex is created once per edge of the grid
+	*  (the slabs store the index of the vertex on the three edges of the samples of two layers), and the slabs are concatenated in order:
+	*  the result does not depend on the number of threads. The triangles are in the same order as the triangles of the function below.
 	* A new mesh is created at each call which is good for single call, but not ideal for efficiency if used in the animation loop. */
 	mesh marching_cube(grid_3D<float> const& field, spatial_domain_grid_3D const& domain, float iso);
 
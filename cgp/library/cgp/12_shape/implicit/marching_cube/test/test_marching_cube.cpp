@@ -0,0 +1,58 @@
+#include "test_marching_cube.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../marching_cube.hpp"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace cgp_test
+{
+	void test_marching_cube()
+	{
+		using namespace cgp;
+
+		// Grids with one voxel layer, and with many slabs (including a last slab thinner than the others)
+		std::vector<int3> const samples = { {5,6,2}, {9,7,41}, {12,11,23} };
+		for (int3 const& N : samples) {
+			spatial_domain_grid_3D const domain = spatial_domain_grid_3D::from_center_length({ 0,0,0 }, { 2,2,1 }, N);
+			grid_3D<float> field(N);
+			for (int kz = 0; kz < N.z; ++kz)
+				for (int ky = 0; ky < N.y; ++ky)
+					for (int kx = 0; kx < N.x; ++kx)
+						field(kx, ky, kz) = norm(domain.position({ kx,ky,kz }) - vec3(0.1f, 0, 0.05f));
+
+			float const iso = 0.8f;
+			mesh const m = marching_cube(field, domain, iso);
+			assert_cgp_no_msg(m.connectivity.size() > 0);
+
+			// Reference: triangles with duplicated vertices, and the grid edges they lie on
+			std::vector<vec3> position;
+			std::vector<marching_cube_relative_coordinates> relative;
+			size_t const N_vertex = marching_cube(position, field.data.data, domain, iso, &relative);
+			std::set<std::pair<size_t, size_t> > edges;
+			for (size_t k = 0; k < N_vertex; ++k)
+				edges.insert({ std::min(relative[k].k0, relative[k].k1), std::max(relative[k].k0, relative[k].k1) });
+
+			// Same triangles in the same order, one vertex per edge
+			assert_cgp_no_msg(m.connectivity.size() * 3 == int(N_vertex));
+			assert_cgp_no_msg(m.position.size() == int(edges.size()));
+			for (int k_tri = 0; k_tri < m.connectivity.size(); ++k_tri)
+				for (int k = 0; k < 3; ++k)
+					assert_cgp_no_msg(norm(m.position[m.connectivity[k_tri][k]] - position[3 * k_tri + k]) < 1e-5f);
+
+			// Every vertex is used
+			std::vector<int> used(m.position.size(), 0);
+			for (uint3 const& triangle : m.connectivity)
+				for (int k = 0; k < 3; ++k)
+					used[triangle[k]] = 1;
+			assert_cgp_no_msg(std::count(used.begin(), used.end(), 0) == 0);
+
+			// The result does not depend on the scheduling of the slabs
+			mesh const m2 = marching_cube(field, domain, iso);
+			assert_cgp_no_msg(is_equal(m.connectivity, m2.connectivity));
+		}
+	}
+}
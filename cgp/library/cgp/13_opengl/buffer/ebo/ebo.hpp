@@ -10,6 +10,8 @@ namespace cgp
 	struct opengl_ebo_structure : opengl_gpu_buffer
 	{
 		void initialize_data_on_gpu(numarray<uint3> const& data);
+		/** Send size triangles read directly from contiguous memory (ex. a file mapped in memory) */
+		void initialize_data_on_gpu(uint3 const* data, size_t size);
 	};
 
 
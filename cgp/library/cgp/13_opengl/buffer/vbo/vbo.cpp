@@ -6,18 +6,37 @@ namespace cgp
 {
 	static void warning_initialize_non_empty();
 
-	template <int N>
-	static GLuint opengl_buffer_data_initialize_generic(numarray<numarray_stack<float,N> > const& data, GLuint buffer_type, GLenum draw_type)
+	static GLuint opengl_buffer_data_initialize_generic(void const* data, size_t size_byte, GLuint buffer_type, GLenum draw_type)
 	{
 		GLuint vbo_index;
-		glGenBuffers(1, &vbo_index);                                                       opengl_check;
-		glBindBuffer(buffer_type, vbo_index);                                              opengl_check;
-		glBufferData(buffer_type, GLsizeiptr(size_in_memory(data)), ptr(data), draw_type); opengl_check;
-		glBindBuffer(buffer_type, 0);                                                      opengl_check;
+		glGenBuffers(1, &vbo_index);                                              opengl_check;
+		glBindBuffer(buffer_type, vbo_index);                                     opengl_check;
+		glBufferData(buffer_type, GLsizeiptr(size_byte), data, draw_type);       opengl_check;
+		glBindBuffer(buffer_type, 0);                                             opengl_check;
 
 		return vbo_index;
 	}
+	template <typename T>
+	static GLuint opengl_buffer_data_initialize_generic(numarray<T> const& data, GLuint buffer_type, GLenum draw_type)
+	{
+		return opengl_buffer_data_initialize_generic(ptr(data), size_in_memory(data), buffer_type, draw_type);
+	}
 
+	void opengl_vbo_structure::initialize_data_on_gpu(numarray<float> const& data, GLuint div)
+	{
+		if(id!=0){
+			warning_initialize_non_empty();
+		}
+
+		divisor = div;
+		id = opengl_buffer_data_initialize_generic(data, GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
+		size = data.size();
+		type = GL_ARRAY_BUFFER;
+
+		details.size_byte = size_in_memory(data);
+		details.size_element = 1;
+		details.type_element = GL_FLOAT;
+	}
 	void opengl_vbo_structure::initialize_data_on_gpu(numarray<vec3> const& data, GLuint div)
 	{
 		if(id!=0){
@@ -63,6 +82,62 @@ namespace cgp
 		details.size_element = 4;
 		details.type_element = GL_FLOAT;
 	}
+	void opengl_vbo_structure::initialize_data_on_gpu(numarray<mat4> const& data, GLuint div)
+	{
+		if(id!=0){
+			warning_initialize_non_empty();
+		}
+
+		divisor = div;
+		id = opengl_buffer_data_initialize_generic(data.data.data(), sizeof(mat4) * data.size(), GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
+		size = data.size();
+		type = GL_ARRAY_BUFFER;
+
+		details.size_byte = sizeof(mat4) * data.size();
+		details.size_element = 16;
+		details.type_element = GL_FLOAT;
+	}
+	void opengl_vbo_structure::initialize_data_on_gpu(vec2 const* data, size_t size_arg, GLuint div)
+	{
+		if(id!=0){
+			warning_initialize_non_empty();
+		}
+
+		divisor = div;
+		id = opengl_buffer_data_initialize_generic(data, size_arg * sizeof(vec2), GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
+		size = GLuint(size_arg);
+		type = GL_ARRAY_BUFFER;
+
+		details.size_byte = GLuint(size_arg * sizeof(vec2));
+		details.size_element = 2;
+		details.type_element = GL_FLOAT;
+	}
+	void opengl_vbo_structure::initialize_data_on_gpu(vec3 const* data, size_t size_arg, GLuint div)
+	{
+		if(id!=0){
+			warning_initialize_non_empty();
+		}
+
+		divisor = div;
+		id = opengl_buffer_data_initialize_generic(data, size_arg * sizeof(vec3), GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
+		size = GLuint(size_arg);
+		type = GL_ARRAY_BUFFER;
+
+		details.size_byte = GLuint(size_arg * sizeof(vec3));
+		details.size_element = 3;
+		details.type_element = GL_FLOAT;
+	}
+	void opengl_vbo_structure::update(numarray<float> const& data, int size_elements_update)
+	{
+		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
+		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+		if (size_elements_update == -1) {
+			glBufferSubData(GL_ARRAY_BUFFER, 0, size_in_memory(data), ptr(data));  opengl_check;
+		}
+		else {
+			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * size_elements_update, ptr(data));  opengl_check;
+		}
+	}
 	void opengl_vbo_structure::update(numarray<vec2> const& data, int size_elements_update)
 	{
 		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
@@ -96,10 +171,33 @@ namespace cgp
 			glBufferSubData(GL_ARRAY_BUFFER, 0, 4 * sizeof(float) * size_elements_update, ptr(data));  opengl_check;
 		}
 	}
+	void opengl_vbo_structure::update(numarray<mat4> const& data, int size_elements_update)
+	{
+		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
+		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+		if (size_elements_update == -1) {
+			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(mat4) * data.size(), data.data.data());  opengl_check;
+		}
+		else {
+			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(mat4) * size_elements_update, data.data.data());  opengl_check;
+		}
+	}
 
 
 	void opengl_set_vao_location(opengl_vbo_structure const& vbo, GLuint location_index)
 	{
+		if (vbo.details.size_element == 16) {
+			// mat4: one attribute of 4 floats per row
+			vbo.bind();
+			for (GLuint k = 0; k < 4; ++k) {
+				glEnableVertexAttribArray(location_index + k); opengl_check
+				glVertexAttribPointer(location_index + k, 4, vbo.details.type_element, GL_FALSE, 16 * sizeof(float), reinterpret_cast<void const*>(4 * k * sizeof(float))); opengl_check
+				if (vbo.divisor>0) { glVertexAttribDivisor(location_index + k, vbo.divisor);                                      opengl_check; }
+			}
+			vbo.unbind();
+			return;
+		}
+
 		vbo.bind();
 		glEnableVertexAttribArray(location_index); opengl_check
 		glVertexAttribPointer(location_index, vbo.details.size_element, vbo.details.type_element, GL_FALSE, 0, nullptr); opengl_check
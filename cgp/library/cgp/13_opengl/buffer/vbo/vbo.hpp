@@ -11,22 +11,32 @@ namespace cgp
 {
 	struct opengl_vbo_structure : opengl_gpu_buffer
 	{
+		void initialize_data_on_gpu(numarray<float> const& data, GLuint divisor = 0);
 		void initialize_data_on_gpu(numarray<vec3> const& data, GLuint divisor = 0);
 		void initialize_data_on_gpu(numarray<vec2> const& data, GLuint divisor = 0);
 		void initialize_data_on_gpu(numarray<vec4> const& data, GLuint divisor = 0);
+		/** A mat4 is read in the shader as 4 consecutive attributes (ex. a mat4 attribute). The rows of the cgp matrix are the columns of the GLSL matrix. */
+		void initialize_data_on_gpu(numarray<mat4> const& data, GLuint divisor = 0);
+
+		/** Send size elements read directly from contiguous memory (ex. a file mapped in memory) */
+		void initialize_data_on_gpu(vec2 const* data, size_t size, GLuint divisor = 0);
+		void initialize_data_on_gpu(vec3 const* data, size_t size, GLuint divisor = 0);
 
 		/** Re-write data on the VBO. (without re-allocation) in calling glBufferSubData
 		* - size_elements_update: 
 		*   number of elements to sent from data
 		*    -1: send all data (similar to data.size()) 	*/
+		void update(numarray<float> const& data, int size_elements_update = -1);
 		void update(numarray<vec2> const& data, int size_elements_update = -1);
 		void update(numarray<vec3> const& data, int size_elements_update = -1);
 		void update(numarray<vec4> const& data, int size_elements_update = -1);
+		void update(numarray<mat4> const& data, int size_elements_update = -1);
 
 		GLuint divisor;
 	};
 
-	/** Call glVertexAttribPointer and set the correspondance between VBO and the location in the shader */
+	/** Call glVertexAttribPointer and set the correspondance between VBO and the location in the shader
+	* A VBO of mat4 uses the 4 locations [location_index, location_index+3] */
 	void opengl_set_vao_location(opengl_vbo_structure const& vbo, GLuint location_index);
 
 }
@@ -18,6 +18,18 @@ namespace cgp
         return s;
 	}
 
+	bool opengl_has_extension(std::string const& name)
+	{
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint k = 0; k < count; ++k) {
+			char const* extension = reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, GLuint(k)));
+			if (extension != nullptr && name == extension)
+				return true;
+		}
+		return false;
+	}
+
 	static std::string opengl_error_to_string(GLenum error)
     {
         switch(error)
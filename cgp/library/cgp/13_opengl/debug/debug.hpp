@@ -12,6 +12,9 @@
 namespace cgp
 {
 	std::string opengl_info_display();
+
+	// Return true if the current OpenGL context exposes the given extension (ex. "GL_EXT_texture_compression_s3tc")
+	bool opengl_has_extension(std::string const& name);
 	void check_opengl_error(const std::string& file, const std::string& function, int line);
 }
 
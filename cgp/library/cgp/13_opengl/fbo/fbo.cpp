@@ -41,6 +41,12 @@ namespace cgp{
 	}
 
 
+	void opengl_fbo_structure::blit(GLuint target_framebuffer) const {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, id);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target_framebuffer);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
 
 	void opengl_fbo_structure::update_screen_size(int new_width, int new_height) {
 
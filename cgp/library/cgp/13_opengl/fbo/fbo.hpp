@@ -51,6 +51,9 @@ namespace cgp {
 		// Stop the rendering pass on the FBO
 		void unbind() const;
 
+		// Copy the color buffer of the FBO in another framebuffer (default: the screen), with the same size
+		void blit(GLuint target_framebuffer = 0) const;
+
 		// Update the screen size (resize the texture if needed)
 		void update_screen_size(int window_width, int windows_height);
 
@@ -0,0 +1,428 @@
+#include "frame_capture.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+#include "cgp/07_image/image.hpp"
+#include "../debug/debug.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <set>
+#include <vector>
+
+#ifndef __EMSCRIPTEN__
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace cgp
+{
+	namespace frame_capture_detail
+	{
+		// Pixels of a frame read back from the GPU (rgb, bottom row first as given by OpenGL)
+		struct frame_data
+		{
+			std::vector<unsigned char> pixels;
+			int width = 0;
+			int height = 0;
+			std::string filename; // empty for a raw frame
+		};
+
+		// PBO of the ring, with the fence signaled when the copy of the frame is finished
+		struct ring_slot
+		{
+			GLuint pbo = 0;
+			GLsync fence = nullptr;
+			size_t capacity = 0;
+			int width = 0;
+			int height = 0;
+			std::string filename; // empty for a raw frame
+			bool screenshot = false;
+		};
+
+		struct capture_state
+		{
+			std::vector<ring_slot> ring;
+			int next_slot = 0;
+			std::deque<int> pending; // slots waiting for their fence, in the order of the frames
+
+			bool recording = false;
+			std::string directory;
+			frame_capture_format format = frame_capture_format::png;
+			int frame_counter = 0;
+			bool screenshot_requested = false;
+			std::string screenshot_directory;
+			int screenshot_counter = 0;
+
+#ifndef __EMSCRIPTEN__
+			// Encoders
+			std::mutex mutex;
+			std::condition_variable work_available;
+			std::condition_variable work_done;
+			std::deque<frame_data> queue;
+			std::vector<std::vector<unsigned char>> buffer_pool;
+			int busy = 0;
+			bool quit = false;
+			std::vector<std::thread> threads;
+
+			std::atomic<int> captured{ 0 };
+			std::atomic<int> written{ 0 };
+			std::atomic<int> dropped{ 0 };
+
+			// Raw output (only used by the single raw encoder thread)
+			std::ofstream raw_stream;
+			int raw_width = 0;
+			int raw_height = 0;
+			std::set<std::string> raw_files;
+
+			void encoder_loop();
+			void encode(frame_data& frame);
+			void start_encoders(int number_of_threads);
+			void stop_encoders();
+#endif
+		};
+
+#ifndef __EMSCRIPTEN__
+		void capture_state::encode(frame_data& frame)
+		{
+			// OpenGL gives the bottom row first
+			size_t const row = size_t(3) * frame.width;
+			for (int y = 0; y < frame.height / 2; ++y)
+				std::swap_ranges(frame.pixels.begin() + y * row, frame.pixels.begin() + (y + 1) * row, frame.pixels.begin() + (frame.height - 1 - y) * row);
+
+			if (frame.filename.empty()) {
+				if (!raw_stream.is_open() || raw_width != frame.width || raw_height != frame.height) {
+					std::string const filename = directory + "capture_" + str(frame.width) + "x" + str(frame.height) + ".rgb";
+					bool const append = raw_files.count(filename) > 0;
+					raw_stream.close();
+					raw_stream.open(filename, std::ios::out | std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+					raw_files.insert(filename);
+					raw_width = frame.width;
+					raw_height = frame.height;
+				}
+				raw_stream.write(reinterpret_cast<char const*>(frame.pixels.data()), std::streamsize(frame.pixels.size()));
+				return;
+			}
+
+			// The pixels are moved in the image (and back) to avoid a copy
+			image_structure im;
+			im.width = frame.width;
+			im.height = frame.height;
+			im.color_type = image_color_type::rgb;
+			im.data.data.swap(frame.pixels);
+			size_t const N = frame.filename.size();
+			if (N > 4 && frame.filename.substr(N - 4) == ".jpg")
+				image_save_jpg(frame.filename, im);
+			else
+				image_save_png(frame.filename, im);
+			im.data.data.swap(frame.pixels);
+		}
+
+		void capture_state::encoder_loop()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true) {
+				work_available.wait(lock, [this]() { return quit || !queue.empty(); });
+				if (queue.empty())
+					return;
+
+				frame_data frame = std::move(queue.front());
+				queue.pop_front();
+				busy++;
+				lock.unlock();
+
+				encode(frame);
+
+				lock.lock();
+				busy--;
+				buffer_pool.push_back(std::move(frame.pixels));
+				written++;
+				work_done.notify_all();
+			}
+		}
+
+		void capture_state::start_encoders(int number_of_threads)
+		{
+			if (int(threads.size()) == number_of_threads)
+				return;
+			stop_encoders();
+			quit = false;
+			for (int k = 0; k < number_of_threads; ++k)
+				threads.push_back(std::thread([this]() { encoder_loop(); }));
+		}
+
+		void capture_state::stop_encoders()
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				work_done.wait(lock, [this]() { return queue.empty() && busy == 0; });
+				quit = true;
+			}
+			work_available.notify_all();
+			for (auto& thread : threads)
+				thread.join();
+			threads.clear();
+			raw_stream.close();
+			raw_files.clear();
+		}
+#endif
+
+		// Copy the content of the PBO of a slot whose copy is finished, and give it to the encoders
+		static void read_slot(capture_state& s, ring_slot& slot, bool wait, int max_queued_frames)
+		{
+			if (wait) {
+				glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(1000000000)); opengl_check;
+			}
+			glDeleteSync(slot.fence);
+			slot.fence = nullptr;
+
+#ifndef __EMSCRIPTEN__
+			size_t const size = size_t(3) * slot.width * slot.height;
+			frame_data frame;
+			{
+				std::lock_guard<std::mutex> lock(s.mutex);
+				// Screenshots are never dropped
+				if (int(s.queue.size()) >= max_queued_frames && !slot.screenshot) {
+					s.dropped++;
+					return;
+				}
+				if (!s.buffer_pool.empty()) {
+					frame.pixels = std::move(s.buffer_pool.back());
+					s.buffer_pool.pop_back();
+				}
+			}
+			frame.pixels.resize(size);
+			frame.width = slot.width;
+			frame.height = slot.height;
+			frame.filename = slot.filename;
+
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo); opengl_check;
+			void const* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GLsizeiptr(size), GL_MAP_READ_BIT); opengl_check;
+			if (data != nullptr)
+				std::memcpy(frame.pixels.data(), data, size);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER); opengl_check;
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0); opengl_check;
+
+			s.captured++;
+			{
+				std::lock_guard<std::mutex> lock(s.mutex);
+				s.queue.push_back(std::move(frame));
+			}
+			s.work_available.notify_one();
+#else
+			(void)s; (void)max_queued_frames;
+#endif
+		}
+
+		// Read the slots whose copy is finished (all of them if wait is true)
+		static void read_finished_slots(capture_state& s, bool wait, int max_queued_frames)
+		{
+			while (!s.pending.empty()) {
+				ring_slot& slot = s.ring[s.pending.front()];
+				if (!wait) {
+					GLenum const status = glClientWaitSync(slot.fence, 0, 0); opengl_check;
+					if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+						return;
+				}
+				s.pending.pop_front();
+				read_slot(s, slot, wait, max_queued_frames);
+			}
+		}
+	}
+
+	using namespace frame_capture_detail;
+
+	opengl_frame_capture_structure::opengl_frame_capture_structure()
+		: state(new capture_state())
+	{}
+
+	opengl_frame_capture_structure::~opengl_frame_capture_structure()
+	{
+#ifndef __EMSCRIPTEN__
+		state->stop_encoders();
+#endif
+	}
+
+	void opengl_frame_capture_structure::start_recording(std::string const& directory, frame_capture_format format)
+	{
+#ifndef __EMSCRIPTEN__
+		stop_recording();
+		create_directory(directory);
+		state->directory = directory;
+		state->format = format;
+		state->frame_counter = 0;
+		state->recording = true;
+
+		int number_of_threads = number_of_encoder_threads > 0 ? number_of_encoder_threads : int(std::thread::hardware_concurrency()) - 1;
+		state->start_encoders(format == frame_capture_format::raw ? 1 : std::max(1, number_of_threads));
+#else
+		(void)directory; (void)format;
+		warning_cgp("Frame capture is not available with WebGL", "");
+#endif
+	}
+
+	void opengl_frame_capture_structure::stop_recording()
+	{
+		if (!state->recording && state->pending.empty())
+			return;
+		state->recording = false;
+		read_finished_slots(*state, true, max_queued_frames);
+#ifndef __EMSCRIPTEN__
+		state->stop_encoders();
+#endif
+	}
+
+	bool opengl_frame_capture_structure::is_recording() const
+	{
+		return state->recording;
+	}
+
+	void opengl_frame_capture_structure::request_screenshot(std::string const& directory)
+	{
+#ifndef __EMSCRIPTEN__
+		create_directory(directory);
+		state->screenshot_directory = directory;
+		state->screenshot_requested = true;
+		if (state->threads.empty())
+			state->start_encoders(1);
+#else
+		(void)directory;
+		warning_cgp("Frame capture is not available with WebGL", "");
+#endif
+	}
+
+	bool opengl_frame_capture_structure::is_active() const
+	{
+		return state->recording || state->screenshot_requested || !state->pending.empty();
+	}
+
+	void opengl_frame_capture_structure::capture(opengl_fbo_structure const& fbo)
+	{
+		capture(fbo.id, fbo.width, fbo.height);
+	}
+
+	void opengl_frame_capture_structure::capture(GLuint framebuffer_id, int width, int height)
+	{
+		if (!is_active() || width <= 0 || height <= 0)
+			return;
+		capture_state& s = *state;
+
+		// Frames of the previous calls that are ready
+		read_finished_slots(s, false, max_queued_frames);
+
+		// Only waiting for the readback of the previous frames (ex. screenshot taken while not recording)
+		if (!s.recording && !s.screenshot_requested)
+			return;
+
+		if (int(s.ring.size()) != std::max(1, ring_size)) {
+			read_finished_slots(s, true, max_queued_frames);
+			for (auto& slot : s.ring)
+				glDeleteBuffers(1, &slot.pbo);
+			s.ring.assign(std::max(1, ring_size), ring_slot());
+			s.next_slot = 0;
+		}
+
+		// The slot is still used by a frame the GPU has not finished: wait for it (the GPU is ring_size frames late)
+		int const k = s.next_slot;
+		ring_slot& slot = s.ring[k];
+		while (slot.fence != nullptr) {
+			ring_slot& oldest = s.ring[s.pending.front()];
+			s.pending.pop_front();
+			read_slot(s, oldest, true, max_queued_frames);
+		}
+		s.next_slot = (k + 1) % int(s.ring.size());
+
+		// Name of the output
+		slot.screenshot = s.screenshot_requested;
+		if (s.screenshot_requested) {
+			slot.filename = s.screenshot_directory + "screenshot_" + str_zero_fill(str(s.screenshot_counter++), 6) + ".png";
+			s.screenshot_requested = false;
+		}
+		else if (s.format == frame_capture_format::raw)
+			slot.filename = "";
+		else
+			slot.filename = s.directory + "frame_" + str_zero_fill(str(s.frame_counter), 6) + (s.format == frame_capture_format::jpg ? ".jpg" : ".png");
+		if (s.recording)
+			s.frame_counter++;
+		slot.width = width;
+		slot.height = height;
+
+		// Asynchronous copy of the framebuffer in the PBO
+		size_t const size = size_t(3) * width * height;
+		if (slot.pbo == 0) {
+			glGenBuffers(1, &slot.pbo); opengl_check;
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo); opengl_check;
+		if (slot.capacity < size) {
+			glBufferData(GL_PIXEL_PACK_BUFFER, GLsizeiptr(size), nullptr, GL_STREAM_READ); opengl_check;
+			slot.capacity = size;
+		}
+
+		GLint previous_read_framebuffer = 0;
+		GLint previous_alignment = 4;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_read_framebuffer);
+		glGetIntegerv(GL_PACK_ALIGNMENT, &previous_alignment);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_id); opengl_check;
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr); opengl_check;
+		slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0); opengl_check;
+		s.pending.push_back(k);
+
+		glPixelStorei(GL_PACK_ALIGNMENT, previous_alignment);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, GLuint(previous_read_framebuffer));
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0); opengl_check;
+	}
+
+	int opengl_frame_capture_structure::frames_captured() const
+	{
+#ifndef __EMSCRIPTEN__
+		return state->captured;
+#else
+		return 0;
+#endif
+	}
+	int opengl_frame_capture_structure::frames_written() const
+	{
+#ifndef __EMSCRIPTEN__
+		return state->written;
+#else
+		return 0;
+#endif
+	}
+	int opengl_frame_capture_structure::frames_dropped() const
+	{
+#ifndef __EMSCRIPTEN__
+		return state->dropped;
+#else
+		return 0;
+#endif
+	}
+	int opengl_frame_capture_structure::frames_queued() const
+	{
+#ifndef __EMSCRIPTEN__
+		std::lock_guard<std::mutex> lock(state->mutex);
+		return int(state->queue.size()) + state->busy;
+#else
+		return 0;
+#endif
+	}
+
+	void opengl_frame_capture_structure::clear()
+	{
+		stop_recording();
+		for (auto& slot : state->ring) {
+			if (slot.fence != nullptr)
+				glDeleteSync(slot.fence);
+			glDeleteBuffers(1, &slot.pbo);
+		}
+		state->ring.clear();
+		state->pending.clear();
+		state->next_slot = 0;
+		opengl_check;
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+#include "cgp/13_opengl/fbo/fbo.hpp"
+
+#include <memory>
+#include <string>
+
+namespace cgp
+{
+	// Output of the frame capture
+	//  png/jpg: one image file per frame (frame_000000.png, ...)
+	//  raw: all the frames appended to a single file of rgb24 pixels, top row first (capture_WxH.rgb)
+	//       ex. converted with: ffmpeg -f rawvideo -pixel_format rgb24 -video_size WxH -framerate 60 -i capture_WxH.rgb video.mp4
+	enum class frame_capture_format { png, jpg, raw };
+
+	namespace frame_capture_detail { struct capture_state; }
+
+	// Capture of the rendered frames without stalling the rendering
+	//  - capture() only issues an asynchronous glReadPixels into a pixel buffer object (PBO) of a ring, protected by a fence.
+	//  - The PBOs of the previous frames are read back once their fence is signaled (the GPU has finished the copy),
+	//    so that the CPU never waits for the GPU as long as the GPU is less than ring_size frames late.
+	//  - The pixels are then handed to background threads which flip, encode (lodepng/jpge) and write the files.
+	//  If the encoders cannot keep up, at most max_queued_frames are kept in memory and the next frames are dropped (and counted)
+	//   instead of slowing down the rendering.
+	//
+	//  The OpenGL objects must be released with clear() while the context exists. The destructor only stops the encoder threads.
+	//
+	//  Usage:
+	//  | opengl_frame_capture_structure capture;
+	//  | capture.start_recording("captures/", frame_capture_format::png);
+	//  | // in the animation loop, after the rendering of the scene in the fbo
+	//  | capture.capture(fbo);
+	//  | ...
+	//  | capture.stop_recording(); // wait until all the frames are written
+	struct opengl_frame_capture_structure
+	{
+		// Number of PBOs in the ring (2 or 3: number of frames the readback can be late)
+		int ring_size = 3;
+		// Number of encoding threads for png/jpg (0: number of hardware threads minus one). The raw format is always written by a single thread.
+		int number_of_encoder_threads = 0;
+		// Maximal number of frames waiting for the encoders
+		int max_queued_frames = 16;
+
+		opengl_frame_capture_structure();
+		~opengl_frame_capture_structure();
+
+		// Start recording the frames passed to capture() in the directory (created if needed)
+		void start_recording(std::string const& directory, frame_capture_format format = frame_capture_format::png);
+		// Stop the recording: wait for the pending readbacks and for the encoders
+		void stop_recording();
+		bool is_recording() const;
+
+		// Save the next captured frame as a png image in the directory (screenshot_000000.png, ...), whether recording or not
+		void request_screenshot(std::string const& directory);
+
+		// True if capture() must be called at the next frame: recording, screenshot requested, or frames still waiting for their readback
+		bool is_active() const;
+
+		// Read asynchronously the color buffer of the fbo (or of a framebuffer id, 0 being the default framebuffer)
+		//  The frames of the previous calls that are ready are handed to the encoders. The current frame is only read when recording
+		//  or when a screenshot is requested. Does nothing if is_active() is false. Must be called from the thread owning the OpenGL context.
+		void capture(opengl_fbo_structure const& fbo);
+		void capture(GLuint framebuffer_id, int width, int height);
+
+		// Statistics
+		int frames_captured() const; // frames read back from the GPU
+		int frames_written() const;  // frames encoded and written on disk
+		int frames_dropped() const;  // frames dropped as the encoders were late
+		int frames_queued() const;   // frames waiting for the encoders
+
+		// Release the PBOs and fences (the recording is stopped)
+		void clear();
+
+	private:
+		std::unique_ptr<frame_capture_detail::capture_state> state;
+	};
+}
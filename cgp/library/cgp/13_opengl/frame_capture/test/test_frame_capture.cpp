@@ -0,0 +1,66 @@
+#include "test_frame_capture.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+#include "cgp/07_image/image.hpp"
+#include "cgp/14_window/headless_context/headless_context.hpp"
+#include "../frame_capture.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+namespace cgp_test
+{
+	void test_frame_capture()
+	{
+		using namespace cgp;
+
+		// An OpenGL context is needed: the test is skipped on the machines without EGL
+		headless_context_structure context;
+		if (!context.create(3, 3)) {
+			std::cout << "test_frame_capture skipped (no headless OpenGL context)" << std::endl;
+			return;
+		}
+
+		opengl_fbo_structure fbo;
+		fbo.initialize();
+		fbo.update_screen_size(16, 8);
+		fbo.bind();
+		glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		fbo.unbind();
+
+		// Screenshot taken while not recording
+		std::string const directory = "test_frame_capture/";
+		opengl_frame_capture_structure capture;
+		assert_cgp_no_msg(!capture.is_active());
+		capture.request_screenshot(directory);
+		assert_cgp_no_msg(capture.is_active());
+		capture.capture(fbo);
+
+		// The following frames are called as the animation loop does: only while is_active() is true.
+		//  The screenshot must be read back and written without any recording nor clear().
+		for (int frame = 0; frame < 1000 && capture.is_active(); ++frame) {
+			glFinish();
+			capture.capture(fbo);
+		}
+		assert_cgp_no_msg(!capture.is_active());
+		assert_cgp_no_msg(capture.frames_captured() == 1);
+
+		for (int k = 0; k < 1000 && capture.frames_written() < 1; ++k)
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		assert_cgp_no_msg(capture.frames_written() == 1);
+
+		std::string const filename = directory + "screenshot_000000.png";
+		assert_cgp_no_msg(check_file_exist(filename));
+		image_structure const im = image_load_png(filename);
+		assert_cgp_no_msg(im.width == 16 && im.height == 8);
+		assert_cgp_no_msg(im.data.data[0] == 255 && im.data.data[1] == 0 && im.data.data[2] == 0);
+
+		capture.clear();
+		std::remove(filename.c_str());
+		context.destroy();
+	}
+}
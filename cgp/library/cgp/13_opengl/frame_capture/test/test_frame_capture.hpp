@@ -0,0 +1,7 @@
+#pragma once
+
+
+namespace cgp_test
+{
+	void test_frame_capture();
+}
@@ -6,6 +6,11 @@
 #include "debug/debug.hpp"
 #include "uniform/uniform.hpp"
 #include "shaders/shaders.hpp"
+#include "shaders/program_binary_cache/program_binary_cache.hpp"
+#include "shaders/shader_builder/shader_builder.hpp"
 #include "texture/texture.hpp"
+#include "texture/texture_manager/texture_manager.hpp"
 #include "fbo/fbo.hpp"
+#include "frame_capture/frame_capture.hpp"
+#include "render_stats/render_stats.hpp"
 #include "emscripten/emscripten.hpp"
\ No newline at end of file
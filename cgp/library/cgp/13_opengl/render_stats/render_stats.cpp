@@ -0,0 +1,216 @@
+#include "render_stats.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace cgp
+{
+	bool render_stats_structure::enabled = true;
+
+	render_stats_counters& render_stats_counters::operator+=(render_stats_counters const& other)
+	{
+		draw_calls += other.draw_calls;
+		program_switches += other.program_switches;
+		texture_binds += other.texture_binds;
+		uniform_uploads += other.uniform_uploads;
+		triangles += other.triangles;
+		return *this;
+	}
+
+	void render_stats_structure::frame_begin()
+	{
+		current = render_stats_frame();
+		current.index = frame_counter;
+		scope_stack.clear();
+		last_program = 0;
+	}
+
+	void render_stats_structure::frame_end()
+	{
+		frame_counter++;
+		last = current;
+		if (max_frames > 0) {
+			history.push_back(std::move(current));
+			while (int(history.size()) > max_frames)
+				history.pop_front();
+		}
+		current = render_stats_frame();
+		current.index = frame_counter;
+		scope_stack.clear();
+	}
+
+	render_stats_frame const& render_stats_structure::last_frame() const
+	{
+		return last;
+	}
+
+	std::deque<render_stats_frame> const& render_stats_structure::frames() const
+	{
+		return history;
+	}
+
+	void render_stats_structure::clear_history()
+	{
+		history.clear();
+	}
+
+	render_stats_counters* render_stats_structure::scope_counters()
+	{
+		if (scope_stack.empty())
+			return nullptr;
+		return &current.scopes[scope_stack.back()].counters;
+	}
+
+	void render_stats_structure::count_draw(GLenum mode, size_t vertex_count, int instance_count)
+	{
+		if (!enabled)
+			return;
+
+		size_t triangles = 0;
+		if (mode == GL_TRIANGLES)
+			triangles = vertex_count / 3;
+		else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && vertex_count > 2)
+			triangles = vertex_count - 2;
+		triangles *= size_t(instance_count > 1 ? instance_count : 1);
+
+		current.total.draw_calls++;
+		current.total.triangles += triangles;
+		if (render_stats_counters* scope = scope_counters()) {
+			scope->draw_calls++;
+			scope->triangles += triangles;
+		}
+	}
+
+	void render_stats_structure::count_program(GLuint program)
+	{
+		if (!enabled || program == 0 || program == last_program)
+			return;
+		last_program = program;
+		current.total.program_switches++;
+		if (render_stats_counters* scope = scope_counters())
+			scope->program_switches++;
+	}
+
+	void render_stats_structure::count_texture_bind()
+	{
+		if (!enabled)
+			return;
+		current.total.texture_binds++;
+		if (render_stats_counters* scope = scope_counters())
+			scope->texture_binds++;
+	}
+
+	void render_stats_structure::count_uniform_upload()
+	{
+		if (!enabled)
+			return;
+		current.total.uniform_uploads++;
+		if (render_stats_counters* scope = scope_counters())
+			scope->uniform_uploads++;
+	}
+
+	void render_stats_structure::push_scope(char const* name)
+	{
+		// A scope used several times in the frame accumulates its counters
+		int index = -1;
+		for (size_t k = 0; k < current.scopes.size() && index < 0; ++k)
+			if (current.scopes[k].name == name || std::strcmp(current.scopes[k].name, name) == 0)
+				index = int(k);
+		if (index < 0) {
+			render_stats_scope_counters scope;
+			scope.name = name;
+			current.scopes.push_back(scope);
+			index = int(current.scopes.size()) - 1;
+		}
+		scope_stack.push_back(index);
+	}
+
+	void render_stats_structure::pop_scope()
+	{
+		if (!scope_stack.empty())
+			scope_stack.pop_back();
+	}
+
+	static void write_csv_line(std::ofstream& stream, int frame, char const* scope, render_stats_counters const& c)
+	{
+		stream << frame << ",\"" << scope << "\"," << c.draw_calls << "," << c.program_switches << "," << c.texture_binds << ","
+			<< c.uniform_uploads << "," << c.triangles << "\n";
+	}
+
+	bool render_stats_structure::save_csv(std::string const& filename) const
+	{
+		std::ofstream stream(filename);
+		if (!stream)
+			return false;
+		stream << "frame,scope,draw_calls,program_switches,texture_binds,uniform_uploads,triangles\n";
+		for (render_stats_frame const& frame : history) {
+			write_csv_line(stream, frame.index, "total", frame.total);
+			for (render_stats_scope_counters const& scope : frame.scopes)
+				write_csv_line(stream, frame.index, scope.name, scope.counters);
+		}
+		return bool(stream);
+	}
+
+	static std::string json_number(double value)
+	{
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+		return buffer;
+	}
+
+	static std::string json_mean(render_stats_counters const& sum, size_t number_of_frames)
+	{
+		double const N = number_of_frames > 0 ? double(number_of_frames) : 1.0;
+		return "{\"draw_calls\": " + json_number(sum.draw_calls / N)
+			+ ", \"program_switches\": " + json_number(sum.program_switches / N)
+			+ ", \"texture_binds\": " + json_number(sum.texture_binds / N)
+			+ ", \"uniform_uploads\": " + json_number(sum.uniform_uploads / N)
+			+ ", \"triangles\": " + json_number(double(sum.triangles) / N) + "}";
+	}
+
+	bool render_stats_structure::save_json(std::string const& filename) const
+	{
+		std::ofstream stream(filename);
+		if (!stream)
+			return false;
+
+		// Sum over the frames of the total and of each scope (in the order of their first use)
+		render_stats_counters total;
+		std::vector<render_stats_scope_counters> scopes;
+		for (render_stats_frame const& frame : history) {
+			total += frame.total;
+			for (render_stats_scope_counters const& scope : frame.scopes) {
+				size_t k = 0;
+				while (k < scopes.size() && std::strcmp(scopes[k].name, scope.name) != 0)
+					k++;
+				if (k == scopes.size())
+					scopes.push_back({ scope.name, render_stats_counters() });
+				scopes[k].counters += scope.counters;
+			}
+		}
+
+		stream << "{\n  \"frames\": " << history.size() << ",\n";
+		stream << "  \"mean_per_frame\": " << json_mean(total, history.size()) << ",\n";
+		stream << "  \"mean_per_frame_scopes\": {";
+		for (size_t k = 0; k < scopes.size(); ++k)
+			stream << (k == 0 ? "\n    \"" : ",\n    \"") << scopes[k].name << "\": " << json_mean(scopes[k].counters, history.size());
+		stream << "\n  },\n  \"per_frame\": [";
+		bool first = true;
+		for (render_stats_frame const& frame : history) {
+			render_stats_counters const& c = frame.total;
+			stream << (first ? "\n    " : ",\n    ") << "{\"frame\": " << frame.index << ", \"draw_calls\": " << c.draw_calls
+				<< ", \"program_switches\": " << c.program_switches << ", \"texture_binds\": " << c.texture_binds
+				<< ", \"uniform_uploads\": " << c.uniform_uploads << ", \"triangles\": " << c.triangles << "}";
+			first = false;
+		}
+		stream << "\n  ]\n}\n";
+		return bool(stream);
+	}
+
+	render_stats_structure& default_render_stats()
+	{
+		static render_stats_structure stats;
+		return stats;
+	}
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+	// Number of rendering operations
+	//  - draw_calls: glDraw* calls issued by the drawables (an instanced call counts once)
+	//  - program_switches: glUseProgram with a program different from the previous one (the reset to 0 after each draw is not counted)
+	//  - texture_binds: textures bound with opengl_texture_image_structure::bind()
+	//  - uniform_uploads: glUniform* calls issued by opengl_uniform()
+	//  - triangles: triangles rasterized by the draw calls (times the number of instances)
+	struct render_stats_counters
+	{
+		int draw_calls = 0;
+		int program_switches = 0;
+		int texture_binds = 0;
+		int uniform_uploads = 0;
+		size_t triangles = 0;
+
+		render_stats_counters& operator+=(render_stats_counters const& other);
+	};
+
+	// Counters of the operations issued inside a named scope (CGP_RENDER_STATS_SCOPE)
+	struct render_stats_scope_counters
+	{
+		char const* name = nullptr;
+		render_stats_counters counters;
+	};
+
+	// Counters of a frame: total, and detail per scope
+	struct render_stats_frame
+	{
+		int index = 0;
+		render_stats_counters total;
+		std::vector<render_stats_scope_counters> scopes; // in the order of their first use in the frame
+	};
+
+	// Statistics of the rendering operations of each frame
+	//  - The counters are incremented by the cgp draw functions and OpenGL wrappers (opengl_uniform, texture bind).
+	//    Each increment is a few integer additions, the counters are always active unless enabled is set to false.
+	//  - The operations issued inside a CGP_RENDER_STATS_SCOPE are also attributed to this scope. The scopes can be nested:
+	//    an operation is only counted in the innermost scope, so that the sum of the scopes does not exceed the total.
+	//  - The last max_frames frames are kept, and can be exported in CSV or JSON (ex. for the headless benchmark).
+	//  The names of the scopes must be string literals (only the pointer is stored). Must be used from the thread owning the OpenGL context.
+	//
+	//  Usage:
+	//  | // in the animation loop
+	//  | default_render_stats().frame_begin();
+	//  | {
+	//  |     CGP_RENDER_STATS_SCOPE("trees");
+	//  |     draw(tree, environment);
+	//  | }
+	//  | default_render_stats().frame_end();
+	//  | int const draw_calls = default_render_stats().last_frame().total.draw_calls;
+	struct render_stats_structure
+	{
+		// Global switch tested by the instrumented functions
+		static bool enabled;
+
+		// Number of frames kept in memory for the export
+		int max_frames = 600;
+
+		// Delimit a frame
+		void frame_begin();
+		void frame_end();
+
+		// Last completed frame (empty before the first frame_end)
+		render_stats_frame const& last_frame() const;
+		// Completed frames, oldest first
+		std::deque<render_stats_frame> const& frames() const;
+		void clear_history();
+
+		// Export the kept frames. Return false if the file cannot be written.
+		//  CSV: one line per frame and per scope ("total" for the whole frame).
+		//  JSON: mean per frame of the total and of each scope, followed by the total of each frame.
+		bool save_csv(std::string const& filename) const;
+		bool save_json(std::string const& filename) const;
+
+		// Used by the instrumented functions
+		void count_draw(GLenum mode, size_t vertex_count, int instance_count = 1);
+		void count_program(GLuint program);
+		void count_texture_bind();
+		void count_uniform_upload();
+		void push_scope(char const* name);
+		void pop_scope();
+
+	private:
+		render_stats_frame current;
+		render_stats_frame last;
+		std::deque<render_stats_frame> history;
+		std::vector<int> scope_stack; // index of the open scopes in current.scopes
+		GLuint last_program = 0;
+		int frame_counter = 0;
+
+		// Counters of the innermost open scope (nullptr if there is no open scope)
+		render_stats_counters* scope_counters();
+	};
+
+	// Statistics incremented by the cgp functions
+	render_stats_structure& default_render_stats();
+
+	// Attribute the operations of its C++ scope to a name
+	struct render_stats_scope
+	{
+		explicit render_stats_scope(char const* name)
+			: active(render_stats_structure::enabled)
+		{
+			if (active)
+				default_render_stats().push_scope(name);
+		}
+		~render_stats_scope()
+		{
+			if (active)
+				default_render_stats().pop_scope();
+		}
+		render_stats_scope(render_stats_scope const&) = delete;
+		render_stats_scope& operator=(render_stats_scope const&) = delete;
+
+	private:
+		bool active;
+	};
+}
+
+#define CGP_RENDER_STATS_CONCATENATE_DETAIL(a, b) a##b
+#define CGP_RENDER_STATS_CONCATENATE(a, b) CGP_RENDER_STATS_CONCATENATE_DETAIL(a, b)
+#define CGP_RENDER_STATS_SCOPE(NAME) cgp::render_stats_scope CGP_RENDER_STATS_CONCATENATE(cgp_render_stats_scope_, __LINE__)(NAME)
@@ -0,0 +1,69 @@
+#include "test_render_stats.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../render_stats.hpp"
+
+namespace cgp_test
+{
+	void test_render_stats()
+	{
+		using namespace cgp;
+
+		// The counters are only modified by the functions of the structure: no OpenGL context is needed
+		render_stats_structure stats;
+		stats.max_frames = 2;
+
+		stats.frame_begin();
+		stats.count_program(5);
+		stats.count_program(5); // same program: not a switch
+		stats.count_draw(GL_TRIANGLES, 30);
+		{
+			stats.push_scope("trees");
+			stats.count_program(7);
+			stats.count_texture_bind();
+			stats.count_uniform_upload();
+			stats.count_draw(GL_TRIANGLES, 6, 10); // instanced: 2 triangles x 10 instances
+			stats.push_scope("leaves");
+			stats.count_draw(GL_TRIANGLE_STRIP, 4);
+			stats.pop_scope();
+			stats.pop_scope();
+		}
+		stats.push_scope("trees"); // same scope used again in the frame
+		stats.count_draw(GL_LINES, 8);
+		stats.pop_scope();
+		stats.frame_end();
+
+		render_stats_frame const& frame = stats.last_frame();
+		assert_cgp_no_msg(frame.total.draw_calls == 4);
+		assert_cgp_no_msg(frame.total.program_switches == 2);
+		assert_cgp_no_msg(frame.total.texture_binds == 1);
+		assert_cgp_no_msg(frame.total.uniform_uploads == 1);
+		assert_cgp_no_msg(frame.total.triangles == 10 + 20 + 2);
+
+		// Nested scopes: the operations are counted in the innermost scope only
+		assert_cgp_no_msg(frame.scopes.size() == 2);
+		assert_cgp_no_msg(frame.scopes[0].counters.draw_calls == 2);
+		assert_cgp_no_msg(frame.scopes[0].counters.triangles == 20);
+		assert_cgp_no_msg(frame.scopes[0].counters.program_switches == 1);
+		assert_cgp_no_msg(frame.scopes[1].counters.draw_calls == 1);
+		assert_cgp_no_msg(frame.scopes[1].counters.triangles == 2);
+
+		// History limited to max_frames
+		for (int k = 0; k < 3; ++k) {
+			stats.frame_begin();
+			stats.count_draw(GL_TRIANGLES, 3);
+			stats.frame_end();
+		}
+		assert_cgp_no_msg(stats.frames().size() == 2);
+		assert_cgp_no_msg(stats.frames().back().index == 3);
+		assert_cgp_no_msg(stats.last_frame().total.draw_calls == 1);
+
+		// Disabled counters
+		render_stats_structure::enabled = false;
+		stats.frame_begin();
+		stats.count_draw(GL_TRIANGLES, 3);
+		stats.frame_end();
+		render_stats_structure::enabled = true;
+		assert_cgp_no_msg(stats.last_frame().total.draw_calls == 0);
+	}
+}
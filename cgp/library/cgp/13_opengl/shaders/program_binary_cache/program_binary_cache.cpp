@@ -0,0 +1,199 @@
+#include "program_binary_cache.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+#include "../../debug/debug.hpp"
+
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// Enums of GL_ARB_get_program_binary (not part of the OpenGL 3.3 loader)
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+namespace cgp
+{
+#ifndef __EMSCRIPTEN__
+	// Functions of GL_ARB_get_program_binary queried at initialization
+	typedef void (APIENTRY* get_program_binary_function)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+	typedef void (APIENTRY* program_binary_function)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+	typedef void (APIENTRY* program_parameteri_function)(GLuint program, GLenum pname, GLint value);
+	static get_program_binary_function get_program_binary = nullptr;
+	static program_binary_function program_binary = nullptr;
+	static program_parameteri_function program_parameteri = nullptr;
+
+	// Header of a cache file, followed by the program binary
+	struct program_binary_header
+	{
+		char magic[8];        // "CGPPBIN1"
+		uint64_t key;         // hash of driver + sources
+		uint64_t checksum;    // hash of the binary data
+		uint32_t format;      // binary format returned by the driver
+		uint32_t length;      // size of the binary data in bytes
+	};
+	static char const program_binary_magic[8] = { 'C','G','P','P','B','I','N','1' };
+
+	static uint64_t program_key(std::string const& driver, std::string const& vertex_shader_text, std::string const& fragment_shader_text)
+	{
+		uint64_t h = hash_fnv1a(driver);
+		h = hash_fnv1a(vertex_shader_text, h);
+		h = hash_fnv1a(std::string("|"), h);
+		return hash_fnv1a(fragment_shader_text, h);
+	}
+
+	bool opengl_program_binary_cache_structure::initialize(std::string const& directory_arg, GLADloadproc loader)
+	{
+		directory = directory_arg;
+		active = false;
+
+		GLint major = 0, minor = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		glGetIntegerv(GL_MINOR_VERSION, &minor);
+		bool const supported = (major > 4 || (major == 4 && minor >= 1)) || opengl_has_extension("GL_ARB_get_program_binary");
+		if (!supported) {
+			std::cout << "  [info] Program binary cache disabled (GL_ARB_get_program_binary not available)" << std::endl;
+			return false;
+		}
+
+		// Some drivers expose the extension without any usable format
+		GLint format_count = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+		glGetError(); // the enum may be unknown from old drivers
+		if (format_count <= 0) {
+			std::cout << "  [info] Program binary cache disabled (no program binary format supported by the driver)" << std::endl;
+			return false;
+		}
+
+		get_program_binary = reinterpret_cast<get_program_binary_function>(loader("glGetProgramBinary"));
+		program_binary = reinterpret_cast<program_binary_function>(loader("glProgramBinary"));
+		program_parameteri = reinterpret_cast<program_parameteri_function>(loader("glProgramParameteri"));
+		if (get_program_binary == nullptr || program_binary == nullptr || program_parameteri == nullptr)
+			return false;
+
+		if (!create_directory(directory)) {
+			warning_cgp("Cannot create the directory for the program binary cache", directory);
+			return false;
+		}
+
+		driver = str(reinterpret_cast<char const*>(glGetString(GL_VENDOR))) + "|";
+		driver += str(reinterpret_cast<char const*>(glGetString(GL_RENDERER))) + "|";
+		driver += str(reinterpret_cast<char const*>(glGetString(GL_VERSION)));
+
+		active = true;
+		return true;
+	}
+
+	std::string opengl_program_binary_cache_structure::filename(std::string const& vertex_shader_text, std::string const& fragment_shader_text) const
+	{
+		return directory + str_hex(program_key(driver, vertex_shader_text, fragment_shader_text)) + ".bin";
+	}
+
+	GLuint opengl_program_binary_cache_structure::load(std::string const& vertex_shader_text, std::string const& fragment_shader_text)
+	{
+		if (!active)
+			return 0;
+
+		std::string const path = filename(vertex_shader_text, fragment_shader_text);
+		std::ifstream stream(path, std::ios::in | std::ios::binary);
+		if (!stream.is_open()) {
+			miss++;
+			return 0;
+		}
+
+		// Read and validate the header and the data
+		program_binary_header header;
+		std::vector<char> binary;
+		bool valid = bool(stream.read(reinterpret_cast<char*>(&header), sizeof(header)));
+		valid = valid && std::memcmp(header.magic, program_binary_magic, sizeof(program_binary_magic)) == 0;
+		valid = valid && header.key == program_key(driver, vertex_shader_text, fragment_shader_text);
+		if (valid) {
+			binary.resize(header.length);
+			valid = header.length > 0 && bool(stream.read(binary.data(), header.length));
+			valid = valid && hash_fnv1a(binary.data(), binary.size()) == header.checksum;
+		}
+		stream.close();
+
+		GLuint program_id = 0;
+		if (valid) {
+			program_id = glCreateProgram();
+			program_binary(program_id, GLenum(header.format), binary.data(), GLsizei(header.length));
+
+			// The driver may reject a binary (e.g. after an update): the program is then not linked
+			GLint is_linked = GL_FALSE;
+			glGetProgramiv(program_id, GL_LINK_STATUS, &is_linked);
+			if (is_linked == GL_FALSE) {
+				glDeleteProgram(program_id);
+				program_id = 0;
+			}
+			while (glGetError() != GL_NO_ERROR) {} // discard the possible error of an invalid format
+		}
+
+		if (program_id == 0) {
+			std::remove(path.c_str());
+			miss++;
+			return 0;
+		}
+
+		hit++;
+		return program_id;
+	}
+
+	void opengl_program_binary_cache_structure::prepare(GLuint program_id) const
+	{
+		if (!active || program_id == 0)
+			return;
+		program_parameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); opengl_check;
+	}
+
+	void opengl_program_binary_cache_structure::store(GLuint program_id, std::string const& vertex_shader_text, std::string const& fragment_shader_text)
+	{
+		if (!active || program_id == 0)
+			return;
+
+		GLint length = 0;
+		glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return;
+
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		GLsizei written = 0;
+		get_program_binary(program_id, GLsizei(length), &written, &format, binary.data());
+		if (written <= 0)
+			return;
+		binary.resize(written);
+
+		program_binary_header header;
+		std::memcpy(header.magic, program_binary_magic, sizeof(program_binary_magic));
+		header.key = program_key(driver, vertex_shader_text, fragment_shader_text);
+		header.checksum = hash_fnv1a(binary.data(), binary.size());
+		header.format = uint32_t(format);
+		header.length = uint32_t(binary.size());
+
+		std::string const path = filename(vertex_shader_text, fragment_shader_text);
+		std::ofstream stream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!stream.is_open()) {
+			warning_cgp("Cannot write the program binary cache file", path);
+			return;
+		}
+		stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		stream.write(binary.data(), binary.size());
+	}
+
+#else
+	// Program binaries are not available in WebGL: the cache is always inactive
+	std::string opengl_program_binary_cache_structure::filename(std::string const&, std::string const&) const { return ""; }
+	GLuint opengl_program_binary_cache_structure::load(std::string const&, std::string const&) { return 0; }
+	void opengl_program_binary_cache_structure::prepare(GLuint) const {}
+	void opengl_program_binary_cache_structure::store(GLuint, std::string const&, std::string const&) {}
+#endif
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+	// On-disk cache of linked shader programs (GL_ARB_get_program_binary, core in OpenGL 4.1)
+	//  A program is stored as a binary file named after a hash of its complete source text and of the driver string (vendor, renderer, version).
+	//  Any change in the shader source, in the defines, or in the driver results in a different entry.
+	//  The cache is disabled (and every call falls back to source compilation) if the extension is not available.
+	//
+	//  Usage:
+	//  | opengl_program_binary_cache_structure cache;
+	//  | cache.initialize("cache/shaders/", (GLADloadproc)glfwGetProcAddress); // after the OpenGL context creation
+	//  | GLuint id = cache.load(vertex_text, fragment_text); // 0 if not in the cache
+	//  | if(id==0) { ...compile from source, calling cache.prepare(id) before the link...; cache.store(id, vertex_text, fragment_text); }
+	struct opengl_program_binary_cache_structure
+	{
+		// Directory where the binary files are stored
+		std::string directory;
+
+		// True if the cache is initialized and the driver supports program binaries
+		bool active = false;
+
+		// Statistics on the current execution
+		int hit = 0;
+		int miss = 0;
+
+#ifndef __EMSCRIPTEN__
+		// Check the driver support and set up the function access
+		//  loader is the function used to query the OpenGL function addresses (typically glfwGetProcAddress)
+		//  Return true if the cache can be used.
+		bool initialize(std::string const& directory, GLADloadproc loader);
+#endif
+
+		// Create a program from the binary cache corresponding to this source. Return 0 if the program is not in the cache or cannot be used.
+		//  Invalid or outdated entries are removed from the disk.
+		GLuint load(std::string const& vertex_shader_text, std::string const& fragment_shader_text);
+
+		// Request the driver to keep the binary of a program compiled from source (GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+		//  Must be called before glLinkProgram: some drivers provide no usable binary otherwise.
+		void prepare(GLuint program_id) const;
+
+		// Save the binary of the linked program corresponding to this source
+		void store(GLuint program_id, std::string const& vertex_shader_text, std::string const& fragment_shader_text);
+
+		// Path of the binary file associated to this source
+		std::string filename(std::string const& vertex_shader_text, std::string const& fragment_shader_text) const;
+
+	private:
+		// Vendor, renderer and version of the current OpenGL driver
+		std::string driver;
+	};
+}
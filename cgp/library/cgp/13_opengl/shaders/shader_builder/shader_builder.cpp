@@ -0,0 +1,178 @@
+#include "shader_builder.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+
+namespace cgp
+{
+	static std::string permutation_key(std::string const& vertex_shader_path, std::string const& fragment_shader_path, opengl_shader_defines const& defines)
+	{
+		std::string key = vertex_shader_path + "|" + fragment_shader_path + "|";
+		for (auto const& define : defines)
+			key += define.first + "=" + define.second + ";";
+		return key;
+	}
+
+	static std::string directory_of(std::string const& path)
+	{
+		std::size_t const pos = path.find_last_of("/\\");
+		if (pos == std::string::npos)
+			return "";
+		return path.substr(0, pos + 1);
+	}
+
+	// Remove leading spaces/tabulations
+	static std::string trim_left(std::string const& line)
+	{
+		std::size_t const pos = line.find_first_not_of(" \t");
+		if (pos == std::string::npos)
+			return "";
+		return line.substr(pos);
+	}
+
+	// Extract the filename from a line of the form: #include "filename"
+	static std::string include_filename(std::string const& line, std::string const& current_path)
+	{
+		std::size_t const first = line.find('"');
+		std::size_t const last = line.find('"', first + 1);
+		if (first == std::string::npos || last == std::string::npos)
+			error_cgp("Incorrect #include directive [" + line + "] in shader " + current_path + " (expected #include \"filename\")");
+		return line.substr(first + 1, last - first - 1);
+	}
+
+	std::string const& opengl_shader_builder_structure::read_file(std::string const& path)
+	{
+		auto it = file_cache.find(path);
+		if (it == file_cache.end()) {
+			assert_file_exist(path);
+			it = file_cache.insert({ path, read_text_file(path) }).first;
+		}
+		return it->second;
+	}
+
+	void opengl_shader_builder_structure::expand_include(std::string const& path, std::string& output, std::vector<std::string>& include_stack)
+	{
+		if (std::find(include_stack.begin(), include_stack.end(), path) != include_stack.end())
+			error_cgp("Recursive #include of the file " + path + " in shader " + include_stack.front());
+		include_stack.push_back(path);
+
+		std::istringstream stream(read_file(path));
+		std::string line;
+		int line_number = 1;
+		while (std::getline(stream, line)) {
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+
+			if (trim_left(line).compare(0, 8, "#include") == 0) {
+				std::string const included_path = directory_of(path) + include_filename(line, path);
+				output += "#line 1\n";
+				expand_include(included_path, output, include_stack);
+				output += "#line " + str(line_number + 1) + "\n";
+			}
+			else {
+				output += line + "\n";
+			}
+			line_number++;
+		}
+
+		include_stack.pop_back();
+	}
+
+	std::string opengl_shader_builder_structure::preprocess(std::string const& shader_path, opengl_shader_defines const& defines)
+	{
+		std::string expanded;
+		std::vector<std::string> include_stack;
+		expand_include(shader_path, expanded, include_stack);
+
+		// Find the end of the #version line - the defines must be placed after it
+		std::size_t const version = expanded.find("#version");
+		if (version == std::string::npos) {
+			warning_cgp("No #version directive found in shader", shader_path);
+			std::string header;
+			for (auto const& define : defines)
+				header += "#define " + define.first + " " + define.second + "\n";
+			return header + "#line 1\n" + expanded;
+		}
+		std::size_t const version_end = expanded.find('\n', version);
+		int const version_line = int(std::count(expanded.begin(), expanded.begin() + version, '\n')) + 1;
+
+		std::string version_txt = expanded.substr(0, version_end + 1);
+#ifdef __EMSCRIPTEN__
+		// #version 330 core => #version 300 es + precision mediump float;
+		std::string const target_string = "#version 330 core";
+		std::size_t const pos = version_txt.find(target_string);
+		if (pos != std::string::npos)
+			version_txt.replace(pos, target_string.size(), "#version 300 es\nprecision mediump float;");
+#endif
+
+		std::string defines_txt;
+		for (auto const& define : defines)
+			defines_txt += "#define " + define.first + " " + define.second + "\n";
+		defines_txt += "#line " + str(version_line + 1) + "\n";
+
+		return version_txt + defines_txt + expanded.substr(version_end + 1);
+	}
+
+	opengl_shader_structure opengl_shader_builder_structure::load(std::string const& vertex_shader_path, std::string const& fragment_shader_path, opengl_shader_defines const& defines)
+	{
+		std::string const key = permutation_key(vertex_shader_path, fragment_shader_path, defines);
+
+		// The permutation is already compiled: share the program
+		auto const it = programs.find(key);
+		if (it != programs.end())
+			return it->second;
+
+		std::string const vertex_shader_text = preprocess(vertex_shader_path, defines);
+		std::string const fragment_shader_text = preprocess(fragment_shader_path, defines);
+
+		opengl_shader_structure shader;
+
+		// Try first to reuse the program saved by a previous execution
+		shader.id = binary_cache.load(vertex_shader_text, fragment_shader_text);
+		if (shader.id != 0) {
+			std::cout << "  [info] Shader loaded from binary cache [ID=" << shader.id << "] (" << vertex_shader_path << ", " << fragment_shader_path << ")" << std::endl;
+			programs[key] = shader;
+			return shader;
+		}
+
+		bool load_shader_ok = false;
+		shader.load_from_inline_text(vertex_shader_text, fragment_shader_text, &load_shader_ok, [this](GLuint program_id) { binary_cache.prepare(program_id); });
+		if (load_shader_ok == false) {
+			std::cout << "===> Failed to build the shader permutation [" << key << "]" << std::endl;
+			std::cout << "The error message from the compiler should be listed above. The program will stop." << std::endl;
+			error_cgp("Failed to build shader " + vertex_shader_path + ", " + fragment_shader_path);
+		}
+		binary_cache.store(shader.id, vertex_shader_text, fragment_shader_text);
+
+		// Debug info
+		std::string msg = "  [info] Shader compiled succesfully [ID=" + str(shader.id) + "]\n";
+		msg            += "         (" + vertex_shader_path + ", " + fragment_shader_path + ")\n";
+		if (!defines.empty()) {
+			msg += "         defines:";
+			for (auto const& define : defines)
+				msg += " " + define.first + (define.second.empty() ? "" : "=" + define.second);
+			msg += "\n";
+		}
+		std::cout << msg << std::endl;
+
+		programs[key] = shader;
+		return shader;
+	}
+
+	int opengl_shader_builder_structure::size() const
+	{
+		return int(programs.size());
+	}
+
+	void opengl_shader_builder_structure::clear()
+	{
+		for (auto const& program : programs)
+			glDeleteProgram(program.second.id);
+		programs.clear();
+		file_cache.clear();
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+#include "../shaders.hpp"
+#include "../program_binary_cache/program_binary_cache.hpp"
+
+#include <string>
+#include <map>
+#include <vector>
+
+namespace cgp
+{
+	// Set of preprocessor definitions injected in a shader right after its #version line
+	//  Each entry {name, value} generates the line "#define name value" (value may be empty)
+	using opengl_shader_defines = std::map<std::string, std::string>;
+
+	// Helper structure building shader programs from glsl files with preprocessor permutations
+	//  - Lines of the form #include "file.glsl" are replaced by the content of the file (path relative to the including file)
+	//  - The defines are inserted after the #version line, allowing to select code paths with #ifdef / #if in the shader
+	//  - Each unique permutation (vertex path, fragment path, defines) is compiled only once:
+	//    all the drawables requesting the same permutation share the same program id.
+	//
+	//  Usage:
+	//  | opengl_shader_builder_structure builder;
+	//  | opengl_shader_structure shader_a = builder.load("shader.vert.glsl", "shader.frag.glsl", {{"USE_WIND",""}});
+	//  | opengl_shader_structure shader_b = builder.load("shader.vert.glsl", "shader.frag.glsl", {{"USE_WIND",""}}); // shader_b.id == shader_a.id
+	//
+	//  If binary_cache is initialized, the linked programs are saved on disk and reloaded on the next executions without GLSL compilation.
+	struct opengl_shader_builder_structure
+	{
+		// Optional on-disk cache of the compiled programs (inactive by default)
+		opengl_program_binary_cache_structure binary_cache;
+
+		// Return the program associated to the given permutation. Compile it if it is requested for the first time.
+		//  The program stops with an error if the shader cannot be compiled.
+		opengl_shader_structure load(std::string const& vertex_shader_path, std::string const& fragment_shader_path, opengl_shader_defines const& defines = opengl_shader_defines());
+
+		// Expanded source of a shader file (includes resolved and defines inserted) as it is sent to the GLSL compiler
+		std::string preprocess(std::string const& shader_path, opengl_shader_defines const& defines = opengl_shader_defines());
+
+		// Number of distinct programs compiled by this builder
+		int size() const;
+
+		// Delete all the programs compiled by this builder from the GPU
+		void clear();
+
+	private:
+		// Compiled programs indexed by their permutation key
+		std::map<std::string, opengl_shader_structure> programs;
+
+		// Text of the files already read from disk (shared sources and includes are read only once)
+		std::map<std::string, std::string> file_cache;
+
+		std::string const& read_file(std::string const& path);
+		void expand_include(std::string const& path, std::string& output, std::vector<std::string>& include_stack);
+	};
+}
@@ -18,7 +18,7 @@ namespace cgp
 
     /** Compile shaders from direct text input.
     * Display no debug information in case of success */
-    GLuint opengl_load_shader_from_text(std::string const& vertex_shader, std::string const& fragment_shader, bool* load_shader_ok=nullptr);
+    GLuint opengl_load_shader_from_text(std::string const& vertex_shader, std::string const& fragment_shader, bool* load_shader_ok=nullptr, std::function<void(GLuint)> const& before_link=nullptr);
 
 
 
@@ -28,13 +28,13 @@ namespace cgp
         id = opengl_load_shader(vertex_shader_path, fragment_shader_path, adapt_opengles);
     }
 
-    void opengl_shader_structure::load_from_inline_text(std::string const& vertex_shader_text, std::string const& fragment_shader_text, bool* load_shader_ok)
+    void opengl_shader_structure::load_from_inline_text(std::string const& vertex_shader_text, std::string const& fragment_shader_text, bool* load_shader_ok, std::function<void(GLuint)> const& before_link)
     {
         if (id != 0) {
             std::cout << " Warning: try to load a shader (" << vertex_shader_text << "," << fragment_shader_text << ") on a non empty shader_structure" << std::endl;
         }
 
-        id = opengl_load_shader_from_text(vertex_shader_text, fragment_shader_text, load_shader_ok);
+        id = opengl_load_shader_from_text(vertex_shader_text, fragment_shader_text, load_shader_ok, before_link);
     }
 
 
@@ -126,7 +126,7 @@ namespace cgp
 
 
     
-	GLuint opengl_load_shader_from_text(std::string const& vertex_shader_txt, std::string const& fragment_shader_txt, bool* load_shader_ok)
+	GLuint opengl_load_shader_from_text(std::string const& vertex_shader_txt, std::string const& fragment_shader_txt, bool* load_shader_ok, std::function<void(GLuint)> const& before_link)
 	{
         GLuint vertex_shader_id; 
         GLuint fragment_shader_id; 
@@ -151,6 +151,9 @@ namespace cgp
         glAttachShader( program_id, vertex_shader_id );
         glAttachShader( program_id, fragment_shader_id );
 
+        if (before_link)
+            before_link(program_id);
+
         // Link Program
         glLinkProgram( program_id );
 
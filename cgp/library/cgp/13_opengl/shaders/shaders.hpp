@@ -4,6 +4,8 @@
 
 #include "cache_uniform_location/cache_uniform_location.hpp"
 
+#include <functional>
+
 
 namespace cgp
 {
@@ -28,7 +30,8 @@ namespace cgp
 		// Load a new shader from inline text
 		// If the shader is loaded successfully, the value load_shader_ok is set to true (if it is not nullptr).
 		// If the shader fails to load, the value load_shader_ok is set to false (if it is not nullptr). The program doesn't crash if the shader cannot be loaded.
-		void load_from_inline_text(std::string const& vertex_shader_text, std::string const& fragment_shader_text, bool *load_shader_ok=nullptr);
+		// If before_link is set, it is called on the program before it is linked (ex. to set program parameters).
+		void load_from_inline_text(std::string const& vertex_shader_text, std::string const& fragment_shader_text, bool *load_shader_ok=nullptr, std::function<void(GLuint)> const& before_link=nullptr);
 
 		// Query the location of a uniform variable using the cache system
 		GLint query_uniform_location(std::string const& uniform_name) const;
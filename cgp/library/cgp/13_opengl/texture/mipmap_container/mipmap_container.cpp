@@ -0,0 +1,380 @@
+#include "mipmap_container.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../../debug/debug.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+// Enums of GL_EXT_texture_compression_s3tc (not part of the OpenGL 3.3 loader)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace cgp
+{
+	// Header of a container file, followed by the table of levels and the data
+	struct mipmap_container_header
+	{
+		char magic[8];          // "CGPMIP02"
+		uint32_t format;        // mipmap_container_format
+		uint32_t level_count;   // number of levels
+		uint64_t file_size;     // size of the complete file in bytes (detects a truncated file)
+		uint64_t checksum;      // hash of the header fields and of the table of levels (the data is not read when the file is opened)
+	};
+	struct mipmap_container_level
+	{
+		uint32_t width;
+		uint32_t height;
+		uint64_t offset;
+		uint64_t size;
+	};
+	static char const mipmap_container_magic[8] = { 'C','G','P','M','I','P','0','2' };
+	static size_t const mipmap_container_alignment = 16;
+
+	// Hash of the header (without the checksum) and of the table of levels that follows it
+	//  Only the first pages of the mapping are touched: the data of the levels is read when it is sent to the GPU.
+	//  The cache entries are named after the size and modification time of the source image (see texture_manager).
+	static uint64_t mipmap_container_checksum(mipmap_container_header const& header, char const* table)
+	{
+		uint64_t h = hash_fnv1a(reinterpret_cast<char const*>(&header), offsetof(mipmap_container_header, checksum));
+		return hash_fnv1a(table, header.level_count * sizeof(mipmap_container_level), h);
+	}
+
+	static int number_of_components(image_color_type type)
+	{
+		return type == image_color_type::rgba ? 4 : 3;
+	}
+
+	std::vector<image_structure> image_mipmap_chain(image_structure const& im)
+	{
+		std::vector<image_structure> chain;
+		chain.push_back(im);
+
+		int const s = number_of_components(im.color_type);
+		while (chain.back().width > 1 || chain.back().height > 1) {
+			image_structure const& src = chain.back();
+			image_structure dst;
+			dst.width = std::max(1, src.width / 2);
+			dst.height = std::max(1, src.height / 2);
+			dst.color_type = src.color_type;
+			dst.data.resize(size_t(s) * dst.width * dst.height);
+
+			// Average of the 2x2 texels (the last row/column is repeated for odd sizes)
+			for (int ky = 0; ky < dst.height; ++ky) {
+				int const y0 = std::min(2 * ky, src.height - 1);
+				int const y1 = std::min(2 * ky + 1, src.height - 1);
+				for (int kx = 0; kx < dst.width; ++kx) {
+					int const x0 = std::min(2 * kx, src.width - 1);
+					int const x1 = std::min(2 * kx + 1, src.width - 1);
+					for (int c = 0; c < s; ++c) {
+						int const sum = src.data[s * (x0 + src.width * y0) + c] + src.data[s * (x1 + src.width * y0) + c]
+							+ src.data[s * (x0 + src.width * y1) + c] + src.data[s * (x1 + src.width * y1) + c];
+						dst.data[s * (kx + dst.width * ky) + c] = (unsigned char)((sum + 2) / 4);
+					}
+				}
+			}
+			chain.push_back(dst);
+		}
+
+		return chain;
+	}
+
+
+	// S3TC block compression
+	//  Endpoints are taken from the (slightly inset) bounding box of the block colors, each texel takes the closest entry of the palette.
+
+	static uint16_t color_to_565(int r, int g, int b)
+	{
+		return uint16_t((((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255));
+	}
+	static void color_from_565(uint16_t c, int rgb[3])
+	{
+		int const r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	static void write_uint16(unsigned char* out, uint16_t value)
+	{
+		out[0] = (unsigned char)(value & 0xFF);
+		out[1] = (unsigned char)(value >> 8);
+	}
+
+	// Compress 16 rgba texels into a bc1 color block (8 bytes, always in 4-color mode)
+	static void compress_color_block(unsigned char const texels[16][4], unsigned char* out)
+	{
+		int low[3] = { 255,255,255 }, high[3] = { 0,0,0 };
+		for (int k = 0; k < 16; ++k) {
+			for (int c = 0; c < 3; ++c) {
+				low[c] = std::min(low[c], int(texels[k][c]));
+				high[c] = std::max(high[c], int(texels[k][c]));
+			}
+		}
+		for (int c = 0; c < 3; ++c) {
+			int const inset = (high[c] - low[c]) / 16;
+			low[c] += inset;
+			high[c] -= inset;
+		}
+
+		uint16_t c0 = color_to_565(high[0], high[1], high[2]);
+		uint16_t c1 = color_to_565(low[0], low[1], low[2]);
+		if (c0 < c1)
+			std::swap(c0, c1);
+		write_uint16(out + 0, c0);
+		write_uint16(out + 2, c1);
+
+		uint32_t indices = 0;
+		if (c0 != c1) {
+			int palette[4][3];
+			color_from_565(c0, palette[0]);
+			color_from_565(c1, palette[1]);
+			for (int c = 0; c < 3; ++c) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			for (int k = 0; k < 16; ++k) {
+				int best = 0, best_distance = 1 << 30;
+				for (int i = 0; i < 4; ++i) {
+					int distance = 0;
+					for (int c = 0; c < 3; ++c)
+						distance += (int(texels[k][c]) - palette[i][c]) * (int(texels[k][c]) - palette[i][c]);
+					if (distance < best_distance) {
+						best_distance = distance;
+						best = i;
+					}
+				}
+				indices |= uint32_t(best) << (2 * k);
+			}
+		}
+		for (int b = 0; b < 4; ++b)
+			out[4 + b] = (unsigned char)((indices >> (8 * b)) & 0xFF);
+	}
+
+	// Compress the alpha of 16 rgba texels into a bc3 alpha block (8 bytes, 8-alpha mode)
+	static void compress_alpha_block(unsigned char const texels[16][4], unsigned char* out)
+	{
+		int a0 = 0, a1 = 255;
+		for (int k = 0; k < 16; ++k) {
+			a0 = std::max(a0, int(texels[k][3]));
+			a1 = std::min(a1, int(texels[k][3]));
+		}
+		out[0] = (unsigned char)a0;
+		out[1] = (unsigned char)a1;
+
+		uint64_t indices = 0;
+		if (a0 != a1) {
+			int palette[8];
+			palette[0] = a0;
+			palette[1] = a1;
+			for (int i = 2; i < 8; ++i)
+				palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+			for (int k = 0; k < 16; ++k) {
+				int best = 0, best_distance = 256;
+				for (int i = 0; i < 8; ++i) {
+					int const distance = std::abs(int(texels[k][3]) - palette[i]);
+					if (distance < best_distance) {
+						best_distance = distance;
+						best = i;
+					}
+				}
+				indices |= uint64_t(best) << (3 * k);
+			}
+		}
+		for (int b = 0; b < 6; ++b)
+			out[2 + b] = (unsigned char)((indices >> (8 * b)) & 0xFF);
+	}
+
+	std::vector<unsigned char> image_compress_bc(image_structure const& im)
+	{
+		int const s = number_of_components(im.color_type);
+		bool const has_alpha = (im.color_type == image_color_type::rgba);
+		int const block_size = has_alpha ? 16 : 8;
+		int const Nx = (im.width + 3) / 4;
+		int const Ny = (im.height + 3) / 4;
+
+		std::vector<unsigned char> blocks(size_t(Nx) * Ny * block_size);
+		unsigned char texels[16][4];
+		for (int by = 0; by < Ny; ++by) {
+			for (int bx = 0; bx < Nx; ++bx) {
+				// Gather the 4x4 texels (clamped to the image border)
+				for (int k = 0; k < 16; ++k) {
+					int const x = std::min(4 * bx + k % 4, im.width - 1);
+					int const y = std::min(4 * by + k / 4, im.height - 1);
+					for (int c = 0; c < 4; ++c)
+						texels[k][c] = (c < s) ? im.data[s * (x + im.width * y) + c] : 255;
+				}
+
+				unsigned char* out = &blocks[(size_t(bx) + size_t(Nx) * by) * block_size];
+				if (has_alpha) {
+					compress_alpha_block(texels, out);
+					compress_color_block(texels, out + 8);
+				}
+				else
+					compress_color_block(texels, out);
+			}
+		}
+		return blocks;
+	}
+
+	static size_t align_offset(size_t offset)
+	{
+		return (offset + mipmap_container_alignment - 1) / mipmap_container_alignment * mipmap_container_alignment;
+	}
+
+	bool mipmap_container_save(std::string const& filename, image_structure const& im, bool compress)
+	{
+		assert_cgp(im.width > 0 && im.height > 0, "Cannot save an empty image as mipmap container " + filename);
+
+		mipmap_container_format format;
+		if (im.color_type == image_color_type::rgba)
+			format = compress ? mipmap_container_format::bc3 : mipmap_container_format::rgba8;
+		else
+			format = compress ? mipmap_container_format::bc1 : mipmap_container_format::rgb8;
+
+		// Data of each level
+		std::vector<image_structure> const chain = image_mipmap_chain(im);
+		std::vector<std::vector<unsigned char>> levels_data(chain.size());
+		for (size_t k = 0; k < chain.size(); ++k) {
+			if (compress)
+				levels_data[k] = image_compress_bc(chain[k]);
+			else
+				levels_data[k].assign(chain[k].data.data.begin(), chain[k].data.data.end());
+		}
+
+		// Table of levels
+		std::vector<mipmap_container_level> table(chain.size());
+		size_t offset = align_offset(sizeof(mipmap_container_header) + table.size() * sizeof(mipmap_container_level));
+		for (size_t k = 0; k < chain.size(); ++k) {
+			table[k].width = uint32_t(chain[k].width);
+			table[k].height = uint32_t(chain[k].height);
+			table[k].offset = offset;
+			table[k].size = levels_data[k].size();
+			offset = align_offset(offset + levels_data[k].size());
+		}
+
+		// The file content after the header
+		size_t const header_size = sizeof(mipmap_container_header);
+		std::vector<char> body(offset - header_size, 0);
+		std::memcpy(body.data(), table.data(), table.size() * sizeof(mipmap_container_level));
+		for (size_t k = 0; k < chain.size(); ++k)
+			std::memcpy(body.data() + table[k].offset - header_size, levels_data[k].data(), levels_data[k].size());
+
+		mipmap_container_header header;
+		std::memcpy(header.magic, mipmap_container_magic, sizeof(mipmap_container_magic));
+		header.format = uint32_t(format);
+		header.level_count = uint32_t(chain.size());
+		header.file_size = uint64_t(offset);
+		header.checksum = mipmap_container_checksum(header, body.data());
+
+		std::ofstream stream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+			return false;
+		stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		stream.write(body.data(), body.size());
+		return bool(stream);
+	}
+
+	bool mipmap_container_structure::open(std::string const& filename)
+	{
+		close();
+		if (!file.open(filename))
+			return false;
+
+		// Validate the header, the table and the data before using them
+		size_t const header_size = sizeof(mipmap_container_header);
+		bool valid = file.size() >= header_size;
+		mipmap_container_header header;
+		if (valid) {
+			std::memcpy(&header, file.data(), header_size);
+			valid = std::memcmp(header.magic, mipmap_container_magic, sizeof(mipmap_container_magic)) == 0;
+			valid = valid && header.format <= uint32_t(mipmap_container_format::bc3);
+			valid = valid && header.file_size == file.size();
+			valid = valid && header.level_count > 0 && header_size + header.level_count * sizeof(mipmap_container_level) <= file.size();
+			valid = valid && mipmap_container_checksum(header, file.data() + header_size) == header.checksum;
+		}
+		if (valid) {
+			format = mipmap_container_format(header.format);
+			levels.resize(header.level_count);
+			for (uint32_t k = 0; k < header.level_count && valid; ++k) {
+				mipmap_container_level level;
+				std::memcpy(&level, file.data() + header_size + k * sizeof(mipmap_container_level), sizeof(level));
+				valid = level.offset + level.size <= file.size() && level.width > 0 && level.height > 0;
+				levels[k].width = int(level.width);
+				levels[k].height = int(level.height);
+				levels[k].offset = size_t(level.offset);
+				levels[k].size = size_t(level.size);
+			}
+		}
+
+		if (!valid)
+			close();
+		return valid;
+	}
+
+	void mipmap_container_structure::close()
+	{
+		file.close();
+		levels.clear();
+	}
+
+	unsigned char const* mipmap_container_structure::data(int level) const
+	{
+		assert_cgp(level >= 0 && level < int(levels.size()), "Incorrect mipmap level " + str(level));
+		return reinterpret_cast<unsigned char const*>(file.data() + levels[level].offset);
+	}
+
+	bool mipmap_container_structure::is_compressed() const
+	{
+		return format == mipmap_container_format::bc1 || format == mipmap_container_format::bc3;
+	}
+
+	void mipmap_container_structure::send_to_gpu(GLenum target, bool all_levels) const
+	{
+		assert_cgp(!levels.empty(), "Cannot send an empty mipmap container to the GPU");
+		int const N = all_levels ? int(levels.size()) : 1;
+
+		// Rows of the small levels are not aligned on 4 bytes
+		GLint previous_alignment = 4;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &previous_alignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		for (int k = 0; k < N; ++k) {
+			level_structure const& level = levels[k];
+			switch (format)
+			{
+			case mipmap_container_format::rgb8:
+				glTexImage2D(target, k, GL_RGB8, level.width, level.height, 0, GL_RGB, GL_UNSIGNED_BYTE, data(k)); opengl_check;
+				break;
+			case mipmap_container_format::rgba8:
+				glTexImage2D(target, k, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data(k)); opengl_check;
+				break;
+			case mipmap_container_format::bc1:
+				glCompressedTexImage2D(target, k, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, level.width, level.height, 0, GLsizei(level.size), data(k)); opengl_check;
+				break;
+			case mipmap_container_format::bc3:
+				glCompressedTexImage2D(target, k, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, level.width, level.height, 0, GLsizei(level.size), data(k)); opengl_check;
+				break;
+			}
+		}
+		glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0); opengl_check;
+		glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, N - 1); opengl_check;
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, previous_alignment);
+	}
+
+	bool opengl_support_texture_compression_bc()
+	{
+#ifndef __EMSCRIPTEN__
+		return opengl_has_extension("GL_EXT_texture_compression_s3tc");
+#else
+		return false;
+#endif
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+#include "cgp/03_files/files.hpp"
+#include "cgp/07_image/image.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace cgp
+{
+	// Storage of the texels in a mipmap container
+	//  rgb8/rgba8: uncompressed 8 bits per component
+	//  bc1: S3TC DXT1 blocks (rgb, 8 bytes per 4x4 block)
+	//  bc3: S3TC DXT5 blocks (rgba, 16 bytes per 4x4 block)
+	enum class mipmap_container_format : uint32_t { rgb8 = 0, rgba8 = 1, bc1 = 2, bc3 = 3 };
+
+	// Binary file storing the complete mipmap chain of an image, ready to be sent to the GPU without decoding nor mipmap generation
+	//  The file is mapped in memory when it is opened, and each level is sent directly from the mapped pages.
+	//  File layout: header (magic, format, number of levels, file size, checksum), table of levels (width, height, offset, size), data of each level.
+	//  The checksum covers the header and the table only, so that open() does not read the whole mapping.
+	//
+	//  Usage:
+	//  | mipmap_container_save("texture.cgpmip", image_load_file("texture.jpg"), true); // offline conversion, block-compressed
+	//  | mipmap_container_structure container;
+	//  | container.open("texture.cgpmip");
+	//  | texture.initialize_texture_2d_on_gpu(container, GL_REPEAT, GL_REPEAT);
+	struct mipmap_container_structure
+	{
+		struct level_structure
+		{
+			int width = 0;
+			int height = 0;
+			size_t offset = 0; // position of the data in the file
+			size_t size = 0;   // size of the data in bytes
+		};
+
+		mipmap_container_format format = mipmap_container_format::rgb8;
+		std::vector<level_structure> levels;
+
+		// Map the file in memory and read its description. Return false if the file is missing or invalid (wrong magic, wrong size, wrong checksum of the table).
+		bool open(std::string const& filename);
+		void close();
+
+		// Data of the given level (pointer in the mapped file)
+		unsigned char const* data(int level) const;
+
+		// True if the data is block-compressed
+		bool is_compressed() const;
+
+		// Send the levels to the texture currently bound on target (GL_TEXTURE_2D). If all_levels is false, only the level 0 is sent.
+		//  GL_TEXTURE_MAX_LEVEL is set accordingly: glGenerateMipmap is not needed.
+		void send_to_gpu(GLenum target = GL_TEXTURE_2D, bool all_levels = true) const;
+
+	private:
+		file_mapping_structure file;
+	};
+
+	// Generate the mipmap chain of an image (box filter) and save it as a container file
+	//  If compress is true, the levels are stored as bc1 (rgb images) or bc3 (rgba images) blocks
+	//  Return false if the file cannot be written.
+	bool mipmap_container_save(std::string const& filename, image_structure const& im, bool compress);
+
+	// Successive levels of the mipmap chain of an image, from the image itself down to 1x1
+	std::vector<image_structure> image_mipmap_chain(image_structure const& im);
+
+	// Block-compress an image in S3TC format: bc1 for rgb images, bc3 for rgba images
+	std::vector<unsigned char> image_compress_bc(image_structure const& im);
+
+	// True if the current OpenGL context can read S3TC compressed textures
+	bool opengl_support_texture_compression_bc();
+}
@@ -1,6 +1,9 @@
 #include "texture.hpp"
 
 #include "cgp/01_base/base.hpp"
+#include "cgp/13_opengl/render_stats/render_stats.hpp"
+
+#include <algorithm>
 
 namespace cgp
 {
@@ -66,6 +69,7 @@ namespace cgp
     void opengl_texture_image_structure::bind() const
     {
         glBindTexture(texture_type, id); opengl_check;
+        default_render_stats().count_texture_bind();
         assert_cgp(id!=0, "Incorrect texture id");
     }
     void opengl_texture_image_structure::unbind() const
@@ -105,6 +109,26 @@ namespace cgp
         initialize_texture_2d_on_gpu(im, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
     }
 
+    void opengl_texture_image_structure::initialize_texture_2d_on_gpu(mipmap_container_structure const& container, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+    {
+        // Store parameters
+        width = container.levels[0].width;
+        height = container.levels[0].height;
+        format = container.format == mipmap_container_format::rgba8 || container.format == mipmap_container_format::bc3 ? GL_RGBA8 : GL_RGB8;
+        texture_type = GL_TEXTURE_2D;
+
+        // Initialize texture data on GPU - the mipmap levels are already computed
+        glGenTextures(1, &id); opengl_check;
+        glBindTexture(texture_type, id); opengl_check;
+        container.send_to_gpu(texture_type, is_mipmap);
+
+        glTexParameteri(texture_type, GL_TEXTURE_WRAP_S, wrap_s); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_WRAP_T, wrap_t); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_MAG_FILTER, texture_mag_filter); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_MIN_FILTER, texture_min_filter); opengl_check;
+        glBindTexture(texture_type, 0); opengl_check;
+    }
+
     void opengl_texture_image_structure::initialize_texture_2d_on_gpu(grid_2D<vec3> const& im, GLint wrap_s, GLint wrap_t, bool is_mippmap, GLint texture_mag_filter, GLint texture_min_filter)
     {
         // Store parameters
@@ -136,6 +160,63 @@ namespace cgp
     }
 
 
+    void opengl_texture_image_structure::initialize_texture_2d_array_on_gpu(std::vector<image_structure> const& layers, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+    {
+        texture_type = GL_TEXTURE_2D_ARRAY;
+
+        glGenTextures(1, &id); opengl_check;
+        glBindTexture(texture_type, id); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_WRAP_S, wrap_s); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_WRAP_T, wrap_t); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_MAG_FILTER, texture_mag_filter); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_MIN_FILTER, texture_min_filter); opengl_check;
+        glBindTexture(texture_type, 0); opengl_check;
+
+        update_layers(layers, is_mipmap);
+    }
+
+    void opengl_texture_image_structure::update_layers(std::vector<image_structure> const& layers, bool is_mipmap)
+    {
+        assert_cgp(texture_type == GL_TEXTURE_2D_ARRAY, "update_layers expects a GL_TEXTURE_2D_ARRAY");
+        assert_cgp(layers.size() > 0, "A texture array should have at least one layer");
+
+        // Common resolution and color type
+        int common_width = 0;
+        int common_height = 0;
+        image_color_type color_type = image_color_type::rgb;
+        for (auto const& im : layers) {
+            common_width = std::max(common_width, im.width);
+            common_height = std::max(common_height, im.height);
+            if (im.color_type == image_color_type::rgba)
+                color_type = image_color_type::rgba;
+        }
+        assert_cgp(common_width > 0 && common_height > 0, "Cannot create a texture array from empty images");
+
+        width = common_width;
+        height = common_height;
+        layer_count = int(layers.size());
+        format = (color_type == image_color_type::rgba ? GL_RGBA8 : GL_RGB8);
+
+        GLint previous_alignment = 4;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &previous_alignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        glBindTexture(texture_type, id); opengl_check;
+        glTexImage3D(texture_type, 0, format, width, height, layer_count, 0, format_to_data_type(format), format_to_component(format), nullptr); opengl_check;
+        for (int k = 0; k < layer_count; ++k) {
+            image_structure im = layers[k].convert_color_type(color_type);
+            if (im.width != width || im.height != height)
+                im = im.resize(width, height);
+            glTexSubImage3D(texture_type, 0, 0, 0, k, width, height, 1, format_to_data_type(format), format_to_component(format), ptr(im.data)); opengl_check;
+        }
+        if (is_mipmap) {
+            glGenerateMipmap(texture_type); opengl_check;
+        }
+        glBindTexture(texture_type, 0); opengl_check;
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, previous_alignment);
+    }
+
     void opengl_texture_image_structure::initialize_cubemap_on_gpu(image_structure const& x_neg, image_structure const& x_pos, image_structure const& y_neg, image_structure const& y_pos, image_structure const& z_neg, image_structure const& z_pos)
     {
         // Sanity check on cubic texture
@@ -5,6 +5,7 @@
 
 #include "cgp/04_grid_container/grid_container.hpp"
 #include "cgp/07_image/image.hpp"
+#include "mipmap_container/mipmap_container.hpp"
 
 
 
@@ -17,10 +18,11 @@ namespace cgp
 
 		int width;  // image width
 		int height; // image height
+		int layer_count = 1; // number of layers (GL_TEXTURE_2D_ARRAY)
 
 		GLint format; // GL_RGB8, GL_RGBA8, GL_RGBF32
 
-		GLenum texture_type; // = GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+		GLenum texture_type; // = GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY or GL_TEXTURE_CUBE_MAP
 
 		void bind() const;
 		void unbind() const;
@@ -40,9 +42,17 @@ namespace cgp
 		// Initialize a GL_TEXTURE_2D from an image
 		void initialize_texture_2d_on_gpu(image_structure const& im, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
 
+		// Initialize a GL_TEXTURE_2D from a precomputed mipmap chain (all the levels are sent if is_mipmap is true, only the first one otherwise)
+		void initialize_texture_2d_on_gpu(mipmap_container_structure const& container, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
+
 		// Initialize a GL_TEXTURE_2D from a float grid
 		void initialize_texture_2d_on_gpu(grid_2D<vec3> const& im, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
 
+		// Initialize a GL_TEXTURE_2D_ARRAY from a set of images (one per layer)
+		//  The layers are resized to a common resolution (the largest width and height of the images), and converted to rgba if one of them has an alpha channel.
+		//  In the shader, the texture is accessed with a sampler2DArray: texture(image_texture, vec3(u, v, layer))
+		void initialize_texture_2d_array_on_gpu(std::vector<image_structure> const& layers, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
+
 		// Initialize a CUBEMAP on GPU from 6 squared images
 		void initialize_cubemap_on_gpu(image_structure const& x_neg, image_structure const& x_pos, image_structure const& y_neg, image_structure const& y_pos, image_structure const& z_neg, image_structure const& z_pos);
 
@@ -52,6 +62,8 @@ namespace cgp
 		// Update a 2D texture
 		void update(grid_2D<vec3> const& im);
 		void update(image_structure const& im);
+		// (Re)allocate and fill all the layers of a GL_TEXTURE_2D_ARRAY (the images are resized to their common resolution)
+		void update_layers(std::vector<image_structure> const& layers, bool is_mipmap = true);
 	};
 
 	// Read an image from file and initialize_snake an opengl texture image from it
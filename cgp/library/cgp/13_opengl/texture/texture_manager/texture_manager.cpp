@@ -0,0 +1,278 @@
+#include "texture_manager.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+#include "cgp/07_image/image.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <exception>
+
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#include <atomic>
+#endif
+
+namespace cgp
+{
+	static std::string texture_key(std::string const& filename, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+	{
+		return filename + "|" + str(wrap_s) + "," + str(wrap_t) + "," + str(int(is_mipmap)) + "," + str(texture_mag_filter) + "," + str(texture_min_filter);
+	}
+
+	// Content of an image file ready to be sent to the GPU: either the decoded image, or its mipmap container
+	struct texture_source
+	{
+		image_structure image;
+		mipmap_container_structure container; // used if it is open
+		bool from_cache = false;
+	};
+
+	// Read one image file. The mipmap container is used (and created if needed) when a cache file is given.
+	static void read_texture_source(std::string const& filename, std::string const& cache_filename, bool compression, texture_source& source)
+	{
+		if (!cache_filename.empty()) {
+			if (source.container.open(cache_filename)) {
+				source.from_cache = true;
+				return;
+			}
+			source.image = image_load_file(filename);
+			if (mipmap_container_save(cache_filename, source.image, compression) && source.container.open(cache_filename))
+				return;
+			warning_cgp("Cannot write the mipmap container", cache_filename);
+			return;
+		}
+		source.image = image_load_file(filename);
+	}
+
+	// Read the image files, using several threads when possible
+	static void read_texture_sources(std::vector<std::string> const& filenames, std::vector<std::string> const& cache_filenames, bool compression, int number_of_threads, std::vector<texture_source>& sources)
+	{
+		int const N = int(filenames.size());
+		sources.resize(N);
+
+#ifndef __EMSCRIPTEN__
+		if (number_of_threads <= 0)
+			number_of_threads = int(std::thread::hardware_concurrency());
+		number_of_threads = std::max(1, std::min(number_of_threads, N));
+
+		// Each thread takes the next file to read until all of them are done
+		std::atomic<int> next(0);
+		std::vector<std::exception_ptr> errors(N);
+		auto worker = [&]() {
+			for (int k = next++; k < N; k = next++) {
+				try {
+					read_texture_source(filenames[k], cache_filenames[k], compression, sources[k]);
+				}
+				catch (...) {
+					errors[k] = std::current_exception();
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (int k = 1; k < number_of_threads; ++k)
+			threads.push_back(std::thread(worker));
+		worker(); // the calling thread also participates
+		for (auto& thread : threads)
+			thread.join();
+
+		// Errors are forwarded to the calling thread
+		for (auto const& error : errors)
+			if (error)
+				std::rethrow_exception(error);
+#else
+		// No thread available in the default WebAssembly build
+		(void)number_of_threads;
+		for (int k = 0; k < N; ++k)
+			read_texture_source(filenames[k], cache_filenames[k], compression, sources[k]);
+#endif
+	}
+
+	bool opengl_texture_manager_structure::initialize_mipmap_cache(std::string const& directory, bool compression)
+	{
+		mipmap_cache_directory = "";
+		if (!create_directory(directory)) {
+			warning_cgp("Cannot create the directory for the mipmap cache", directory);
+			return false;
+		}
+		mipmap_cache_directory = directory;
+
+		mipmap_cache_compression = compression && opengl_support_texture_compression_bc();
+		if (compression && !mipmap_cache_compression)
+			std::cout << "  [info] Texture manager: S3TC compression not supported, the mipmap cache is not compressed" << std::endl;
+		return true;
+	}
+
+	std::string opengl_texture_manager_structure::mipmap_cache_filename(std::string const& filename) const
+	{
+		if (mipmap_cache_directory.empty())
+			return "";
+
+		// Any modification of the source file results in a new container
+		uint64_t h = hash_fnv1a(filename);
+		h = hash_fnv1a(std::string("|") + str(file_get_size(filename)) + "|" + str(file_get_modification_time(filename)), h);
+		h = hash_fnv1a(std::string(mipmap_cache_compression ? "|bc" : "|raw"), h);
+		return mipmap_cache_directory + str_hex(h) + ".cgpmip";
+	}
+
+	opengl_texture_image_structure opengl_texture_manager_structure::load(std::string const& filename, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+	{
+		std::string const key = texture_key(filename, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
+		return create_texture(key, { filename }, GL_TEXTURE_2D, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
+	}
+
+	opengl_texture_image_structure opengl_texture_manager_structure::load_array(std::vector<std::string> const& filenames, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+	{
+		assert_cgp(filenames.size() > 0, "A texture array should have at least one layer");
+
+		std::string layers;
+		for (auto const& filename : filenames)
+			layers += filename + ";";
+		std::string const key = "[array]" + texture_key(layers, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
+		return create_texture(key, filenames, GL_TEXTURE_2D_ARRAY, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
+	}
+
+	opengl_texture_image_structure opengl_texture_manager_structure::create_texture(std::string const& key, std::vector<std::string> const& filenames, GLenum texture_type, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+	{
+		// The texture is already known: share it
+		auto const it = textures.find(key);
+		if (it != textures.end())
+			return it->second.texture;
+
+		for (auto const& filename : filenames)
+			assert_file_exist(filename);
+
+		texture_entry entry;
+		entry.filenames = filenames;
+		entry.is_mipmap = is_mipmap;
+
+		// Create the texture object now so that the id can be shared before the data is available
+		opengl_texture_image_structure& texture = entry.texture;
+		texture.width = 0;
+		texture.height = 0;
+		texture.format = GL_RGB8;
+		texture.texture_type = texture_type;
+		glGenTextures(1, &texture.id); opengl_check;
+		glBindTexture(texture_type, texture.id); opengl_check;
+		glTexParameteri(texture_type, GL_TEXTURE_WRAP_S, wrap_s); opengl_check;
+		glTexParameteri(texture_type, GL_TEXTURE_WRAP_T, wrap_t); opengl_check;
+		glTexParameteri(texture_type, GL_TEXTURE_MAG_FILTER, texture_mag_filter); opengl_check;
+		glTexParameteri(texture_type, GL_TEXTURE_MIN_FILTER, texture_min_filter); opengl_check;
+		glBindTexture(texture_type, 0); opengl_check;
+
+		textures[key] = entry;
+		pending.push_back(key);
+
+		return texture;
+	}
+
+	void opengl_texture_manager_structure::upload_pending()
+	{
+		if (pending.empty())
+			return;
+
+		// List the files to read - a file used by several textures is read once
+		//  The layers of the texture arrays are always decoded (the mipmap containers store 2D textures only)
+		std::vector<std::string> filenames;
+		std::vector<bool> need_image;
+		for (auto const& key : pending) {
+			texture_entry const& entry = textures[key];
+			for (auto const& filename : entry.filenames) {
+				size_t const index = std::find(filenames.begin(), filenames.end(), filename) - filenames.begin();
+				if (index == filenames.size()) {
+					filenames.push_back(filename);
+					need_image.push_back(false);
+				}
+				if (entry.texture.texture_type == GL_TEXTURE_2D_ARRAY)
+					need_image[index] = true;
+			}
+		}
+
+		std::vector<std::string> cache_filenames;
+		for (size_t k = 0; k < filenames.size(); ++k)
+			cache_filenames.push_back(need_image[k] ? "" : mipmap_cache_filename(filenames[k]));
+
+		std::vector<texture_source> sources;
+		read_texture_sources(filenames, cache_filenames, mipmap_cache_compression, number_of_threads, sources);
+
+		// Send the data to the GPU (in the current thread, which owns the OpenGL context)
+		int cache_hit = 0;
+		for (auto const& source : sources)
+			cache_hit += source.from_cache ? 1 : 0;
+		for (auto const& key : pending) {
+			texture_entry& entry = textures[key];
+			opengl_texture_image_structure& texture = entry.texture;
+
+			if (texture.texture_type == GL_TEXTURE_2D_ARRAY) {
+				std::vector<image_structure> layers;
+				for (auto const& filename : entry.filenames)
+					layers.push_back(sources[std::find(filenames.begin(), filenames.end(), filename) - filenames.begin()].image);
+				texture.update_layers(layers, entry.is_mipmap);
+				continue;
+			}
+
+			size_t const index = std::find(filenames.begin(), filenames.end(), entry.filenames[0]) - filenames.begin();
+			texture_source const& source = sources[index];
+
+			glBindTexture(GL_TEXTURE_2D, texture.id); opengl_check;
+			if (source.container.levels.size() > 0) {
+				// Precomputed mipmap levels
+				mipmap_container_structure const& container = source.container;
+				texture.width = container.levels[0].width;
+				texture.height = container.levels[0].height;
+				texture.format = (container.format == mipmap_container_format::rgba8 || container.format == mipmap_container_format::bc3 ? GL_RGBA8 : GL_RGB8);
+				container.send_to_gpu(GL_TEXTURE_2D, entry.is_mipmap);
+			}
+			else {
+				image_structure const& im = source.image;
+				if (im.width == 0 || im.height == 0)
+					warning_cgp("Warning texture has a size=0", "Filename=" + entry.filenames[0]);
+
+				texture.width = im.width;
+				texture.height = im.height;
+				texture.format = (im.color_type == image_color_type::rgba ? GL_RGBA8 : GL_RGB8);
+				GLenum const gl_format = (im.color_type == image_color_type::rgba ? GL_RGBA : GL_RGB);
+
+				glTexImage2D(GL_TEXTURE_2D, 0, texture.format, texture.width, texture.height, 0, gl_format, GL_UNSIGNED_BYTE, ptr(im.data)); opengl_check;
+				if (entry.is_mipmap) {
+					glGenerateMipmap(GL_TEXTURE_2D); opengl_check;
+				}
+			}
+			glBindTexture(GL_TEXTURE_2D, 0); opengl_check;
+		}
+
+		std::cout << "  [info] Texture manager: " << filenames.size() << " image(s) read for " << pending.size() << " texture(s)";
+		if (!mipmap_cache_directory.empty())
+			std::cout << " (" << cache_hit << " from the mipmap cache)";
+		std::cout << std::endl;
+		pending.clear();
+	}
+
+	opengl_texture_image_structure const& opengl_texture_manager_structure::get(std::string const& filename, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter) const
+	{
+		std::string const key = texture_key(filename, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
+		auto const it = textures.find(key);
+		if (it == textures.end())
+			error_cgp("Texture " + filename + " was not requested to the texture manager with these parameters");
+		return it->second.texture;
+	}
+
+	int opengl_texture_manager_structure::size() const
+	{
+		return int(textures.size());
+	}
+
+	int opengl_texture_manager_structure::size_pending() const
+	{
+		return int(pending.size());
+	}
+
+	void opengl_texture_manager_structure::clear()
+	{
+		for (auto const& texture : textures)
+			glDeleteTextures(1, &texture.second.texture.id);
+		textures.clear();
+		pending.clear();
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+#include "../texture.hpp"
+
+#include <string>
+#include <map>
+#include <vector>
+
+namespace cgp
+{
+	// Cache of the 2D textures loaded from image files
+	//  - Each texture is identified by its filename and its sampling parameters (wrap, mipmap, filters):
+	//    all the requests with the same key share the same OpenGL texture.
+	//  - load() does not read the file: it returns immediately a handle with a valid id, and the image is only decoded in upload_pending().
+	//  - upload_pending() decodes all the pending files in parallel (each file is decoded only once, even if it is used with different parameters),
+	//    then sends the data to the GPU from the calling thread (which must own the OpenGL context).
+	//
+	//  The handle can be copied (ex. in a mesh_drawable added to a hierarchy) before upload_pending() is called: the copies share the same id.
+	//  Note that the width/height/format of the handle are only set after the upload. Use get() to access the complete information.
+	//
+	//  If initialize_mipmap_cache() is called, each image is converted on its first use into a mipmap container (see mipmap_container.hpp)
+	//  stored in the cache directory. The next executions map this file in memory and send the precomputed levels, without decoding nor glGenerateMipmap.
+	//
+	//  Usage:
+	//  | opengl_texture_manager_structure texture_manager;
+	//  | drawable_a.texture = texture_manager.load("image.jpg", GL_REPEAT, GL_REPEAT);
+	//  | drawable_b.texture = texture_manager.load("image.jpg", GL_REPEAT, GL_REPEAT); // same id, decoded once
+	//  | ...
+	//  | texture_manager.upload_pending(); // before the first draw call
+	struct opengl_texture_manager_structure
+	{
+		// Number of threads used to decode the images (0: number of hardware threads)
+		int number_of_threads = 0;
+
+		// Directory of the mipmap containers (empty: the cache is not used)
+		std::string mipmap_cache_directory;
+		// True if the containers are block-compressed (only if supported by the driver)
+		bool mipmap_cache_compression = false;
+
+		// Activate the cache of mipmap containers. The block compression (lossy) is optional, and disabled if the driver does not support S3TC textures.
+		//  Return false if the directory cannot be created.
+		bool initialize_mipmap_cache(std::string const& directory, bool compression = false);
+
+		// Return the texture associated to this file and parameters. The texture is created (but not filled) if it is requested for the first time.
+		opengl_texture_image_structure load(std::string const& filename, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
+
+		// Return the GL_TEXTURE_2D_ARRAY made of these files (one layer per file, in this order). The layers are resized to a common resolution.
+		opengl_texture_image_structure load_array(std::vector<std::string> const& filenames, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
+
+		// Decode the images of all the textures requested since the last call, and send them to the GPU
+		void upload_pending();
+
+		// Complete information on a texture previously requested with load() (width and height are 0 until upload_pending() is called)
+		opengl_texture_image_structure const& get(std::string const& filename, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR) const;
+
+		// Number of distinct textures handled by the manager
+		int size() const;
+		// Number of textures waiting for upload_pending()
+		int size_pending() const;
+
+		// Delete all the textures from the GPU
+		void clear();
+
+	private:
+		struct texture_entry
+		{
+			opengl_texture_image_structure texture;
+			std::vector<std::string> filenames; // a single file for a GL_TEXTURE_2D, one per layer for a GL_TEXTURE_2D_ARRAY
+			bool is_mipmap;
+		};
+
+		// Textures indexed by their filename and parameters
+		std::map<std::string, texture_entry> textures;
+
+		// Keys of the textures created but not yet filled with their image
+		std::vector<std::string> pending;
+
+		opengl_texture_image_structure create_texture(std::string const& key, std::vector<std::string> const& filenames, GLenum texture_type, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter);
+
+		// Path of the mipmap container associated to an image file
+		std::string mipmap_cache_filename(std::string const& filename) const;
+	};
+}
@@ -3,6 +3,7 @@
 
 #include "cgp/01_base/base.hpp"
 #include "cgp/13_opengl/debug/debug.hpp"
+#include "cgp/13_opengl/render_stats/render_stats.hpp"
 
 
 namespace cgp
@@ -31,6 +32,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniform1i(location, value); opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 
@@ -39,6 +41,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniform1i(location, value); opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 
 	}
@@ -47,6 +50,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniform1f(location, value); opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, vec2 const& value, bool expected)
@@ -54,6 +58,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniform2f(location, value.x, value.y); opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, vec3 const& value, bool expected)
@@ -61,6 +66,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniform3f(location, value.x, value.y, value.z); opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, vec4 const& value, bool expected)
@@ -68,6 +74,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniform4f(location, value.x, value.y, value.z, value.w); opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, float x, float y, bool expected)
@@ -75,6 +82,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniform2f(location, x, y);  opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, float x, float y, float z, bool expected)
@@ -82,6 +90,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniform3f(location, x, y, z);  opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, float x, float y, float z, float w, bool expected)
@@ -89,6 +98,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniform4f(location, x, y, z, w);  opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, mat4 const& m, bool expected)
@@ -96,6 +106,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniformMatrix4fv(location, 1, GL_TRUE, ptr(m));  opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, mat3 const& m, bool expected)
@@ -103,6 +114,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniformMatrix3fv(location, 1, GL_TRUE, ptr(m)); opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, mat2 const& m, bool expected)
@@ -110,6 +122,7 @@ namespace cgp
 		GLint const location = shader.query_uniform_location(name);
 		if (check_location(location, name, shader.id, expected)) {
 			glUniformMatrix2fv(location, 1, GL_TRUE, ptr(m)); opengl_check;
+			default_render_stats().count_uniform_upload();
 		}
 	}
 
@@ -133,7 +146,7 @@ namespace cgp
 			opengl_uniform(shader, data.first, data.second, expected);
 		for (auto const& data : uniform_mat3)
 			opengl_uniform(shader, data.first, data.second, expected);
-		for (auto const& data : uniform_mat3)
+		for (auto const& data : uniform_mat4)
 			opengl_uniform(shader, data.first, data.second, expected);
 	}
 
@@ -0,0 +1,188 @@
+#include "cgp/opengl_include.hpp"
+#include "headless_context.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__) && defined(__has_include)
+#if __has_include(<EGL/egl.h>) && __has_include(<EGL/eglext.h>)
+#define CGP_HEADLESS_EGL
+#endif
+#endif
+
+#ifdef CGP_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <dlfcn.h>
+#endif
+
+namespace cgp
+{
+#ifdef CGP_HEADLESS_EGL
+	namespace headless_context_detail
+	{
+		// EGL entry points, loaded from libEGL on the first use
+		struct egl_functions
+		{
+			void* library = nullptr;
+			PFNEGLGETPROCADDRESSPROC GetProcAddress = nullptr;
+			PFNEGLGETDISPLAYPROC GetDisplay = nullptr;
+			PFNEGLINITIALIZEPROC Initialize = nullptr;
+			PFNEGLTERMINATEPROC Terminate = nullptr;
+			PFNEGLCHOOSECONFIGPROC ChooseConfig = nullptr;
+			PFNEGLBINDAPIPROC BindAPI = nullptr;
+			PFNEGLCREATECONTEXTPROC CreateContext = nullptr;
+			PFNEGLDESTROYCONTEXTPROC DestroyContext = nullptr;
+			PFNEGLMAKECURRENTPROC MakeCurrent = nullptr;
+			PFNEGLGETERRORPROC GetError = nullptr;
+		};
+
+		static egl_functions& egl()
+		{
+			static egl_functions f;
+			return f;
+		}
+
+		template <typename T>
+		static bool load(T& function, char const* name)
+		{
+			function = reinterpret_cast<T>(dlsym(egl().library, name));
+			return function != nullptr;
+		}
+
+		static bool load_library()
+		{
+			egl_functions& f = egl();
+			if (f.library != nullptr)
+				return true;
+
+			void* library = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+			if (library == nullptr)
+				library = dlopen("libEGL.so", RTLD_NOW | RTLD_LOCAL);
+			if (library == nullptr)
+				return false;
+			f.library = library;
+
+			bool const ok = load(f.GetProcAddress, "eglGetProcAddress") && load(f.GetDisplay, "eglGetDisplay")
+				&& load(f.Initialize, "eglInitialize") && load(f.Terminate, "eglTerminate")
+				&& load(f.ChooseConfig, "eglChooseConfig") && load(f.BindAPI, "eglBindAPI")
+				&& load(f.CreateContext, "eglCreateContext") && load(f.DestroyContext, "eglDestroyContext")
+				&& load(f.MakeCurrent, "eglMakeCurrent") && load(f.GetError, "eglGetError");
+			if (!ok) {
+				dlclose(library);
+				f = egl_functions();
+			}
+			return ok;
+		}
+	}
+
+	bool headless_context_structure::create(int opengl_version_major, int opengl_version_minor)
+	{
+		using namespace headless_context_detail;
+		destroy();
+
+		if (!load_library()) {
+			warning_cgp("Cannot create a headless OpenGL context", "libEGL cannot be loaded");
+			return false;
+		}
+		egl_functions const& f = egl();
+
+		// The surfaceless platform of Mesa does not need any GPU nor display server
+		EGLDisplay egl_display = EGL_NO_DISPLAY;
+		auto const get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(f.GetProcAddress("eglGetPlatformDisplayEXT"));
+		if (get_platform_display != nullptr)
+			egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		EGLint version_major = 0, version_minor = 0;
+		if (egl_display == EGL_NO_DISPLAY || !f.Initialize(egl_display, &version_major, &version_minor)) {
+			egl_display = f.GetDisplay(EGL_DEFAULT_DISPLAY);
+			if (egl_display == EGL_NO_DISPLAY || !f.Initialize(egl_display, &version_major, &version_minor)) {
+				warning_cgp("Cannot create a headless OpenGL context", "No EGL display");
+				return false;
+			}
+		}
+
+		EGLint const config_attributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+		EGLConfig config = nullptr;
+		EGLint number_of_configs = 0;
+		f.ChooseConfig(egl_display, config_attributes, &config, 1, &number_of_configs);
+		if (number_of_configs == 0)
+			config = nullptr; // EGL_KHR_no_config_context (the context is never bound to a surface)
+
+		f.BindAPI(EGL_OPENGL_API);
+		EGLint const context_attributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, opengl_version_major,
+			EGL_CONTEXT_MINOR_VERSION, opengl_version_minor,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE };
+		EGLContext egl_context = f.CreateContext(egl_display, config, EGL_NO_CONTEXT, context_attributes);
+		if (egl_context == EGL_NO_CONTEXT) {
+			warning_cgp("Cannot create a headless OpenGL context", "eglCreateContext failed (EGL error " + str(int(f.GetError())) + ") - requesting OpenGL " + str(opengl_version_major) + "." + str(opengl_version_minor));
+			f.Terminate(egl_display);
+			return false;
+		}
+		if (!f.MakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context)) {
+			warning_cgp("Cannot create a headless OpenGL context", "eglMakeCurrent failed");
+			f.DestroyContext(egl_display, egl_context);
+			f.Terminate(egl_display);
+			return false;
+		}
+		display = egl_display;
+		context = egl_context;
+
+		if (gladLoadGLLoader(reinterpret_cast<GLADloadproc>(&headless_context_structure::get_proc_address)) == 0) {
+			warning_cgp("Cannot create a headless OpenGL context", "Failed to load the OpenGL functions");
+			destroy();
+			return false;
+		}
+
+		// Same setup as the windows created with GLFW
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		return true;
+	}
+
+	void headless_context_structure::destroy()
+	{
+		if (context == nullptr)
+			return;
+		headless_context_detail::egl_functions const& f = headless_context_detail::egl();
+		f.MakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		f.DestroyContext(display, context);
+		f.Terminate(display);
+		display = nullptr;
+		context = nullptr;
+	}
+
+	void* headless_context_structure::get_proc_address(char const* name)
+	{
+		headless_context_detail::egl_functions const& f = headless_context_detail::egl();
+		if (f.GetProcAddress == nullptr)
+			return nullptr;
+		return reinterpret_cast<void*>(f.GetProcAddress(name));
+	}
+#else
+	bool headless_context_structure::create(int, int)
+	{
+		warning_cgp("Cannot create a headless OpenGL context", "EGL is not available on this platform");
+		return false;
+	}
+
+	void headless_context_structure::destroy()
+	{
+	}
+
+	void* headless_context_structure::get_proc_address(char const*)
+	{
+		return nullptr;
+	}
+#endif
+
+	bool headless_context_structure::is_created() const
+	{
+		return context != nullptr;
+	}
+
+	headless_context_structure::~headless_context_structure()
+	{
+		destroy();
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+
+namespace cgp
+{
+	// OpenGL context without window nor display server (ex. benchmark on a CI machine running Mesa llvmpipe)
+	//  - The context is created with EGL on the surfaceless platform when available (Mesa), or on the default EGL display.
+	//  - libEGL is loaded at runtime: the executable does not depend on it, and create() returns false if it is missing
+	//    (or on platforms without EGL: Windows, MacOS, Emscripten).
+	//  - There is no default framebuffer: the rendering must be done in a framebuffer object.
+	//
+	//  Usage:
+	//  | headless_context_structure context;
+	//  | if(!context.create(3, 3)) error_cgp("No headless OpenGL context");
+	//  | opengl_fbo_structure fbo;
+	//  | fbo.initialize();
+	//  | fbo.update_screen_size(1280, 720);
+	//  | fbo.bind();
+	//  | ... // draw
+	//  | context.destroy();
+	struct headless_context_structure
+	{
+		// Create the context, make it current on the calling thread and load the OpenGL functions
+		//  Return false (with a warning) if the context cannot be created.
+		bool create(int opengl_version_major = 3, int opengl_version_minor = 3);
+		void destroy();
+
+		bool is_created() const;
+
+		// Address of an OpenGL function of the context (can be used as a GLADloadproc)
+		static void* get_proc_address(char const* name);
+
+		headless_context_structure() = default;
+		headless_context_structure(headless_context_structure const&) = delete;
+		headless_context_structure& operator=(headless_context_structure const&) = delete;
+		~headless_context_structure();
+
+	private:
+		void* display = nullptr;
+		void* context = nullptr;
+	};
+}
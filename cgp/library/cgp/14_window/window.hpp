@@ -1,4 +1,5 @@
 #pragma once
 
 #include "window/window.hpp"
+#include "headless_context/headless_context.hpp"
 #include "imgui/imgui.hpp"
@@ -1,4 +1,6 @@
 #include "cgp/01_base/base.hpp"
+#include "cgp/13_opengl/render_stats/render_stats.hpp"
+#include "cgp/23_profiler/profiler/profiler.hpp"
 #include "curve_drawable.hpp"
 
 namespace cgp
@@ -69,6 +71,7 @@ namespace cgp
 
 	void draw(curve_drawable const& drawable, environment_generic_structure const& environment, int N_points)
 	{
+		CGP_PROFILE_SCOPE("draw(curve_drawable)");
 		// Initial clean check
 		// ********************************** //
 		// If there is not vertices or not triangles, returns
@@ -80,6 +83,7 @@ namespace cgp
 		// ********************************** //
 		assert_cgp(drawable.shader.id != 0, "Try to draw curve_drawable without shader");
 		glUseProgram(drawable.shader.id); opengl_check;
+		default_render_stats().count_program(drawable.shader.id);
 
 		// Send uniforms for this shader
 		// ********************************** //
@@ -100,6 +104,7 @@ namespace cgp
 		else {
 			glDrawArrays(GL_LINES, 0, N_points_display); opengl_check;
 		}
+		default_render_stats().count_draw(GL_LINES, size_t(N_points_display));
 
 
 		// Clean buffers
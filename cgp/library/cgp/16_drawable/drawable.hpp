@@ -8,3 +8,4 @@
 #include "special_drawable/special_drawable.hpp"
 #include "environment/environment.hpp"
 #include "hierarchy_mesh_drawable/hierarchy_mesh_drawable.hpp"
+#include "hierarchy_mesh_drawable_instances/hierarchy_mesh_drawable_instances.hpp"
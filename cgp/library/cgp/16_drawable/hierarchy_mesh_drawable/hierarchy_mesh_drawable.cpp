@@ -1,31 +1,39 @@
 #include "cgp/01_base/base.hpp"
+#include "cgp/23_profiler/profiler/profiler.hpp"
 #include "hierarchy_mesh_drawable.hpp"
 
+#include <algorithm>
+
 namespace cgp
 {
 
-    static void assert_valid_hierarchy(hierarchy_mesh_drawable const& hierarchy);
+    // Index of the parent of a node to be added (-1 for a root), after checking that it can be added to the hierarchy
+    static int parent_of_new_node(hierarchy_mesh_drawable const& hierarchy, hierarchy_mesh_drawable_node const& node);
 
-    void hierarchy_mesh_drawable::add(hierarchy_mesh_drawable_node const& node)
+    int hierarchy_mesh_drawable::add(hierarchy_mesh_drawable_node const& node)
     {
-        name_map[node.name] = static_cast<int>(elements.size());
-        elements.push_back(node);
-        assert_valid_hierarchy(*this);
+        int const parent = parent_of_new_node(*this, node);
+        int const index = static_cast<int>(nodes.size());
+
+        name_map[node.name] = index;
+        nodes.push_back(node);
+        parent_index.push_back(parent);
+        dirty.push_back(true);
+        return index;
     }
-    void hierarchy_mesh_drawable::add(mesh_drawable const& element, std::string const& name, std::string const& name_parent, vec3 const& translation, rotation_transform const& rotation)
+    int hierarchy_mesh_drawable::add(mesh_drawable const& element, std::string const& name, std::string const& name_parent, vec3 const& translation, rotation_transform const& rotation)
     {
         affine_rts const transform = affine_rts(rotation, translation, 1.0f);
         hierarchy_mesh_drawable_node const node = {element, name, name_parent, transform};
-        add(node);
+        return add(node);
     }
-    void hierarchy_mesh_drawable::add(mesh_drawable const& element, std::string const& name, std::string const& name_parent, affine_rts const& transform)
+    int hierarchy_mesh_drawable::add(mesh_drawable const& element, std::string const& name, std::string const& name_parent, affine_rts const& transform)
     {
         hierarchy_mesh_drawable_node const node = {element, name, name_parent, transform};
-        add(node);
+        return add(node);
     }
 
-
-    hierarchy_mesh_drawable_node& hierarchy_mesh_drawable::operator[](std::string const& name)
+    int hierarchy_mesh_drawable::handle(std::string const& name) const
     {
         auto it = name_map.find(name);
         if (it == name_map.end())
@@ -35,143 +43,126 @@ namespace cgp
             for (auto const& s : name_map) { std::cerr << "[" << s.first << "] "; }
             abort();
         }
+        return it->second;
+    }
 
-        const size_t index = it->second;
-        assert_cgp_no_msg(index < elements.size());
 
-        return elements[index];
+    hierarchy_mesh_drawable_node& hierarchy_mesh_drawable::operator[](std::string const& name)
+    {
+        return (*this)[handle(name)];
     }
     hierarchy_mesh_drawable_node const& hierarchy_mesh_drawable::operator[](std::string const& name) const
     {
-        auto it = name_map.find(name);
-        if (it == name_map.end())
-        {
-            std::cerr << "Error: cannot find element [" << name << "] in hierarchy_mesh_drawable" << std::endl;
-            std::cerr << "Possibles element names are: ";
-            for (auto const& s : name_map) { std::cerr << "[" << s.first << "] "; }
-            abort();
-        }
+        return (*this)[handle(name)];
+    }
+    hierarchy_mesh_drawable_node& hierarchy_mesh_drawable::operator[](int handle)
+    {
+        assert_cgp(handle >= 0 && handle < int(nodes.size()), "Invalid handle " + str(handle) + " in hierarchy_mesh_drawable of " + str(nodes.size()) + " elements");
+        dirty[handle] = true;
+        return nodes[handle];
+    }
+    hierarchy_mesh_drawable_node const& hierarchy_mesh_drawable::operator[](int handle) const
+    {
+        assert_cgp(handle >= 0 && handle < int(nodes.size()), "Invalid handle " + str(handle) + " in hierarchy_mesh_drawable of " + str(nodes.size()) + " elements");
+        return nodes[handle];
+    }
 
-        const size_t index = it->second;
-        assert_cgp_no_msg(index < elements.size());
+    std::vector<hierarchy_mesh_drawable_node> const& hierarchy_mesh_drawable::elements() const
+    {
+        return nodes;
+    }
+    int hierarchy_mesh_drawable::size() const
+    {
+        return static_cast<int>(nodes.size());
+    }
+    mesh_drawable& hierarchy_mesh_drawable::drawable(int handle)
+    {
+        assert_cgp(handle >= 0 && handle < int(nodes.size()), "Invalid handle " + str(handle) + " in hierarchy_mesh_drawable of " + str(nodes.size()) + " elements");
+        return nodes[handle].drawable;
+    }
 
-        return elements[index];
+    void hierarchy_mesh_drawable::set_transform_local(int handle, affine_rts const& transform)
+    {
+        (*this)[handle].transform_local = transform;
+    }
+    void hierarchy_mesh_drawable::mark_dirty(int handle)
+    {
+        assert_cgp(handle >= 0 && handle < int(nodes.size()), "Invalid handle " + str(handle) + " in hierarchy_mesh_drawable of " + str(nodes.size()) + " elements");
+        dirty[handle] = true;
+    }
+    void hierarchy_mesh_drawable::mark_all_dirty()
+    {
+        std::fill(dirty.begin(), dirty.end(), char(true));
+    }
+    bool hierarchy_mesh_drawable::is_dirty(int handle) const
+    {
+        assert_cgp(handle >= 0 && handle < int(nodes.size()), "Invalid handle " + str(handle) + " in hierarchy_mesh_drawable of " + str(nodes.size()) + " elements");
+        return dirty[handle] != 0;
     }
 
 
     void hierarchy_mesh_drawable::update_local_to_global_coordinates()
     {
-        if(elements.size()==0)
-            return ;
-
-        assert_valid_hierarchy(*this);
-
-        std::string const& name_root_parent = elements[0].name_parent;
+        int const N = static_cast<int>(nodes.size());
+        assert_cgp(int(parent_index.size()) == N && int(dirty.size()) == N, "The elements of the hierarchy_mesh_drawable must be added with add()");
 
-        int const N = static_cast<int>(elements.size());
+        // The parents are stored before their children: the dirty flags are propagated to the descendants in the same pass
         for(int k=0; k<N; ++k)
         {
-            hierarchy_mesh_drawable_node& element = elements[k];
-
-            std::string const& parent_name = element.name_parent;
-
-            // Case of root element (or same parent) - local = global
-            if( parent_name == name_root_parent ) {
+            int const parent = parent_index[k];
+            if (parent >= 0 && dirty[parent])
+                dirty[k] = true;
+            if (!dirty[k])
+                continue;
+
+            hierarchy_mesh_drawable_node& element = nodes[k];
+            if (parent < 0)
                 element.drawable.hierarchy_transform_model = element.transform_local;
-            }
-            // Else apply hierarchical transformation
             else
-            {
-                int const parent_id = name_map[parent_name];
-                affine_rts const& local = element.transform_local;
-                affine_rts const& global_parent = elements[parent_id].drawable.hierarchy_transform_model;
-
-                element.drawable.hierarchy_transform_model = global_parent * local;
-            }
+                element.drawable.hierarchy_transform_model = nodes[parent].drawable.hierarchy_transform_model * element.transform_local;
         }
+        std::fill(dirty.begin(), dirty.end(), char(false));
     }
 
 
-    void assert_valid_hierarchy(hierarchy_mesh_drawable const& hierarchy)
+    int parent_of_new_node(hierarchy_mesh_drawable const& hierarchy, hierarchy_mesh_drawable_node const& node)
     {
-        if(hierarchy.elements.size()==0)
-            return ;
-
-        {
-            // Check that elements and name_map have the same size
-            const size_t N1 = hierarchy.elements.size();
-            const size_t N2 = hierarchy.name_map.size();
-            if(N1!=N2) {
-                std::cerr<<"Error: Hierarchy not valid - Number of element ("<<N1<<") != Name_map.size() ("<<N2<<")"<<std::endl;
-                abort();
-            }
-        }
-
-        {
-            // Check that the name of the parent of root node doesn't belong to the hierarchy
-            const std::string root_name_parent = hierarchy.elements[0].name_parent;
-            const auto it = hierarchy.name_map.find(root_name_parent);
-            if(it!=hierarchy.name_map.end()) {
-                std::cerr<<"Error: Hierarchy not valid - name of the root node ("<<root_name_parent<<") cannot be an element of the hierarchy"<<std::endl;
-                abort();
-            }
+        if (hierarchy.name_map.find(node.name) != hierarchy.name_map.end()) {
+            std::cerr << "Error: Hierarchy not valid - Element name (" << node.name << ") is already used in the hierarchy" << std::endl;
+            abort();
         }
 
-        {
-            // Check that all names stored in map are designating the corresponding elements
-            for(const auto& e : hierarchy.name_map)
-            {
-                std::string const& name = e.first;
-                int const index = e.second;
-
-                if(index>=int(hierarchy.elements.size()) || index<0)
-                {
-                    std::cerr<<"Error: Hierarchy not valid - Incorrect index stored in name_map: "<<name<<";"<<index<<std::endl;
-                    abort();
-                }
-
-                hierarchy_mesh_drawable_node const& designated_element = hierarchy.elements[index];
-                if(designated_element.name != name)
-                {
-                    std::cerr<<"Error: Hierarchy not valid - Incoherent name between map ("<<name<<";"<<index<<") and element ("<<designated_element.name<<") "<<std::endl;
-                    abort();
-                }
-            }
+        // The first element defines the name of the parent of the roots
+        if (hierarchy.elements().size() == 0)
+            return -1;
+        std::string const& root_name_parent = hierarchy.elements()[0].name_parent;
+        if (node.name == root_name_parent) {
+            std::cerr << "Error: Hierarchy not valid - name of the root node (" << root_name_parent << ") cannot be an element of the hierarchy" << std::endl;
+            abort();
         }
-
-        {
-            // Check that all parents are defined before their children (excepted for root parent)
-            std::set<std::string> parent_names_visited;
-            parent_names_visited.insert(hierarchy.elements[0].name_parent);
-            int const N = hierarchy.elements.size();
-            for(int k=0; k<N; ++k)
-            {
-                std::string const& name = hierarchy.elements[k].name;
-                std::string const& parent_name = hierarchy.elements[k].name_parent;
-                if(parent_names_visited.find(parent_name)==parent_names_visited.end())
-                {
-                    std::cerr<<"Error: Hierarchy not valid"<<std::endl;
-                    std::cerr<<"Element ("<<name<<","<<k<<") has parent name ("<<parent_name<<") used before being defined"<<std::endl;
-                    std::cerr << std::endl;
-                    std::cerr << "Display hierarchy for debugging: " << std::endl;
-                    std::cerr << hierarchy.hierarchy_display() << std::endl;
-                    abort();
-                }
-                else
-                    parent_names_visited.insert(name);
-            }
+        if (node.name_parent == root_name_parent)
+            return -1;
+
+        auto const it = hierarchy.name_map.find(node.name_parent);
+        if (it == hierarchy.name_map.end()) {
+            std::cerr << "Error: Hierarchy not valid" << std::endl;
+            std::cerr << "Element (" << node.name << "," << hierarchy.elements().size() << ") has parent name (" << node.name_parent << ") used before being defined" << std::endl;
+            std::cerr << std::endl;
+            std::cerr << "Display hierarchy for debugging: " << std::endl;
+            std::cerr << hierarchy.hierarchy_display() << std::endl;
+            abort();
         }
-
+        return it->second;
     }
 
     std::string hierarchy_mesh_drawable::hierarchy_display() const
     {
         std::string s;
 
-        int const N = elements.size();
+        int const N = nodes.size();
         for (int k = 0; k < N; ++k)
         {
-            s += "Element [" + str(k) + "] " + elements[k].name + " has parent: " + elements[k].name_parent + "\n";
+            s += "Element [" + str(k) + "] " + nodes[k].name + " has parent: " + nodes[k].name_parent + "\n";
         }
 
         return s;
@@ -180,16 +171,17 @@ namespace cgp
 
     void draw(hierarchy_mesh_drawable const& hierarchy, environment_generic_structure const& environment, int instance_count, bool expected_uniforms, uniform_generic_structure const& additional_uniforms)
     {
-        int const N = hierarchy.elements.size();
+        CGP_PROFILE_SCOPE("draw(hierarchy_mesh_drawable)");
+        int const N = hierarchy.elements().size();
         for (int k = 0; k < N; ++k)
-            draw(hierarchy.elements[k].drawable, environment, instance_count, expected_uniforms, additional_uniforms);
+            draw(hierarchy.elements()[k].drawable, environment, instance_count, expected_uniforms, additional_uniforms);
     }
 
     void draw_wireframe(hierarchy_mesh_drawable const& hierarchy, environment_generic_structure const& environment, vec3 const& color, int instance_count, bool expected_uniforms, uniform_generic_structure const& additional_uniforms)
     {
-        int const N = hierarchy.elements.size();
+        int const N = hierarchy.elements().size();
         for (int k = 0; k < N; ++k)
-            draw_wireframe(hierarchy.elements[k].drawable, environment, color, instance_count, expected_uniforms, additional_uniforms);
+            draw_wireframe(hierarchy.elements()[k].drawable, environment, color, instance_count, expected_uniforms, additional_uniforms);
     }
 
 }
\ No newline at end of file
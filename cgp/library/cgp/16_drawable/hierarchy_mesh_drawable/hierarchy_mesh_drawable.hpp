@@ -21,32 +21,69 @@ namespace cgp
 	};
 
 
+	// Hierarchy of mesh_drawable, each node being placed relatively to its parent
+	//  The nodes are stored flat in the order of their addition: the parent of each node is stored before it (parent_index).
+	//  The names are resolved at add() and by handle(): the hierarchy can then be manipulated with the integer handles of the nodes.
+	//  Only the nodes marked as dirty, and their descendants, are recomposed by update_local_to_global_coordinates(). A node is marked as
+	//  dirty when it is added, or accessed through the non-const operator[] or set_transform_local. The nodes are otherwise read-only
+	//  (elements() is const): a transform modified through a reference kept after the update must be signaled with mark_dirty.
+	//
+	//  Usage:
+	//  | int const trunk = hierarchy.add(trunk_drawable, "trunk");
+	//  | hierarchy.add(foliage_drawable, "foliage", "trunk");
+	//  | ...
+	//  | hierarchy[trunk].transform_local.translation = position;
+	//  | hierarchy.update_local_to_global_coordinates();
+	//  | draw(hierarchy, environment);
 	struct hierarchy_mesh_drawable
 	{
-		
-		std::vector<hierarchy_mesh_drawable_node> elements;
+		// Index of the parent of each element (-1 for the roots). The parent is always stored before its children.
+		std::vector<int> parent_index;
 
 		// Lookup table to quickly find the index of an element from its name
 		std::map<std::string, int> name_map;
 		
-		// Add new node to the hierarchy
+		// Add new node to the hierarchy and return its handle (index in elements)
 		// Note: Parent node is expected to be already present in the hierarchy
 		// The name of each node must be unique in the hierarchy
-		void add(hierarchy_mesh_drawable_node const& node);
-		void add(mesh_drawable const& element, std::string const& name, std::string const& name_parent = "global_frame", vec3 const& translation = vec3(), rotation_transform const& = rotation_transform());
-		void add(mesh_drawable const& element, std::string const& name, std::string const& name_parent, affine_rts const& transform);
+		int add(hierarchy_mesh_drawable_node const& node);
+		int add(mesh_drawable const& element, std::string const& name, std::string const& name_parent = "global_frame", vec3 const& translation = vec3(), rotation_transform const& = rotation_transform());
+		int add(mesh_drawable const& element, std::string const& name, std::string const& name_parent, affine_rts const& transform);
+
+		// Handle of the node from its name (to be resolved once, outside of the frame loop)
+		int handle(std::string const& name) const;
 
-		// Get node by name
+		// Get node by name or by handle (the non-const versions mark the node as dirty)
 		hierarchy_mesh_drawable_node& operator[](std::string const& name);
 		hierarchy_mesh_drawable_node const& operator[](std::string const& name) const;
+		hierarchy_mesh_drawable_node& operator[](int handle);
+		hierarchy_mesh_drawable_node const& operator[](int handle) const;
+
+		// Read-only access to the nodes, in the order of their addition (the handle is the index)
+		std::vector<hierarchy_mesh_drawable_node> const& elements() const;
+		int size() const;
 
+		// Drawable of a node, to change its shader, textures or uniforms without marking the node as dirty
+		mesh_drawable& drawable(int handle);
+
+		// Set the local transform of a node and mark it as dirty
+		void set_transform_local(int handle, affine_rts const& transform);
+		void mark_dirty(int handle);
+		void mark_all_dirty();
+		bool is_dirty(int handle) const;
 
 		// Update the global coordinates of the nodes along the hierarchy
 		//  This function must be called before draw, and called again if any hierarchical transform is modified
+		//  Only the dirty nodes and their descendants are updated, in a single pass in the order of the elements.
 		void update_local_to_global_coordinates();
 
 		// Helper function to display all the hierarchy
 		std::string hierarchy_display() const;
+
+	private:
+		std::vector<hierarchy_mesh_drawable_node> nodes;
+		// Nodes whose global transform must be recomputed at the next update (with their descendants)
+		std::vector<char> dirty;
 	};
 
 	void draw(hierarchy_mesh_drawable const& drawable, environment_generic_structure const& environment = environment_generic_structure(), int instance_count=1, bool expected_uniforms=true, uniform_generic_structure const& additional_uniforms = uniform_generic_structure());
@@ -0,0 +1,67 @@
+#include "test_hierarchy_mesh_drawable.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../hierarchy_mesh_drawable.hpp"
+
+#include <iostream>
+using namespace cgp;
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	static affine_rts global_transform(hierarchy_mesh_drawable const& hierarchy, std::string const& name)
+	{
+		return hierarchy[name].drawable.hierarchy_transform_model;
+	}
+
+	void test_hierarchy_mesh_drawable()
+	{
+		mesh_drawable const drawable{};
+
+		// root -> a -> b, root -> c, and a second root
+		hierarchy_mesh_drawable hierarchy;
+		int const root = hierarchy.add(drawable, "root", "global_frame", vec3{ 1,0,0 });
+		int const a = hierarchy.add(drawable, "a", "root", vec3{ 0,1,0 }, rotation_transform::from_axis_angle({ 0,0,1 }, 0.5f));
+		int const b = hierarchy.add(drawable, "b", "a", vec3{ 0,0,1 });
+		int const c = hierarchy.add(drawable, "c", "root", vec3{ 2,0,0 });
+		int const root_2 = hierarchy.add(drawable, "root_2", "global_frame", vec3{ 0,0,5 });
+
+		assert_cgp_no_msg( root == 0 && a == 1 && b == 2 && c == 3 && root_2 == 4 );
+		assert_cgp_no_msg( hierarchy.handle("b") == b );
+		assert_cgp_no_msg( hierarchy.parent_index == std::vector<int>({ -1, 0, 1, 0, -1 }) );
+
+		// First update: all the nodes are computed
+		hierarchy.update_local_to_global_coordinates();
+		affine_rts const expected_b = hierarchy[root].transform_local * hierarchy[a].transform_local * hierarchy[b].transform_local;
+		hierarchy.update_local_to_global_coordinates();
+		assert_cgp_no_msg( is_equal(global_transform(hierarchy, "b").matrix(), expected_b.matrix()) );
+		assert_cgp_no_msg( is_equal(global_transform(hierarchy, "root_2").translation, vec3{ 0,0,5 }) );
+		for (int k = 0; k < hierarchy.size(); ++k)
+			assert_cgp_no_msg( hierarchy.is_dirty(k) == false );
+
+		// Modifying a node updates its subtree only
+		hierarchy.set_transform_local(a, affine_rts(rotation_transform(), vec3{ 0,3,0 }, 2.0f));
+		hierarchy.drawable(root_2).hierarchy_transform_model = affine_rts(); // not recomputed: root_2 is not dirty
+		assert_cgp_no_msg( hierarchy.is_dirty(a) && !hierarchy.is_dirty(root_2) );
+		hierarchy.update_local_to_global_coordinates();
+		assert_cgp_no_msg( is_equal(global_transform(hierarchy, "a").translation, vec3{ 1,3,0 }) );
+		assert_cgp_no_msg( is_equal(global_transform(hierarchy, "b").translation, vec3{ 1,3,2 }) );
+		assert_cgp_no_msg( is_equal(global_transform(hierarchy, "c").translation, vec3{ 3,0,0 }) );
+		assert_cgp_no_msg( is_equal(global_transform(hierarchy, "root_2").translation, vec3{ 0,0,0 }) );
+
+		// Modifying the root updates all its descendants
+		hierarchy[root].transform_local.translation = { 0,0,0 };
+		assert_cgp_no_msg( hierarchy.is_dirty(root) );
+		hierarchy.update_local_to_global_coordinates();
+		assert_cgp_no_msg( is_equal(global_transform(hierarchy, "b").translation, vec3{ 0,3,2 }) );
+		assert_cgp_no_msg( is_equal(global_transform(hierarchy, "c").translation, vec3{ 2,0,0 }) );
+
+		// mark_all_dirty recomputes every node
+		hierarchy.mark_all_dirty();
+		hierarchy.update_local_to_global_coordinates();
+		assert_cgp_no_msg( is_equal(global_transform(hierarchy, "root_2").translation, vec3{ 0,0,5 }) );
+	}
+}
@@ -0,0 +1,117 @@
+#include "cgp/01_base/base.hpp"
+#include "cgp/23_profiler/profiler/profiler.hpp"
+#include "hierarchy_mesh_drawable_instances.hpp"
+
+namespace cgp
+{
+	hierarchy_mesh_drawable_instances& hierarchy_mesh_drawable_instances::resize(int N)
+	{
+		int const N_previous = root.size();
+		root.resize(N);
+		for (int i = N_previous; i < N; ++i)
+			root.set(i, affine_rts());
+
+		for (soa_affine_rts& local : local_override) {
+			if (local.size() == 0)
+				continue;
+			int const N_local = local.size();
+			local.resize(N);
+			for (int i = N_local; i < N; ++i)
+				local.set(i, affine_rts());
+		}
+		return *this;
+	}
+
+	int hierarchy_mesh_drawable_instances::size() const
+	{
+		return root.size();
+	}
+
+	soa_affine_rts& hierarchy_mesh_drawable_instances::override_local(hierarchy_mesh_drawable const& hierarchy, int handle)
+	{
+		int const N_node = int(hierarchy.elements().size());
+		assert_cgp(handle >= 0 && handle < N_node, "Invalid handle " + str(handle) + " in hierarchy_mesh_drawable of " + str(N_node) + " elements");
+		if (int(local_override.size()) < N_node)
+			local_override.resize(N_node);
+
+		soa_affine_rts& local = local_override[handle];
+		int const N = size();
+		if (local.size() != N) {
+			local.resize(N);
+			for (int i = 0; i < N; ++i)
+				local.set(i, hierarchy.elements()[handle].transform_local);
+		}
+		return local;
+	}
+
+	void hierarchy_mesh_drawable_instances::update(hierarchy_mesh_drawable const& hierarchy)
+	{
+		CGP_PROFILE_SCOPE("hierarchy_mesh_drawable_instances::update");
+		size_t const N_node = hierarchy.elements().size();
+		if (local_override.size() < N_node)
+			local_override.resize(N_node);
+
+		std::vector<affine_rts> local(N_node);
+		std::vector<soa_affine_rts const*> local_instances(N_node, nullptr);
+		for (size_t k = 0; k < N_node; ++k) {
+			local[k] = hierarchy.elements()[k].transform_local;
+			if (local_override[k].size() > 0)
+				local_instances[k] = &local_override[k];
+		}
+
+		batch_hierarchy_matrix(hierarchy.parent_index, local, root, local_instances, matrix);
+	}
+
+	void hierarchy_mesh_drawable_instances::update_gpu(hierarchy_mesh_drawable const& hierarchy, GLuint location_index)
+	{
+		CGP_PROFILE_SCOPE("hierarchy_mesh_drawable_instances::update_gpu");
+		size_t const N_node = hierarchy.elements().size();
+		assert_cgp(matrix.size() == N_node, "update() must be called before update_gpu()");
+		if (vbo_matrix.size() < N_node)
+			vbo_matrix.resize(N_node);
+
+		int const N = size();
+		for (size_t k = 0; k < N_node; ++k)
+		{
+			opengl_vbo_structure& vbo = vbo_matrix[k];
+			if (vbo.id != 0 && int(vbo.size) == N) {
+				vbo.update(matrix[k]);
+				continue;
+			}
+
+			// The number of instances changed: the buffer is allocated again and attached to the VAO of the node
+			if (vbo.id != 0)
+				vbo.clear();
+			if (N == 0)
+				continue;
+			vbo.initialize_data_on_gpu(matrix[k], 1);
+			glBindVertexArray(hierarchy.elements()[k].drawable.vao); opengl_check;
+			opengl_set_vao_location(vbo, location_index);
+			glBindVertexArray(0); opengl_check;
+		}
+	}
+
+	void hierarchy_mesh_drawable_instances::clear()
+	{
+		for (opengl_vbo_structure& vbo : vbo_matrix)
+			vbo.clear();
+		vbo_matrix.clear();
+	}
+
+	void draw(hierarchy_mesh_drawable& hierarchy, hierarchy_mesh_drawable_instances const& instances, environment_generic_structure const& environment, bool expected_uniforms, uniform_generic_structure const& additional_uniforms)
+	{
+		CGP_PROFILE_SCOPE("draw(hierarchy_mesh_drawable_instances)");
+		int const N = instances.size();
+		if (N == 0)
+			return;
+		assert_cgp(instances.vbo_matrix.size() == hierarchy.elements().size(), "update_gpu() must be called before drawing the instances");
+
+		for (int k = 0; k < int(hierarchy.elements().size()); ++k) {
+			// The hierarchy transform is given by the instance matrices: the uniform model only contains the model transform of the drawable
+			//  (the node is marked dirty, so that a later update_local_to_global_coordinates() recomputes its transform)
+			mesh_drawable& drawable = hierarchy[k].drawable;
+			drawable.hierarchy_transform_model = affine_rts();
+			draw(drawable, environment, N, expected_uniforms, additional_uniforms);
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "cgp/09_geometric_transformation/batch_transform/batch_transform.hpp"
+#include "cgp/16_drawable/hierarchy_mesh_drawable/hierarchy_mesh_drawable.hpp"
+
+#include <vector>
+
+namespace cgp
+{
+	// N instances of a hierarchy_mesh_drawable (the template), evaluated in one pass and drawn with one instanced draw call per node
+	//  Each instance has its own root transform, applied above the roots of the template, and optionally its own local transform
+	//  for some nodes (ex. the angle of the wings of each mosquito). update() computes the global matrix of every node of every
+	//  instance (vectorized and parallel, see batch_hierarchy_matrix) and update_gpu() writes them in one per-instance buffer per node.
+	//
+	//  The vertex shader of the nodes reads the matrix of the instance as a mat4 attribute (4 locations from location_index),
+	//  whose columns are the rows of the cgp matrix:
+	//  | layout (location = 5) in mat4 instance_model;
+	//  | mat4 M = transpose(instance_model) * model; // model: uniform of the mesh_drawable (without the hierarchy transform)
+	//
+	//  The instance buffers are attached to the VAO of the drawables of the template: a template is drawn by a single set of instances.
+	//
+	//  Usage:
+	//  | hierarchy_mesh_drawable_instances instances;
+	//  | instances.resize(N);
+	//  | soa_affine_rts& wing = instances.override_local(hierarchy, wing_node);
+	//  | ...
+	//  | for (int i = 0; i < N; ++i) { instances.root.set(i, T[i]); wing.set(i, wing_transform[i]); }
+	//  | instances.update(hierarchy);
+	//  | instances.update_gpu(hierarchy);
+	//  | draw(hierarchy, instances, environment);
+	struct hierarchy_mesh_drawable_instances
+	{
+		// Transform of each instance
+		soa_affine_rts root;
+		// Per-instance local transforms replacing the transform_local of a node of the template (empty if the node is not overridden)
+		std::vector<soa_affine_rts> local_override;
+		// Global matrix of each node (first index) for each instance (second index)
+		std::vector<numarray<mat4> > matrix;
+		// Per-instance buffer of the matrices of each node
+		std::vector<opengl_vbo_structure> vbo_matrix;
+
+		// Set the number of instances (the new root transforms are identity, the overrides are resized)
+		hierarchy_mesh_drawable_instances& resize(int N);
+		int size() const;
+
+		// Enable the per-instance local transform of a node and return it (initialized with the transform_local of the template)
+		soa_affine_rts& override_local(hierarchy_mesh_drawable const& hierarchy, int handle);
+
+		// Compute the global matrices of all the nodes of all the instances
+		void update(hierarchy_mesh_drawable const& hierarchy);
+		// Send the matrices to the instance buffers, attached at location_index in the VAO of each node (4 locations for a mat4)
+		void update_gpu(hierarchy_mesh_drawable const& hierarchy, GLuint location_index = 5);
+
+		// Clear the GPU buffers
+		void clear();
+	};
+
+	// Draw each node of the hierarchy once for all the instances (the shaders of the nodes must read the instance matrices, see above)
+	//  The hierarchy_transform_model of the drawables is reset to identity, the hierarchy transform being given by the instances.
+	void draw(hierarchy_mesh_drawable& hierarchy, hierarchy_mesh_drawable_instances const& instances, environment_generic_structure const& environment = environment_generic_structure(), bool expected_uniforms = true, uniform_generic_structure const& additional_uniforms = uniform_generic_structure());
+}
@@ -1,6 +1,8 @@
 #include "mesh_drawable.hpp"
 
 #include "cgp/01_base/base.hpp"
+#include "cgp/13_opengl/render_stats/render_stats.hpp"
+#include "cgp/23_profiler/profiler/profiler.hpp"
 
 #if defined(__linux__) || defined(__EMSCRIPTEN__)
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -14,6 +16,19 @@ namespace cgp
 	static void warning_initialize_non_empty();
 
 	void mesh_drawable::initialize_data_on_gpu(mesh const& data, opengl_shader_structure const& shader_arg, opengl_texture_image_structure const& texture_arg)
+	{
+		if (data.position.size() == 0) {
+			warning_cgp("Warning try to generate mesh_drawable with 0 vertex", "");
+			return;
+		}
+
+		// Sanity check before sending mesh data to GPU
+		assert_cgp(mesh_check(data), "Cannot send this mesh data to GPU in initializing mesh_drawable");
+
+		initialize_data_on_gpu(mesh_view(data), shader_arg, texture_arg);
+	}
+
+	void mesh_drawable::initialize_data_on_gpu(mesh_view const& data, opengl_shader_structure const& shader_arg, opengl_texture_image_structure const& texture_arg)
 	{
 		// Error detection before sending the data to avoid unexpected behavior
 		// *********************************************************************** //
@@ -24,13 +39,13 @@ namespace cgp
 		if (vao != 0 || vbo_position.size != 0)
 			warning_initialize_non_empty();
 
-		if (data.position.size() == 0) {
+		if (data.number_of_vertex == 0) {
 			warning_cgp("Warning try to generate mesh_drawable with 0 vertex", "");
 			return;
 		}
 
 		// Sanity check before sending mesh data to GPU
-		assert_cgp(mesh_check(data), "Cannot send this mesh data to GPU in initializing mesh_drawable");
+		assert_cgp(mesh_view_check(data), "Cannot send this mesh data to GPU in initializing mesh_drawable");
 
 
 		// Variable initialization
@@ -47,12 +62,12 @@ namespace cgp
 		// Send the data to the GPU
 		// ******************************************** //
 
-		vbo_position.initialize_data_on_gpu(data.position);
-		vbo_normal.initialize_data_on_gpu(data.normal);
-		vbo_color.initialize_data_on_gpu(data.color);
-		vbo_uv.initialize_data_on_gpu(data.uv);
+		vbo_position.initialize_data_on_gpu(data.position, data.number_of_vertex);
+		vbo_normal.initialize_data_on_gpu(data.normal, data.number_of_vertex);
+		vbo_color.initialize_data_on_gpu(data.color, data.number_of_vertex);
+		vbo_uv.initialize_data_on_gpu(data.uv, data.number_of_vertex);
 
-		ebo_connectivity.initialize_data_on_gpu(data.connectivity);
+		ebo_connectivity.initialize_data_on_gpu(data.connectivity, data.number_of_triangle);
 
 
 		// Generate VAO 
@@ -83,6 +98,7 @@ namespace cgp
 		glBindVertexArray(0); opengl_check;
 	}
 
+	template void mesh_drawable::initialize_supplementary_data_on_gpu(numarray<float> const& data, GLuint location_index, GLuint divisor);
 	template void mesh_drawable::initialize_supplementary_data_on_gpu(numarray<vec2> const& data, GLuint location_index, GLuint divisor);
 	template void mesh_drawable::initialize_supplementary_data_on_gpu(numarray<vec3> const& data, GLuint location_index, GLuint divisor);
 	template void mesh_drawable::initialize_supplementary_data_on_gpu(numarray<vec4> const& data, GLuint location_index, GLuint divisor);
@@ -125,6 +141,7 @@ namespace cgp
 
 	void draw(mesh_drawable const& drawable, environment_generic_structure const& environment, int instance_count, bool expected_uniforms, uniform_generic_structure const& additional_uniforms, GLenum draw_mode)
 	{
+		CGP_PROFILE_SCOPE("draw(mesh_drawable)");
 		opengl_check;
 		// Initial clean check
 		// ********************************** //
@@ -140,6 +157,7 @@ namespace cgp
 		// Set the current shader
 		// ********************************** //
 		glUseProgram(drawable.shader.id); opengl_check;
+		default_render_stats().count_program(drawable.shader.id);
 
 		// Send uniforms for this shader
 		// ********************************** //
@@ -189,6 +207,7 @@ namespace cgp
 		else {
 			glDrawElementsInstanced(draw_mode, GLsizei(drawable.ebo_connectivity.size * 3), GL_UNSIGNED_INT, nullptr, instance_count); opengl_check;
 		}
+		default_render_stats().count_draw(draw_mode, size_t(drawable.ebo_connectivity.size) * 3, instance_count);
 
 
 		// Clean state
@@ -2,6 +2,7 @@
 
 #include "cgp/09_geometric_transformation/affine/affine.hpp"
 #include "cgp/11_mesh/mesh/mesh.hpp"
+#include "cgp/11_mesh/mesh_view/mesh_view.hpp"
 #include "cgp/13_opengl/opengl.hpp"
 #include "cgp/16_drawable/material/material_mesh_drawable_phong/material_mesh_drawable_phong.hpp"
 #include "cgp/16_drawable/environment/environment.hpp"
@@ -67,6 +68,8 @@ namespace cgp
 
 		// Fill the VBO and VAO of the class using the data provided from the mesh
 		void initialize_data_on_gpu(mesh const& data, opengl_shader_structure const& shader = default_shader, opengl_texture_image_structure const& texture = default_texture);
+		// Fill the VBO and VAO directly from the memory referenced by the view (no intermediate copy of the buffers)
+		void initialize_data_on_gpu(mesh_view const& data, opengl_shader_structure const& shader = default_shader, opengl_texture_image_structure const& texture = default_texture);
 
 		// Clear the GPU memory from the VBO and VAO data
 		void clear();
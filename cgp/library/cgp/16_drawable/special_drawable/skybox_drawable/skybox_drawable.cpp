@@ -1,6 +1,7 @@
 #include "skybox_drawable.hpp"
 
 #include "cgp/11_mesh/mesh.hpp"
+#include "cgp/13_opengl/render_stats/render_stats.hpp"
 
 namespace cgp {
 
@@ -107,6 +108,7 @@ namespace cgp {
 		// Set the current shader
 		// ********************************** //
 		glUseProgram(drawable.shader.id); opengl_check;
+		default_render_stats().count_program(drawable.shader.id);
 
 		// Send uniforms for this shader
 		// ********************************** //
@@ -131,6 +133,7 @@ namespace cgp {
 		glBindVertexArray(drawable.vao);   opengl_check;
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, drawable.ebo_connectivity.id); opengl_check;
 		glDrawElements(GL_TRIANGLES, GLsizei(drawable.ebo_connectivity.size * 3), GL_UNSIGNED_INT, nullptr); opengl_check;
+		default_render_stats().count_draw(GL_TRIANGLES, size_t(drawable.ebo_connectivity.size) * 3);
 
 
 
@@ -1,6 +1,8 @@
 #include "triangles_drawable.hpp"
 
 #include "cgp/01_base/base.hpp"
+#include "cgp/13_opengl/render_stats/render_stats.hpp"
+#include "cgp/23_profiler/profiler/profiler.hpp"
 
 #if defined(__linux__) || defined(__EMSCRIPTEN__)
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -135,6 +137,7 @@ namespace cgp
 
 	void draw(triangles_drawable const& drawable, environment_generic_structure const& environment, uniform_generic_structure const& additional_uniforms)
 	{
+		CGP_PROFILE_SCOPE("draw(triangles_drawable)");
 		// Initial clean check
 		// ********************************** //
 		// If there is not vertices or not triangles, returns
@@ -149,6 +152,7 @@ namespace cgp
 		// Set the current shader
 		// ********************************** //
 		glUseProgram(drawable.shader.id); opengl_check;
+		default_render_stats().count_program(drawable.shader.id);
 
 		// Send uniforms for this shader
 		// ********************************** //
@@ -192,6 +196,7 @@ namespace cgp
 		// Draw call
 		// ********************************** //
 		glDrawArrays(GL_TRIANGLES, 0, drawable.vertex_number); opengl_check;
+		default_render_stats().count_draw(GL_TRIANGLES, size_t(drawable.vertex_number));
 
 
 		// Clean state
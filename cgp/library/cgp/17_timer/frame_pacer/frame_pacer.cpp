@@ -0,0 +1,72 @@
+#include "frame_pacer.hpp"
+
+#include <cmath>
+#include <thread>
+
+namespace cgp
+{
+	static double seconds(std::chrono::steady_clock::duration d)
+	{
+		return std::chrono::duration<double>(d).count();
+	}
+
+	frame_pacer::frame_pacer()
+		:frame_duration(0), work_duration(0), wait_duration(0), wake_up_error(0), timer_slack(0), overrun_counter(0),
+		history_frame_duration(), history_index(0),
+		deadline(clock::now()), last_return(clock::now()),
+		oversleep_mean(0.5e-3), oversleep_variance(0.0)
+	{}
+
+	void frame_pacer::reset()
+	{
+		deadline = clock::now();
+		last_return = deadline;
+	}
+
+	void frame_pacer::wait(float fps_target)
+	{
+		clock::time_point const start = clock::now();
+
+		if (fps_target > 0) {
+			clock::duration const period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / fps_target));
+			deadline += period;
+
+			// Too late: the following deadlines are computed from now
+			if (start - deadline > period) {
+				deadline = start;
+				++overrun_counter;
+			}
+
+			// Sleep once until the estimated oversleep before the deadline
+			double const slack = oversleep_mean + std::sqrt(oversleep_variance);
+			clock::time_point const t0 = clock::now();
+			double const sleep_duration = seconds(deadline - t0) - slack;
+			if (sleep_duration > 0) {
+				std::this_thread::sleep_for(std::chrono::duration<double>(sleep_duration));
+				double const oversleep = seconds(clock::now() - t0) - sleep_duration;
+
+				double const delta = oversleep - oversleep_mean;
+				oversleep_mean += 0.05 * delta;
+				oversleep_variance = 0.95 * (oversleep_variance + 0.05 * delta * delta);
+			}
+			timer_slack = static_cast<float>(oversleep_mean + std::sqrt(oversleep_variance));
+
+			// Spin for the remaining time
+			while (clock::now() < deadline)
+				std::this_thread::yield();
+		}
+		else
+			deadline = start;
+
+		clock::time_point const end = clock::now();
+		frame_duration = static_cast<float>(seconds(end - last_return));
+		work_duration = static_cast<float>(seconds(start - last_return));
+		wait_duration = static_cast<float>(seconds(end - start));
+		wake_up_error = fps_target > 0 ? static_cast<float>(seconds(end - deadline)) : 0.0f;
+		last_return = end;
+
+		history_frame_duration[history_index] = frame_duration;
+		history_index = (history_index + 1) % history_size;
+	}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+
+namespace cgp
+{
+	// Limit the frame rate of the animation loop without keeping a CPU core busy
+	//  wait() sleeps once until shortly before the end of the frame period, then spins for the remaining time:
+	//   - The time actually slept is measured to estimate the slack of the OS timer (mean + standard deviation of the oversleep).
+	//     The sleep stops this slack before the deadline, so that the spin only covers it.
+	//   - The deadlines are spaced by exactly one period (no drift). A frame late by less than one period is compensated on the next frames,
+	//     a larger overrun restarts the deadlines from the current time (no burst of frames to catch up).
+	//  The durations of the last frame are available for display (in seconds).
+	//
+	//  Usage:
+	//  | frame_pacer pacer;
+	//  | while (...) {
+	//  |     animation_loop();
+	//  |     pacer.wait(60.0f); // or pacer.wait(0) to only measure the frame durations
+	//  | }
+	struct frame_pacer
+	{
+		frame_pacer();
+
+		// Wait for the end of the current frame period. If fps_target <= 0, returns immediately (the durations are still measured).
+		void wait(float fps_target);
+		// Restart the deadlines from the current time
+		void reset();
+
+		float frame_duration;   // time between the two last returns of wait()
+		float work_duration;    // time spent outside of wait() during the last frame (rendering)
+		float wait_duration;    // time spent in wait() during the last frame
+		float wake_up_error;    // time of the return of wait() minus its deadline (positive when late)
+		float timer_slack;      // current estimation of the oversleep of the OS
+		int overrun_counter;    // number of frames that started more than one period late
+
+		// Last frame durations, stored in a circular buffer (history_index is the next element to be written)
+		static const int history_size = 120;
+		float history_frame_duration[history_size];
+		int history_index;
+
+		// Internal state
+		using clock = std::chrono::steady_clock;
+		clock::time_point deadline;
+		clock::time_point last_return;
+
+		// Statistics of the oversleep (exponential moving average of the mean and of the variance)
+		double oversleep_mean;
+		double oversleep_variance;
+	};
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "frame_pacer/frame_pacer.hpp"
 #include "timer_basic/timer_basic.hpp"
 #include "timer_event_periodic/timer_event_periodic.hpp"
 #include "timer_fps/timer_fps.hpp"
@@ -0,0 +1,200 @@
+#include "mesh_binary.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../obj/obj.hpp"
+
+#include <cstring>
+#include <fstream>
+
+namespace cgp
+{
+    // Header of a binary mesh file, followed by the buffers
+    struct mesh_binary_header
+    {
+        char magic[8];           // "CGPMSH01"
+        uint64_t vertex_count;
+        uint64_t triangle_count;
+        uint64_t source_stamp;   // identifies the version of the source file for a cached conversion (0 otherwise)
+        uint64_t checksum;       // hash of the data following the header
+    };
+    static char const mesh_binary_magic[8] = { 'C','G','P','M','S','H','0','1' };
+    static size_t const mesh_binary_alignment = 16;
+
+    static size_t align_offset(size_t offset)
+    {
+        return (offset + mesh_binary_alignment - 1) / mesh_binary_alignment * mesh_binary_alignment;
+    }
+
+    // Position of each buffer in the file: {position, normal, color, uv, connectivity, end of file}
+    struct mesh_binary_layout
+    {
+        size_t offset[6];
+    };
+    static mesh_binary_layout compute_layout(uint64_t vertex_count, uint64_t triangle_count)
+    {
+        size_t const sizes[5] = { size_t(vertex_count) * sizeof(vec3), size_t(vertex_count) * sizeof(vec3), size_t(vertex_count) * sizeof(vec3), size_t(vertex_count) * sizeof(vec2), size_t(triangle_count) * sizeof(uint3) };
+        mesh_binary_layout layout;
+        layout.offset[0] = align_offset(sizeof(mesh_binary_header));
+        for (int k = 0; k < 5; ++k)
+            layout.offset[k + 1] = align_offset(layout.offset[k] + sizes[k]);
+        return layout;
+    }
+
+    // Identifier of the current version of a source file
+    static uint64_t source_file_stamp(std::string const& filename)
+    {
+        uint64_t const h = hash_fnv1a(str(file_get_size(filename)) + "|" + str(file_get_modification_time(filename)));
+        return h == 0 ? 1 : h;
+    }
+
+    static bool save_mesh_binary(std::string const& filename, mesh const& m_arg, uint64_t source_stamp)
+    {
+        // All the per-vertex fields are stored
+        mesh filled;
+        bool const is_filled = m_arg.normal.size() == m_arg.position.size() && m_arg.color.size() == m_arg.position.size() && m_arg.uv.size() == m_arg.position.size();
+        if (!is_filled) {
+            filled = m_arg;
+            filled.fill_empty_field();
+        }
+        mesh const& m = is_filled ? m_arg : filled;
+        if (!mesh_check(m))
+            return false;
+
+        mesh_binary_layout const layout = compute_layout(m.position.size(), m.connectivity.size());
+        char const* buffers[5] = { reinterpret_cast<char const*>(m.position.data.data()), reinterpret_cast<char const*>(m.normal.data.data()), reinterpret_cast<char const*>(m.color.data.data()), reinterpret_cast<char const*>(m.uv.data.data()), reinterpret_cast<char const*>(m.connectivity.data.data()) };
+        size_t const sizes[5] = { size_t(size_in_memory(m.position)), size_t(size_in_memory(m.normal)), size_t(size_in_memory(m.color)), size_t(size_in_memory(m.uv)), size_t(size_in_memory(m.connectivity)) };
+
+        std::ofstream stream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.is_open())
+            return false;
+
+        // The header is written last, once the checksum of the buffers is known
+        mesh_binary_header header;
+        std::memset(&header, 0, sizeof(header));
+        stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+        char const padding[mesh_binary_alignment] = {};
+        uint64_t checksum = hash_fnv1a_seed;
+        size_t position = sizeof(header);
+        for (int k = 0; k < 5; ++k) {
+            size_t const pad = layout.offset[k] - position;
+            stream.write(padding, pad);
+            checksum = hash_fnv1a(padding, pad, checksum);
+
+            stream.write(buffers[k], sizes[k]);
+            checksum = hash_fnv1a(buffers[k], sizes[k], checksum);
+            position = layout.offset[k] + sizes[k];
+        }
+        size_t const pad = layout.offset[5] - position;
+        stream.write(padding, pad);
+        checksum = hash_fnv1a(padding, pad, checksum);
+
+        std::memcpy(header.magic, mesh_binary_magic, sizeof(mesh_binary_magic));
+        header.vertex_count = m.position.size();
+        header.triangle_count = m.connectivity.size();
+        header.source_stamp = source_stamp;
+        header.checksum = checksum;
+        stream.seekp(0);
+        stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+        return bool(stream);
+    }
+
+    bool save_file_mesh_binary(std::string const& filename, mesh const& m)
+    {
+        return save_mesh_binary(filename, m, 0);
+    }
+
+    mesh mesh_load_file_binary(std::string const& filename)
+    {
+        assert_file_exist(filename);
+        mesh_binary_structure file;
+        if (!file.open(filename))
+            error_cgp("Invalid binary mesh file " + filename);
+        return file.view().to_mesh();
+    }
+
+    bool mesh_binary_structure::open_mapping(std::string const& filename, uint64_t source_stamp, bool check_source)
+    {
+        close();
+        if (!file.open(filename))
+            return false;
+
+        // Validate the header before using the data: the buffers themselves are not read, so that the pages are only loaded when used
+        size_t const header_size = sizeof(mesh_binary_header);
+        bool valid = file.size() >= header_size;
+        mesh_binary_header header;
+        if (valid) {
+            std::memcpy(&header, file.data(), header_size);
+            valid = std::memcmp(header.magic, mesh_binary_magic, sizeof(mesh_binary_magic)) == 0;
+            valid = valid && header.vertex_count > 0 && header.triangle_count > 0;
+            valid = valid && (!check_source || header.source_stamp == source_stamp);
+        }
+        mesh_binary_layout layout;
+        if (valid) {
+            layout = compute_layout(header.vertex_count, header.triangle_count);
+            valid = layout.offset[5] == file.size();
+#ifndef CGP_NO_DEBUG
+            // Full check of the data with the debug checks (reads the whole file)
+            valid = valid && hash_fnv1a(file.data() + header_size, file.size() - header_size) == header.checksum;
+#endif
+        }
+
+        if (!valid) {
+            close();
+            return false;
+        }
+
+        char const* data = file.data();
+        mapped_view.number_of_vertex = size_t(header.vertex_count);
+        mapped_view.number_of_triangle = size_t(header.triangle_count);
+        mapped_view.position = reinterpret_cast<vec3 const*>(data + layout.offset[0]);
+        mapped_view.normal = reinterpret_cast<vec3 const*>(data + layout.offset[1]);
+        mapped_view.color = reinterpret_cast<vec3 const*>(data + layout.offset[2]);
+        mapped_view.uv = reinterpret_cast<vec2 const*>(data + layout.offset[3]);
+        mapped_view.connectivity = reinterpret_cast<uint3 const*>(data + layout.offset[4]);
+        return true;
+    }
+
+    bool mesh_binary_structure::open(std::string const& filename)
+    {
+        return open_mapping(filename, 0, false);
+    }
+
+    void mesh_binary_structure::open_cached_obj(std::string const& obj_filename)
+    {
+        assert_file_exist(obj_filename);
+
+        std::string const cache_filename = obj_filename + ".cgpmesh";
+        uint64_t const stamp = source_file_stamp(obj_filename);
+        if (open_mapping(cache_filename, stamp, true))
+            return;
+
+        // First use (or modified OBJ): parse the text file and store its conversion
+        mesh m = mesh_load_file_obj(obj_filename);
+        if (save_mesh_binary(cache_filename, m, stamp) && open_mapping(cache_filename, stamp, true))
+            return;
+
+        warning_cgp("Cannot write the binary conversion of the OBJ file " + obj_filename, "The mesh is kept in memory and the OBJ file will be parsed again at the next execution.");
+        fallback = m;
+        fallback.fill_empty_field(); // the view needs all the per-vertex fields
+        mapped_view = mesh_view(fallback);
+    }
+
+    void mesh_binary_structure::close()
+    {
+        file.close();
+        fallback = mesh();
+        mapped_view = mesh_view();
+    }
+
+    bool mesh_binary_structure::is_open() const
+    {
+        return mapped_view.number_of_vertex > 0;
+    }
+
+    mesh_view mesh_binary_structure::view() const
+    {
+        return mapped_view;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "cgp/11_mesh/mesh.hpp"
+#include "cgp/03_files/files.hpp"
+
+#include <string>
+#include <cstdint>
+
+namespace cgp
+{
+    /** Save a mesh in the binary format of cgp (.cgpmesh)
+    * The per-vertex fields that are empty are filled with their default values (see mesh::fill_empty_field).
+    * File layout: header (magic, number of vertices and triangles, checksum), then position, normal, color, uv and connectivity,
+    *  each buffer stored as raw little-endian floats/uint32 and aligned on 16 bytes.
+    * Return false if the file cannot be written. */
+    bool save_file_mesh_binary(std::string const& filename, mesh const& m);
+
+    /** Load a mesh stored in the binary format (copy of the buffers in the mesh) */
+    mesh mesh_load_file_binary(std::string const& filename);
+
+    /** Binary mesh file mapped in memory
+    * The buffers are read directly from the mapped pages: the view can be sent to the GPU without any intermediate copy.
+    * open_cached_obj() provides an automatic conversion of OBJ files: the binary file is stored next to the OBJ (filename.obj.cgpmesh),
+    *  and regenerated when the OBJ file is modified.
+    *
+    *  Usage:
+    *  | mesh_binary_structure file;
+    *  | file.open_cached_obj("model.obj"); // parse the OBJ only once, then map the binary file in the next executions
+    *  | drawable.initialize_data_on_gpu(file.view(), shader);
+    *  | file.close();                      // the data is no longer needed once it is on the GPU */
+    struct mesh_binary_structure
+    {
+        /** Map the file in memory and validate its header. Return false if the file is missing or invalid (wrong magic, size not matching the header).
+        * The checksum of the data is only verified with the debug checks (CGP_NO_DEBUG not defined), as it reads the whole file. */
+        bool open(std::string const& filename);
+
+        /** Open the binary conversion of an OBJ file, creating (or updating) it if needed.
+        * If the binary file cannot be written (ex. read-only directory), the OBJ is parsed and its mesh is kept in memory instead. */
+        void open_cached_obj(std::string const& obj_filename);
+
+        void close();
+        bool is_open() const;
+
+        /** View on the buffers of the mesh (valid until close() or the destruction of the structure) */
+        mesh_view view() const;
+
+    private:
+        file_mapping_structure file;
+        mesh_view mapped_view;
+        mesh fallback; // mesh used when the OBJ cannot be converted
+
+        bool open_mapping(std::string const& filename, uint64_t source_stamp, bool check_source);
+    };
+}
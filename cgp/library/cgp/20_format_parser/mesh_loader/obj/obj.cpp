@@ -10,15 +10,21 @@
 #include "cgp/01_base/base.hpp"
 #include "cgp/03_files/files.hpp"
 
-#include <map>
-
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#include <atomic>
+#endif
+
 namespace cgp
 {
 
-    void mesh_save_file_obj(std::string const& filename, mesh const& m)
+    void save_file_obj(std::string const& filename, mesh const& m)
     {
         std::ofstream stream(filename, std::ofstream::out);
         assert_cgp(stream.is_open(), "Cannot open file " + str(filename));
@@ -69,48 +75,399 @@ namespace cgp
     }
 
 
-// Comparator of triplet of integer for std::map
-struct comparator_int3 {
-    long int N; // number of vertices
+// Single pass parser of the OBJ file
+//  The file is mapped in memory and split in chunks of complete lines, parsed in parallel.
+//  Each chunk stores its positions/uv/normals and its triangulated faces, they are concatenated in the order of the file.
+//  Floats are converted exactly with a fast path, or with strtof otherwise (std::from_chars is not available in C++14):
+//  the values are identical to the stream extraction of the previous parser.
+namespace
+{
+    // Vertex of a face as written in the file "i0", "i0/i1", "i0/i1/i2" or "i0//i2"
+    //  The final meaning of i1 and i2 depends on the type of the file (see obj_face_index)
+    struct obj_face_vertex
+    {
+        int i0, i1, i2;
+        bool has_i1;       // i0/i1[...]
+        bool has_i2;       // i0/i1/i2
+        bool double_slash; // i0//i2
+    };
+
+    struct obj_chunk
+    {
+        std::vector<vec3> positions;
+        std::vector<vec2> texture_uv;
+        std::vector<vec3> normals;
+        std::vector<obj_face_vertex> triangles; // 3 consecutive vertices per triangle
+    };
+
+    inline bool is_blank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // Read an integer (optional sign). Return false if there is no digit.
+    inline bool parse_int(char const*& p, char const* end, int& value)
+    {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+        if (p == end || *p < '0' || *p > '9')
+            return false;
+        long long v = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            v = 10 * v + (*p - '0');
+            ++p;
+        }
+        value = int(negative ? -v : v);
+        return true;
+    }
+
+    // Exact conversion of decimal numbers with a short mantissa and a small exponent (Clinger's fast path)
+    //  Return false if the number must be converted by strtof: other syntax (inf, nan, hexadecimal), long mantissa, large exponent,
+    //  or a value for which the rounding through a double may differ from the direct rounding to float.
+    inline bool parse_float_fast(char const*& p_arg, char const* end, float& value)
+    {
+        static double const powers_of_ten[23] = { 1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22 };
+
+        char const* p = p_arg;
+        bool const negative = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+'))
+            ++p;
+
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            mantissa = 10 * mantissa + uint64_t(*p - '0');
+            digits += (mantissa > 0);
+            ++p;
+        }
+        bool has_digit = p > p_arg + (p_arg < end && (*p_arg == '-' || *p_arg == '+'));
+        if (p < end && *p == '.') {
+            ++p;
+            char const* const fraction = p;
+            while (p < end && *p >= '0' && *p <= '9') {
+                mantissa = 10 * mantissa + uint64_t(*p - '0');
+                digits += (mantissa > 0);
+                --exponent;
+                ++p;
+            }
+            has_digit = has_digit || p > fraction;
+        }
+        if (!has_digit || digits > 15)
+            return false;
+
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            char const* q = p + 1;
+            bool const negative_exponent = q < end && *q == '-';
+            if (q < end && (*q == '-' || *q == '+'))
+                ++q;
+            if (q < end && *q >= '0' && *q <= '9') {
+                int e = 0;
+                while (q < end && *q >= '0' && *q <= '9') {
+                    if (e < 1000) e = 10 * e + (*q - '0');
+                    ++q;
+                }
+                exponent += negative_exponent ? -e : e;
+                p = q;
+            }
+        }
+        if (p < end && (*p == 'x' || *p == 'X' || *p == 'n' || *p == 'N' || *p == 'i' || *p == 'I'))
+            return false;
+        if (exponent < -22 || exponent > 22)
+            return false;
+
+        // mantissa < 10^15 < 2^53 and 10^|exponent| are exact doubles: the result is the correctly rounded double
+        double const d = exponent < 0 ? double(mantissa) / powers_of_ten[-exponent] : double(mantissa) * powers_of_ten[exponent];
+
+        // Rounding the double to float gives the correctly rounded float, except if the double lies exactly between two floats
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(d));
+        if ((bits & ((uint64_t(1) << 29) - 1)) == (uint64_t(1) << 28))
+            return false;
+        if (d != 0.0 && (d < 1.5e-38 || d > 3.4e38))
+            return false;
+
+        value = float(negative ? -d : d);
+        p_arg = p;
+        return true;
+    }
+
+    // Read the next float of the line. Return false (and set 0) if there is no valid number.
+    //  The line is copied when it is the last one of the file, as strtof needs a terminating character.
+    inline bool parse_float(char const*& p, char const* end, float& value)
+    {
+        while (p < end && is_blank(*p))
+            ++p;
+        value = 0.0f;
+        if (p == end)
+            return false;
+        if (parse_float_fast(p, end, value))
+            return true;
+
+        char* next = nullptr;
+        value = std::strtof(p, &next);
+        if (next == p)
+            return false;
+        p = next;
+        return true;
+    }
 
-    comparator_int3(int N_arg=0) :N(N_arg) {}
+    obj_face_vertex parse_face_vertex(char const* p, char const* end)
+    {
+        obj_face_vertex v = { 0, 0, 0, false, false, false };
+        parse_int(p, end, v.i0);
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p == '/') {
+                ++p;
+                v.double_slash = parse_int(p, end, v.i2);
+            }
+            else {
+                v.has_i1 = parse_int(p, end, v.i1);
+                if (v.has_i1 && p < end && *p == '/') {
+                    ++p;
+                    v.has_i2 = parse_int(p, end, v.i2);
+                }
+            }
+        }
+        return v;
+    }
+
+    // Index (position, uv, normal) of the face vertex given the type of the file. Missing indices are set to -1.
+    int3 obj_face_index(obj_face_vertex const& v, loader::obj_type const type)
+    {
+        int3 index = { v.i0 - 1, -1, -1 };
+        if (type == loader::obj_type::vertex_texture && v.has_i1)
+            index[1] = v.i1 - 1;
+        else if (type == loader::obj_type::vertex_normal && v.double_slash)
+            index[2] = v.i2 - 1;
+        else if (type == loader::obj_type::vertex_texture_normal && v.has_i1) {
+            index[1] = v.i1 - 1;
+            if (v.has_i2)
+                index[2] = v.i2 - 1;
+        }
+        return index;
+    }
+
+    void parse_line(char const* p, char const* end, obj_chunk& chunk, std::vector<obj_face_vertex>& polygon)
+    {
+        while (p < end && is_blank(*p))
+            ++p;
+        char const* const word = p;
+        while (p < end && !is_blank(*p))
+            ++p;
+        size_t const word_size = size_t(p - word);
+
+        if (word_size == 1 && word[0] == 'v') {
+            vec3 position;
+            parse_float(p, end, position.x) && parse_float(p, end, position.y) && parse_float(p, end, position.z);
+            chunk.positions.push_back(position);
+        }
+        else if (word_size == 2 && word[0] == 'v' && word[1] == 't') {
+            vec2 uv;
+            parse_float(p, end, uv.x) && parse_float(p, end, uv.y);
+            chunk.texture_uv.push_back(uv);
+        }
+        else if (word_size == 2 && word[0] == 'v' && word[1] == 'n') {
+            vec3 normal;
+            parse_float(p, end, normal.x) && parse_float(p, end, normal.y) && parse_float(p, end, normal.z);
+            chunk.normals.push_back(normal);
+        }
+        else if (word_size == 1 && word[0] == 'f') {
+            polygon.clear();
+            while (p < end) {
+                while (p < end && is_blank(*p))
+                    ++p;
+                char const* const vertex_word = p;
+                while (p < end && !is_blank(*p))
+                    ++p;
+                if (p > vertex_word)
+                    polygon.push_back(parse_face_vertex(vertex_word, p));
+            }
+
+            // Triangulation of the polygon as a fan around its first vertex
+            for (size_t k = 0; k + 2 < polygon.size(); ++k) {
+                chunk.triangles.push_back(polygon[0]);
+                chunk.triangles.push_back(polygon[k + 1]);
+                chunk.triangles.push_back(polygon[k + 2]);
+            }
+        }
+    }
+
+    void parse_chunk(char const* begin, char const* end, char const* file_end, obj_chunk& chunk)
+    {
+        std::vector<obj_face_vertex> polygon;
+        std::string last_line;
+        char const* p = begin;
+        while (p < end) {
+            char const* line_end = static_cast<char const*>(std::memchr(p, '\n', size_t(end - p)));
+            if (line_end == nullptr)
+                line_end = end;
+
+            if (line_end == file_end) {
+                // Last line without end of line: parsed from a null-terminated copy
+                last_line.assign(p, line_end);
+                parse_line(last_line.c_str(), last_line.c_str() + last_line.size(), chunk, polygon);
+            }
+            else
+                parse_line(p, line_end, chunk, polygon);
+            p = line_end + 1;
+        }
+    }
+
+    // Split the file in chunks ending at a line break, and parse them in parallel
+    std::vector<obj_chunk> parse_obj_chunks(char const* data, size_t size)
+    {
+        size_t const minimal_chunk_size = size_t(1) << 20;
+        int number_of_chunks = 1;
+#ifndef __EMSCRIPTEN__
+        int const number_of_threads = std::max(1, int(std::thread::hardware_concurrency()));
+        number_of_chunks = int(std::min<size_t>(size_t(4 * number_of_threads), std::max<size_t>(1, size / minimal_chunk_size)));
+#endif
+
+        std::vector<char const*> bounds;
+        bounds.push_back(data);
+        for (int k = 1; k < number_of_chunks; ++k) {
+            char const* p = std::max(bounds.back(), data + size * size_t(k) / size_t(number_of_chunks));
+            char const* line_end = static_cast<char const*>(std::memchr(p, '\n', size_t(data + size - p)));
+            if (line_end == nullptr)
+                break;
+            bounds.push_back(line_end + 1);
+        }
+        bounds.push_back(data + size);
+        number_of_chunks = int(bounds.size()) - 1;
+
+        std::vector<obj_chunk> chunks(number_of_chunks);
+#ifndef __EMSCRIPTEN__
+        // Each thread takes the next chunk to parse until all of them are done
+        std::atomic<int> next_chunk(0);
+        auto worker = [&]() {
+            for (int k = next_chunk++; k < number_of_chunks; k = next_chunk++)
+                parse_chunk(bounds[k], bounds[k + 1], data + size, chunks[k]);
+        };
+        std::vector<std::thread> threads;
+        for (int k = 1; k < std::min(number_of_threads, number_of_chunks); ++k)
+            threads.push_back(std::thread(worker));
+        worker(); // the calling thread also participates
+        for (auto& thread : threads)
+            thread.join();
+#else
+        parse_chunk(bounds[0], bounds[1], data + size, chunks[0]);
+#endif
+        return chunks;
+    }
 
-    // compute a<b
-    bool operator()(int3 const& a, int3 const& b) const
+    template <typename T>
+    void concatenate(std::vector<obj_chunk> const& chunks, std::vector<T> obj_chunk::* field, numarray<T>& result)
     {
-        long int const offset_a = long(a[0]) + N*(long(a[1]) + N*long(a[2]));
-        long int const offset_b = long(b[0]) + N*(long(b[1]) + N*long(b[2]));
-        return offset_a < offset_b;
+        size_t N = 0;
+        for (auto const& chunk : chunks)
+            N += (chunk.*field).size();
+        result.data.reserve(N);
+        for (auto const& chunk : chunks)
+            result.data.insert(result.data.end(), (chunk.*field).begin(), (chunk.*field).end());
     }
-};
 
+    // Open addressing hash table associating the (position, uv, normal) index of a face vertex to the index of the vertex in the mesh
+    struct obj_vertex_table
+    {
+        struct slot
+        {
+            int3 key;
+            int value; // -1 if the slot is empty
+        };
+        std::vector<slot> slots;
+        size_t count = 0;
+
+        explicit obj_vertex_table(size_t expected_size)
+        {
+            size_t capacity = 16;
+            while (capacity < 4 * expected_size)
+                capacity *= 2;
+            slots.assign(capacity, slot{ int3{0,0,0}, -1 });
+        }
 
-static numarray<numarray_stack<int3,3>> triangulate_faces(numarray<numarray<int3>> faces);
+        // Faces of a file reference nearby positions: the hash keeps the position index in the high bits so that the probes stay in cache
+        static size_t hash(int3 const& k)
+        {
+            uint64_t const h = (uint64_t(uint32_t(k[1])) * 0x9E3779B97F4A7C15ull) ^ (uint64_t(uint32_t(k[2])) * 0xC2B2AE3D27D4EB4Full);
+            return size_t(4 * uint64_t(uint32_t(k[0])) + (h >> 62));
+        }
 
+        // Return the value associated to the key, or insert value if the key is not in the table
+        int find_or_insert(int3 const& key, int value)
+        {
+            if (2 * (count + 1) > slots.size())
+                grow();
+            size_t const mask = slots.size() - 1;
+            for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+                slot& s = slots[i];
+                if (s.value < 0) {
+                    s.key = key;
+                    s.value = value;
+                    ++count;
+                    return value;
+                }
+                if (s.key[0] == key[0] && s.key[1] == key[1] && s.key[2] == key[2])
+                    return s.value;
+            }
+        }
+
+        void grow()
+        {
+            std::vector<slot> previous(2 * slots.size(), slot{ int3{0,0,0}, -1 });
+            previous.swap(slots);
+            size_t const mask = slots.size() - 1;
+            for (slot const& s : previous) {
+                if (s.value < 0) continue;
+                size_t i = hash(s.key) & mask;
+                while (slots[i].value >= 0)
+                    i = (i + 1) & mask;
+                slots[i] = s;
+            }
+        }
+    };
+}
 
-static std::pair<mesh, std::map<int3, int, comparator_int3>>
-    make_unique_parameter_per_value(numarray<vec3> const& positions,
-                                    numarray<vec2> const& texture_uv,
-                                    numarray<vec3> const& normals,
-                                    numarray<numarray_stack<int3,3>> const& faces,
-                                    loader::obj_type const type);
 
+static mesh load_file_obj(const std::string& filename, numarray<numarray<int> >* vertex_correspondance);
 
 mesh mesh_load_file_obj(const std::string& filename)
 {
-    numarray<numarray<int>> vertex_correspondance;
-     mesh m = mesh_load_file_obj(filename, vertex_correspondance);
+     mesh m = load_file_obj(filename, nullptr);
      m.fill_empty_field();
      return m;
 }
 mesh mesh_load_file_obj(const std::string& filename, numarray<numarray<int> >& vertex_correspondance)
+{
+    return load_file_obj(filename, &vertex_correspondance);
+}
+
+// Load the mesh, and the correspondance between the vertices of the file and the vertices of the mesh if it is requested
+mesh load_file_obj(const std::string& filename, numarray<numarray<int> >* vertex_correspondance)
 {
     assert_file_exist(filename);
 
-    // Load parameters
-    numarray<vec3> positions = loader::obj_read_positions(filename);
-    numarray<vec2> texture_uv = loader::obj_read_texture_uv(filename);
-    numarray<vec3> normals = loader::obj_read_normals(filename);
+    file_mapping_structure file;
+    bool const ok = file.open(filename);
+    if (!ok)
+        error_cgp("Cannot open file "+str(filename));
+
+    // Load parameters and triangulated faces
+    std::vector<obj_chunk> const chunks = parse_obj_chunks(file.data(), file.size());
+    file.close();
+
+    numarray<vec3> positions;
+    numarray<vec2> texture_uv;
+    numarray<vec3> normals;
+    numarray<obj_face_vertex> triangles;
+    concatenate(chunks, &obj_chunk::positions, positions);
+    concatenate(chunks, &obj_chunk::texture_uv, texture_uv);
+    concatenate(chunks, &obj_chunk::normals, normals);
+    concatenate(chunks, &obj_chunk::triangles, triangles);
 
     assert_cgp(positions.size()>0, str("File ")+filename+" has 0 vertices");
 
@@ -122,101 +479,60 @@ mesh mesh_load_file_obj(const std::string& filename, numarray<numarray<int> >& v
         type = loader::obj_type::vertex_texture;
     else if( normals.size()>0 )
         type = loader::obj_type::vertex_normal;
-
-    // Load connectivity and triangulate
-    numarray<numarray_stack<int3,3>> faces = triangulate_faces( loader::obj_read_faces(filename, type) );
+    bool const has_uv = type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture;
+    bool const has_normal = type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal;
 
     // Set unique per-vertex value for texture and normals (duplicate vertices if necessary)
+    //  The vertices are numbered in the order of their first use in the faces
     mesh m;
-    std::map<int3, int, comparator_int3> connectivity_map;
-    std::tie(m,connectivity_map) = make_unique_parameter_per_value(positions, texture_uv, normals, faces, type);
-
-    // Retrieve correspondance between initial vertices in files and new ones
-    vertex_correspondance.resize(positions.size());
-    for(auto const& it : connectivity_map)
-    {
-        int const vertex_in = it.first[0];
-        int const vertex_out = it.second;
-
-        vertex_correspondance[vertex_in].push_back(vertex_out);
-    }
-
-    return m;
-}
-
-
-numarray<numarray_stack<int3,3>> triangulate_faces(numarray<numarray<int3>> faces)
-{
-    numarray<numarray_stack<int3,3>> faces_triangulation;
-    size_t const N_face = faces.size();
-    for(size_t k_face=0; k_face<N_face; ++k_face)
-    {
-        numarray<int3> const& current_polygon = faces[k_face];
-        int const N_polygon = int(current_polygon.size());
-
-        for(int k=0; k<N_polygon-2; ++k) {
-            // triangulation
-            int3 const& f0 = current_polygon[0];
-            int3 const& f1 = current_polygon[k+1];
-            int3 const& f2 = current_polygon[k+2];
-
-            faces_triangulation.push_back({f0,f1,f2});
-        }
-    }
-    return faces_triangulation;
-}
-
-std::pair<mesh, std::map<int3, int, comparator_int3>>
-    make_unique_parameter_per_value(numarray<vec3> const& positions,
-                                    numarray<vec2> const& texture_uv,
-                                    numarray<vec3> const& normals,
-                                    numarray<numarray_stack<int3,3>> const& faces,
-                                    loader::obj_type const type)
-{
-    mesh m;
-    comparator_int3 comparator(int(positions.size()));
-    std::map<int3, int, comparator_int3> connectivity_map(comparator); // stores map between original face index and final offset
-
-
-    size_t const N_triangle = faces.size();
+    size_t const N_triangle = triangles.size()/3;
+    m.connectivity.resize(N_triangle);
+    obj_vertex_table table(positions.size());
+    std::vector<int3> unique_index; // (position, uv, normal) index of each vertex of the mesh
     for(size_t k_triangle=0; k_triangle<N_triangle; ++k_triangle)
     {
-        numarray_stack<int3,3> const& tri = faces[k_triangle];
-        uint3 new_triangle_index;
         for(int k=0; k<3; ++k)
         {
-            int3 const& index = tri[k];
-            auto const it = connectivity_map.find( index );
-            if( it==connectivity_map.end() ) {
-
-                size_t const offset = m.position.size();
-                connectivity_map[index] = int(offset);
-                new_triangle_index[k] = int(offset);
-
-                int const idx_position = index[0];
-
-                assert_cgp_no_msg( idx_position<int(positions.size()));
-                m.position.push_back( positions[idx_position] );
-
-                if(type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture) {
-                    int const idx_uv = index[1];
-                    assert_cgp_no_msg( idx_uv<int(texture_uv.size()) );
-                    m.uv.push_back( texture_uv[ idx_uv ] );
-                }
-                if(type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal) {
-                    int const idx_normal = index[2];
-                    assert_cgp_no_msg( idx_normal<int(normals.size()) );
-                    m.normal.push_back( normals[idx_normal] );
-                }
-
+            int3 const index = obj_face_index(triangles[3*k_triangle+k], type);
+            int const offset = table.find_or_insert(index, int(unique_index.size()));
+            if( offset==int(unique_index.size()) ) {
+                assert_cgp_no_msg( index[0]<int(positions.size()) );
+                assert_cgp_no_msg( !has_uv || index[1]<int(texture_uv.size()) );
+                assert_cgp_no_msg( !has_normal || index[2]<int(normals.size()) );
+                unique_index.push_back(index);
             }
-            else
-                new_triangle_index[k] = it->second;
+            m.connectivity[k_triangle][k] = offset;
         }
-        m.connectivity.push_back(new_triangle_index);
     }
 
-    return {m, connectivity_map};
+    size_t const N_vertex = unique_index.size();
+    m.position.resize(N_vertex);
+    if(has_uv) m.uv.resize(N_vertex);
+    if(has_normal) m.normal.resize(N_vertex);
+    for(size_t k=0; k<N_vertex; ++k) {
+        int3 const& index = unique_index[k];
+        m.position[k] = positions[index[0]];
+        if(has_uv) m.uv[k] = texture_uv[index[1]];
+        if(has_normal) m.normal[k] = normals[index[2]];
+    }
+
+    if(vertex_correspondance==nullptr)
+        return m;
+
+    // Retrieve correspondance between initial vertices in files and new ones
+    //  (for each position, the duplicated vertices are sorted by their normal then uv index)
+    std::vector<int> order(N_vertex);
+    for(size_t k=0; k<N_vertex; ++k)
+        order[k] = int(k);
+    long const N = long(positions.size());
+    auto key = [&](int k) { int3 const& a = unique_index[k]; return long(a[0]) + N*(long(a[1]) + N*long(a[2])); };
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return key(a) < key(b); });
+
+    vertex_correspondance->resize(positions.size());
+    for(int const vertex_out : order)
+        (*vertex_correspondance)[unique_index[vertex_out][0]].push_back(vertex_out);
+
+    return m;
 }
 
 
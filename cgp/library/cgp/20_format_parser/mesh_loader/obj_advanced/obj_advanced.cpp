@@ -1,8 +1,20 @@
 #include "obj_advanced.hpp"
 
+#include "cgp/01_base/base.hpp"
+
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "third_party/src/tinyobj/tiny_obj_loader.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <mutex>
+
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#include <atomic>
+#endif
+
 namespace cgp
 {
 	namespace mesh_obj_advanced_loader
@@ -21,70 +33,33 @@ namespace cgp
 			}
 			return drawables;
 		}
-	}
-
-	std::vector<mesh_obj_advanced_loader::shape_element_node> mesh_load_file_obj_advanced(std::string const& directory, std::string const& filename)
-	{
-		std::vector<mesh_obj_advanced_loader::shape_element_node> data;
-
-		std::string inputfile = directory + filename; // project::path + "assets/StMaria/StMaria.obj";
-		tinyobj::ObjReaderConfig reader_config;
-		tinyobj::ObjReader reader;
-
-		if (!reader.ParseFromFile(inputfile, reader_config)) {
-			if (!reader.Error().empty()) {
-				std::cerr << "TinyObjReader: " << reader.Error();
-			}
-			exit(1);
-		}
-
-		if (!reader.Warning().empty()) {
-			std::cout << "TinyObjReader: " << reader.Warning();
-		}
-
-		auto& attrib = reader.GetAttrib();
-		auto& shapes = reader.GetShapes();
-		auto& materials = reader.GetMaterials();
-
-		int N_material = materials.size();
-		std::vector<opengl_texture_image_structure> texture_array;
-		texture_array.resize(N_material);
-
-		for (int k = 0; k < N_material; ++k) {
-			std::string texture_filename = materials[k].diffuse_texname;
-			if (texture_filename != "") {
-				texture_array[k].load_and_initialize_texture_2d_on_gpu(directory + texture_filename, GL_REPEAT, GL_REPEAT);
-			}
-			else {
-				texture_array[k] = mesh_drawable::default_texture;
-			}
-		}
 
+		// Part of a shape using a single material
+		struct shape_part {
+			mesh mesh_element;
+			int material; // index of the material (-1 if none)
+		};
 
-		// Loop over shapes
-		for (int shape_idx = 0; shape_idx < shapes.size(); shape_idx++)
+		// Split a shape in parts of consecutive faces sharing the same material
+		static std::vector<shape_part> build_shape_parts(tinyobj::attrib_t const& attrib, tinyobj::shape_t const& shape)
 		{
-
+			std::vector<shape_part> parts;
 
 			// Loop over faces(polygon)
 			int connectivity_counter = 0;
 			size_t index_offset = 0;
 			int idx_material_previous = -1;
 			mesh mesh_current;
-			for (size_t f = 0; f < shapes[shape_idx].mesh.num_face_vertices.size(); f++)
+			for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); f++)
 			{
 
 				// per-face material
-				int idx_material = shapes[shape_idx].mesh.material_ids[f];
+				int idx_material = shape.mesh.material_ids[f];
 				if (idx_material != idx_material_previous)
 				{
 					if (idx_material_previous != -1)
 					{
-						mesh_obj_advanced_loader::shape_element_node node;
-						node.mesh_element = mesh_current;
-						node.texture_element = texture_array[idx_material_previous];
-
-						data.push_back(node);
+						parts.push_back({ mesh_current, idx_material_previous });
 						mesh_current = mesh();
 						connectivity_counter = 0;
 
@@ -93,10 +68,10 @@ namespace cgp
 				}
 
 				// Loop over vertices in the face.
-				size_t fv = size_t(shapes[shape_idx].mesh.num_face_vertices[f]);
+				size_t fv = size_t(shape.mesh.num_face_vertices[f]);
 				for (size_t v = 0; v < fv; v++) {
 					// access to vertex
-					tinyobj::index_t idx = shapes[shape_idx].mesh.indices[index_offset + v];
+					tinyobj::index_t idx = shape.mesh.indices[index_offset + v];
 					tinyobj::real_t vx = attrib.vertices[3 * size_t(idx.vertex_index) + 0];
 					tinyobj::real_t vy = attrib.vertices[3 * size_t(idx.vertex_index) + 1];
 					tinyobj::real_t vz = attrib.vertices[3 * size_t(idx.vertex_index) + 2];
@@ -128,16 +103,360 @@ namespace cgp
 				mesh_current.connectivity.push_back({ connectivity_counter, connectivity_counter + 1, connectivity_counter + 2 });
 				connectivity_counter += 3;
 
-				if (f == shapes[shape_idx].mesh.num_face_vertices.size() - 1) {
-					mesh_obj_advanced_loader::shape_element_node node;
-					node.mesh_element = mesh_current;
-					node.texture_element = texture_array[idx_material];
-					data.push_back(node);
+				if (f == shape.mesh.num_face_vertices.size() - 1)
+					parts.push_back({ mesh_current, idx_material });
+			}
+
+			return parts;
+		}
+
+		static bool parse_file(tinyobj::ObjReader& reader, std::string const& inputfile, std::string& error)
+		{
+			tinyobj::ObjReaderConfig reader_config;
+			if (!reader.ParseFromFile(inputfile, reader_config)) {
+				error = "TinyObjReader: cannot read " + inputfile + " " + reader.Error();
+				return false;
+			}
+			if (!reader.Warning().empty()) {
+				std::cout << "TinyObjReader: " << reader.Warning();
+			}
+			return true;
+		}
+
+		// Data shared between the loading threads and the render thread
+		struct async_state
+		{
+			std::string directory;
+			std::string filename;
+			int number_of_threads = 0;
+
+			std::mutex mutex;
+
+			// Written by the loading threads (protected by the mutex)
+			bool parsed = false;
+			bool finished = false;
+			std::string error;
+			std::vector<std::string> texture_filenames;   // per material (empty if the material has no texture)
+			std::vector<image_structure> texture_images;
+			std::vector<char> texture_decoded;
+			std::vector<std::vector<shape_part>> shapes;
+			std::vector<char> shape_built;
+
+			// Used only by the render thread
+			std::vector<opengl_texture_image_structure> textures;
+			std::vector<char> texture_uploaded;
+			size_t next_shape = 0;
+			size_t next_part = 0;
+			int uploaded_elements = 0;
+			int total_elements = 0;
+
+#ifndef __EMSCRIPTEN__
+			std::atomic<bool> cancel{ false };
+			std::thread loading_thread;
+#endif
+
+			void load();
+			// True when nothing remains to decode nor to send to the GPU (called with the mutex locked)
+			bool is_loaded() const;
+		};
+
+		// Parse the file, then build the shapes and decode the textures in parallel
+		void async_state::load()
+		{
+			tinyobj::ObjReader reader;
+			std::string parse_error;
+			if (!parse_file(reader, directory + filename, parse_error)) {
+				std::lock_guard<std::mutex> lock(mutex);
+				error = parse_error;
+				finished = true;
+				return;
+			}
+
+			auto const& attrib = reader.GetAttrib();
+			auto const& file_shapes = reader.GetShapes();
+			auto const& materials = reader.GetMaterials();
+			int const N_material = int(materials.size());
+			int const N_shape = int(file_shapes.size());
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				texture_filenames.resize(N_material);
+				for (int k = 0; k < N_material; ++k)
+					texture_filenames[k] = materials[k].diffuse_texname;
+				texture_images.resize(N_material);
+				texture_decoded.assign(N_material, 0);
+				shapes.resize(N_shape);
+				shape_built.assign(N_shape, 0);
+				parsed = true;
+			}
+
+			// Tasks: the textures first (longest to decode), then the shapes
+			int const N_task = N_material + N_shape;
+			auto run_task = [&](int k) {
+				if (k < N_material) {
+					image_structure im;
+					if (!materials[k].diffuse_texname.empty())
+						im = image_load_file(directory + materials[k].diffuse_texname);
+					std::lock_guard<std::mutex> lock(mutex);
+					texture_images[k] = std::move(im);
+					texture_decoded[k] = 1;
+				}
+				else {
+					int const s = k - N_material;
+					std::vector<shape_part> parts = build_shape_parts(attrib, file_shapes[s]);
+					for (auto& part : parts)
+						part.mesh_element.fill_empty_field();
+					std::lock_guard<std::mutex> lock(mutex);
+					shapes[s] = std::move(parts);
+					shape_built[s] = 1;
+				}
+			};
+
+#ifndef __EMSCRIPTEN__
+			// Each thread takes the next task until all of them are done
+			std::atomic<int> next_task(0);
+			auto worker = [&]() {
+				for (int k = next_task++; k < N_task && !cancel; k = next_task++) {
+					try {
+						run_task(k);
+					}
+					catch (std::exception const& e) {
+						std::lock_guard<std::mutex> lock(mutex);
+						error = e.what();
+					}
 				}
+			};
+			int threads_count = number_of_threads > 0 ? number_of_threads : int(std::thread::hardware_concurrency());
+			threads_count = std::max(1, std::min(threads_count, N_task));
+			std::vector<std::thread> threads;
+			for (int k = 1; k < threads_count; ++k)
+				threads.push_back(std::thread(worker));
+			worker(); // the loading thread also participates
+			for (auto& thread : threads)
+				thread.join();
+#else
+			for (int k = 0; k < N_task; ++k)
+				run_task(k);
+#endif
+
+			std::lock_guard<std::mutex> lock(mutex);
+			finished = true;
+		}
+
+		bool async_state::is_loaded() const
+		{
+			// The textures that are not used by any shape must also be sent
+			bool const textures_uploaded = textures.size() == texture_filenames.size() && std::find(texture_uploaded.begin(), texture_uploaded.end(), 0) == texture_uploaded.end();
+			return parsed && finished && textures_uploaded && next_shape == shapes.size();
+		}
+	}
+
+
+	std::vector<mesh_obj_advanced_loader::shape_element_node> mesh_load_file_obj_advanced(std::string const& directory, std::string const& filename)
+	{
+		using namespace mesh_obj_advanced_loader;
+		std::vector<shape_element_node> data;
+
+		std::string inputfile = directory + filename; // project::path + "assets/StMaria/StMaria.obj";
+		tinyobj::ObjReader reader;
+
+		std::string error;
+		if (!parse_file(reader, inputfile, error)) {
+			std::cerr << error;
+			exit(1);
+		}
+
+		auto& attrib = reader.GetAttrib();
+		auto& shapes = reader.GetShapes();
+		auto& materials = reader.GetMaterials();
+
+		int N_material = materials.size();
+		std::vector<opengl_texture_image_structure> texture_array;
+		texture_array.resize(N_material);
+
+		for (int k = 0; k < N_material; ++k) {
+			std::string texture_filename = materials[k].diffuse_texname;
+			if (texture_filename != "") {
+				texture_array[k].load_and_initialize_texture_2d_on_gpu(directory + texture_filename, GL_REPEAT, GL_REPEAT);
+			}
+			else {
+				texture_array[k] = mesh_drawable::default_texture;
+			}
+		}
+
+
+		// Loop over shapes
+		for (int shape_idx = 0; shape_idx < shapes.size(); shape_idx++)
+		{
+			for (auto& part : build_shape_parts(attrib, shapes[shape_idx]))
+			{
+				shape_element_node node;
+				node.mesh_element = std::move(part.mesh_element);
+				node.texture_element = part.material >= 0 ? texture_array[part.material] : mesh_drawable::default_texture;
+				data.push_back(node);
 			}
 		}
 
 
 		return data;
 	}
-}
\ No newline at end of file
+
+
+	mesh_obj_advanced_async_structure::mesh_obj_advanced_async_structure() = default;
+	mesh_obj_advanced_async_structure::mesh_obj_advanced_async_structure(mesh_obj_advanced_async_structure&&) = default;
+
+	mesh_obj_advanced_async_structure& mesh_obj_advanced_async_structure::operator=(mesh_obj_advanced_async_structure&& other)
+	{
+		if (this != &other) {
+			stop();
+			drawables = std::move(other.drawables);
+			state = std::move(other.state);
+		}
+		return *this;
+	}
+
+	mesh_obj_advanced_async_structure::~mesh_obj_advanced_async_structure()
+	{
+		stop();
+	}
+
+	void mesh_obj_advanced_async_structure::stop()
+	{
+#ifndef __EMSCRIPTEN__
+		if (state != nullptr && state->loading_thread.joinable()) {
+			state->cancel = true;
+			state->loading_thread.join();
+		}
+#endif
+		state.reset();
+	}
+
+	mesh_obj_advanced_async_structure mesh_load_file_obj_advanced_async(std::string const& directory, std::string const& filename, int number_of_threads)
+	{
+		mesh_obj_advanced_async_structure handle;
+		handle.state.reset(new mesh_obj_advanced_loader::async_state());
+		mesh_obj_advanced_loader::async_state& state = *handle.state;
+		state.directory = directory;
+		state.filename = filename;
+		state.number_of_threads = number_of_threads;
+
+#ifndef __EMSCRIPTEN__
+		state.loading_thread = std::thread([&state]() { state.load(); });
+#else
+		// No thread available in the default WebAssembly build: the CPU part is done immediately, the GPU upload is still spread over the frames
+		state.load();
+#endif
+		return handle;
+	}
+
+	bool mesh_obj_advanced_async_structure::update(float time_budget_ms)
+	{
+		if (state == nullptr)
+			return true;
+		mesh_obj_advanced_loader::async_state& s = *state;
+		auto const start = std::chrono::steady_clock::now();
+		auto budget_exceeded = [&]() {
+			return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() > time_budget_ms;
+		};
+
+		std::unique_lock<std::mutex> lock(s.mutex);
+		if (!s.error.empty()) {
+			std::string const message = s.error;
+			s.error.clear();
+			lock.unlock();
+			error_cgp("Cannot load the OBJ file " + s.directory + s.filename + "\n" + message);
+			return false;
+		}
+		if (!s.parsed)
+			return false;
+
+		// The texture handles are created once the materials are known
+		int const N_material = int(s.texture_filenames.size());
+		if (s.textures.size() != size_t(N_material)) {
+			s.textures.assign(N_material, mesh_drawable::default_texture);
+			s.texture_uploaded.assign(N_material, 0);
+			for (int k = 0; k < N_material; ++k)
+				s.texture_uploaded[k] = s.texture_filenames[k].empty() ? 1 : 0;
+			s.total_elements = int(std::count(s.texture_uploaded.begin(), s.texture_uploaded.end(), 0)) + int(s.shapes.size());
+		}
+
+		bool sent = true;
+		while (sent)
+		{
+			sent = false;
+
+			// Send a decoded texture
+			for (int k = 0; k < N_material && !sent; ++k) {
+				if (s.texture_decoded[k] && !s.texture_uploaded[k]) {
+					image_structure im = std::move(s.texture_images[k]);
+					lock.unlock();
+					opengl_texture_image_structure texture;
+					texture.initialize_texture_2d_on_gpu(im, GL_REPEAT, GL_REPEAT);
+					lock.lock();
+					s.textures[k] = texture;
+					s.texture_uploaded[k] = 1;
+					s.uploaded_elements++;
+					sent = true;
+				}
+			}
+
+			// Send the next part of the shapes (in the order of the file), once its texture is available
+			if (!sent && s.next_shape < s.shapes.size() && s.shape_built[s.next_shape]) {
+				std::vector<mesh_obj_advanced_loader::shape_part>& parts = s.shapes[s.next_shape];
+				if (s.next_part < parts.size()) {
+					mesh_obj_advanced_loader::shape_part& part = parts[s.next_part];
+					if (part.material < 0 || s.texture_uploaded[part.material]) {
+						mesh m = std::move(part.mesh_element);
+						opengl_texture_image_structure const texture = part.material >= 0 ? s.textures[part.material] : mesh_drawable::default_texture;
+						lock.unlock();
+						mesh_drawable drawable;
+						drawable.initialize_data_on_gpu(m);
+						drawable.texture = texture;
+						drawables.push_back(drawable);
+						lock.lock();
+						s.next_part++;
+						sent = true;
+					}
+				}
+				if (s.next_part >= parts.size()) {
+					parts.clear();
+					s.next_shape++;
+					s.next_part = 0;
+					s.uploaded_elements++;
+					sent = true;
+				}
+			}
+
+			if (sent && budget_exceeded())
+				break;
+		}
+
+		return s.is_loaded();
+	}
+
+	bool mesh_obj_advanced_async_structure::is_complete() const
+	{
+		if (state == nullptr)
+			return true;
+		std::lock_guard<std::mutex> lock(state->mutex);
+		return state->is_loaded();
+	}
+
+	float mesh_obj_advanced_async_structure::progress() const
+	{
+		if (state == nullptr)
+			return 1.0f;
+		std::lock_guard<std::mutex> lock(state->mutex);
+		if (state->total_elements == 0)
+			return state->is_loaded() ? 1.0f : 0.0f;
+		return float(state->uploaded_elements) / float(state->total_elements);
+	}
+
+	void mesh_obj_advanced_async_structure::wait()
+	{
+		while (!update(1e9f)) {
+#ifndef __EMSCRIPTEN__
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+		}
+	}
+}
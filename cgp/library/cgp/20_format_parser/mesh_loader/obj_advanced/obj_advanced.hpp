@@ -2,6 +2,10 @@
 
 #include "cgp/16_drawable/mesh_drawable/mesh_drawable.hpp"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace cgp
 {
 
@@ -13,9 +17,58 @@ namespace cgp
 		};
 
 		std::vector<cgp::mesh_drawable> convert_to_mesh_drawable(std::vector<shape_element_node> const& elements);
+
+		struct async_state;
 	}
 
 	std::vector<mesh_obj_advanced_loader::shape_element_node> mesh_load_file_obj_advanced(std::string const& directory, std::string const& filename);
 
 
-}
\ No newline at end of file
+	// Handle on an OBJ file loaded in the background (see mesh_load_file_obj_advanced_async)
+	//  The file is parsed by a loading thread, then the meshes of the shapes are built and the textures of the materials are decoded by worker threads.
+	//  The GPU part is done by update(), called once per frame from the render thread: it sends the data that is ready, within a time budget,
+	//  so that large files stream in over several frames without freezing the window.
+	//  The drawables are appended in the order of the shapes in the file (same order as convert_to_mesh_drawable). Each mesh is sent once its texture is available.
+	//
+	//  Usage:
+	//  | mesh_obj_advanced_async_structure scene_loader = mesh_load_file_obj_advanced_async(directory, "scene.obj");
+	//  | ...
+	//  | // in the animation loop
+	//  | scene_loader.update(2.0f); // at most ~2ms of GPU upload in this frame
+	//  | for (auto const& drawable : scene_loader.drawables)
+	//  |     draw(drawable, environment);
+	struct mesh_obj_advanced_async_structure
+	{
+		// Drawables already sent to the GPU
+		std::vector<mesh_drawable> drawables;
+
+		mesh_obj_advanced_async_structure();
+		// Wait for the end of the loading threads (the data which is not sent yet is discarded)
+		~mesh_obj_advanced_async_structure();
+		mesh_obj_advanced_async_structure(mesh_obj_advanced_async_structure&&);
+		mesh_obj_advanced_async_structure& operator=(mesh_obj_advanced_async_structure&&);
+
+		// Send the ready textures and meshes to the GPU during at most time_budget_ms (at least one element is sent if one is ready)
+		//  Must be called from the thread owning the OpenGL context.
+		//  Return true when the whole file is loaded: nothing remains to decode, and every texture and shape is sent to the GPU.
+		bool update(float time_budget_ms = 2.0f);
+
+		// True when all the textures and shapes are sent to the GPU
+		bool is_complete() const;
+		// Ratio of the elements (textures and shapes) sent to the GPU, in [0,1]
+		float progress() const;
+
+		// Block until the file is entirely loaded and sent to the GPU
+		void wait();
+
+	private:
+		std::unique_ptr<mesh_obj_advanced_loader::async_state> state;
+		void stop(); // cancel the remaining tasks and wait for the loading threads
+		friend mesh_obj_advanced_async_structure mesh_load_file_obj_advanced_async(std::string const& directory, std::string const& filename, int number_of_threads);
+	};
+
+	// Start the loading of an OBJ file (and of the textures of its materials) in background threads. The function returns immediately.
+	//  number_of_threads: threads building the meshes and decoding the textures (0: number of hardware threads)
+	mesh_obj_advanced_async_structure mesh_load_file_obj_advanced_async(std::string const& directory, std::string const& filename, int number_of_threads = 0);
+
+}
@@ -0,0 +1,70 @@
+#include "job_deque.hpp"
+
+namespace cgp
+{
+	static const int64_t job_deque_mask = job_deque_structure::capacity - 1;
+
+	job_deque_structure::job_deque_structure()
+		: top(0), bottom(0)
+	{
+		for (int k = 0; k < capacity; ++k)
+			buffer[k].store(nullptr, std::memory_order_relaxed);
+	}
+
+	bool job_deque_structure::push(job* j)
+	{
+		int64_t const b = bottom.load(std::memory_order_relaxed);
+		int64_t const t = top.load(std::memory_order_acquire);
+		if (b - t >= capacity)
+			return false;
+
+		buffer[b & job_deque_mask].store(j, std::memory_order_release);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	job* job_deque_structure::pop()
+	{
+		int64_t const b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		// Empty deque
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		job* j = buffer[b & job_deque_mask].load(std::memory_order_acquire);
+		if (t == b) {
+			// Last job: race against the thieves
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				j = nullptr;
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return j;
+	}
+
+	job* job_deque_structure::steal()
+	{
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t const b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return nullptr;
+
+		job* j = buffer[t & job_deque_mask].load(std::memory_order_acquire);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr; // another thread took it
+		return j;
+	}
+
+	int job_deque_structure::size() const
+	{
+		int64_t const b = bottom.load(std::memory_order_relaxed);
+		int64_t const t = top.load(std::memory_order_relaxed);
+		return b > t ? int(b - t) : 0;
+	}
+}
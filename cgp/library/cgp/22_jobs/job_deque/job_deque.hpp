@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace cgp
+{
+	struct job;
+
+	// Lock-free double-ended queue of jobs (Chase-Lev deque with a fixed capacity)
+	//  The owner thread pushes and pops at the bottom (LIFO: the most recent job is still in the cache),
+	//  the other threads steal from the top (FIFO: the oldest jobs, usually the largest ones).
+	//  push() returns false if the deque is full: the caller is then expected to execute the job itself.
+	struct job_deque_structure
+	{
+		static const int capacity = 4096; // power of two
+
+		job_deque_structure();
+
+		// Owner thread only
+		bool push(job* j);
+		job* pop();
+
+		// Any thread
+		job* steal();
+
+		// Approximate number of jobs (exact if called by the owner while no other thread steals)
+		int size() const;
+
+	private:
+		std::atomic<int64_t> top;
+		std::atomic<int64_t> bottom;
+		std::atomic<job*> buffer[capacity];
+	};
+}
@@ -0,0 +1,303 @@
+#include "job_system.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace cgp
+{
+	struct job
+	{
+		std::function<void()> function;
+		job_group_structure* group = nullptr;
+	};
+
+	job_group_structure::job_group_structure()
+		: pending(0), exception(nullptr)
+	{}
+
+	bool job_group_structure::is_done() const
+	{
+		return pending.load(std::memory_order_acquire) == 0;
+	}
+
+	namespace job_system_detail
+	{
+		struct scheduler
+		{
+			// Deque 0 belongs to the main thread, deque k to the worker k
+			std::vector<std::unique_ptr<job_deque_structure>> deques;
+			std::vector<std::thread> threads;
+
+			// Jobs submitted by the threads that do not own a deque
+			std::mutex shared_mutex;
+			std::deque<job*> shared_queue;
+
+			// Jobs of the main thread
+			std::mutex main_thread_mutex;
+			std::deque<job*> main_thread_queue;
+
+			// Sleep of the idle workers
+			std::atomic<int> queued{ 0 };
+			std::atomic<int> sleeping{ 0 };
+			std::mutex sleep_mutex;
+			std::condition_variable wake_up;
+			std::atomic<bool> quit{ false };
+
+			std::thread::id main_thread;
+
+			job* find_job(int index);
+			void execute(job* j);
+			void push(job* j, int index);
+			void worker_loop(int index);
+		};
+
+		// Scheduler and index of the calling thread (set for the worker threads)
+		struct thread_identity
+		{
+			scheduler const* owner = nullptr;
+			int index = -1;
+		};
+		static thread_local thread_identity current_thread;
+
+		static int index_of(scheduler const* s)
+		{
+			if (std::this_thread::get_id() == s->main_thread)
+				return 0;
+			return current_thread.owner == s ? current_thread.index : -1;
+		}
+
+		void scheduler::execute(job* j)
+		{
+			job_group_structure* group = j->group;
+			try {
+				j->function();
+			}
+			catch (...) {
+				if (group != nullptr) {
+					std::lock_guard<std::mutex> lock(group->exception_mutex);
+					if (group->exception == nullptr)
+						group->exception = std::current_exception();
+				}
+				else
+					warning_cgp("Uncaught exception in a job without group", "");
+			}
+			delete j;
+			if (group != nullptr)
+				group->pending.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		void scheduler::push(job* j, int index)
+		{
+			bool pushed = false;
+			if (index >= 0)
+				pushed = deques[index]->push(j);
+			else {
+				std::lock_guard<std::mutex> lock(shared_mutex);
+				shared_queue.push_back(j);
+				pushed = true;
+			}
+
+			// Full deque: the job is executed immediately
+			if (!pushed) {
+				execute(j);
+				return;
+			}
+
+			queued.fetch_add(1, std::memory_order_seq_cst);
+			if (sleeping.load(std::memory_order_seq_cst) > 0) {
+				std::lock_guard<std::mutex> lock(sleep_mutex);
+				wake_up.notify_one();
+			}
+		}
+
+		job* scheduler::find_job(int index)
+		{
+			job* j = nullptr;
+
+			// Own deque first (most recent jobs)
+			if (index >= 0)
+				j = deques[index]->pop();
+
+			// Then the jobs submitted by the other threads
+			if (j == nullptr) {
+				std::lock_guard<std::mutex> lock(shared_mutex);
+				if (!shared_queue.empty()) {
+					j = shared_queue.front();
+					shared_queue.pop_front();
+				}
+			}
+
+			// Then steal the oldest jobs of the other deques
+			int const N = int(deques.size());
+			for (int k = 1; j == nullptr && k <= N; ++k) {
+				int const victim = (std::max(index, 0) + k) % N;
+				if (victim != index)
+					j = deques[victim]->steal();
+			}
+
+			if (j != nullptr)
+				queued.fetch_sub(1, std::memory_order_relaxed);
+			return j;
+		}
+
+		void scheduler::worker_loop(int index)
+		{
+			current_thread.owner = this;
+			current_thread.index = index;
+
+			int idle_rounds = 0;
+			while (!quit.load(std::memory_order_acquire)) {
+				job* j = find_job(index);
+				if (j != nullptr) {
+					execute(j);
+					idle_rounds = 0;
+					continue;
+				}
+
+				// Spin shortly before sleeping: new jobs often come in bursts
+				if (++idle_rounds < 64) {
+					std::this_thread::yield();
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(sleep_mutex);
+				sleeping.fetch_add(1, std::memory_order_seq_cst);
+				wake_up.wait(lock, [this]() { return quit.load() || queued.load(std::memory_order_seq_cst) > 0; });
+				sleeping.fetch_sub(1, std::memory_order_seq_cst);
+				idle_rounds = 0;
+			}
+		}
+	}
+
+	using namespace job_system_detail;
+
+	job_system_structure::job_system_structure(int number_of_worker_threads)
+		: data(new scheduler())
+	{
+#ifdef __EMSCRIPTEN__
+		number_of_worker_threads = 0;
+#else
+		if (number_of_worker_threads <= 0)
+			number_of_worker_threads = std::max(int(std::thread::hardware_concurrency()) - 1, 0);
+#endif
+
+		for (int k = 0; k < number_of_worker_threads + 1; ++k)
+			data->deques.push_back(std::unique_ptr<job_deque_structure>(new job_deque_structure()));
+
+		// The calling thread is the main thread
+		data->main_thread = std::this_thread::get_id();
+
+		scheduler* s = data.get();
+		for (int k = 1; k <= number_of_worker_threads; ++k)
+			data->threads.push_back(std::thread([s, k]() { s->worker_loop(k); }));
+	}
+
+	job_system_structure::~job_system_structure()
+	{
+		{
+			std::lock_guard<std::mutex> lock(data->sleep_mutex);
+			data->quit = true;
+		}
+		data->wake_up.notify_all();
+		for (auto& thread : data->threads)
+			thread.join();
+
+		// Jobs that were never executed
+		for (auto& deque : data->deques)
+			while (job* j = deque->pop())
+				delete j;
+		for (job* j : data->shared_queue)
+			delete j;
+		for (job* j : data->main_thread_queue)
+			delete j;
+	}
+
+	void job_system_structure::run(std::function<void()> const& function, job_group_structure* group)
+	{
+		job* j = new job();
+		j->function = function;
+		j->group = group;
+		if (group != nullptr)
+			group->pending.fetch_add(1, std::memory_order_relaxed);
+
+		// No worker: sequential execution
+		if (data->threads.empty()) {
+			data->execute(j);
+			return;
+		}
+		data->push(j, index_of(data.get()));
+	}
+
+	void job_system_structure::wait(job_group_structure& group)
+	{
+		int const index = index_of(data.get());
+		while (!group.is_done()) {
+			job* j = data->find_job(index);
+			if (j != nullptr)
+				data->execute(j);
+			else if (index != 0 || execute_main_thread_jobs() == 0)
+				std::this_thread::yield();
+		}
+
+		std::exception_ptr exception;
+		{
+			std::lock_guard<std::mutex> lock(group.exception_mutex);
+			std::swap(exception, group.exception);
+		}
+		if (exception != nullptr)
+			std::rethrow_exception(exception);
+	}
+
+	void job_system_structure::run_on_main_thread(std::function<void()> const& function, job_group_structure* group)
+	{
+		job* j = new job();
+		j->function = function;
+		j->group = group;
+		if (group != nullptr)
+			group->pending.fetch_add(1, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(data->main_thread_mutex);
+		data->main_thread_queue.push_back(j);
+	}
+
+	int job_system_structure::execute_main_thread_jobs()
+	{
+		assert_cgp(is_main_thread(), "execute_main_thread_jobs() must be called from the main thread");
+
+		// The jobs queued during the execution are kept for the next call
+		std::deque<job*> jobs;
+		{
+			std::lock_guard<std::mutex> lock(data->main_thread_mutex);
+			std::swap(jobs, data->main_thread_queue);
+		}
+		for (job* j : jobs)
+			data->execute(j);
+		return int(jobs.size());
+	}
+
+	int job_system_structure::number_of_threads() const
+	{
+		return int(data->deques.size());
+	}
+
+	int job_system_structure::thread_index() const
+	{
+		return index_of(data.get());
+	}
+
+	bool job_system_structure::is_main_thread() const
+	{
+		return thread_index() == 0;
+	}
+
+	job_system_structure& default_job_system()
+	{
+		static job_system_structure system;
+		return system;
+	}
+}
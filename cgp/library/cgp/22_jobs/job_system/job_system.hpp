@@ -0,0 +1,81 @@
+#pragma once
+
+#include "../job_deque/job_deque.hpp"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace cgp
+{
+	namespace job_system_detail { struct scheduler; }
+
+	// Counter of the unfinished jobs of a group, used to wait for their completion
+	//  The first exception thrown by a job of the group is rethrown by job_system_structure::wait().
+	struct job_group_structure
+	{
+		job_group_structure();
+		job_group_structure(job_group_structure const&) = delete;
+		job_group_structure& operator=(job_group_structure const&) = delete;
+
+		// True if all the jobs of the group are finished
+		bool is_done() const;
+
+	private:
+		friend struct job_system_structure;
+		friend struct job_system_detail::scheduler;
+		std::atomic<int> pending;
+		std::mutex exception_mutex;
+		std::exception_ptr exception;
+	};
+
+	// Work-stealing scheduler shared by the library and the application
+	//  - Each worker thread owns a lock-free deque of jobs (see job_deque_structure): the jobs it creates are pushed and popped locally,
+	//    and an idle worker steals the oldest jobs of the other deques. Idle workers sleep until new jobs are submitted.
+	//  - The thread that created the system (the main thread, owning the OpenGL context) has its own deque and executes jobs while it waits.
+	//    Jobs submitted by other threads go through a shared queue.
+	//  - Jobs that must run on the main thread (OpenGL calls) are queued with run_on_main_thread(), and executed
+	//    either by execute_main_thread_jobs() (ex. once per frame) or when the main thread waits.
+	//  Without worker threads (single core, emscripten) the jobs are executed immediately by run().
+	//
+	//  Usage:
+	//  | job_system_structure& jobs = default_job_system();
+	//  | job_group_structure group;
+	//  | jobs.run([&]() { mesh = create_mesh(); }, &group);
+	//  | jobs.run([&]() { image = image_load_file("image.png"); }, &group);
+	//  | jobs.wait(group); // the calling thread executes jobs meanwhile
+	struct job_system_structure
+	{
+		// Start number_of_worker_threads threads (0: number of hardware threads minus one, the main thread being the last one)
+		explicit job_system_structure(int number_of_worker_threads = 0);
+		~job_system_structure();
+
+		job_system_structure(job_system_structure const&) = delete;
+		job_system_structure& operator=(job_system_structure const&) = delete;
+
+		// Submit a job. If group is not null, the job is counted in the group until it is finished.
+		void run(std::function<void()> const& function, job_group_structure* group = nullptr);
+
+		// Execute jobs until all the jobs of the group are finished, then rethrow the first exception of the group if any
+		void wait(job_group_structure& group);
+
+		// Queue a job that must be executed by the main thread
+		void run_on_main_thread(std::function<void()> const& function, job_group_structure* group = nullptr);
+		// Execute the jobs queued for the main thread (must be called from the main thread). Return the number of executed jobs.
+		int execute_main_thread_jobs();
+
+		// Number of threads executing the jobs (workers and main thread)
+		int number_of_threads() const;
+		// Index of the calling thread: 0 for the main thread, 1..N for the workers, -1 for the other threads
+		int thread_index() const;
+		bool is_main_thread() const;
+
+	private:
+		std::unique_ptr<job_system_detail::scheduler> data;
+	};
+
+	// Scheduler shared by the whole program, created on the first call (which should be done by the main thread)
+	job_system_structure& default_job_system();
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "job_deque/job_deque.hpp"
+#include "job_system/job_system.hpp"
+#include "parallel_for/parallel_for.hpp"
+#include "task_graph/task_graph.hpp"
@@ -0,0 +1,50 @@
+#include "parallel_for.hpp"
+#include "cgp/01_base/parallel/parallel.hpp"
+
+#include <algorithm>
+
+namespace cgp
+{
+	// Submit the upper halves of the range as jobs and process the remaining lower chunk
+	static void parallel_for_split(size_t begin, size_t end, size_t grain_size, std::function<void(size_t, size_t)> const& function, job_system_structure& system, job_group_structure& group)
+	{
+		while (end - begin > grain_size) {
+			size_t const middle = begin + (end - begin) / 2;
+			size_t const upper_end = end;
+			system.run([middle, upper_end, grain_size, &function, &system, &group]() {
+				parallel_for_split(middle, upper_end, grain_size, function, system, group);
+			}, &group);
+			end = middle;
+		}
+		function(begin, end);
+	}
+
+	void parallel_for_range(size_t begin, size_t end, std::function<void(size_t, size_t)> const& function, size_t grain_size, job_system_structure& system)
+	{
+		if (end <= begin)
+			return;
+
+		size_t const N = end - begin;
+		size_t const number_of_threads = size_t(system.number_of_threads());
+		if (grain_size == 0)
+			grain_size = std::max(N / (4 * number_of_threads), size_t(1));
+
+		// Sequential execution if there is nothing to share
+		if (number_of_threads == 1 || N <= grain_size) {
+			function(begin, end);
+			return;
+		}
+
+		job_group_structure group;
+		parallel_for_split(begin, end, grain_size, function, system, group);
+		system.wait(group);
+	}
+
+	// The job system schedules the parallel loops of the modules that cannot depend on it (see 01_base/parallel).
+	//  The scheduler is installed at static initialization, the default job system itself being created by the first loop.
+	static void parallel_chunks_on_job_system(size_t begin, size_t end, std::function<void(size_t, size_t)> const& function, size_t grain_size)
+	{
+		parallel_for_range(begin, end, function, grain_size);
+	}
+	static bool const parallel_chunks_installed = (set_parallel_chunks_scheduler(parallel_chunks_on_job_system), true);
+}
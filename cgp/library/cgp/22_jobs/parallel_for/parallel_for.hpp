@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../job_system/job_system.hpp"
+
+#include <cstddef>
+#include <functional>
+
+namespace cgp
+{
+	// Call function(chunk_begin, chunk_end) on consecutive chunks covering [begin, end[, in parallel on the job system
+	//  The range is split recursively in halves until the chunks contain at most grain_size indices: the idle threads steal the largest halves.
+	//  grain_size = 0 selects a size giving about 4 chunks per thread. The function returns when all the chunks are processed.
+	//  The lower level modules reach it through parallel_chunks (01_base/parallel), on default_job_system().
+	//
+	//  Usage:
+	//  | parallel_for_range(0, N, [&](size_t k0, size_t k1) { for (size_t k = k0; k < k1; ++k) ... });
+	void parallel_for_range(size_t begin, size_t end, std::function<void(size_t, size_t)> const& function, size_t grain_size = 0, job_system_structure& system = default_job_system());
+
+	// Call function(k) for each k in [begin, end[, in parallel (same splitting as parallel_for_range)
+	//
+	//  Usage:
+	//  | parallel_for(0, mesh.position.size(), [&](size_t k) { mesh.position[k] *= 2.0f; }, 1024);
+	template <typename F>
+	void parallel_for(size_t begin, size_t end, F const& function, size_t grain_size = 0, job_system_structure& system = default_job_system())
+	{
+		parallel_for_range(begin, end, [&function](size_t chunk_begin, size_t chunk_end) {
+			for (size_t k = chunk_begin; k < chunk_end; ++k)
+				function(k);
+		}, grain_size, system);
+	}
+}
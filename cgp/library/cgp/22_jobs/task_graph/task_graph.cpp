@@ -0,0 +1,75 @@
+#include "task_graph.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+namespace cgp
+{
+	int task_graph_structure::add_task(std::function<void()> const& function, std::vector<int> const& dependencies, bool main_thread)
+	{
+		int const index = int(tasks.size());
+		for (int dependency : dependencies) {
+			assert_cgp(dependency >= 0 && dependency < index, "Dependency " + str(dependency) + " of the task " + str(index) + " must refer to a previously added task");
+			tasks[dependency].successors.push_back(index);
+		}
+
+		task t;
+		t.function = function;
+		t.main_thread = main_thread;
+		t.number_of_dependencies = int(dependencies.size());
+		tasks.push_back(t);
+		return index;
+	}
+
+	int task_graph_structure::add(std::function<void()> const& function, std::vector<int> const& dependencies)
+	{
+		return add_task(function, dependencies, false);
+	}
+
+	int task_graph_structure::add_main_thread(std::function<void()> const& function, std::vector<int> const& dependencies)
+	{
+		return add_task(function, dependencies, true);
+	}
+
+	void task_graph_structure::run(job_system_structure& system)
+	{
+		int const N = int(tasks.size());
+		if (N == 0)
+			return;
+
+		// Number of unfinished dependencies of each task during this run
+		std::unique_ptr<std::atomic<int>[]> remaining(new std::atomic<int>[N]);
+		for (int k = 0; k < N; ++k)
+			remaining[k].store(tasks[k].number_of_dependencies, std::memory_order_relaxed);
+
+		job_group_structure group;
+		std::function<void(int)> submit;
+		submit = [&](int k) {
+			auto execute = [&, k]() {
+				tasks[k].function();
+				// Start the successors whose dependencies are all finished
+				for (int successor : tasks[k].successors)
+					if (remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+						submit(successor);
+			};
+			if (tasks[k].main_thread)
+				system.run_on_main_thread(execute, &group);
+			else
+				system.run(execute, &group);
+		};
+
+		for (int k = 0; k < N; ++k)
+			if (tasks[k].number_of_dependencies == 0)
+				submit(k);
+		system.wait(group);
+	}
+
+	int task_graph_structure::size() const
+	{
+		return int(tasks.size());
+	}
+
+	void task_graph_structure::clear()
+	{
+		tasks.clear();
+	}
+}
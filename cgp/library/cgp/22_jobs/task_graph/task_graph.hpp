@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../job_system/job_system.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace cgp
+{
+	// Set of tasks with dependencies, executed on the job system
+	//  A task is started as soon as all the tasks it depends on are finished. The dependencies can only refer to tasks already added:
+	//  the graph is acyclic by construction. A task marked as main-thread (ex. sending data to the GPU) is executed by the main thread.
+	//  The same graph can be run several times.
+	//
+	//  Usage:
+	//  | task_graph_structure graph;
+	//  | int const terrain = graph.add([&]() { terrain_mesh = create_terrain_mesh(); });
+	//  | int const trees = graph.add([&]() { tree_positions = generate_positions(); }, { terrain });
+	//  | graph.add_main_thread([&]() { terrain_drawable.initialize_data_on_gpu(terrain_mesh); }, { terrain });
+	//  | graph.run(); // from the main thread
+	struct task_graph_structure
+	{
+		// Add a task executed after the tasks of the given indices. Return the index of the new task.
+		int add(std::function<void()> const& function, std::vector<int> const& dependencies = {});
+		// Same as add(), the task being executed by the main thread
+		int add_main_thread(std::function<void()> const& function, std::vector<int> const& dependencies = {});
+
+		// Execute all the tasks and wait for their completion (the first exception thrown by a task is rethrown)
+		//  If the graph contains main-thread tasks, run() must be called from the main thread.
+		void run(job_system_structure& system = default_job_system());
+
+		int size() const;
+		void clear();
+
+	private:
+		struct task
+		{
+			std::function<void()> function;
+			bool main_thread = false;
+			int number_of_dependencies = 0;
+			std::vector<int> successors;
+		};
+		std::vector<task> tasks;
+
+		int add_task(std::function<void()> const& function, std::vector<int> const& dependencies, bool main_thread);
+	};
+}
@@ -0,0 +1,115 @@
+#include "test_jobs.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/01_base/parallel/parallel.hpp"
+#include "../jobs.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace cgp_test
+{
+	void test_jobs()
+	{
+		using namespace cgp;
+
+		// Workers are created even on a single core machine to test the stealing
+		job_system_structure jobs(3);
+		assert_cgp_no_msg(jobs.number_of_threads() == 4);
+		assert_cgp_no_msg(jobs.is_main_thread());
+
+		// Jobs and groups
+		{
+			std::atomic<int> counter(0);
+			job_group_structure group;
+			for (int k = 0; k < 1000; ++k)
+				jobs.run([&counter]() { counter++; }, &group);
+			jobs.wait(group);
+			assert_cgp_no_msg(group.is_done());
+			assert_cgp_no_msg(counter == 1000);
+		}
+
+		// Exceptions are rethrown by wait()
+		{
+			job_group_structure group;
+			jobs.run([]() { throw std::runtime_error("job error"); }, &group);
+			bool thrown = false;
+			try { jobs.wait(group); }
+			catch (std::runtime_error const&) { thrown = true; }
+			assert_cgp_no_msg(thrown);
+		}
+
+		// parallel_for covers each index exactly once, for different grain sizes
+		for (size_t grain : { size_t(0), size_t(1), size_t(7), size_t(5000) }) {
+			std::vector<int> a(4321, 0);
+			parallel_for(0, a.size(), [&a](size_t k) { a[k] += int(k); }, grain, jobs);
+			bool ok = true;
+			for (size_t k = 0; k < a.size(); ++k)
+				ok = ok && a[k] == int(k);
+			assert_cgp_no_msg(ok);
+		}
+		{
+			std::atomic<size_t> sum(0);
+			parallel_for_range(10, 110, [&sum](size_t k0, size_t k1) { for (size_t k = k0; k < k1; ++k) sum += k; }, 8, jobs);
+			assert_cgp_no_msg(sum == 5950);
+		}
+
+		// Nested parallel_for
+		{
+			std::atomic<int> counter(0);
+			parallel_for(0, 16, [&](size_t) {
+				parallel_for(0, 100, [&counter](size_t) { counter++; }, 10, jobs);
+			}, 1, jobs);
+			assert_cgp_no_msg(counter == 1600);
+		}
+
+		// The job system is installed as the scheduler of parallel_chunks, which falls back to a sequential loop without scheduler
+		{
+			parallel_chunks_scheduler const scheduler = set_parallel_chunks_scheduler(nullptr);
+			assert_cgp_no_msg(scheduler != nullptr);
+			for (int run = 0; run < 2; ++run) {
+				std::vector<int> a(4321, 0);
+				parallel_indices(0, a.size(), [&a](size_t k) { a[k] += int(k); }, 100);
+				bool ok = true;
+				for (size_t k = 0; k < a.size(); ++k)
+					ok = ok && a[k] == int(k);
+				assert_cgp_no_msg(ok);
+				set_parallel_chunks_scheduler(scheduler);
+			}
+			assert_cgp_no_msg(set_parallel_chunks_scheduler(scheduler) == scheduler);
+		}
+
+		// Task graph: each task is executed after its dependencies, main-thread tasks on the main thread
+		{
+			std::atomic<int> step(0);
+			int order_a = -1, order_b = -1, order_c = -1, order_d = -1;
+			bool d_on_main_thread = false;
+
+			task_graph_structure graph;
+			int const a = graph.add([&]() { order_a = step++; });
+			int const b = graph.add([&]() { order_b = step++; }, { a });
+			int const c = graph.add([&]() { order_c = step++; }, { a });
+			graph.add_main_thread([&]() { order_d = step++; d_on_main_thread = jobs.is_main_thread(); }, { b, c });
+			assert_cgp_no_msg(graph.size() == 4);
+
+			for (int run = 0; run < 3; ++run) {
+				step = 0;
+				graph.run(jobs);
+				assert_cgp_no_msg(order_a == 0);
+				assert_cgp_no_msg(order_b > order_a && order_c > order_a);
+				assert_cgp_no_msg(order_d == 3);
+				assert_cgp_no_msg(d_on_main_thread);
+			}
+		}
+
+		// Main thread queue
+		{
+			int value = 0;
+			jobs.run_on_main_thread([&value]() { value = 1; });
+			assert_cgp_no_msg(jobs.execute_main_thread_jobs() == 1);
+			assert_cgp_no_msg(value == 1);
+			assert_cgp_no_msg(jobs.execute_main_thread_jobs() == 0);
+		}
+	}
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "profiler/profiler.hpp"
+#include "profiler_gui/profiler_gui.hpp"
+#include "render_stats_gui/render_stats_gui.hpp"
@@ -0,0 +1,264 @@
+#include "profiler.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../../13_opengl/debug/debug.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+namespace cgp
+{
+	std::atomic<bool> profiler_structure::enabled(false);
+
+	static std::chrono::steady_clock::time_point const profiler_epoch = std::chrono::steady_clock::now();
+
+	// Index of the calling thread in the events (in the order of their first event)
+	static int profiler_thread_index()
+	{
+		static std::atomic<int> counter(0);
+		thread_local int const index = counter++;
+		return index;
+	}
+
+	int& profiler_thread_depth()
+	{
+		thread_local int depth = 0;
+		return depth;
+	}
+
+	int& profiler_gpu_depth()
+	{
+		static int depth = 0;
+		return depth;
+	}
+
+	profiler_structure& default_profiler()
+	{
+		static profiler_structure profiler;
+		return profiler;
+	}
+
+	profiler_structure::profiler_structure()
+	{}
+
+	double profiler_structure::now() const
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - profiler_epoch).count();
+	}
+
+	void profiler_structure::record_cpu(char const* name, double start, double end, int depth)
+	{
+		profiler_event event;
+		event.name = name;
+		event.start = start;
+		event.duration = end - start;
+		event.depth = depth;
+		event.thread = profiler_thread_index();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		current.events.push_back(event);
+	}
+
+	void profiler_structure::frame_begin()
+	{
+		if (!enabled && !frame_open && gpu_pending.empty())
+			return;
+		if (gpu_queries.size() > 0)
+			read_gpu_queries();
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// Events recorded before the first frame (ex. initialization) are kept as a frame
+		std::vector<profiler_event> previous_events;
+		if (!frame_open && frame_counter == 0 && !current.events.empty()) {
+			double end = current.events[0].start;
+			current.start = end;
+			for (profiler_event const& event : current.events) {
+				current.start = std::min(current.start, event.start);
+				end = std::max(end, event.start + event.duration);
+			}
+			current.duration = end - current.start;
+			current.index = frame_counter++;
+			history.push_back(std::move(current));
+		}
+		// Events recorded between the previous frame and this one (ex. by the simulation thread) belong to this frame
+		else if (!frame_open)
+			previous_events = std::move(current.events);
+
+		current = profiler_frame();
+		current.index = frame_counter++;
+		current.start = now();
+		current.events = std::move(previous_events);
+		frame_open = true;
+
+		while (int(history.size()) > std::max(max_frames, 1))
+			history.pop_front();
+	}
+
+	void profiler_structure::frame_end()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!frame_open)
+			return;
+		current.duration = now() - current.start;
+		history.push_back(std::move(current));
+		current = profiler_frame();
+		frame_open = false;
+	}
+
+	std::deque<profiler_frame> const& profiler_structure::frames() const
+	{
+		return history;
+	}
+
+	void profiler_structure::clear_history()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		history.clear();
+		gpu_pending.clear();
+		std::fill(gpu_query_used.begin(), gpu_query_used.end(), false);
+	}
+
+	void profiler_structure::clear()
+	{
+		clear_history();
+#ifndef __EMSCRIPTEN__
+		if (!gpu_queries.empty())
+			glDeleteQueries(GLsizei(gpu_queries.size()), gpu_queries.data());
+#endif
+		gpu_queries.clear();
+		gpu_query_used.clear();
+		gpu_query_next = 0;
+	}
+
+	int profiler_structure::gpu_query()
+	{
+#ifndef __EMSCRIPTEN__
+		if (gpu_queries.empty()) {
+			int const N = std::max(gpu_query_ring_size, 2);
+			gpu_queries.resize(N);
+			gpu_query_used.assign(N, false);
+			glGenQueries(GLsizei(N), gpu_queries.data()); opengl_check;
+		}
+
+		// The ring is full: the section is not measured
+		int const k = gpu_query_next;
+		if (gpu_query_used[k])
+			return -1;
+
+		gpu_query_used[k] = true;
+		gpu_query_next = (k + 1) % int(gpu_queries.size());
+		glQueryCounter(gpu_queries[k], GL_TIMESTAMP); opengl_check;
+		return k;
+#else
+		return -1;
+#endif
+	}
+
+	void profiler_structure::record_gpu(char const* name, int query_begin, int query_end, int depth)
+	{
+		if (query_end < 0) {
+			if (query_begin >= 0)
+				gpu_query_used[query_begin] = false;
+			return;
+		}
+		gpu_pending.push_back({ name, query_begin, query_end, depth, current.index });
+	}
+
+	void profiler_structure::read_gpu_queries()
+	{
+#ifndef __EMSCRIPTEN__
+		// Offset between the GPU and CPU clocks
+		GLint64 gpu_now = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+		gpu_offset = now() - double(gpu_now) / 1000.0;
+
+		size_t k = 0;
+		for (; k < gpu_pending.size(); ++k) {
+			gpu_section const& section = gpu_pending[k];
+
+			// The queries are finished in order: stop at the first one that is not available
+			GLuint available = 0;
+			glGetQueryObjectuiv(gpu_queries[section.query_end], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available == 0)
+				break;
+
+			GLuint64 time_begin = 0, time_end = 0;
+			glGetQueryObjectui64v(gpu_queries[section.query_begin], GL_QUERY_RESULT, &time_begin);
+			glGetQueryObjectui64v(gpu_queries[section.query_end], GL_QUERY_RESULT, &time_end);
+			gpu_query_used[section.query_begin] = false;
+			gpu_query_used[section.query_end] = false;
+
+			profiler_event event;
+			event.name = section.name;
+			event.start = double(time_begin) / 1000.0 + gpu_offset;
+			event.duration = double(time_end - time_begin) / 1000.0;
+			event.depth = section.depth;
+			event.thread = -1;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			for (profiler_frame& frame : history) {
+				if (frame.index == section.frame) {
+					frame.events.push_back(event);
+					break;
+				}
+			}
+		}
+		gpu_pending.erase(gpu_pending.begin(), gpu_pending.begin() + k);
+		opengl_check;
+#endif
+	}
+
+	static std::string json_string(char const* s)
+	{
+		std::string result = "\"";
+		for (char const* c = s; *c != '\0'; ++c) {
+			if (*c == '"' || *c == '\\')
+				result += '\\';
+			result += *c;
+		}
+		return result + "\"";
+	}
+
+	bool profiler_structure::save_chrome_trace(std::string const& filename) const
+	{
+		std::ofstream stream(filename);
+		if (!stream.is_open())
+			return false;
+
+		// Complete events ("ph":"X"): one line per CPU thread, the GPU being displayed on a separate line
+		stream << "{\"traceEvents\":[\n";
+		stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1000,\"args\":{\"name\":\"GPU\"}}";
+		stream.precision(3);
+		stream << std::fixed;
+		for (profiler_frame const& frame : history) {
+			stream << ",\n{\"name\":\"frame " << frame.index << "\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":" << frame.start << ",\"dur\":" << frame.duration << ",\"pid\":0,\"tid\":999}";
+			for (profiler_event const& event : frame.events) {
+				stream << ",\n{\"name\":" << json_string(event.name) << ",\"cat\":\"" << (event.thread < 0 ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"ts\":" << event.start
+					<< ",\"dur\":" << event.duration << ",\"pid\":0,\"tid\":" << (event.thread < 0 ? 1000 : event.thread) << "}";
+			}
+		}
+		stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+		return bool(stream);
+	}
+
+	profiler_gpu_scope::profiler_gpu_scope(char const* name_arg)
+		: name(profiler_structure::enabled ? name_arg : nullptr)
+	{
+		if (name != nullptr) {
+			query_begin = default_profiler().gpu_query();
+			depth = profiler_gpu_depth()++;
+		}
+	}
+
+	profiler_gpu_scope::~profiler_gpu_scope()
+	{
+		if (name != nullptr) {
+			profiler_gpu_depth()--;
+			int const query_end = query_begin >= 0 ? default_profiler().gpu_query() : -1;
+			default_profiler().record_gpu(name, query_begin, query_end, depth);
+		}
+	}
+}
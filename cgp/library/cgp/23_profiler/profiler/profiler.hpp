@@ -0,0 +1,176 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+	// Timed section of a frame
+	//  Times are in microseconds since the creation of the profiler. thread is the index of the CPU thread (0 for the first thread recording events),
+	//  or -1 for the sections measured on the GPU.
+	struct profiler_event
+	{
+		char const* name = nullptr;
+		double start = 0;
+		double duration = 0;
+		int depth = 0;
+		int thread = 0;
+	};
+
+	// Events recorded between frame_begin() and frame_end()
+	struct profiler_frame
+	{
+		int index = 0;
+		double start = 0;
+		double duration = 0;
+		std::vector<profiler_event> events;
+	};
+
+	// Hierarchical CPU and GPU profiler
+	//  - CPU sections are measured by scoped markers (CGP_PROFILE_SCOPE). When profiler_structure::enabled is false, a marker only costs a branch,
+	//    and the markers are removed at compilation when CGP_NO_PROFILER is defined.
+	//  - GPU sections (CGP_PROFILE_GPU_SCOPE) write GL_TIMESTAMP queries at their beginning and end. The queries are taken from a ring
+	//    and read a few frames later, when their result is available: the profiler never waits for the GPU.
+	//    Timestamps are used instead of GL_TIME_ELAPSED queries as they can be nested and placed on the timeline.
+	//  - The last max_frames frames are kept in memory, and can be saved in the Chrome trace format (chrome://tracing, ui.perfetto.dev).
+	//  The names of the sections must be string literals (only the pointer is stored).
+	//
+	//  Usage:
+	//  | profiler_structure::enabled = true;
+	//  | // in the animation loop
+	//  | default_profiler().frame_begin();
+	//  | {
+	//  |     CGP_PROFILE_SCOPE("scene");
+	//  |     CGP_PROFILE_GPU_SCOPE("scene (GPU)");
+	//  |     draw(...);
+	//  | }
+	//  | default_profiler().frame_end();
+	//  | ...
+	//  | default_profiler().save_chrome_trace("trace.json");
+	struct profiler_structure
+	{
+		// Global switch tested by all the markers (read by every thread recording events)
+		static std::atomic<bool> enabled;
+
+		// Number of frames kept in memory
+		int max_frames = 120;
+		// Number of timestamp queries of the GPU ring (two per GPU section)
+		int gpu_query_ring_size = 512;
+
+		profiler_structure();
+
+		// Delimit a frame (called by the main thread)
+		//  The events recorded before the first frame (ex. initialization) are kept as a frame of their own.
+		//  The events recorded later between two frames (ex. by a simulation thread) are added to the next frame.
+		void frame_begin();
+		void frame_end();
+
+		// Completed frames, oldest first (to be accessed by the main thread)
+		std::deque<profiler_frame> const& frames() const;
+
+		// Save the frames in the Chrome trace event format (JSON). Return false if the file cannot be written.
+		bool save_chrome_trace(std::string const& filename) const;
+
+		// Remove the recorded frames
+		void clear_history();
+		// Delete the OpenGL queries (must be called while the context exists)
+		void clear();
+
+		// Current time in microseconds since the creation of the profiler
+		double now() const;
+
+		// Used by the markers
+		void record_cpu(char const* name, double start, double end, int depth);
+		int gpu_query();
+		void record_gpu(char const* name, int query_begin, int query_end, int depth);
+
+	private:
+		std::mutex mutex;
+		profiler_frame current;
+		bool frame_open = false;
+		int frame_counter = 0;
+		std::deque<profiler_frame> history;
+
+		// GPU queries
+		struct gpu_section
+		{
+			char const* name;
+			int query_begin;
+			int query_end;
+			int depth;
+			int frame;
+		};
+		std::vector<GLuint> gpu_queries;
+		std::vector<bool> gpu_query_used;
+		int gpu_query_next = 0;
+		std::vector<gpu_section> gpu_pending;
+		double gpu_offset = 0; // cpu time - gpu time (in microseconds)
+
+		void read_gpu_queries();
+	};
+
+	// Profiler used by the markers
+	profiler_structure& default_profiler();
+
+	// Depth of the current CPU section for the calling thread
+	int& profiler_thread_depth();
+	// Depth of the current GPU section
+	int& profiler_gpu_depth();
+
+	// Marker measuring the CPU time of its scope
+	struct profiler_scope
+	{
+		explicit profiler_scope(char const* name_arg)
+			: name(profiler_structure::enabled ? name_arg : nullptr)
+		{
+			if (name != nullptr) {
+				start = default_profiler().now();
+				depth = profiler_thread_depth()++;
+			}
+		}
+		~profiler_scope()
+		{
+			if (name != nullptr) {
+				profiler_thread_depth()--;
+				default_profiler().record_cpu(name, start, default_profiler().now(), depth);
+			}
+		}
+		profiler_scope(profiler_scope const&) = delete;
+		profiler_scope& operator=(profiler_scope const&) = delete;
+
+	private:
+		char const* name;
+		double start = 0;
+		int depth = 0;
+	};
+
+	// Marker measuring the GPU time of the commands issued in its scope (main thread only)
+	struct profiler_gpu_scope
+	{
+		explicit profiler_gpu_scope(char const* name_arg);
+		~profiler_gpu_scope();
+		profiler_gpu_scope(profiler_gpu_scope const&) = delete;
+		profiler_gpu_scope& operator=(profiler_gpu_scope const&) = delete;
+
+	private:
+		char const* name;
+		int query_begin = -1;
+		int depth = 0;
+	};
+}
+
+#define CGP_PROFILER_CONCATENATE_DETAIL(a, b) a##b
+#define CGP_PROFILER_CONCATENATE(a, b) CGP_PROFILER_CONCATENATE_DETAIL(a, b)
+
+#ifndef CGP_NO_PROFILER
+#define CGP_PROFILE_SCOPE(NAME) cgp::profiler_scope CGP_PROFILER_CONCATENATE(cgp_profiler_scope_, __LINE__)(NAME)
+#define CGP_PROFILE_GPU_SCOPE(NAME) cgp::profiler_gpu_scope CGP_PROFILER_CONCATENATE(cgp_profiler_gpu_scope_, __LINE__)(NAME)
+#else
+#define CGP_PROFILE_SCOPE(NAME)
+#define CGP_PROFILE_GPU_SCOPE(NAME)
+#endif
@@ -0,0 +1,42 @@
+#include "test_profiler.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../profiler.hpp"
+
+#include <thread>
+
+namespace cgp_test
+{
+	void test_profiler()
+	{
+		using namespace cgp;
+
+		// Only CPU events are recorded: no OpenGL context is needed
+		profiler_structure profiler;
+		profiler_structure::enabled = true;
+
+		// Events before the first frame: kept as a frame of their own
+		profiler.record_cpu("initialization", 0.0, 10.0, 0);
+
+		profiler.frame_begin();
+		profiler.record_cpu("scene", profiler.now(), profiler.now(), 0);
+		profiler.frame_end();
+		assert_cgp_no_msg(profiler.frames().size() == 2);
+		assert_cgp_no_msg(profiler.frames()[0].index == 0 && profiler.frames()[0].events.size() == 1);
+		assert_cgp_no_msg(profiler.frames()[1].index == 1 && profiler.frames()[1].events.size() == 1);
+
+		// Event recorded by another thread between two frames: added to the next frame, without creating a frame
+		std::thread simulation([&profiler]() { profiler.record_cpu("simulate", profiler.now(), profiler.now(), 0); });
+		simulation.join();
+		profiler.frame_begin();
+		profiler.record_cpu("scene", profiler.now(), profiler.now(), 0);
+		profiler.frame_end();
+		assert_cgp_no_msg(profiler.frames().size() == 3);
+		profiler_frame const& frame = profiler.frames().back();
+		assert_cgp_no_msg(frame.index == 2);
+		assert_cgp_no_msg(frame.events.size() == 2);
+		assert_cgp_no_msg(frame.events[0].thread != frame.events[1].thread);
+
+		profiler_structure::enabled = false;
+	}
+}
@@ -0,0 +1,120 @@
+#include "profiler_gui.hpp"
+
+#include "cgp/14_window/imgui/imgui.hpp"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace cgp
+{
+	// Color of a section, constant for a given name
+	static ImU32 profiler_color(char const* name, bool gpu)
+	{
+		unsigned int h = 2166136261u;
+		for (char const* c = name; *c != '\0'; ++c)
+			h = (h ^ static_cast<unsigned char>(*c)) * 16777619u;
+		float const v = 0.55f + 0.35f * float(h % 256) / 255.0f;
+		float const w = 0.35f + 0.35f * float((h >> 8) % 256) / 255.0f;
+		return gpu ? ImGui::ColorConvertFloat4ToU32(ImVec4(w, v, 0.35f, 1.0f)) : ImGui::ColorConvertFloat4ToU32(ImVec4(v, w, 0.3f, 1.0f));
+	}
+
+	static void profiler_display_flame_graph(profiler_frame const& frame)
+	{
+		float const row_height = ImGui::GetTextLineHeight() + 4;
+
+		// Events grouped by thread (the GPU, index -1, is displayed last)
+		std::map<int, int> number_of_rows;
+		for (profiler_event const& event : frame.events) {
+			int& rows = number_of_rows[event.thread < 0 ? 1 << 30 : event.thread];
+			rows = std::max(rows, event.depth + 1);
+		}
+		std::map<int, float> row_offset;
+		float height = 0;
+		for (auto const& it : number_of_rows) {
+			row_offset[it.first] = height;
+			height += (it.second + 1) * row_height;
+		}
+		if (height == 0) {
+			ImGui::Text("No section recorded in this frame");
+			return;
+		}
+
+		// Time range: the frame and the GPU sections that may end after it
+		double time_begin = frame.start;
+		double time_end = frame.start + frame.duration;
+		for (profiler_event const& event : frame.events) {
+			time_begin = std::min(time_begin, event.start);
+			time_end = std::max(time_end, event.start + event.duration);
+		}
+		double const time_scale = time_end > time_begin ? 1.0 / (time_end - time_begin) : 0.0;
+
+		float const width = std::max(ImGui::GetContentRegionAvail().x, 300.0f);
+		ImVec2 const origin = ImGui::GetCursorScreenPos();
+		ImGui::InvisibleButton("profiler_flame_graph", ImVec2(width, height));
+		bool const hovered = ImGui::IsItemHovered();
+		ImVec2 const mouse = ImGui::GetIO().MousePos;
+
+		ImDrawList* draw_list = ImGui::GetWindowDrawList();
+		for (auto const& it : number_of_rows) {
+			std::string const label = it.first == 1 << 30 ? std::string("GPU") : "Thread " + std::to_string(it.first);
+			draw_list->AddText(ImVec2(origin.x, origin.y + row_offset[it.first]), ImGui::GetColorU32(ImGuiCol_TextDisabled), label.c_str());
+		}
+
+		for (profiler_event const& event : frame.events) {
+			int const key = event.thread < 0 ? 1 << 30 : event.thread;
+			float const x0 = origin.x + float((event.start - time_begin) * time_scale) * width;
+			float const x1 = std::max(x0 + 1.0f, origin.x + float((event.start + event.duration - time_begin) * time_scale) * width);
+			float const y0 = origin.y + row_offset[key] + (event.depth + 1) * row_height;
+			float const y1 = y0 + row_height - 1;
+
+			draw_list->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), profiler_color(event.name, event.thread < 0));
+			if (ImGui::CalcTextSize(event.name).x < x1 - x0 - 4) {
+				draw_list->PushClipRect(ImVec2(x0, y0), ImVec2(x1, y1), true);
+				draw_list->AddText(ImVec2(x0 + 2, y0 + 2), IM_COL32(0, 0, 0, 255), event.name);
+				draw_list->PopClipRect();
+			}
+
+			if (hovered && mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1)
+				ImGui::SetTooltip("%s\n%.3f ms (%s)", event.name, event.duration / 1000.0, event.thread < 0 ? "GPU" : "CPU");
+		}
+	}
+
+	void profiler_display_gui(profiler_structure& profiler, std::string const& trace_filename)
+	{
+		bool enabled = profiler_structure::enabled;
+		if (ImGui::Checkbox("Enable profiler", &enabled))
+			profiler_structure::enabled = enabled;
+
+		static std::string save_message;
+		if (ImGui::Button("Save Chrome trace")) {
+			bool const saved = profiler.save_chrome_trace(trace_filename);
+			save_message = saved ? "Saved in " + trace_filename : "Cannot write " + trace_filename;
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Clear"))
+			profiler.clear_history();
+		if (!save_message.empty())
+			ImGui::Text("%s", save_message.c_str());
+
+		std::deque<profiler_frame> const& frames = profiler.frames();
+		if (frames.empty())
+			return;
+
+		// Duration of the frames
+		std::vector<float> durations;
+		for (profiler_frame const& frame : frames)
+			durations.push_back(float(frame.duration / 1000.0));
+		ImGui::PlotHistogram("##profiler_frames", durations.data(), int(durations.size()), 0, "frame duration (ms)", 0.0f, FLT_MAX, ImVec2(0, 50));
+
+		// Selection of the displayed frame (counted from the last one). The GPU sections of the last frames are usually not yet available.
+		static int frame_offset = 3;
+		int const N = int(frames.size());
+		ImGui::SliderInt("Frame (from last)", &frame_offset, 0, N - 1);
+		frame_offset = std::max(0, std::min(frame_offset, N - 1));
+		profiler_frame const& frame = frames[N - 1 - frame_offset];
+		ImGui::Text("Frame %d: %.3f ms, %d sections", frame.index, frame.duration / 1000.0, int(frame.events.size()));
+
+		profiler_display_flame_graph(frame);
+	}
+}
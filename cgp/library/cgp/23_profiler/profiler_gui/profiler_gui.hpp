@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../profiler/profiler.hpp"
+
+#include <string>
+
+namespace cgp
+{
+	// ImGui panel of the profiler (to be called between ImGui::Begin() and ImGui::End())
+	//  - Activation of the profiler and export of the recorded frames in the Chrome trace format (trace_filename).
+	//  - Plot of the duration of the last frames, and flame graph of a selected frame:
+	//    one block per CPU thread and one for the GPU, the nested sections being displayed under their parent.
+	void profiler_display_gui(profiler_structure& profiler, std::string const& trace_filename);
+}
@@ -0,0 +1,56 @@
+#include "render_stats_gui.hpp"
+
+#include "cgp/14_window/imgui/imgui.hpp"
+
+#include <cstdio>
+
+namespace cgp
+{
+	std::string render_stats_summary(render_stats_structure const& stats)
+	{
+		render_stats_counters const& total = stats.last_frame().total;
+		char buffer[128];
+		std::snprintf(buffer, sizeof(buffer), "%d draws, %.1fk triangles", total.draw_calls, double(total.triangles) / 1000.0);
+		return buffer;
+	}
+
+	static void render_stats_row(char const* name, render_stats_counters const& c)
+	{
+		ImGui::Text("%s", name); ImGui::NextColumn();
+		ImGui::Text("%d", c.draw_calls); ImGui::NextColumn();
+		ImGui::Text("%d", c.program_switches); ImGui::NextColumn();
+		ImGui::Text("%d", c.texture_binds); ImGui::NextColumn();
+		ImGui::Text("%d", c.uniform_uploads); ImGui::NextColumn();
+		ImGui::Text("%zu", c.triangles); ImGui::NextColumn();
+	}
+
+	void render_stats_display_gui(render_stats_structure& stats, std::string const& filename_prefix)
+	{
+		ImGui::Checkbox("Enable render statistics", &render_stats_structure::enabled);
+
+		static std::string save_message;
+		if (ImGui::Button("Save CSV/JSON")) {
+			bool const saved = stats.save_csv(filename_prefix + ".csv") && stats.save_json(filename_prefix + ".json");
+			save_message = saved ? "Saved " + std::to_string(stats.frames().size()) + " frames in " + filename_prefix + ".csv/json" : "Cannot write " + filename_prefix + ".csv/json";
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Clear"))
+			stats.clear_history();
+		if (!save_message.empty())
+			ImGui::Text("%s", save_message.c_str());
+
+		render_stats_frame const& frame = stats.last_frame();
+		ImGui::Columns(6, "render_stats_columns");
+		ImGui::Text("scope"); ImGui::NextColumn();
+		ImGui::Text("draws"); ImGui::NextColumn();
+		ImGui::Text("programs"); ImGui::NextColumn();
+		ImGui::Text("textures"); ImGui::NextColumn();
+		ImGui::Text("uniforms"); ImGui::NextColumn();
+		ImGui::Text("triangles"); ImGui::NextColumn();
+		ImGui::Separator();
+		render_stats_row("total", frame.total);
+		for (render_stats_scope_counters const& scope : frame.scopes)
+			render_stats_row(scope.name, scope.counters);
+		ImGui::Columns(1);
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "cgp/13_opengl/render_stats/render_stats.hpp"
+
+#include <string>
+
+namespace cgp
+{
+	// One line summary of the last frame (draw calls and triangles), ex. to be displayed next to the FPS
+	std::string render_stats_summary(render_stats_structure const& stats);
+
+	// ImGui panel of the render statistics (to be called between ImGui::Begin() and ImGui::End())
+	//  - Counters of the last frame, in total and per scope.
+	//  - Export of the kept frames in filename_prefix + ".csv" and filename_prefix + ".json".
+	void render_stats_display_gui(render_stats_structure& stats, std::string const& filename_prefix);
+}